@@ -3,7 +3,7 @@ LOCAL_PATH := $(call my-dir)
 include $(CLEAR_VARS)
 
 LOCAL_MODULE := openxr_overlay_app
-LOCAL_SRC_FILES := main.cpp
+LOCAL_SRC_FILES := main.cpp alloc_guard.cpp frame_analyzer.cpp frame_arena.cpp frame_capture.cpp frame_stats.cpp frame_timeline.cpp gl_capture.cpp gpu_timer.cpp knob_console.cpp knobs.cpp log.cpp perf_hud.cpp pipeline_warmup.cpp platform_android.cpp pose_latency.cpp profiler.cpp refresh_rate.cpp shared_metrics.cpp startup_graph.cpp xr_clock.cpp xr_dispatch.cpp xr_math.cpp
 LOCAL_CPPFLAGS := -std=c++17 -fexceptions -frtti
 LOCAL_CFLAGS := -DANDROID -DXR_USE_PLATFORM_ANDROID
 LOCAL_LDLIBS := -llog -landroid -lEGL -lGLESv3
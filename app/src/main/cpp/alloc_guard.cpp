@@ -0,0 +1,110 @@
+#include "alloc_guard.h"
+
+#if XR_ALLOC_GUARD
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#define LOG_TAG "AllocGuard"
+#include "log.h"
+
+static thread_local uint64_t threadAllocCount = 0;
+static std::atomic<uint32_t> framesSinceReset{0};
+static std::atomic<uint32_t> violations{0};
+static std::atomic<bool> fatalOnViolation{false};
+
+uint64_t allocGuardThreadCount() {
+    return threadAllocCount;
+}
+
+void allocGuardReset() {
+    framesSinceReset = 0;
+}
+
+void allocGuardSetFatal(bool fatal) {
+    fatalOnViolation = fatal;
+}
+
+uint32_t allocGuardViolations() {
+    return violations;
+}
+
+AllocGuardFrame::AllocGuardFrame() : startCount(threadAllocCount) {}
+
+AllocGuardFrame::~AllocGuardFrame() {
+    uint64_t allocations = threadAllocCount - startCount;
+    uint32_t frame = framesSinceReset++;
+    if (allocations == 0 || frame < ALLOC_GUARD_WARMUP_FRAMES) return;
+
+    violations++;
+    LOGE("Steady-state frame %u made %llu heap allocation(s)", frame, (unsigned long long)allocations);
+    if (fatalOnViolation) {
+        logFlush();
+        abort();
+    }
+}
+
+// --- Global operator new/delete replacements ---
+// Only operator new is counted: that covers every std container and smart pointer. The frame
+// loop makes no direct malloc calls, and allocations inside the GL driver or the runtime are
+// not ours to remove.
+
+static void* countedAlloc(size_t size) {
+    threadAllocCount++;
+    return malloc(size == 0 ? 1 : size);
+}
+
+static void* countedAlignedAlloc(size_t size, std::align_val_t alignment) {
+    threadAllocCount++;
+    void* ptr = nullptr;
+    size_t align = static_cast<size_t>(alignment);
+    if (align < sizeof(void*)) align = sizeof(void*);
+    if (posix_memalign(&ptr, align, size == 0 ? 1 : size) != 0) return nullptr;
+    return ptr;
+}
+
+void* operator new(size_t size) {
+    void* ptr = countedAlloc(size);
+    if (!ptr) throw std::bad_alloc();
+    return ptr;
+}
+
+void* operator new[](size_t size) {
+    void* ptr = countedAlloc(size);
+    if (!ptr) throw std::bad_alloc();
+    return ptr;
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return countedAlloc(size); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return countedAlloc(size); }
+
+void* operator new(size_t size, std::align_val_t alignment) {
+    void* ptr = countedAlignedAlloc(size, alignment);
+    if (!ptr) throw std::bad_alloc();
+    return ptr;
+}
+
+void* operator new[](size_t size, std::align_val_t alignment) {
+    void* ptr = countedAlignedAlloc(size, alignment);
+    if (!ptr) throw std::bad_alloc();
+    return ptr;
+}
+
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { return countedAlignedAlloc(size, alignment); }
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { return countedAlignedAlloc(size, alignment); }
+
+void operator delete(void* ptr) noexcept { free(ptr); }
+void operator delete[](void* ptr) noexcept { free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { free(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { free(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { free(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { free(ptr); }
+void operator delete(void* ptr, std::align_val_t) noexcept { free(ptr); }
+void operator delete[](void* ptr, std::align_val_t) noexcept { free(ptr); }
+void operator delete(void* ptr, size_t, std::align_val_t) noexcept { free(ptr); }
+void operator delete[](void* ptr, size_t, std::align_val_t) noexcept { free(ptr); }
+void operator delete(void* ptr, std::align_val_t, const std::nothrow_t&) noexcept { free(ptr); }
+void operator delete[](void* ptr, std::align_val_t, const std::nothrow_t&) noexcept { free(ptr); }
+
+#endif
@@ -0,0 +1,62 @@
+#ifndef ANDROIDSAMSUNG_ALLOC_GUARD_H
+#define ANDROIDSAMSUNG_ALLOC_GUARD_H
+
+#include <stdint.h>
+
+// Counts heap allocations per frame so the steady-state frame loop can be kept allocation-free.
+// Enabled in debug builds (or with -DXR_ALLOC_GUARD=1); in release builds every call below is
+// an empty inline function and the global operator new is left alone.
+#ifndef XR_ALLOC_GUARD
+#ifdef NDEBUG
+#define XR_ALLOC_GUARD 0
+#else
+#define XR_ALLOC_GUARD 1
+#endif
+#endif
+
+// Frames allowed to allocate after a reset (first frame after startup or a resume lazily sets
+// things up); every frame after that is a steady-state frame and must not allocate.
+const uint32_t ALLOC_GUARD_WARMUP_FRAMES = 8;
+
+#if XR_ALLOC_GUARD
+
+// Allocations made through operator new by the calling thread since it started.
+uint64_t allocGuardThreadCount();
+
+// Starts a new warm-up period, e.g. after the session or swapchains are recreated. Violations
+// already counted are kept.
+void allocGuardReset();
+
+// When set, a steady-state frame that allocates aborts the process instead of only logging.
+// Benchmarks and test harnesses turn this on to fail the run.
+void allocGuardSetFatal(bool fatal);
+
+// Number of steady-state frames that allocated since the process started.
+uint32_t allocGuardViolations();
+
+// Brackets one frame on the calling thread.
+class AllocGuardFrame {
+public:
+    AllocGuardFrame();
+    ~AllocGuardFrame();
+
+private:
+    uint64_t startCount;
+};
+
+#else
+
+inline uint64_t allocGuardThreadCount() { return 0; }
+inline void allocGuardReset() {}
+inline void allocGuardSetFatal(bool) {}
+inline uint32_t allocGuardViolations() { return 0; }
+
+// Not trivially destructible, so an unused guard does not warn in release builds
+class AllocGuardFrame {
+public:
+    ~AllocGuardFrame() {}
+};
+
+#endif
+
+#endif //ANDROIDSAMSUNG_ALLOC_GUARD_H
@@ -0,0 +1,210 @@
+#include "bench_harness.h"
+
+#include "monotonic_clock.h"
+
+#include <sys/utsname.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <map>
+
+static const int JSON_VERSION = 1;
+
+// Iteration counts stop doubling here even if the body is too cheap to time
+static const uint64_t MAX_ITERATIONS = 1ull << 32;
+
+static std::string jsonEscape(const std::string& text) {
+    std::string out;
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else if ((unsigned char)c < 0x20) {
+            char escaped[8];
+            snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+            out += escaped;
+        } else {
+            out += c;
+        }
+    }
+    return out;
+}
+
+bool BenchRunner::selected(const char* name) const {
+    return options.filter.empty() || strstr(name, options.filter.c_str()) != nullptr;
+}
+
+BenchRunner::Stats BenchRunner::summarise(std::vector<double> samplesNs) {
+    Stats s = {};
+    if (samplesNs.empty()) return s;
+    std::sort(samplesNs.begin(), samplesNs.end());
+    size_t n = samplesNs.size();
+    double sum = 0;
+    for (double v : samplesNs) sum += v;
+    s.meanNs = sum / n;
+    double squares = 0;
+    for (double v : samplesNs) squares += (v - s.meanNs) * (v - s.meanNs);
+    s.stddevNs = n > 1 ? sqrt(squares / (n - 1)) : 0.0;
+    s.minNs = samplesNs.front();
+    s.maxNs = samplesNs.back();
+    s.medianNs = n % 2 ? samplesNs[n / 2] : (samplesNs[n / 2 - 1] + samplesNs[n / 2]) / 2;
+    // Nearest rank
+    size_t rank = (size_t)ceil(0.9 * n);
+    s.p90Ns = samplesNs[rank > 0 ? rank - 1 : 0];
+    return s;
+}
+
+void BenchRunner::run(const char* name, const std::function<void(uint64_t)>& fn) {
+    if (!selected(name)) return;
+
+    // Calibrate: enough iterations for one call to fill a repetition
+    int64_t minNs = (int64_t)(options.minRepetitionMs * 1e6);
+    uint64_t iterations = 1;
+    for (;;) {
+        int64_t start = monotonicNowNs();
+        fn(iterations);
+        int64_t elapsed = monotonicNowNs() - start;
+        if (elapsed >= minNs || iterations >= MAX_ITERATIONS) break;
+        // Jump close to the target once a call is long enough to extrapolate from
+        if (elapsed > minNs / 16) {
+            uint64_t scaled = (uint64_t)((double)iterations * minNs / (elapsed > 0 ? elapsed : 1)) + 1;
+            iterations = std::min(std::max(scaled, iterations + 1), MAX_ITERATIONS);
+            break;
+        }
+        iterations *= 2;
+    }
+
+    for (int i = 0; i < options.warmup; ++i) fn(iterations);
+
+    Result result;
+    result.name = name;
+    result.iterations = iterations;
+    for (int i = 0; i < options.repetitions; ++i) {
+        int64_t start = monotonicNowNs();
+        fn(iterations);
+        result.samplesNs.push_back((double)(monotonicNowNs() - start) / iterations);
+    }
+    result.stats = summarise(result.samplesNs);
+    const Stats& s = result.stats;
+    printf("%-40s %14.2f ns  min %12.2f  p90 %12.2f  +-%5.1f%%  x%llu\n", name, s.medianNs, s.minNs, s.p90Ns,
+           s.meanNs > 0 ? 100.0 * s.stddevNs / s.meanNs : 0.0, (unsigned long long)iterations);
+    fflush(stdout);
+    all.push_back(std::move(result));
+}
+
+bool BenchRunner::writeJson(const char* path) const {
+    FILE* file = fopen(path, "w");
+    if (!file) {
+        fprintf(stderr, "Cannot open %s\n", path);
+        return false;
+    }
+    char date[32] = "";
+    time_t now = time(nullptr);
+    strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", gmtime(&now));
+    struct utsname host = {};
+    uname(&host);
+#if defined(__clang__)
+    const char* compiler = __VERSION__;  // already "Clang x.y.z ..."
+#elif defined(__GNUC__)
+    const char* compiler = "gcc " __VERSION__;
+#else
+    const char* compiler = "unknown";
+#endif
+#if defined(NDEBUG)
+    const char* build = "release";
+#else
+    const char* build = "debug";
+#endif
+
+    fprintf(file, "{\n");
+    fprintf(file, "\"version\": %d,\n", JSON_VERSION);
+    fprintf(file, "\"label\": \"%s\",\n", jsonEscape(options.label).c_str());
+    fprintf(file, "\"date\": \"%s\",\n", date);
+    fprintf(file, "\"host\": \"%s %s %s %s\",\n", jsonEscape(host.nodename).c_str(), jsonEscape(host.sysname).c_str(),
+            jsonEscape(host.release).c_str(), jsonEscape(host.machine).c_str());
+    fprintf(file, "\"compiler\": \"%s\",\n", jsonEscape(compiler).c_str());
+    fprintf(file, "\"build\": \"%s\",\n", build);
+    fprintf(file, "\"config\": {\"warmup\": %d, \"repetitions\": %d, \"min_repetition_ms\": %.3f},\n",
+            options.warmup, options.repetitions, options.minRepetitionMs);
+    fprintf(file, "\"results\": [\n");
+    // One result per line; compare() relies on it
+    for (size_t i = 0; i < all.size(); ++i) {
+        const Result& r = all[i];
+        const Stats& s = r.stats;
+        fprintf(file, "{\"name\": \"%s\", \"iterations\": %llu, \"min_ns\": %.3f, \"median_ns\": %.3f, "
+                      "\"mean_ns\": %.3f, \"stddev_ns\": %.3f, \"p90_ns\": %.3f, \"max_ns\": %.3f, \"samples_ns\": [",
+                jsonEscape(r.name).c_str(), (unsigned long long)r.iterations, s.minNs, s.medianNs, s.meanNs,
+                s.stddevNs, s.p90Ns, s.maxNs);
+        for (size_t j = 0; j < r.samplesNs.size(); ++j) fprintf(file, "%s%.3f", j ? ", " : "", r.samplesNs[j]);
+        fprintf(file, "]}%s\n", i + 1 < all.size() ? "," : "");
+    }
+    fprintf(file, "]\n}\n");
+    bool ok = fclose(file) == 0;
+    if (ok) printf("Wrote %zu results to %s\n", all.size(), path);
+    return ok;
+}
+
+// Reads "key": <number> from one result line
+static bool readNumber(const char* line, const char* key, double* value) {
+    const char* at = strstr(line, key);
+    if (at == nullptr) return false;
+    at = strchr(at + strlen(key), ':');
+    if (at == nullptr) return false;
+    *value = strtod(at + 1, nullptr);
+    return true;
+}
+
+bool BenchRunner::compare(const char* baselinePath) const {
+    FILE* file = fopen(baselinePath, "r");
+    if (!file) {
+        fprintf(stderr, "Cannot open %s\n", baselinePath);
+        return false;
+    }
+    struct Baseline {
+        double medianNs, meanNs, stddevNs;
+    };
+    std::map<std::string, Baseline> baseline;
+    std::string label;
+    char line[64 * 1024];
+    while (fgets(line, sizeof(line), file)) {
+        const char* name = strstr(line, "{\"name\": \"");
+        if (name == nullptr) {
+            const char* labelAt = strstr(line, "\"label\": \"");
+            if (labelAt != nullptr) {
+                label.assign(labelAt + 10);
+                label = label.substr(0, label.find('"'));
+            }
+            continue;
+        }
+        name += 10;
+        const char* end = strchr(name, '"');
+        Baseline b = {};
+        if (end == nullptr || !readNumber(line, "\"median_ns\"", &b.medianNs)) continue;
+        readNumber(line, "\"mean_ns\"", &b.meanNs);
+        readNumber(line, "\"stddev_ns\"", &b.stddevNs);
+        baseline[std::string(name, end)] = b;
+    }
+    fclose(file);
+
+    printf("\nAgainst %s%s%s%s:\n", baselinePath, label.empty() ? "" : " (", label.c_str(), label.empty() ? "" : ")");
+    printf("%-40s %14s %14s %9s\n", "benchmark", "baseline ns", "now ns", "change");
+    for (const Result& r : all) {
+        auto it = baseline.find(r.name);
+        if (it == baseline.end()) {
+            printf("%-40s %14s %14.2f %9s\n", r.name.c_str(), "-", r.stats.medianNs, "new");
+            continue;
+        }
+        const Baseline& b = it->second;
+        double change = b.medianNs > 0 ? r.stats.medianNs / b.medianNs - 1.0 : 0.0;
+        // Within twice the combined relative spread of the two runs is noise
+        double cvThen = b.meanNs > 0 ? b.stddevNs / b.meanNs : 0.0;
+        double cvNow = r.stats.meanNs > 0 ? r.stats.stddevNs / r.stats.meanNs : 0.0;
+        bool significant = fabs(change) > 2.0 * sqrt(cvThen * cvThen + cvNow * cvNow) && fabs(change) > 0.01;
+        printf("%-40s %14.2f %14.2f %+8.1f%%%s\n", r.name.c_str(), b.medianNs, r.stats.medianNs, 100.0 * change,
+               significant ? (change > 0 ? "  slower" : "  faster") : "");
+    }
+    return true;
+}
@@ -0,0 +1,71 @@
+#ifndef ANDROIDSAMSUNG_BENCH_HARNESS_H
+#define ANDROIDSAMSUNG_BENCH_HARNESS_H
+
+#include <stdint.h>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Runs microbenchmarks with warmup and repetitions and summarises each as ns per iteration.
+//
+// A benchmark is a function that runs its body `iterations` times. The harness first doubles
+// the iteration count until one call takes at least minRepetitionMs, runs `warmup` untimed
+// calls at that count, then times `repetitions` calls. Each repetition gives one sample, and
+// the samples are summarised (min, median, mean, stddev, p90, max).
+//
+// Results can be written as JSON and compared against a previous run's JSON, so two commits
+// can be measured on the same machine and diffed:
+//
+//     BenchRunner runner(options);
+//     runner.run("math/matrix_multiply", [&](uint64_t n) { for (...) matrix_multiply(a, b, r); });
+//     runner.writeJson("bench.json");
+class BenchRunner {
+public:
+    struct Options {
+        int warmup = 2;
+        int repetitions = 15;
+        double minRepetitionMs = 20.0;
+        std::string filter;  // substring a name must contain to run; empty runs everything
+        std::string label;   // free text stored in the JSON, e.g. the commit being measured
+    };
+
+    struct Stats {
+        double minNs, medianNs, meanNs, stddevNs, p90Ns, maxNs;  // per iteration
+    };
+
+    struct Result {
+        std::string name;
+        uint64_t iterations;  // per repetition
+        std::vector<double> samplesNs;
+        Stats stats;
+    };
+
+    explicit BenchRunner(const Options& options) : options(options) {}
+
+    // Whether `name` passes the filter; lets callers skip expensive setup
+    bool selected(const char* name) const;
+
+    // Measures fn unless filtered out, and prints one line for it
+    void run(const char* name, const std::function<void(uint64_t iterations)>& fn);
+
+    const std::vector<Result>& results() const { return all; }
+
+    bool writeJson(const char* path) const;
+    // Prints each result's median against the same benchmark in a JSON file from writeJson().
+    // Returns false if the file cannot be read.
+    bool compare(const char* baselinePath) const;
+
+    static Stats summarise(std::vector<double> samplesNs);
+
+private:
+    Options options;
+    std::vector<Result> all;
+};
+
+// Keeps the compiler from discarding a computed value or folding the work that produced it
+template <typename T>
+inline void benchKeep(const T& value) {
+    asm volatile("" : : "g"(&value) : "memory");
+}
+
+#endif //ANDROIDSAMSUNG_BENCH_HARNESS_H
@@ -0,0 +1,464 @@
+// Microbenchmarks for the engine's per-frame hot paths, in one host executable:
+//
+//   math/     the matrix functions of xr_math.h, per call and as the per-eye setup
+//   layers/   building one frame's quad layer list, for 4 to 1024 panels
+//   events/   draining xrPollEvent, through the dispatch table, against the mock runtime
+//   render/   main.cpp's stereo scene and custom_monado_runtime.cpp's panel clears on a
+//             headless GLES 3 context, finished every frame (llvmpipe on CI)
+//
+//     engine_bench [--filter <text>] [--warmup <n>] [--repetitions <n>] [--min-time-ms <ms>]
+//                  [--json <path>] [--label <text>] [--baseline <json>]
+//
+// Every result is ns per iteration; see bench_harness.h for how they are measured. To compare
+// two commits, run one with --json and the other with --baseline pointing at that file.
+
+#include "bench_harness.h"
+
+#include "fixed_vector.h"
+#include "frame_arena.h"
+#include "pipeline_warmup.h"
+#include "tools/headless_egl.h"
+#include "xr_dispatch.h"
+#include "xr_math.h"
+
+#include <GLES3/gl3.h>
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory_resource>
+#include <vector>
+
+// --- Math ---
+
+// A head pose and a Quest-like asymmetric eye FOV
+static const XrPosef EYE_POSE = {{0.0871557f, 0.0f, 0.0f, 0.9961947f}, {-0.032f, 1.6f, 0.0f}};
+static const XrFovf EYE_FOV = {-0.8726646f, 0.7853982f, 0.8377581f, -0.9424778f};
+
+static void benchMath(BenchRunner& runner) {
+    float a[16], b[16], r[16];
+    matrix_create_projection_from_fov(EYE_FOV, 0.1f, 100.0f, a);
+    matrix_create_view_from_pose(EYE_POSE, b);
+
+    runner.run("math/matrix_multiply", [&](uint64_t n) {
+        for (uint64_t i = 0; i < n; ++i) {
+            matrix_multiply(a, b, r);
+            benchKeep(r);
+        }
+    });
+    runner.run("math/matrix_create_view_from_pose", [&](uint64_t n) {
+        for (uint64_t i = 0; i < n; ++i) {
+            matrix_create_view_from_pose(EYE_POSE, r);
+            benchKeep(r);
+        }
+    });
+    runner.run("math/matrix_create_projection_from_fov", [&](uint64_t n) {
+        for (uint64_t i = 0; i < n; ++i) {
+            matrix_create_projection_from_fov(EYE_FOV, 0.1f, 100.0f, r);
+            benchKeep(r);
+        }
+    });
+    // What main.cpp's renderFrameVR does per eye before drawing
+    runner.run("math/eye_view_projection", [&](uint64_t n) {
+        float proj[16], view[16];
+        for (uint64_t i = 0; i < n; ++i) {
+            matrix_create_projection_from_fov(EYE_FOV, 0.1f, 100.0f, proj);
+            matrix_create_view_from_pose(EYE_POSE, view);
+            matrix_multiply(proj, view, r);
+            benchKeep(r);
+        }
+    });
+}
+
+// --- Layer list ---
+
+static const uint32_t MAX_BENCH_LAYERS = 1024;
+static const uint32_t LAYER_COUNTS[] = {4, 16, 64, 256, 1024};
+
+using LayerList = FixedVector<XrCompositionLayerBaseHeader*, MAX_BENCH_LAYERS>;
+
+// Panels on a ring around the viewer, so about half are behind the head and culled
+static std::vector<XrVector3f> panelRing(uint32_t count) {
+    std::vector<XrVector3f> positions(count);
+    for (uint32_t i = 0; i < count; ++i) {
+        float angle = 6.2831853f * (i + 0.5f) / count;
+        positions[i] = {1.5f * sinf(angle), 1.6f + 0.1f * (float)(i % 5), -1.5f * cosf(angle)};
+    }
+    return positions;
+}
+
+// One frame's layers, built the way custom_monado_runtime.cpp's renderFrame builds its panels:
+// panels behind the viewer culled, and pointers into `quadLayers` (one per position, from the
+// frame arena) collected into a fixed-capacity list for xrEndFrame. `quadLayers` is the
+// caller's, so it outlives the pointers in `layers`.
+static void buildQuadLayers(std::pmr::vector<XrCompositionLayerQuad>& quadLayers, LayerList& layers,
+                            const std::vector<XrVector3f>& positions, const XrPosef& head, float scale) {
+    layers.clear();
+    for (size_t i = 0; i < positions.size(); ++i) {
+        if (!pose_faces_point(head, positions[i])) continue;
+        XrCompositionLayerQuad& quad = quadLayers[i];
+        quad = {XR_TYPE_COMPOSITION_LAYER_QUAD};
+        quad.space = (XrSpace)1;
+        quad.subImage = {{(XrSwapchain)(i % 4 + 1)}, {{0, 0}, {512, 256}}};
+        quad.pose = {{0, 0, 0, 1}, positions[i]};
+        quad.size = {0.5f * scale, 0.25f * scale};
+        layers.push_back(reinterpret_cast<XrCompositionLayerBaseHeader*>(&quad));
+    }
+}
+
+static void benchLayers(BenchRunner& runner) {
+    // Room for the largest list in one frame's slab, as the app sizes its arena
+    FrameArena arena(MAX_BENCH_LAYERS * sizeof(XrCompositionLayerQuad) + 4096, 2);
+    LayerList layers;
+    const XrPosef head = {{0, 0, 0, 1}, {0, 1.6f, 0}};
+    for (uint32_t count : LAYER_COUNTS) {
+        char name[64];
+        snprintf(name, sizeof(name), "layers/build/%u", count);
+        std::vector<XrVector3f> positions = panelRing(count);
+        runner.run(name, [&](uint64_t n) {
+            for (uint64_t i = 0; i < n; ++i) {
+                arena.beginFrame();
+                std::pmr::vector<XrCompositionLayerQuad> quadLayers(positions.size(), &arena);
+                buildQuadLayers(quadLayers, layers, positions, head, (float)(i & 1) * 0.5f + 0.5f);
+                benchKeep(layers);
+            }
+        });
+    }
+}
+
+// --- Event polling ---
+
+struct MockSessionHandles {
+    XrInstance instance = XR_NULL_HANDLE;
+    XrSession session = XR_NULL_HANDLE;
+    XrDispatchTable xr;
+};
+
+// Headless instance and session on the mock runtime, which is linked in place of the loader
+static bool createMockSession(MockSessionHandles* mock) {
+    const char* extensions[] = {XR_MND_HEADLESS_EXTENSION_NAME, XR_FB_DISPLAY_REFRESH_RATE_EXTENSION_NAME};
+    XrInstanceCreateInfo createInfo{XR_TYPE_INSTANCE_CREATE_INFO};
+    strncpy(createInfo.applicationInfo.applicationName, "engine_bench", XR_MAX_APPLICATION_NAME_SIZE - 1);
+    createInfo.applicationInfo.apiVersion = XR_CURRENT_API_VERSION;
+    createInfo.enabledExtensionCount = 2;
+    createInfo.enabledExtensionNames = extensions;
+    if (XR_FAILED(xrCreateInstance(&createInfo, &mock->instance)) || !xrDispatchLoad(mock->instance, &mock->xr)) {
+        fprintf(stderr, "Cannot create a headless instance on the mock runtime\n");
+        return false;
+    }
+    XrSystemGetInfo systemInfo{XR_TYPE_SYSTEM_GET_INFO};
+    systemInfo.formFactor = XR_FORM_FACTOR_HEAD_MOUNTED_DISPLAY;
+    XrSystemId systemId = XR_NULL_SYSTEM_ID;
+    XrSessionCreateInfo sessionInfo{XR_TYPE_SESSION_CREATE_INFO};
+    if (XR_FAILED(mock->xr.GetSystem(mock->instance, &systemInfo, &systemId))) return false;
+    sessionInfo.systemId = systemId;
+    if (XR_FAILED(mock->xr.CreateSession(mock->instance, &sessionInfo, &mock->session))) {
+        fprintf(stderr, "Cannot create a headless session on the mock runtime\n");
+        return false;
+    }
+    return mock->xr.RequestDisplayRefreshRateFB != nullptr;
+}
+
+// The apps' pollEvents() loop, minus the handling: drain the queue, resetting the buffer
+static uint32_t drainEvents(const MockSessionHandles& mock) {
+    uint32_t events = 0;
+    XrEventDataBuffer eventData = {XR_TYPE_EVENT_DATA_BUFFER};
+    while (mock.xr.PollEvent(mock.instance, &eventData) == XR_SUCCESS) {
+        events++;
+        eventData = {XR_TYPE_EVENT_DATA_BUFFER};
+    }
+    return events;
+}
+
+static void benchEvents(BenchRunner& runner) {
+    if (!runner.selected("events/poll_empty") && !runner.selected("events/poll_one_event")) return;
+    MockSessionHandles mock;
+    if (!createMockSession(&mock)) {
+        fprintf(stderr, "Skipping events/\n");
+        if (mock.instance) xrDestroyInstance(mock.instance);
+        return;
+    }
+    drainEvents(mock);
+
+    // The steady state: nothing queued, one call per frame
+    runner.run("events/poll_empty", [&](uint64_t n) {
+        for (uint64_t i = 0; i < n; ++i) benchKeep(drainEvents(mock));
+    });
+    // One event per frame, queued by the refresh-rate request that is timed along with it
+    runner.run("events/poll_one_event", [&](uint64_t n) {
+        for (uint64_t i = 0; i < n; ++i) {
+            mock.xr.RequestDisplayRefreshRateFB(mock.session, (i & 1) ? 90.0f : 72.0f);
+            benchKeep(drainEvents(mock));
+        }
+    });
+
+    mock.xr.DestroySession(mock.session);
+    mock.xr.DestroyInstance(mock.instance);
+}
+
+// --- Render loop ---
+
+// main.cpp's scene shaders
+static const char* VERTEX_SHADER = R"(#version 300 es
+layout (location = 0) in vec3 aPos;
+uniform mat4 mvp;
+void main() {
+    gl_Position = mvp * vec4(aPos, 1.0);
+}
+)";
+static const char* OPAQUE_FRAGMENT_SHADER = R"(#version 300 es
+precision mediump float;
+uniform vec3 color;
+out vec4 FragColor;
+void main() {
+    FragColor = vec4(color, 1.0);
+}
+)";
+static const char* OVERLAY_FRAGMENT_SHADER = R"(#version 300 es
+precision mediump float;
+uniform vec3 color;
+uniform float alpha;
+out vec4 FragColor;
+void main() {
+    FragColor = vec4(color, alpha);
+}
+)";
+
+static const GLsizei EYE_SIZE = 1024;
+// custom_monado_runtime.cpp's four panel swapchains
+static const GLsizei PANEL_SIZES[4][2] = {{1024, 1024}, {512, 256}, {512, 256}, {512, 256}};
+
+struct QuadDraw {
+    int pipeline;
+    float x, y, z;
+    float r, g, b, alpha;
+};
+
+struct RenderScene {
+    GLuint programs[2] = {};
+    GLuint vao = 0, vbo = 0, ebo = 0;
+    GLuint eyeTexture = 0, depthbuffer = 0, framebuffer = 0;
+    GLuint panelTextures[4] = {}, panelFramebuffers[4] = {};
+    PipelineRegistry pipelines;
+    int background = -1, overlay = -1;
+};
+
+static GLuint linkProgram(const char* fragmentSource) {
+    GLuint program = glCreateProgram();
+    const char* sources[2] = {VERTEX_SHADER, fragmentSource};
+    GLenum types[2] = {GL_VERTEX_SHADER, GL_FRAGMENT_SHADER};
+    for (int i = 0; i < 2; ++i) {
+        GLuint shader = glCreateShader(types[i]);
+        glShaderSource(shader, 1, &sources[i], nullptr);
+        glCompileShader(shader);
+        glAttachShader(program, shader);
+        glDeleteShader(shader);
+    }
+    glLinkProgram(program);
+    GLint linked = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    return linked ? program : 0;
+}
+
+static bool createScene(RenderScene* scene) {
+    scene->programs[0] = linkProgram(OPAQUE_FRAGMENT_SHADER);
+    scene->programs[1] = linkProgram(OVERLAY_FRAGMENT_SHADER);
+    if (!scene->programs[0] || !scene->programs[1]) return false;
+
+    float vertices[] = {-0.5f, -0.5f, 0.0f, 0.5f, -0.5f, 0.0f, 0.5f, 0.5f, 0.0f, -0.5f, 0.5f, 0.0f};
+    unsigned int indices[] = {0, 1, 2, 2, 3, 0};
+    glGenVertexArrays(1, &scene->vao);
+    glGenBuffers(1, &scene->vbo);
+    glGenBuffers(1, &scene->ebo);
+    glBindVertexArray(scene->vao);
+    glBindBuffer(GL_ARRAY_BUFFER, scene->vbo);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, scene->ebo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+    glBindVertexArray(0);
+
+    scene->background = scene->pipelines.add({"background", scene->programs[0], true, true, false});
+    scene->overlay = scene->pipelines.add({"overlay", scene->programs[1], true, false, true});
+    scene->pipelines.warmUp(scene->vao, 6, GL_UNSIGNED_INT);
+
+    // Stereo swapchain image: a two-layer array, one layer per eye, plus a shared depth buffer
+    glGenTextures(1, &scene->eyeTexture);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, scene->eyeTexture);
+    glTexStorage3D(GL_TEXTURE_2D_ARRAY, 1, GL_RGBA8, EYE_SIZE, EYE_SIZE, 2);
+    glGenRenderbuffers(1, &scene->depthbuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, scene->depthbuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, EYE_SIZE, EYE_SIZE);
+    glGenFramebuffers(1, &scene->framebuffer);
+
+    glGenTextures(4, scene->panelTextures);
+    glGenFramebuffers(4, scene->panelFramebuffers);
+    for (int i = 0; i < 4; ++i) {
+        glBindTexture(GL_TEXTURE_2D, scene->panelTextures[i]);
+        glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, PANEL_SIZES[i][0], PANEL_SIZES[i][1]);
+        glBindFramebuffer(GL_FRAMEBUFFER, scene->panelFramebuffers[i]);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, scene->panelTextures[i], 0);
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    return glGetError() == GL_NO_ERROR;
+}
+
+static void destroyScene(RenderScene* scene) {
+    glDeleteFramebuffers(4, scene->panelFramebuffers);
+    glDeleteTextures(4, scene->panelTextures);
+    glDeleteFramebuffers(1, &scene->framebuffer);
+    glDeleteRenderbuffers(1, &scene->depthbuffer);
+    glDeleteTextures(1, &scene->eyeTexture);
+    glDeleteBuffers(1, &scene->ebo);
+    glDeleteBuffers(1, &scene->vbo);
+    glDeleteVertexArrays(1, &scene->vao);
+    glDeleteProgram(scene->programs[0]);
+    glDeleteProgram(scene->programs[1]);
+}
+
+// main.cpp's renderFrameVR between xrWaitSwapchainImage and xrReleaseSwapchainImage: the draw
+// list from the frame arena, then per eye the clear, eye matrices and one draw per quad. The
+// glFinish charges the GPU work to the frame.
+static void renderStereoFrame(RenderScene& scene, FrameArena& arena, uint32_t overlayCount) {
+    arena.beginFrame();
+    std::pmr::vector<QuadDraw> drawList(&arena);
+    drawList.reserve(overlayCount + 1);
+    drawList.push_back({scene.background, 0.0f, 0.0f, -3.0f, 0.2f, 0.3f, 0.8f, 1.0f});
+    for (uint32_t i = 0; i < overlayCount; ++i) {
+        float t = (float)i / overlayCount;
+        drawList.push_back({scene.overlay, t - 0.5f, 0.2f - 0.4f * t, -1.5f - t, 1.0f, 0.2f, t, 0.6f});
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, scene.framebuffer);
+    for (uint32_t eye = 0; eye < 2; ++eye) {
+        glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, scene.eyeTexture, 0, eye);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, scene.depthbuffer);
+        glViewport(0, 0, EYE_SIZE, EYE_SIZE);
+        glClearColor(0.1f, 0.2f, 0.3f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+        XrPosef eyePose = EYE_POSE;
+        eyePose.position.x = eye == 0 ? -0.032f : 0.032f;
+        float projMatrix[16], viewMatrix[16], viewProjMatrix[16];
+        matrix_create_projection_from_fov(EYE_FOV, 0.1f, 100.0f, projMatrix);
+        matrix_create_view_from_pose(eyePose, viewMatrix);
+        matrix_multiply(projMatrix, viewMatrix, viewProjMatrix);
+
+        glBindVertexArray(scene.vao);
+        int boundPipeline = -1;
+        for (const QuadDraw& quad : drawList) {
+            if (quad.pipeline != boundPipeline) {
+                scene.pipelines.bind(quad.pipeline);
+                boundPipeline = quad.pipeline;
+            }
+            GLuint program = scene.pipelines.state(quad.pipeline).program;
+            float modelMatrix[16], mvp[16];
+            matrix_translate(quad.x, quad.y, quad.z, modelMatrix);
+            matrix_multiply(viewProjMatrix, modelMatrix, mvp);
+            glUniformMatrix4fv(glGetUniformLocation(program, "mvp"), 1, GL_FALSE, mvp);
+            glUniform3f(glGetUniformLocation(program, "color"), quad.r, quad.g, quad.b);
+            glUniform1f(glGetUniformLocation(program, "alpha"), quad.alpha);
+            scene.pipelines.draw(GL_TRIANGLES, 6, GL_UNSIGNED_INT);
+        }
+        scene.pipelines.unbind();
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glFinish();
+}
+
+// custom_monado_runtime.cpp's renderSwapchains: one clear per panel swapchain
+static void clearPanels(RenderScene& scene) {
+    for (int i = 0; i < 4; ++i) {
+        glBindFramebuffer(GL_FRAMEBUFFER, scene.panelFramebuffers[i]);
+        glViewport(0, 0, PANEL_SIZES[i][0], PANEL_SIZES[i][1]);
+        glClearColor(0.0f, 0.25f * i, 1.0f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glFinish();
+}
+
+static void benchRender(BenchRunner& runner) {
+    if (!runner.selected("render/stereo_frame/3_quads") && !runner.selected("render/stereo_frame/64_quads") &&
+        !runner.selected("render/panel_clears")) {
+        return;
+    }
+    HeadlessEgl egl;
+    if (!headlessEglCreate(&egl)) {
+        fprintf(stderr, "Skipping render/ (no GLES 3 context; try EGL_PLATFORM=surfaceless)\n");
+        headlessEglDestroy(&egl);
+        return;
+    }
+    RenderScene scene;
+    if (!createScene(&scene)) {
+        fprintf(stderr, "Skipping render/ (scene setup failed: 0x%x)\n", glGetError());
+        destroyScene(&scene);
+        headlessEglDestroy(&egl);
+        return;
+    }
+    FrameArena arena(16 * 1024, 2);
+
+    // main.cpp's scene is the background and two overlays
+    runner.run("render/stereo_frame/3_quads", [&](uint64_t n) {
+        for (uint64_t i = 0; i < n; ++i) renderStereoFrame(scene, arena, 2);
+    });
+    runner.run("render/stereo_frame/64_quads", [&](uint64_t n) {
+        for (uint64_t i = 0; i < n; ++i) renderStereoFrame(scene, arena, 63);
+    });
+    runner.run("render/panel_clears", [&](uint64_t n) {
+        for (uint64_t i = 0; i < n; ++i) clearPanels(scene);
+    });
+
+    destroyScene(&scene);
+    headlessEglDestroy(&egl);
+}
+
+static void usage(const char* program) {
+    fprintf(stderr,
+            "usage: %s [--filter <text>] [--warmup <n>] [--repetitions <n>] [--min-time-ms <ms>]\n"
+            "          [--json <path>] [--label <text>] [--baseline <json>]\n",
+            program);
+}
+
+int main(int argc, char** argv) {
+    BenchRunner::Options options;
+    const char* jsonPath = nullptr;
+    const char* baselinePath = nullptr;
+    for (int i = 1; i < argc; ++i) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--filter") == 0 && hasValue) {
+            options.filter = argv[++i];
+        } else if (strcmp(argv[i], "--warmup") == 0 && hasValue) {
+            options.warmup = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--repetitions") == 0 && hasValue) {
+            options.repetitions = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--min-time-ms") == 0 && hasValue) {
+            options.minRepetitionMs = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--json") == 0 && hasValue) {
+            jsonPath = argv[++i];
+        } else if (strcmp(argv[i], "--label") == 0 && hasValue) {
+            options.label = argv[++i];
+        } else if (strcmp(argv[i], "--baseline") == 0 && hasValue) {
+            baselinePath = argv[++i];
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if (options.warmup < 0 || options.repetitions < 1 || options.minRepetitionMs <= 0) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    BenchRunner runner(options);
+    benchMath(runner);
+    benchLayers(runner);
+    benchEvents(runner);
+    benchRender(runner);
+
+    if (jsonPath != nullptr && !runner.writeJson(jsonPath)) return 1;
+    if (baselinePath != nullptr && !runner.compare(baselinePath)) return 1;
+    return 0;
+}
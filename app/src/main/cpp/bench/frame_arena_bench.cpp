@@ -0,0 +1,105 @@
+// Compares FrameArena with the default heap on workloads shaped like our frame loops:
+// a composition layer list, a draw list that grows without a reserve, culling results and
+// uniform staging. Every frame builds its containers from scratch, as the renderer does.
+
+#include "frame_arena.h"
+#include "monotonic_clock.h"
+
+#include <openxr/openxr.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <memory_resource>
+#include <vector>
+
+struct DrawItem {
+    int pipeline;
+    float model[16];
+    float color[4];
+};
+
+static volatile size_t sink;
+
+// One frame of transient work with `layerCount` layers and `drawCount` draws
+static void simulateFrame(std::pmr::memory_resource* resource, uint32_t layerCount, uint32_t drawCount) {
+    std::pmr::vector<XrCompositionLayerQuad> quads(resource);
+    quads.reserve(layerCount);
+    std::pmr::vector<XrCompositionLayerBaseHeader*> layers(resource);
+    layers.reserve(layerCount);
+    for (uint32_t i = 0; i < layerCount; ++i) {
+        XrCompositionLayerQuad quad{XR_TYPE_COMPOSITION_LAYER_QUAD};
+        quad.pose = {{0, 0, 0, 1}, {0.1f * i, 0, -2.0f}};
+        quad.size = {0.5f, 0.5f};
+        quads.push_back(quad);
+        layers.push_back(reinterpret_cast<XrCompositionLayerBaseHeader*>(&quads.back()));
+    }
+
+    std::pmr::vector<DrawItem> drawList(resource);
+    for (uint32_t i = 0; i < drawCount; ++i) {
+        DrawItem item = {};
+        item.pipeline = (int)(i & 1);
+        item.model[0] = item.model[5] = item.model[10] = item.model[15] = 1.0f;
+        item.model[14] = -1.0f - i * 0.01f;
+        drawList.push_back(item);
+    }
+
+    std::pmr::vector<uint32_t> visible(resource);
+    for (uint32_t i = 0; i < drawCount; ++i) {
+        if (drawList[i].model[14] > -5.0f) visible.push_back(i);
+    }
+
+    std::pmr::vector<float> uniformStaging(resource);
+    uniformStaging.resize(visible.size() * 20);
+    for (size_t i = 0; i < visible.size(); ++i) {
+        std::copy(drawList[visible[i]].model, drawList[visible[i]].model + 16, uniformStaging.begin() + i * 20);
+    }
+
+    sink = layers.size() + uniformStaging.size();
+}
+
+struct Result {
+    double nsPerFrame;
+};
+
+static Result runDefault(uint32_t frames, uint32_t layerCount, uint32_t drawCount) {
+    std::pmr::memory_resource* heap = std::pmr::new_delete_resource();
+    int64_t start = monotonicNowNs();
+    for (uint32_t frame = 0; frame < frames; ++frame) {
+        simulateFrame(heap, layerCount, drawCount);
+    }
+    return {(double)(monotonicNowNs() - start) / frames};
+}
+
+static Result runArena(uint32_t frames, uint32_t layerCount, uint32_t drawCount, FrameArena::Stats* stats) {
+    FrameArena arena(256 * 1024, 2);
+    int64_t start = monotonicNowNs();
+    for (uint32_t frame = 0; frame < frames; ++frame) {
+        arena.beginFrame();
+        simulateFrame(&arena, layerCount, drawCount);
+    }
+    Result result{(double)(monotonicNowNs() - start) / frames};
+    arena.beginFrame();
+    *stats = arena.stats();
+    return result;
+}
+
+int main() {
+    const uint32_t frames = 20000;
+    const uint32_t workloads[][2] = {{4, 16}, {16, 64}, {64, 256}, {256, 1024}, {1024, 4096}};
+
+    printf("%-8s %-8s %14s %14s %8s %14s %10s\n", "layers", "draws", "default ns/f", "arena ns/f",
+           "speedup", "high-water B", "overflows");
+    for (const auto& workload : workloads) {
+        // Warm both paths once so page faults and lazy init do not land in the first timing
+        FrameArena::Stats stats;
+        runDefault(frames / 10, workload[0], workload[1]);
+        runArena(frames / 10, workload[0], workload[1], &stats);
+
+        Result heap = runDefault(frames, workload[0], workload[1]);
+        Result arena = runArena(frames, workload[0], workload[1], &stats);
+        printf("%-8u %-8u %14.1f %14.1f %7.2fx %14zu %10llu\n", workload[0], workload[1],
+               heap.nsPerFrame, arena.nsPerFrame, heap.nsPerFrame / arena.nsPerFrame,
+               stats.highWaterBytes, (unsigned long long)stats.overflowAllocations);
+    }
+    return 0;
+}
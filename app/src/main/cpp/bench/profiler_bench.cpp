@@ -0,0 +1,96 @@
+// Measures what a PROFILE_ZONE costs on the calling thread: the same loop body timed with
+// and without a zone around it, on one thread and on several at once. Batches stay below
+// the per-thread ring size and are flushed outside the timed region, so every zone is
+// really recorded rather than dropped.
+
+#include "profiler.h"
+#include "monotonic_clock.h"
+
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#define LOG_TAG "ProfilerBench"
+#include "log.h"
+
+static const uint32_t BATCH = 2048;
+static const uint32_t BATCHES = 200;
+
+static volatile uint32_t sink;
+
+static inline void work(uint32_t i) {
+    sink = sink + i;
+}
+
+static double runPlain() {
+    int64_t total = 0;
+    for (uint32_t batch = 0; batch < BATCHES; ++batch) {
+        int64_t start = monotonicNowNs();
+        for (uint32_t i = 0; i < BATCH; ++i) {
+            work(i);
+        }
+        total += monotonicNowNs() - start;
+    }
+    return (double)total / ((double)BATCH * BATCHES);
+}
+
+static double runZoned() {
+    int64_t total = 0;
+    for (uint32_t batch = 0; batch < BATCHES; ++batch) {
+        int64_t start = monotonicNowNs();
+        for (uint32_t i = 0; i < BATCH; ++i) {
+            PROFILE_ZONE("bench zone");
+            work(i);
+        }
+        total += monotonicNowNs() - start;
+        profilerFlush();
+    }
+    return (double)total / ((double)BATCH * BATCHES);
+}
+
+// A zone reads the clock twice, so this is its floor
+static double clockReadNs() {
+    const uint32_t reads = 1000000;
+    int64_t start = monotonicNowNs();
+    int64_t last = 0;
+    for (uint32_t i = 0; i < reads; ++i) last = monotonicNowNs();
+    sink = (uint32_t)last;
+    return (double)(monotonicNowNs() - start) / reads;
+}
+
+int main() {
+#if !XR_PROFILER
+    printf("built with XR_PROFILER=0: zones compile to nothing\n");
+    return 0;
+#else
+    profilerSetThreadName("bench main");
+    // First zone on a thread allocates its ring; keep that out of the numbers
+    runZoned();
+
+    printf("clock read: %.2f ns\n", clockReadNs());
+    printf("%-10s %14s %14s %14s\n", "threads", "plain ns/iter", "zoned ns/iter", "zone ns");
+    for (int threads : {1, 2, 4}) {
+        std::vector<double> plain(threads), zoned(threads);
+        std::vector<std::thread> workers;
+        for (int t = 0; t < threads; ++t) {
+            workers.emplace_back([t, &plain, &zoned] {
+                runZoned();
+                plain[t] = runPlain();
+                zoned[t] = runZoned();
+            });
+        }
+        for (std::thread& worker : workers) worker.join();
+
+        double plainMean = 0, zonedMean = 0;
+        for (int t = 0; t < threads; ++t) {
+            plainMean += plain[t] / threads;
+            zonedMean += zoned[t] / threads;
+        }
+        printf("%-10d %14.2f %14.2f %14.2f\n", threads, plainMean, zonedMean, zonedMean - plainMean);
+    }
+    printf("dropped zones: %llu\n", (unsigned long long)profilerDroppedCount());
+    profilerShutdown();
+    logShutdown();
+    return 0;
+#endif
+}
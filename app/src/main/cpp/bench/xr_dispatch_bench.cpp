@@ -0,0 +1,157 @@
+// Measures the per-call cost of reaching the runtime through XrDispatchTable versus the
+// loader's exported trampolines. The runtime is a stand-in whose entry points return
+// immediately, so the numbers are pure call overhead. xr_loader_shim stands in for
+// libopenxr_loader.so: a separate shared library whose exports check the active instance
+// and forward through their own table, like the generated loader trampolines.
+
+#include "xr_dispatch.h"
+#include "monotonic_clock.h"
+
+#include <cstdio>
+#include <cstring>
+
+extern "C" void xrShimInstallRuntime(PFN_xrGetInstanceProcAddr getProcAddr, XrInstance instance);
+
+// --- Stand-in runtime ---
+
+static const XrInstance STUB_INSTANCE = (XrInstance)(uintptr_t)0x1;
+static const XrSession STUB_SESSION = (XrSession)(uintptr_t)0x2;
+static const XrSwapchain STUB_SWAPCHAIN = (XrSwapchain)(uintptr_t)0x3;
+
+static XrTime stubTime = 0;
+
+static XrResult XRAPI_CALL stubWaitFrame(XrSession, const XrFrameWaitInfo*, XrFrameState* state) {
+    stubTime += 11111111;
+    state->predictedDisplayTime = stubTime;
+    state->shouldRender = XR_TRUE;
+    return XR_SUCCESS;
+}
+static XrResult XRAPI_CALL stubBeginFrame(XrSession, const XrFrameBeginInfo*) { return XR_SUCCESS; }
+static XrResult XRAPI_CALL stubEndFrame(XrSession, const XrFrameEndInfo*) { return XR_SUCCESS; }
+static XrResult XRAPI_CALL stubAcquireSwapchainImage(XrSwapchain, const XrSwapchainImageAcquireInfo*, uint32_t* index) {
+    *index = 0;
+    return XR_SUCCESS;
+}
+static XrResult XRAPI_CALL stubWaitSwapchainImage(XrSwapchain, const XrSwapchainImageWaitInfo*) { return XR_SUCCESS; }
+static XrResult XRAPI_CALL stubReleaseSwapchainImage(XrSwapchain, const XrSwapchainImageReleaseInfo*) { return XR_SUCCESS; }
+static XrResult XRAPI_CALL stubLocateViews(XrSession, const XrViewLocateInfo*, XrViewState*, uint32_t, uint32_t* count, XrView*) {
+    *count = 2;
+    return XR_SUCCESS;
+}
+static XrResult XRAPI_CALL stubPollEvent(XrInstance, XrEventDataBuffer*) { return XR_EVENT_UNAVAILABLE; }
+// Every other core function resolves to this; the bench never calls them
+static XrResult XRAPI_CALL stubUnimplemented() { return XR_ERROR_FUNCTION_UNSUPPORTED; }
+
+static XrResult XRAPI_CALL stubGetInstanceProcAddr(XrInstance, const char* name, PFN_xrVoidFunction* function) {
+    struct Entry {
+        const char* name;
+        PFN_xrVoidFunction function;
+    };
+    static const Entry entries[] = {
+            {"xrWaitFrame", (PFN_xrVoidFunction)stubWaitFrame},
+            {"xrBeginFrame", (PFN_xrVoidFunction)stubBeginFrame},
+            {"xrEndFrame", (PFN_xrVoidFunction)stubEndFrame},
+            {"xrAcquireSwapchainImage", (PFN_xrVoidFunction)stubAcquireSwapchainImage},
+            {"xrWaitSwapchainImage", (PFN_xrVoidFunction)stubWaitSwapchainImage},
+            {"xrReleaseSwapchainImage", (PFN_xrVoidFunction)stubReleaseSwapchainImage},
+            {"xrLocateViews", (PFN_xrVoidFunction)stubLocateViews},
+            {"xrPollEvent", (PFN_xrVoidFunction)stubPollEvent},
+            {"xrGetInstanceProcAddr", (PFN_xrVoidFunction)stubGetInstanceProcAddr},
+    };
+    for (const Entry& entry : entries) {
+        if (strcmp(entry.name, name) == 0) {
+            *function = entry.function;
+            return XR_SUCCESS;
+        }
+    }
+#define XR_BENCH_IS_CORE(fn, feature) || strcmp(name, "xr" #fn) == 0
+    if (false XR_LIST_FUNCTIONS_XR_VERSION_1_0(XR_BENCH_IS_CORE)) {
+        *function = (PFN_xrVoidFunction)stubUnimplemented;
+        return XR_SUCCESS;
+    }
+#undef XR_BENCH_IS_CORE
+    *function = nullptr;
+    return XR_ERROR_FUNCTION_UNSUPPORTED;
+}
+
+// --- Frame-path call sequences ---
+
+// Calls each frame makes on the hot path: wait, begin, locate, acquire/wait/release, end, poll
+static const int CALLS_PER_FRAME = 8;
+
+static volatile uint32_t sink;
+
+static void frameViaLoader() {
+    XrFrameState frameState{XR_TYPE_FRAME_STATE};
+    xrWaitFrame(STUB_SESSION, nullptr, &frameState);
+    xrBeginFrame(STUB_SESSION, nullptr);
+    XrViewLocateInfo locateInfo{XR_TYPE_VIEW_LOCATE_INFO};
+    XrViewState viewState{XR_TYPE_VIEW_STATE};
+    XrView views[2] = {{XR_TYPE_VIEW}, {XR_TYPE_VIEW}};
+    uint32_t viewCount = 0;
+    xrLocateViews(STUB_SESSION, &locateInfo, &viewState, 2, &viewCount, views);
+    uint32_t imageIndex = 0;
+    xrAcquireSwapchainImage(STUB_SWAPCHAIN, nullptr, &imageIndex);
+    XrSwapchainImageWaitInfo waitInfo{XR_TYPE_SWAPCHAIN_IMAGE_WAIT_INFO};
+    xrWaitSwapchainImage(STUB_SWAPCHAIN, &waitInfo);
+    xrReleaseSwapchainImage(STUB_SWAPCHAIN, nullptr);
+    XrFrameEndInfo endInfo{XR_TYPE_FRAME_END_INFO};
+    xrEndFrame(STUB_SESSION, &endInfo);
+    XrEventDataBuffer event{XR_TYPE_EVENT_DATA_BUFFER};
+    xrPollEvent(STUB_INSTANCE, &event);
+    sink = viewCount + imageIndex;
+}
+
+static void frameViaTable(const XrDispatchTable& xr) {
+    XrFrameState frameState{XR_TYPE_FRAME_STATE};
+    xr.WaitFrame(STUB_SESSION, nullptr, &frameState);
+    xr.BeginFrame(STUB_SESSION, nullptr);
+    XrViewLocateInfo locateInfo{XR_TYPE_VIEW_LOCATE_INFO};
+    XrViewState viewState{XR_TYPE_VIEW_STATE};
+    XrView views[2] = {{XR_TYPE_VIEW}, {XR_TYPE_VIEW}};
+    uint32_t viewCount = 0;
+    xr.LocateViews(STUB_SESSION, &locateInfo, &viewState, 2, &viewCount, views);
+    uint32_t imageIndex = 0;
+    xr.AcquireSwapchainImage(STUB_SWAPCHAIN, nullptr, &imageIndex);
+    XrSwapchainImageWaitInfo waitInfo{XR_TYPE_SWAPCHAIN_IMAGE_WAIT_INFO};
+    xr.WaitSwapchainImage(STUB_SWAPCHAIN, &waitInfo);
+    xr.ReleaseSwapchainImage(STUB_SWAPCHAIN, nullptr);
+    XrFrameEndInfo endInfo{XR_TYPE_FRAME_END_INFO};
+    xr.EndFrame(STUB_SESSION, &endInfo);
+    XrEventDataBuffer event{XR_TYPE_EVENT_DATA_BUFFER};
+    xr.PollEvent(STUB_INSTANCE, &event);
+    sink = viewCount + imageIndex;
+}
+
+template <typename Frame>
+static double nsPerCall(uint32_t frames, Frame frame) {
+    for (uint32_t i = 0; i < frames / 10; ++i) frame();
+    int64_t start = monotonicNowNs();
+    for (uint32_t i = 0; i < frames; ++i) frame();
+    return (double)(monotonicNowNs() - start) / ((double)frames * CALLS_PER_FRAME);
+}
+
+int main() {
+    xrShimInstallRuntime(stubGetInstanceProcAddr, STUB_INSTANCE);
+
+    // Resolve through the shim's xrGetInstanceProcAddr, as the app does through the loader
+    XrDispatchTable xr;
+    if (!xrDispatchLoad(STUB_INSTANCE, &xr)) {
+        fprintf(stderr, "dispatch table incomplete\n");
+        return 1;
+    }
+
+    const uint32_t frames = 2000000;
+    const int repetitions = 5;
+    printf("%-4s %16s %16s %8s\n", "run", "loader ns/call", "table ns/call", "speedup");
+    double bestLoader = 1e9, bestTable = 1e9;
+    for (int run = 0; run < repetitions; ++run) {
+        double loader = nsPerCall(frames, frameViaLoader);
+        double table = nsPerCall(frames, [&xr] { frameViaTable(xr); });
+        if (loader < bestLoader) bestLoader = loader;
+        if (table < bestTable) bestTable = table;
+        printf("%-4d %16.2f %16.2f %7.2fx\n", run, loader, table, loader / table);
+    }
+    printf("best %16.2f %16.2f %7.2fx\n", bestLoader, bestTable, bestLoader / bestTable);
+    return 0;
+}
@@ -0,0 +1,131 @@
+// Stand-in for libopenxr_loader.so in xr_dispatch_bench. Built as its own shared library so
+// calls from the bench go through the PLT, and each exported function does what the loader's
+// generated trampolines do: look up the active loader instance, fail if there is none, then
+// forward through that instance's dispatch table.
+
+#include <openxr/openxr.h>
+
+#include <atomic>
+
+#define XR_SHIM_EXPORT extern "C" __attribute__((visibility("default")))
+
+namespace {
+
+struct ShimDispatch {
+    PFN_xrGetInstanceProcAddr GetInstanceProcAddr;
+    PFN_xrWaitFrame WaitFrame;
+    PFN_xrBeginFrame BeginFrame;
+    PFN_xrEndFrame EndFrame;
+    PFN_xrAcquireSwapchainImage AcquireSwapchainImage;
+    PFN_xrWaitSwapchainImage WaitSwapchainImage;
+    PFN_xrReleaseSwapchainImage ReleaseSwapchainImage;
+    PFN_xrLocateViews LocateViews;
+    PFN_xrPollEvent PollEvent;
+};
+
+struct ShimInstance {
+    ShimDispatch dispatch;
+};
+
+// The loader keeps a single active instance behind a global and checks it on every call
+ShimInstance shimInstance;
+std::atomic<ShimInstance*> activeInstance{nullptr};
+
+inline XrResult getActive(ShimInstance** out) {
+    ShimInstance* instance = activeInstance.load(std::memory_order_acquire);
+    if (!instance) return XR_ERROR_HANDLE_INVALID;
+    *out = instance;
+    return XR_SUCCESS;
+}
+
+template <typename Pfn>
+void resolve(PFN_xrGetInstanceProcAddr getProcAddr, XrInstance instance, const char* name, Pfn* out) {
+    getProcAddr(instance, name, reinterpret_cast<PFN_xrVoidFunction*>(out));
+}
+
+} // namespace
+
+// Installs the runtime the trampolines forward to, as the loader does after negotiation
+XR_SHIM_EXPORT void xrShimInstallRuntime(PFN_xrGetInstanceProcAddr getProcAddr, XrInstance instance) {
+    ShimDispatch& d = shimInstance.dispatch;
+    d.GetInstanceProcAddr = getProcAddr;
+    resolve(getProcAddr, instance, "xrWaitFrame", &d.WaitFrame);
+    resolve(getProcAddr, instance, "xrBeginFrame", &d.BeginFrame);
+    resolve(getProcAddr, instance, "xrEndFrame", &d.EndFrame);
+    resolve(getProcAddr, instance, "xrAcquireSwapchainImage", &d.AcquireSwapchainImage);
+    resolve(getProcAddr, instance, "xrWaitSwapchainImage", &d.WaitSwapchainImage);
+    resolve(getProcAddr, instance, "xrReleaseSwapchainImage", &d.ReleaseSwapchainImage);
+    resolve(getProcAddr, instance, "xrLocateViews", &d.LocateViews);
+    resolve(getProcAddr, instance, "xrPollEvent", &d.PollEvent);
+    activeInstance.store(&shimInstance, std::memory_order_release);
+}
+
+XR_SHIM_EXPORT XrResult XRAPI_CALL xrGetInstanceProcAddr(XrInstance instance, const char* name, PFN_xrVoidFunction* function) {
+    ShimInstance* active;
+    XrResult result = getActive(&active);
+    if (XR_FAILED(result)) return result;
+    return active->dispatch.GetInstanceProcAddr(instance, name, function);
+}
+
+XR_SHIM_EXPORT XrResult XRAPI_CALL xrWaitFrame(XrSession session, const XrFrameWaitInfo* info, XrFrameState* state) {
+    ShimInstance* active;
+    XrResult result = getActive(&active);
+    if (XR_SUCCEEDED(result)) result = active->dispatch.WaitFrame(session, info, state);
+    return result;
+}
+
+XR_SHIM_EXPORT XrResult XRAPI_CALL xrBeginFrame(XrSession session, const XrFrameBeginInfo* info) {
+    ShimInstance* active;
+    XrResult result = getActive(&active);
+    if (XR_SUCCEEDED(result)) result = active->dispatch.BeginFrame(session, info);
+    return result;
+}
+
+XR_SHIM_EXPORT XrResult XRAPI_CALL xrEndFrame(XrSession session, const XrFrameEndInfo* info) {
+    ShimInstance* active;
+    XrResult result = getActive(&active);
+    if (XR_SUCCEEDED(result)) result = active->dispatch.EndFrame(session, info);
+    return result;
+}
+
+XR_SHIM_EXPORT XrResult XRAPI_CALL xrAcquireSwapchainImage(XrSwapchain swapchain, const XrSwapchainImageAcquireInfo* info, uint32_t* index) {
+    ShimInstance* active;
+    XrResult result = getActive(&active);
+    if (XR_SUCCEEDED(result)) result = active->dispatch.AcquireSwapchainImage(swapchain, info, index);
+    return result;
+}
+
+XR_SHIM_EXPORT XrResult XRAPI_CALL xrWaitSwapchainImage(XrSwapchain swapchain, const XrSwapchainImageWaitInfo* info) {
+    ShimInstance* active;
+    XrResult result = getActive(&active);
+    if (XR_SUCCEEDED(result)) result = active->dispatch.WaitSwapchainImage(swapchain, info);
+    return result;
+}
+
+XR_SHIM_EXPORT XrResult XRAPI_CALL xrReleaseSwapchainImage(XrSwapchain swapchain, const XrSwapchainImageReleaseInfo* info) {
+    ShimInstance* active;
+    XrResult result = getActive(&active);
+    if (XR_SUCCEEDED(result)) result = active->dispatch.ReleaseSwapchainImage(swapchain, info);
+    return result;
+}
+
+XR_SHIM_EXPORT XrResult XRAPI_CALL xrLocateViews(XrSession session, const XrViewLocateInfo* info, XrViewState* viewState,
+                                                 uint32_t capacity, uint32_t* count, XrView* views) {
+    ShimInstance* active;
+    XrResult result = getActive(&active);
+    if (XR_SUCCEEDED(result)) result = active->dispatch.LocateViews(session, info, viewState, capacity, count, views);
+    return result;
+}
+
+XR_SHIM_EXPORT XrResult XRAPI_CALL xrPollEvent(XrInstance instance, XrEventDataBuffer* event) {
+    ShimInstance* active;
+    XrResult result = getActive(&active);
+    if (XR_SUCCEEDED(result)) result = active->dispatch.PollEvent(instance, event);
+    return result;
+}
+
+// The stand-in runtime offers no extensions
+XR_SHIM_EXPORT XrResult XRAPI_CALL xrEnumerateInstanceExtensionProperties(const char*, uint32_t, uint32_t* count, XrExtensionProperties*) {
+    *count = 0;
+    return XR_SUCCESS;
+}
@@ -1,5 +1,4 @@
-#include <android/log.h>
-#include "android_native_app_glue.h"
+#include "platform.h"
 #include <EGL/egl.h>
 #include <EGL/eglext.h>
 #include <GLES3/gl3.h>
@@ -9,22 +8,42 @@
 #include <cstring>
 #include <unistd.h>
 #include <algorithm> // For std::min
-
-// OpenXR Headers
-#define XR_USE_PLATFORM_ANDROID
-#define XR_USE_GRAPHICS_API_OPENGL_ES
-#include <openxr/openxr.h>
-#include <openxr/openxr_platform.h>
-
-#define TAG "OpenXROverlayApp"
-#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, TAG, __VA_ARGS__)
-#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, TAG, __VA_ARGS__)
+#include <memory_resource>
+
+#include "alloc_guard.h"
+#include "fixed_vector.h"
+#include "frame_analyzer.h"
+#include "frame_arena.h"
+#include "frame_stats.h"
+#include "frame_timeline.h"
+#include "gpu_timer.h"
+#include "perf_hud.h"
+#include "profiler.h"
+#include "refresh_rate.h"
+#include "space_cache.h"
+#include "startup_graph.h"
+#include "xr_math.h"
+
+// OpenXR Headers (platform defines live in xr_platform.h)
+#include "monotonic_clock.h"
+#include "xr_clock.h"
+#include "xr_dispatch.h"
+
+#define LOG_TAG "OpenXROverlayApp"
+#include "log.h"
 
 const uint32_t LAYER_COUNT = 4;
 
+// Refresh rates the content needs: panels scaling in, and panels standing still
+const float ANIMATING_REFRESH_HZ = 72.0f;
+const float STATIC_REFRESH_HZ = 60.0f;
+
 // Main application state
 struct OpenXrApp {
-    struct android_app* app;
+    PlatformApp* app;
+    // No GL and no swapchains (PlatformApp::noGraphics): the loop still waits, begins, builds
+    // and submits the same layers, so what is left is its CPU cost
+    bool headless = false;
     bool resumed = false;
     bool sessionRunning = false;
 
@@ -34,10 +53,18 @@ struct OpenXrApp {
     float stage_timer = 0.0f;
 
     XrInstance instance = XR_NULL_HANDLE;
+    XrDispatchTable xr; // Runtime entry points for `instance`, used on the frame path
     XrSystemId systemId = XR_NULL_SYSTEM_ID;
     XrSession session = XR_NULL_HANDLE;
     XrSessionState sessionState = XR_SESSION_STATE_UNKNOWN;
     XrSpace appSpace = XR_NULL_HANDLE;
+    XrSpace viewSpace = XR_NULL_HANDLE;
+
+    // Every space the frame reads, located once per frame; headSlot is viewSpace's entry
+    SpaceLocationCache spaces;
+    int headSlot = -1;
+
+    RefreshRateManager refreshRate;
 
     XrSwapchain swapchains[LAYER_COUNT] = {XR_NULL_HANDLE};
     std::vector<GLuint> framebuffers[LAYER_COUNT];
@@ -48,6 +75,29 @@ struct OpenXrApp {
 
     XrViewConfigurationType viewConfigType;
     XrEnvironmentBlendMode blendMode;
+
+    EGLDisplay display = EGL_NO_DISPLAY;
+    EGLConfig config = nullptr;
+    EGLContext context = EGL_NO_CONTEXT;
+
+    // Per-frame layer structs are bump-allocated from here
+    FrameArena frameArena{4 * 1024, 2};
+
+    // Phase timings of recent frames, written out as a Chrome trace on exit
+    FrameTimeline timeline;
+    // Last pollEvents(), recorded into the frame that follows it
+    int64_t pollStartNs = 0;
+    int64_t pollEndNs = 0;
+
+    // Drops and frame-time percentiles; GPU time of the swapchain clears
+    FrameStats frameStats;
+    GpuTimer gpuTimer;
+
+    // What limits each frame: CPU, GPU, compositor or nothing
+    FrameAnalyzer analyzer;
+
+    // Head-locked stats quad, submitted on top of the panels
+    PerfHud hud;
 };
 
 // ... (CompileShader and CreateProgram helpers are unchanged) ...
@@ -93,32 +143,57 @@ GLuint CreateProgram(const char* vs_source, const char* fs_source) {
     return program;
 }
 
-bool initializeOpenXR(OpenXrApp* oxr) {
-    // Initialize loader first
-    PFN_xrInitializeLoaderKHR xrInitializeLoaderKHR;
-    xrGetInstanceProcAddr(XR_NULL_HANDLE, "xrInitializeLoaderKHR", (PFN_xrVoidFunction*)&xrInitializeLoaderKHR);
-    XrLoaderInitInfoAndroidKHR loaderInitInfo = {XR_TYPE_LOADER_INIT_INFO_ANDROID_KHR};
-    loaderInitInfo.applicationVM = oxr->app->activity->vm;
-    loaderInitInfo.applicationContext = oxr->app->activity->clazz;
-    xrInitializeLoaderKHR((const XrLoaderInitInfoBaseHeaderKHR*)&loaderInitInfo);
+bool initializeEGL(OpenXrApp* oxr) {
+    PROFILE_ZONE("initializeEGL");
+    oxr->display = platformEglDisplay();
+    if (oxr->display == EGL_NO_DISPLAY) {
+        LOGE("Failed to initialize EGL display: 0x%x", eglGetError());
+        return false;
+    }
+    // The context is used without a surface; asking for pbuffer configs rather than the default
+    // window ones also works on surfaceless displays (Mesa on a headless host)
+    const EGLint configAttribs[] = { EGL_RENDERABLE_TYPE, EGL_OPENGL_ES3_BIT, EGL_SURFACE_TYPE, EGL_PBUFFER_BIT, EGL_NONE };
+    EGLint numConfigs;
+    eglChooseConfig(oxr->display, configAttribs, &oxr->config, 1, &numConfigs);
+    const EGLint contextAttribs[] = {EGL_CONTEXT_CLIENT_VERSION, 3, EGL_NONE};
+    oxr->context = eglCreateContext(oxr->display, oxr->config, EGL_NO_CONTEXT, contextAttribs);
+    if (oxr->context == EGL_NO_CONTEXT) {
+        LOGE("Failed to create EGL context: 0x%x", eglGetError());
+        return false;
+    }
+    return eglMakeCurrent(oxr->display, EGL_NO_SURFACE, EGL_NO_SURFACE, oxr->context) == EGL_TRUE;
+}
+
+bool initializeLoader(OpenXrApp* oxr) {
+    PROFILE_ZONE("initializeLoader");
+    return platformInitXrLoader(oxr->app);
+}
 
+bool initializeOpenXR(OpenXrApp* oxr) {
+    PROFILE_ZONE("initializeOpenXR");
     // Required extensions for XR_EXTX_overlay
-    std::vector<const char*> extensions = {
-            XR_KHR_ANDROID_CREATE_INSTANCE_EXTENSION_NAME,
-            XR_KHR_OPENGL_ES_ENABLE_EXTENSION_NAME,
-            XR_EXTX_OVERLAY_EXTENSION_NAME  // This is the correct extension name
-    };
+    std::vector<const char*> extensions;
+    platformXrInstanceExtensions(oxr->app, &extensions);
+    extensions.push_back(XR_EXTX_OVERLAY_EXTENSION_NAME);  // This is the correct extension name
+    // Lets the space cache locate everything in one call on 1.0 runtimes
+    if (runtimeSupportsExtension(XR_KHR_LOCATE_SPACES_EXTENSION_NAME)) {
+        extensions.push_back(XR_KHR_LOCATE_SPACES_EXTENSION_NAME);
+    }
+    // Lets static panels drop the display to a lower refresh rate
+    if (runtimeSupportsExtension(XR_FB_DISPLAY_REFRESH_RATE_EXTENSION_NAME)) {
+        extensions.push_back(XR_FB_DISPLAY_REFRESH_RATE_EXTENSION_NAME);
+    }
+    // Lets runtime timestamps be converted to the app's CLOCK_MONOTONIC timebase
+    if (runtimeSupportsExtension(XR_KHR_CONVERT_TIMESPEC_TIME_EXTENSION_NAME)) {
+        extensions.push_back(XR_KHR_CONVERT_TIMESPEC_TIME_EXTENSION_NAME);
+    }
 
     XrApplicationInfo appInfo = {};
     strncpy(appInfo.applicationName, "MultiOverlayTest", XR_MAX_APPLICATION_NAME_SIZE - 1);
     appInfo.apiVersion = XR_CURRENT_API_VERSION;
 
-    XrInstanceCreateInfoAndroidKHR instanceCreateInfoAndroid = {XR_TYPE_INSTANCE_CREATE_INFO_ANDROID_KHR};
-    instanceCreateInfoAndroid.applicationVM = oxr->app->activity->vm;
-    instanceCreateInfoAndroid.applicationActivity = oxr->app->activity->clazz;
-
     XrInstanceCreateInfo instanceCreateInfo = {XR_TYPE_INSTANCE_CREATE_INFO};
-    instanceCreateInfo.next = &instanceCreateInfoAndroid;
+    instanceCreateInfo.next = platformXrInstanceNext(oxr->app);
     instanceCreateInfo.applicationInfo = appInfo;
     instanceCreateInfo.enabledExtensionCount = static_cast<uint32_t>(extensions.size());
     instanceCreateInfo.enabledExtensionNames = extensions.data();
@@ -128,6 +203,11 @@ bool initializeOpenXR(OpenXrApp* oxr) {
         LOGE("Failed to create OpenXR instance: %d", result);
         return false;
     }
+    if (!xrDispatchLoad(oxr->instance, &oxr->xr)) {
+        LOGE("Failed to resolve OpenXR dispatch table");
+        return false;
+    }
+    xrClockInit(&oxr->xr, oxr->instance);
 
     XrSystemGetInfo systemGetInfo = {XR_TYPE_SYSTEM_GET_INFO};
     systemGetInfo.formFactor = XR_FORM_FACTOR_HEAD_MOUNTED_DISPLAY;
@@ -142,6 +222,7 @@ bool initializeOpenXR(OpenXrApp* oxr) {
 }
 
 bool createSession(OpenXrApp* oxr) {
+    PROFILE_ZONE("createSession");
     uint32_t viewConfigCount;
     xrEnumerateViewConfigurations(oxr->instance, oxr->systemId, 0, &viewConfigCount, nullptr);
     std::vector<XrViewConfigurationType> viewConfigs(viewConfigCount);
@@ -156,18 +237,14 @@ bool createSession(OpenXrApp* oxr) {
     oxr->blendMode = blendModes[0];
     LOGI("Using environment blend mode: %d", oxr->blendMode);
 
-    PFN_xrGetOpenGLESGraphicsRequirementsKHR xrGetOpenGLESGraphicsRequirementsKHR = nullptr;
-    xrGetInstanceProcAddr(oxr->instance, "xrGetOpenGLESGraphicsRequirementsKHR", (PFN_xrVoidFunction*)&xrGetOpenGLESGraphicsRequirementsKHR);
-    XrGraphicsRequirementsOpenGLESKHR graphicsRequirements = {XR_TYPE_GRAPHICS_REQUIREMENTS_OPENGL_ES_KHR};
-    xrGetOpenGLESGraphicsRequirementsKHR(oxr->instance, oxr->systemId, &graphicsRequirements);
-
-    XrGraphicsBindingOpenGLESAndroidKHR graphicsBinding = {XR_TYPE_GRAPHICS_BINDING_OPENGL_ES_ANDROID_KHR};
-    graphicsBinding.display = eglGetCurrentDisplay();
-    graphicsBinding.context = eglGetCurrentContext();
+    // XR_MND_headless: a session created without a graphics binding has no compositor behind it
+    const void* graphicsBinding = oxr->headless ? nullptr
+                                                : platformXrGraphicsBinding(oxr->app, oxr->instance, oxr->systemId,
+                                                                            eglGetCurrentDisplay(), oxr->config, eglGetCurrentContext());
 
     // Create overlay session using XR_EXTX_overlay extension
     XrSessionCreateInfoOverlayEXTX overlayCreateInfo = {XR_TYPE_SESSION_CREATE_INFO_OVERLAY_EXTX};
-    overlayCreateInfo.next = &graphicsBinding;  // Graphics binding goes in overlay struct's next
+    overlayCreateInfo.next = graphicsBinding;  // Graphics binding goes in overlay struct's next
     overlayCreateInfo.createFlags = 0;
     overlayCreateInfo.sessionLayersPlacement = 1;  // Place overlay on top
 
@@ -190,11 +267,30 @@ bool createSession(OpenXrApp* oxr) {
         return false;
     }
 
+    spaceCreateInfo.referenceSpaceType = XR_REFERENCE_SPACE_TYPE_VIEW;
+    result = xrCreateReferenceSpace(oxr->session, &spaceCreateInfo, &oxr->viewSpace);
+    if (XR_FAILED(result)) {
+        LOGE("Failed to create view space: %d", result);
+        return false;
+    }
+    oxr->headSlot = oxr->spaces.add(oxr->viewSpace);
+    oxr->refreshRate.init(&oxr->xr, oxr->session);
+    if (!oxr->headless) {
+        oxr->gpuTimer.init();
+        oxr->hud.init(&oxr->xr, oxr->session, platformXrSwapchainImageType(oxr->app));
+    }
+
     return true;
 }
 
 bool createSwapchains(OpenXrApp* oxr) {
+    PROFILE_ZONE("createSwapchains");
     if (oxr->swapchainsCreated) return true;
+    if (oxr->headless) {
+        // Nothing to create; the layers go out with null swapchains, which a headless session ignores
+        oxr->swapchainsCreated = true;
+        return true;
+    }
     LOGI("Creating %d swapchains...", LAYER_COUNT);
 
     for (uint32_t i = 0; i < LAYER_COUNT; ++i) {
@@ -212,7 +308,7 @@ bool createSwapchains(OpenXrApp* oxr) {
 
         uint32_t image_count;
         xrEnumerateSwapchainImages(oxr->swapchains[i], 0, &image_count, nullptr);
-        std::vector<XrSwapchainImageOpenGLESKHR> swapchain_images(image_count, {XR_TYPE_SWAPCHAIN_IMAGE_OPENGL_ES_KHR});
+        std::vector<XrSwapchainImageOpenGLESKHR> swapchain_images(image_count, {platformXrSwapchainImageType(oxr->app)});
         xrEnumerateSwapchainImages(oxr->swapchains[i], image_count, &image_count, (XrSwapchainImageBaseHeader*)swapchain_images.data());
 
         oxr->framebuffers[i].resize(image_count);
@@ -230,8 +326,9 @@ bool createSwapchains(OpenXrApp* oxr) {
 }
 
 void pollEvents(OpenXrApp* oxr) {
+    oxr->pollStartNs = monotonicNowNs();
     XrEventDataBuffer eventData = {XR_TYPE_EVENT_DATA_BUFFER};
-    while (xrPollEvent(oxr->instance, &eventData) == XR_SUCCESS) {
+    while (oxr->xr.PollEvent(oxr->instance, &eventData) == XR_SUCCESS) {
         if (eventData.type == XR_TYPE_EVENT_DATA_SESSION_STATE_CHANGED) {
             auto stateEvent = *reinterpret_cast<const XrEventDataSessionStateChanged*>(&eventData);
             oxr->sessionState = stateEvent.state;
@@ -239,23 +336,73 @@ void pollEvents(OpenXrApp* oxr) {
                 case XR_SESSION_STATE_READY: {
                     XrSessionBeginInfo beginInfo = {XR_TYPE_SESSION_BEGIN_INFO};
                     beginInfo.primaryViewConfigurationType = oxr->viewConfigType;
-                    if (XR_SUCCEEDED(xrBeginSession(oxr->session, &beginInfo))) {
+                    if (XR_SUCCEEDED(oxr->xr.BeginSession(oxr->session, &beginInfo))) {
                         oxr->sessionRunning = true;
                         createSwapchains(oxr);
+                        allocGuardReset();
                     }
                 } break;
                 case XR_SESSION_STATE_STOPPING:
                     oxr->sessionRunning = false;
-                    xrEndSession(oxr->session);
+                    oxr->xr.EndSession(oxr->session);
                     break;
                 case XR_SESSION_STATE_EXITING:
-                    ANativeActivity_finish(oxr->app->activity);
+                    platformFinish(oxr->app);
                     break;
                 default: break;
             }
+        } else if (eventData.type == XR_TYPE_EVENT_DATA_DISPLAY_REFRESH_RATE_CHANGED_FB) {
+            oxr->refreshRate.onRefreshRateChanged(*reinterpret_cast<const XrEventDataDisplayRefreshRateChangedFB*>(&eventData));
         }
         eventData = {XR_TYPE_EVENT_DATA_BUFFER};
     }
+    oxr->pollEndNs = monotonicNowNs();
+}
+
+// Whether a panel centred at `position` (app space) is in front of the viewer. Panels behind
+// the head are left out of the frame so the compositor does not sample them. Assumes visible
+// when the head pose is not valid.
+bool inFrontOfViewer(const OpenXrApp* oxr, const XrVector3f& position) {
+    if (!oxr->spaces.poseValid(oxr->headSlot)) return true;
+    return pose_faces_point(oxr->spaces.location(oxr->headSlot).pose, position);
+}
+
+// Clears each panel's swapchain image to its colour
+void renderSwapchains(OpenXrApp* oxr) {
+    float colors[LAYER_COUNT][4] = {
+            {0.0f, 1.0f, 1.0f, 1.0f}, // Cyan
+            {0.0f, 0.0f, 0.8f, 1.0f}, // Blue
+            {1.0f, 0.0f, 1.0f, 1.0f}, // Magenta
+            {0.0f, 1.0f, 0.0f, 1.0f}  // Green
+    };
+
+    oxr->gpuTimer.begin();
+    for (uint32_t i = 0; i < LAYER_COUNT; ++i) {
+        uint32_t imageIndex;
+        {
+            FramePhaseScope phase(oxr->timeline, FramePhase::Acquire, i);
+            oxr->xr.AcquireSwapchainImage(oxr->swapchains[i], nullptr, &imageIndex);
+        }
+        XrSwapchainImageWaitInfo waitInfo = {XR_TYPE_SWAPCHAIN_IMAGE_WAIT_INFO,
+                                             reinterpret_cast<const void *>(XR_INFINITE_DURATION)};
+        {
+            FramePhaseScope phase(oxr->timeline, FramePhase::WaitImage, i);
+            oxr->xr.WaitSwapchainImage(oxr->swapchains[i], &waitInfo);
+        }
+        {
+            FramePhaseScope phase(oxr->timeline, FramePhase::Render, i);
+            glBindFramebuffer(GL_FRAMEBUFFER, oxr->framebuffers[i][imageIndex]);
+            glViewport(0, 0, oxr->swapchainWidths[i], oxr->swapchainHeights[i]);
+            glClearColor(colors[i][0], colors[i][1], colors[i][2], colors[i][3]);
+            glClear(GL_COLOR_BUFFER_BIT);
+        }
+        {
+            FramePhaseScope phase(oxr->timeline, FramePhase::Release, i);
+            oxr->xr.ReleaseSwapchainImage(oxr->swapchains[i], nullptr);
+        }
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    oxr->gpuTimer.end();
 }
 
 void renderFrame(OpenXrApp* oxr) {
@@ -269,38 +416,39 @@ void renderFrame(OpenXrApp* oxr) {
         oxr->animation_stage++;
         oxr->stage_timer = 0.0f; // Reset timer for the next stage
     }
+    // Once every panel has scaled in nothing moves, so the display can slow down
+    oxr->refreshRate.setRequiredRate(oxr->animation_stage < 4 ? ANIMATING_REFRESH_HZ : STATIC_REFRESH_HZ);
 
+    oxr->timeline.beginFrame();
+    // Events were polled just before this frame started; charge them to it
+    oxr->timeline.record(FramePhase::Poll, oxr->pollStartNs, oxr->pollEndNs);
     XrFrameState frameState = {XR_TYPE_FRAME_STATE};
-    xrWaitFrame(oxr->session, nullptr, &frameState);
-    xrBeginFrame(oxr->session, nullptr);
+    {
+        FramePhaseScope phase(oxr->timeline, FramePhase::Wait);
+        oxr->xr.WaitFrame(oxr->session, nullptr, &frameState);
+    }
+    int64_t waitReturnNs = monotonicNowNs();
+    oxr->frameStats.onWaitFrame(frameState, waitReturnNs);
+    oxr->analyzer.onWaitFrame(frameState);
+    {
+        FramePhaseScope phase(oxr->timeline, FramePhase::Begin);
+        oxr->xr.BeginFrame(oxr->session, nullptr);
+    }
+    oxr->frameArena.beginFrame();
+    xrClockRefresh(monotonicNowNs());
+    oxr->timeline.recordFrameState(frameState);
 
-    std::vector<XrCompositionLayerBaseHeader*> layers;
+    FixedVector<XrCompositionLayerBaseHeader*, LAYER_COUNT + 1> layers;
+    // `layers` points into this, so it has to outlive xrEndFrame
+    std::pmr::vector<XrCompositionLayerQuad> quadLayers(LAYER_COUNT, &oxr->frameArena);
 
     if (frameState.shouldRender) {
-        // --- Render content to each swapchain ---
-        float colors[LAYER_COUNT][4] = {
-                {0.0f, 1.0f, 1.0f, 1.0f}, // Cyan
-                {0.0f, 0.0f, 0.8f, 1.0f}, // Blue
-                {1.0f, 0.0f, 1.0f, 1.0f}, // Magenta
-                {0.0f, 1.0f, 0.0f, 1.0f}  // Green
-        };
-
-        for (uint32_t i = 0; i < LAYER_COUNT; ++i) {
-            uint32_t imageIndex;
-            xrAcquireSwapchainImage(oxr->swapchains[i], nullptr, &imageIndex);
-            XrSwapchainImageWaitInfo waitInfo = {XR_TYPE_SWAPCHAIN_IMAGE_WAIT_INFO,
-                                                 reinterpret_cast<const void *>(XR_INFINITE_DURATION)};
-            xrWaitSwapchainImage(oxr->swapchains[i], &waitInfo);
-            glBindFramebuffer(GL_FRAMEBUFFER, oxr->framebuffers[i][imageIndex]);
-            glViewport(0, 0, oxr->swapchainWidths[i], oxr->swapchainHeights[i]);
-            glClearColor(colors[i][0], colors[i][1], colors[i][2], colors[i][3]);
-            glClear(GL_COLOR_BUFFER_BIT);
-            xrReleaseSwapchainImage(oxr->swapchains[i], nullptr);
-        }
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        oxr->spaces.update(oxr->xr, oxr->session, oxr->appSpace, frameState.predictedDisplayTime);
+
+        if (!oxr->headless) renderSwapchains(oxr);
 
         // --- Define Layers and Animate Them ---
-        static XrCompositionLayerQuad quadLayers[LAYER_COUNT];
+        FramePhaseScope buildPhase(oxr->timeline, FramePhase::BuildLayers);
 
         // Layer 0: Cyan Background (Always visible)
         quadLayers[0] = {XR_TYPE_COMPOSITION_LAYER_QUAD};
@@ -311,7 +459,7 @@ void renderFrame(OpenXrApp* oxr) {
         layers.push_back(reinterpret_cast<XrCompositionLayerBaseHeader*>(&quadLayers[0]));
 
         // Layer 1: Blue
-        if (oxr->animation_stage >= 1) {
+        if (oxr->animation_stage >= 1 && inFrontOfViewer(oxr, {-0.4f, 0.5f, -1.5f})) {
             quadLayers[1] = {XR_TYPE_COMPOSITION_LAYER_QUAD};
             quadLayers[1].space = oxr->appSpace;
             quadLayers[1].subImage = {{oxr->swapchains[1]}, {{0,0}, {(int32_t)oxr->swapchainWidths[1], (int32_t)oxr->swapchainHeights[1]}}};
@@ -322,7 +470,7 @@ void renderFrame(OpenXrApp* oxr) {
         }
 
         // Layer 2: Magenta
-        if (oxr->animation_stage >= 2) {
+        if (oxr->animation_stage >= 2 && inFrontOfViewer(oxr, {-0.2f, -0.2f, -1.0f})) {
             quadLayers[2] = {XR_TYPE_COMPOSITION_LAYER_QUAD};
             quadLayers[2].space = oxr->appSpace;
             quadLayers[2].subImage = {{oxr->swapchains[2]}, {{0,0}, {(int32_t)oxr->swapchainWidths[2], (int32_t)oxr->swapchainHeights[2]}}};
@@ -333,7 +481,7 @@ void renderFrame(OpenXrApp* oxr) {
         }
 
         // Layer 3: Green
-        if (oxr->animation_stage >= 3) {
+        if (oxr->animation_stage >= 3 && inFrontOfViewer(oxr, {0.4f, 0.3f, -1.2f})) {
             quadLayers[3] = {XR_TYPE_COMPOSITION_LAYER_QUAD};
             quadLayers[3].space = oxr->appSpace;
             quadLayers[3].subImage = {{oxr->swapchains[3]}, {{0,0}, {(int32_t)oxr->swapchainWidths[3], (int32_t)oxr->swapchainHeights[3]}}};
@@ -342,6 +490,8 @@ void renderFrame(OpenXrApp* oxr) {
             quadLayers[3].size = {0.5f * scale, 0.5f * scale}; // Animate scale-in
             layers.push_back(reinterpret_cast<XrCompositionLayerBaseHeader*>(&quadLayers[3]));
         }
+
+        if (XrCompositionLayerBaseHeader* hudLayer = oxr->hud.layer()) layers.push_back(hudLayer);
     }
 
     XrFrameEndInfo endInfo = {XR_TYPE_FRAME_END_INFO};
@@ -349,54 +499,89 @@ void renderFrame(OpenXrApp* oxr) {
     endInfo.environmentBlendMode = oxr->blendMode;
     endInfo.layerCount = static_cast<uint32_t>(layers.size());
     endInfo.layers = layers.data();
-    xrEndFrame(oxr->session, &endInfo);
+    {
+        FramePhaseScope phase(oxr->timeline, FramePhase::End);
+        oxr->xr.EndFrame(oxr->session, &endInfo);
+    }
+    oxr->frameStats.onEndFrame(waitReturnNs, monotonicNowNs());
+    int64_t gpuNs;
+    if (oxr->gpuTimer.poll(&gpuNs)) {
+        oxr->frameStats.onGpuTime(gpuNs);
+        oxr->analyzer.onGpuTime(gpuNs);
+        oxr->hud.onGpuTime(gpuNs);
+    }
+    oxr->analyzer.onEndFrame(oxr->timeline);
+    oxr->hud.onEndFrame(waitReturnNs, monotonicNowNs(), oxr->frameStats.droppedFrames(), endInfo.layerCount,
+                        frameState.predictedDisplayPeriod);
 }
 
-void android_main(struct android_app* app) {
-    EGLDisplay display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
-    eglInitialize(display, nullptr, nullptr);
-    EGLConfig config;
-    const EGLint configAttribs[] = { EGL_RENDERABLE_TYPE, EGL_OPENGL_ES3_BIT, EGL_NONE };
-    EGLint numConfigs;
-    eglChooseConfig(display, configAttribs, &config, 1, &numConfigs);
-    const EGLint contextAttribs[] = {EGL_CONTEXT_CLIENT_VERSION, 3, EGL_NONE};
-    EGLContext context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttribs);
-    eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context);
+// EGL comes up on a worker thread while the loader, instance and system are created here.
+// The context is then made current on this thread, which creates the session and renders.
+bool startup(OpenXrApp* oxr) {
+    StartupGraph graph;
+    if (oxr->headless) {
+        auto loader = graph.addTask("xr-loader", StartupGraph::MAIN_LANE, [oxr] { return initializeLoader(oxr); });
+        auto xrInstance = graph.addTask("xr-instance+system", StartupGraph::MAIN_LANE, [oxr] { return initializeOpenXR(oxr); }, {loader});
+        graph.addTask("xr-session", StartupGraph::MAIN_LANE, [oxr] { return createSession(oxr); }, {xrInstance});
+        bool ok = graph.run();
+        graph.report();
+        return ok;
+    }
+    int glLane = graph.addLane("gl");
+
+    auto egl = graph.addTask("egl", glLane, [oxr] { return initializeEGL(oxr); });
+    auto release = graph.addTask("egl-release", glLane, [oxr] {
+        return eglMakeCurrent(oxr->display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT) == EGL_TRUE;
+    }, {egl});
+
+    auto loader = graph.addTask("xr-loader", StartupGraph::MAIN_LANE, [oxr] { return initializeLoader(oxr); });
+    auto xrInstance = graph.addTask("xr-instance+system", StartupGraph::MAIN_LANE, [oxr] { return initializeOpenXR(oxr); }, {loader});
+    auto bind = graph.addTask("egl-bind", StartupGraph::MAIN_LANE, [oxr] {
+        return eglMakeCurrent(oxr->display, EGL_NO_SURFACE, EGL_NO_SURFACE, oxr->context) == EGL_TRUE;
+    }, {release});
+    graph.addTask("xr-session", StartupGraph::MAIN_LANE, [oxr] { return createSession(oxr); }, {xrInstance, bind});
+
+    bool ok = graph.run();
+    graph.report();
+    return ok;
+}
 
+void platformMain(PlatformApp* app) {
     OpenXrApp oxr = {};
     oxr.app = app;
+    oxr.headless = app->noGraphics;
     app->userData = &oxr;
+    if (oxr.headless) LOGI("No graphics: XR_MND_headless session, layers built and submitted without swapchains");
 
-    app->onAppCmd = [](struct android_app* app, int32_t cmd) {
+    app->onCmd = [](PlatformApp* app, PlatformCmd cmd) {
         auto* oxr_ptr = (OpenXrApp*)app->userData;
-        if (cmd == APP_CMD_RESUME) oxr_ptr->resumed = true;
-        if (cmd == APP_CMD_PAUSE) oxr_ptr->resumed = false;
+        if (cmd == PlatformCmd::Resume) oxr_ptr->resumed = true;
+        if (cmd == PlatformCmd::Pause) oxr_ptr->resumed = false;
     };
 
     // Modified input handler to reset the animation on tap
-    app->onInputEvent = [](struct android_app* app, AInputEvent* event) -> int32_t {
+    app->onInput = [](PlatformApp* app, const PlatformInput& input) {
         auto* oxr_ptr = (OpenXrApp*)app->userData;
-        if (AInputEvent_getType(event) == AINPUT_EVENT_TYPE_MOTION) {
-            if (AMotionEvent_getAction(event) == AMOTION_EVENT_ACTION_DOWN) {
-                // Reset animation
-                oxr_ptr->animation_stage = 0;
-                oxr_ptr->stage_timer = 0.0f;
-                LOGI("Animation reset by user.");
-            }
-            return 1;
+        if (input.action == PlatformInput::Down) {
+            // Reset animation
+            oxr_ptr->animation_stage = 0;
+            oxr_ptr->stage_timer = 0.0f;
+            LOGI("Animation reset by user.");
         }
-        return 0;
+        return true;
     };
 
-    if (!initializeOpenXR(&oxr) || !createSession(&oxr)) {
+    if (!startup(&oxr)) {
         if(oxr.instance) xrDestroyInstance(oxr.instance);
+        if (oxr.context != EGL_NO_CONTEXT) eglDestroyContext(oxr.display, oxr.context);
+        if (oxr.display != EGL_NO_DISPLAY) eglTerminate(oxr.display);
         return;
     }
 
     while (!app->destroyRequested) {
-        struct android_poll_source* source;
-        while (ALooper_pollOnce(0, nullptr, nullptr, (void**)&source) >= 0) {
-            if (source) source->process(app, source);
+        // Steady-state frames must not allocate; debug builds check it
+        AllocGuardFrame frameGuard;
+        while (platformPollEvent(app, 0)) {
             if (app->destroyRequested) break;
         }
         pollEvents(&oxr);
@@ -404,13 +589,41 @@ void android_main(struct android_app* app) {
     }
 
     for (uint32_t i = 0; i < LAYER_COUNT; ++i) {
-        glDeleteFramebuffers(oxr.framebuffers[i].size(), oxr.framebuffers[i].data());
+        if (!oxr.framebuffers[i].empty()) glDeleteFramebuffers(oxr.framebuffers[i].size(), oxr.framebuffers[i].data());
         if (oxr.swapchains[i]) xrDestroySwapchain(oxr.swapchains[i]);
     }
 
+    const FrameArena::Stats& arenaStats = oxr.frameArena.stats();
+    LOGI("Frame arena: high-water %zu of %zu bytes/frame, %llu overflow allocations (%zu bytes)",
+         arenaStats.highWaterBytes, arenaStats.capacityPerFrame,
+         (unsigned long long)arenaStats.overflowAllocations, arenaStats.overflowBytes);
+
+    const SpaceLocationCache::Stats& spaceStats = oxr.spaces.stats();
+    LOGI("Space cache: %.2f runtime calls/frame over %llu frames (%s)",
+         spaceStats.frames ? (double)spaceStats.totalCalls / spaceStats.frames : 0.0,
+         (unsigned long long)spaceStats.frames, spaceStats.batched ? "batched" : "per space");
+
+    oxr.refreshRate.shutdown();
+    oxr.refreshRate.report();
+    oxr.frameStats.report("Session");
+    oxr.analyzer.report("Session");
+    oxr.analyzer.reportPhases("Session");
+    oxr.gpuTimer.destroy();
+    oxr.hud.destroy();
+    std::string tracePath = std::string(app->dataPath) + "/frame_timeline.json";
+    oxr.timeline.exportChromeTrace(tracePath.c_str());
+    profilerReport();
+    profilerExportChromeTrace((std::string(app->dataPath) + "/profile.json").c_str());
+
+    if (oxr.viewSpace) xrDestroySpace(oxr.viewSpace);
     if (oxr.appSpace) xrDestroySpace(oxr.appSpace);
     if (oxr.session) xrDestroySession(oxr.session);
+    xrClockShutdown();
     if (oxr.instance) xrDestroyInstance(oxr.instance);
-    eglDestroyContext(display, context);
-    eglTerminate(display);
+    if (oxr.display != EGL_NO_DISPLAY) {
+        eglMakeCurrent(oxr.display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        eglDestroyContext(oxr.display, oxr.context);
+        eglTerminate(oxr.display);
+    }
+    logFlush();
 }
\ No newline at end of file
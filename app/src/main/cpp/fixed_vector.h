@@ -0,0 +1,39 @@
+#ifndef ANDROIDSAMSUNG_FIXED_VECTOR_H
+#define ANDROIDSAMSUNG_FIXED_VECTOR_H
+
+#include <stddef.h>
+
+// Vector with inline storage and a compile-time capacity. Never touches the heap, so it can
+// live on the stack of the frame loop. push_back() refuses (returns false) once full.
+template <typename T, size_t Capacity>
+class FixedVector {
+public:
+    bool push_back(const T& value) {
+        if (count == Capacity) return false;
+        items[count++] = value;
+        return true;
+    }
+
+    void clear() { count = 0; }
+
+    size_t size() const { return count; }
+    static constexpr size_t capacity() { return Capacity; }
+    bool empty() const { return count == 0; }
+    bool full() const { return count == Capacity; }
+
+    T* data() { return items; }
+    const T* data() const { return items; }
+    T& operator[](size_t i) { return items[i]; }
+    const T& operator[](size_t i) const { return items[i]; }
+
+    T* begin() { return items; }
+    T* end() { return items + count; }
+    const T* begin() const { return items; }
+    const T* end() const { return items + count; }
+
+private:
+    T items[Capacity] = {};
+    size_t count = 0;
+};
+
+#endif //ANDROIDSAMSUNG_FIXED_VECTOR_H
@@ -0,0 +1,207 @@
+#include "frame_analyzer.h"
+
+#define LOG_TAG "FrameAnalyzer"
+#include "log.h"
+
+static const char* const BOUND_NAMES[] = {"idle", "CPU-bound", "GPU-bound", "compositor-bound"};
+static_assert(sizeof(BOUND_NAMES) / sizeof(BOUND_NAMES[0]) == (size_t)FrameBound::Count, "one name per class");
+
+const char* frameBoundName(FrameBound bound) {
+    return bound < FrameBound::Count ? BOUND_NAMES[(int)bound] : "unknown";
+}
+
+// Wait and WaitImage are time spent blocked on the runtime, not work done by the app
+static bool isCpuPhase(int phase) {
+    return phase != (int)FramePhase::Wait && phase != (int)FramePhase::WaitImage && phase != (int)FramePhase::Display;
+}
+
+static int64_t cpuNs(const int64_t* phaseNs) {
+    int64_t sum = 0;
+    for (int phase = 0; phase < (int)FramePhase::Count; ++phase) {
+        if (isCpuPhase(phase)) sum += phaseNs[phase];
+    }
+    return sum;
+}
+
+void FrameAnalyzer::onWaitFrame(const XrFrameState& frameState) {
+    if (pendingValid && pendingEnded) {
+        int64_t period = pending.periodNs;
+        if (period > 0) {
+            int64_t gap = frameState.predictedDisplayTime - pendingDisplayTime;
+            pending.dropped = (gap + period / 2) / period > 1;
+        }
+        pending.bound = classify(pending);
+        last = pending.bound;
+        totals[(int)pending.bound]++;
+        push(pending);
+    }
+    pending = {};
+    pending.periodNs = frameState.predictedDisplayPeriod;
+    pending.shouldRender = frameState.shouldRender;
+    pendingDisplayTime = frameState.predictedDisplayTime;
+    pendingValid = true;
+    pendingEnded = false;
+}
+
+void FrameAnalyzer::onEndFrame(const FrameTimeline& timeline) {
+    if (!pendingValid) return;
+    timeline.forEachInFrame(timeline.currentFrame(), [this](const FrameTimelineRecord& r) {
+        if (r.phase < PHASES) pending.phaseNs[r.phase] += r.endNs - r.startNs;
+    });
+    pending.phaseNs[(int)FramePhase::Display] = 0;
+    pending.gpuNs = latestGpuNs;
+    pendingEnded = true;
+}
+
+FrameBound FrameAnalyzer::classify(const Sample& sample) {
+    double period = (double)sample.periodNs;
+    if (!sample.shouldRender || period <= 0) return FrameBound::Idle;
+
+    double cpu = (double)cpuNs(sample.phaseNs);
+    double gpu = sample.gpuNs > 0 ? (double)sample.gpuNs : 0.0;
+    double wait = (double)sample.phaseNs[(int)FramePhase::Wait];
+    double waitImage = (double)sample.phaseNs[(int)FramePhase::WaitImage];
+
+    if (cpu >= BOUND_LOAD * period && cpu >= gpu) return FrameBound::Cpu;
+    if (gpu >= BOUND_LOAD * period) return FrameBound::Gpu;
+    if (sample.dropped || waitImage >= COMPOSITOR_BLOCK * period) return FrameBound::Compositor;
+    if (wait >= IDLE_SLACK * period || (cpu < IDLE_LOAD * period && gpu < IDLE_LOAD * period)) return FrameBound::Idle;
+    return cpu >= gpu ? FrameBound::Cpu : FrameBound::Gpu;
+}
+
+void FrameAnalyzer::push(const Sample& sample) {
+    for (int phase = 0; phase < PHASES; ++phase) {
+        phaseTotalNs[phase] += sample.phaseNs[phase];
+        if (sample.phaseNs[phase] > phaseMaxNs[phase]) phaseMaxNs[phase] = sample.phaseNs[phase];
+    }
+    phaseFrames++;
+
+    window[windowNext] = sample;
+    windowNext = (windowNext + 1) % WINDOW;
+    if (windowCount < WINDOW) windowCount++;
+    if (windowNext != 0) return;
+
+    // Once per full window: log a change in what mostly limits the frames
+    Summary s = summary();
+    if (s.dominant == reportedDominant) return;
+    reportedDominant = s.dominant;
+    PhaseCost top;
+    bool haveTop = rankedPhases(&top, 1) == 1;
+    LOGI("Frames now mostly %s (%u of %u): cpu %.2f  gpu %.2f  blocked %.2f ms, top phase %s %.2f ms",
+         frameBoundName(s.dominant), s.counts[(int)s.dominant], s.frames, s.cpuMs, s.gpuMs,
+         s.waitMs + s.waitImageMs, haveTop ? framePhaseName(top.phase) : "-", haveTop ? top.meanMs : 0.0);
+}
+
+FrameAnalyzer::Summary FrameAnalyzer::summary() const {
+    Summary s = {};
+    s.frames = windowCount;
+    int64_t cpu = 0, gpu = 0, wait = 0, waitImage = 0;
+    uint32_t gpuSamples = 0;
+    for (uint32_t i = 0; i < windowCount; ++i) {
+        const Sample& sample = window[i];
+        s.counts[(int)sample.bound]++;
+        if (sample.dropped) s.dropped++;
+        cpu += cpuNs(sample.phaseNs);
+        wait += sample.phaseNs[(int)FramePhase::Wait];
+        waitImage += sample.phaseNs[(int)FramePhase::WaitImage];
+        if (sample.gpuNs > 0) {
+            gpu += sample.gpuNs;
+            gpuSamples++;
+        }
+    }
+    s.dominant = FrameBound::Idle;
+    for (int bound = 0; bound < (int)FrameBound::Count; ++bound) {
+        if (s.counts[bound] > s.counts[(int)s.dominant]) s.dominant = (FrameBound)bound;
+    }
+    if (windowCount > 0) {
+        s.cpuMs = cpu / 1e6 / windowCount;
+        s.waitMs = wait / 1e6 / windowCount;
+        s.waitImageMs = waitImage / 1e6 / windowCount;
+    }
+    if (gpuSamples > 0) s.gpuMs = gpu / 1e6 / gpuSamples;
+    return s;
+}
+
+int FrameAnalyzer::rankedPhases(PhaseCost* out, int max) const {
+    if (windowCount == 0 || max <= 0) return 0;
+    PhaseCost costs[PHASES];
+    int count = 0;
+    for (int phase = 0; phase < PHASES; ++phase) {
+        // The xrWaitFrame block is slack, not cost
+        if (phase == (int)FramePhase::Wait || phase == (int)FramePhase::Display) continue;
+        int64_t sum = 0, worst = 0;
+        for (uint32_t i = 0; i < windowCount; ++i) {
+            int64_t ns = window[i].phaseNs[phase];
+            sum += ns;
+            if (ns > worst) worst = ns;
+        }
+        costs[count++] = {(FramePhase)phase, sum / 1e6 / windowCount, worst / 1e6};
+    }
+    // Insertion sort, most expensive first; there are only a handful of phases
+    for (int i = 1; i < count; ++i) {
+        PhaseCost cost = costs[i];
+        int j = i;
+        for (; j > 0 && costs[j - 1].meanMs < cost.meanMs; --j) costs[j] = costs[j - 1];
+        costs[j] = cost;
+    }
+    int n = count < max ? count : max;
+    for (int i = 0; i < n; ++i) out[i] = costs[i];
+    return n;
+}
+
+void FrameAnalyzer::report(const char* label) const {
+    uint64_t all = 0;
+    for (uint64_t count : totals) all += count;
+    if (all == 0) return;
+    LOGI("%s frames: %llu idle, %llu CPU-bound, %llu GPU-bound, %llu compositor-bound",
+         label, (unsigned long long)totals[(int)FrameBound::Idle], (unsigned long long)totals[(int)FrameBound::Cpu],
+         (unsigned long long)totals[(int)FrameBound::Gpu], (unsigned long long)totals[(int)FrameBound::Compositor]);
+
+    Summary s = summary();
+    LOGI("%s last %u frames mostly %s: cpu %.2f  gpu %.2f  xrWaitFrame %.2f  xrWaitSwapchainImage %.2f ms, %u missed",
+         label, s.frames, frameBoundName(s.dominant), s.cpuMs, s.gpuMs, s.waitMs, s.waitImageMs, s.dropped);
+    PhaseCost ranked[3];
+    int n = rankedPhases(ranked, 3);
+    for (int i = 0; i < n; ++i) {
+        LOGI("%s   #%d %-24s mean %.3f  max %.3f ms", label, i + 1, framePhaseName(ranked[i].phase),
+             ranked[i].meanMs, ranked[i].maxMs);
+    }
+}
+
+void FrameAnalyzer::reportPhases(const char* label) const {
+    if (phaseFrames == 0) return;
+    int64_t cpu = cpuNs(phaseTotalNs);
+    LOGI("%s per-phase cost over %llu frames: cpu %.3f ms/frame", label, (unsigned long long)phaseFrames,
+         cpu / 1e6 / phaseFrames);
+    // Frame order rather than enum order: events are polled before xrWaitFrame
+    static const FramePhase ORDER[] = {
+            FramePhase::Poll, FramePhase::Wait, FramePhase::Begin, FramePhase::LocateViews, FramePhase::Acquire,
+            FramePhase::WaitImage, FramePhase::Render, FramePhase::Release, FramePhase::BuildLayers, FramePhase::End,
+    };
+    static_assert(sizeof(ORDER) / sizeof(ORDER[0]) == PHASES - 1, "every phase but the Display marker");
+    for (FramePhase phase : ORDER) {
+        int p = (int)phase;
+        if (isCpuPhase(p)) {
+            LOGI("%s   %-24s mean %.4f  max %.3f ms  %5.1f%%", label, framePhaseName(phase),
+                 phaseTotalNs[p] / 1e6 / phaseFrames, phaseMaxNs[p] / 1e6, cpu > 0 ? 100.0 * phaseTotalNs[p] / cpu : 0.0);
+        } else {
+            LOGI("%s   %-24s mean %.4f  max %.3f ms  (blocked)", label, framePhaseName(phase),
+                 phaseTotalNs[p] / 1e6 / phaseFrames, phaseMaxNs[p] / 1e6);
+        }
+    }
+}
+
+void FrameAnalyzer::reset() {
+    pending = {};
+    pendingValid = false;
+    pendingEnded = false;
+    pendingDisplayTime = 0;
+    latestGpuNs = -1;
+    windowCount = 0;
+    windowNext = 0;
+    for (uint64_t& count : totals) count = 0;
+    for (int phase = 0; phase < PHASES; ++phase) phaseTotalNs[phase] = phaseMaxNs[phase] = 0;
+    phaseFrames = 0;
+    last = FrameBound::Idle;
+    reportedDominant = FrameBound::Count;
+}
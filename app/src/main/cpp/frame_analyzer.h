@@ -0,0 +1,110 @@
+#ifndef ANDROIDSAMSUNG_FRAME_ANALYZER_H
+#define ANDROIDSAMSUNG_FRAME_ANALYZER_H
+
+#include <stdint.h>
+
+#include "frame_timeline.h"
+#include "xr_dispatch.h"
+
+enum class FrameBound : uint8_t {
+    Idle,        // not rendered, or plenty of headroom on both processors
+    Cpu,         // the frame loop itself is what limits the frame
+    Gpu,         // GPU work is what limits the frame
+    Compositor,  // neither side is near the budget, yet the frame slipped or blocked on the swapchain
+    Count
+};
+
+const char* frameBoundName(FrameBound bound);
+
+// Classifies each frame by what limited it.
+//
+// Inputs are the frame's phases from the FrameTimeline (CPU work is everything but Wait and
+// WaitImage), the latest GpuTimer result (queries lag a few frames, so this is the GPU cost
+// of a recent frame rather than exactly this one), the time blocked in xrWaitFrame, and
+// whether the frame missed its display slot. A miss only shows up in the next frame's
+// predictedDisplayTime, so each frame is classified when the following xrWaitFrame returns.
+//
+// Keeps the last WINDOW frames for rolling summaries and a ranking of the phases (all but the
+// xrWaitFrame block) by mean cost, and logs whenever the dominant class of a full window
+// changes. Frame thread only.
+//
+//     { FramePhaseScope phase(timeline, FramePhase::Wait); xr.WaitFrame(...); }
+//     analyzer.onWaitFrame(frameState);
+//     ...
+//     analyzer.onEndFrame(timeline);
+class FrameAnalyzer {
+public:
+    static constexpr int WINDOW = 128;
+
+    // Fractions of the display period used by the classification
+    static constexpr double BOUND_LOAD = 0.85;       // CPU or GPU at least this busy is the bottleneck
+    static constexpr double IDLE_LOAD = 0.5;         // both under this is idle
+    static constexpr double IDLE_SLACK = 0.5;        // blocked in xrWaitFrame at least this long is idle
+    static constexpr double COMPOSITOR_BLOCK = 0.25; // blocked in xrWaitSwapchainImage this long
+
+    struct PhaseCost {
+        FramePhase phase;
+        double meanMs;
+        double maxMs;
+    };
+
+    struct Summary {
+        uint32_t frames;                          // in the window
+        uint32_t counts[(int)FrameBound::Count];  // per class, in the window
+        FrameBound dominant;
+        double cpuMs, gpuMs, waitMs, waitImageMs; // means over the window
+        uint32_t dropped;                         // frames in the window that missed their slot
+    };
+
+    // Call right after xrWaitFrame returns; classifies the previous frame
+    void onWaitFrame(const XrFrameState& frameState);
+    void onGpuTime(int64_t gpuNs) { latestGpuNs = gpuNs; }
+    // Call after xrEndFrame; collects this frame's phases from the timeline
+    void onEndFrame(const FrameTimeline& timeline);
+
+    FrameBound lastBound() const { return last; }
+    uint64_t total(FrameBound bound) const { return totals[(int)bound]; }
+
+    Summary summary() const;
+    // Fills `out` with up to `max` phases, most expensive first; returns how many
+    int rankedPhases(PhaseCost* out, int max) const;
+
+    void report(const char* label) const;
+    // Logs every phase over all frames since the last reset, in frame order: mean and worst
+    // time per frame, and each CPU phase's share of the frame loop's CPU time
+    void reportPhases(const char* label) const;
+    void reset();
+
+private:
+    static constexpr int PHASES = (int)FramePhase::Count;
+
+    struct Sample {
+        int64_t phaseNs[PHASES];
+        int64_t gpuNs;
+        int64_t periodNs;
+        bool shouldRender;
+        bool dropped;
+        FrameBound bound;
+    };
+
+    static FrameBound classify(const Sample& sample);
+    void push(const Sample& sample);
+
+    Sample pending = {};
+    bool pendingValid = false;
+    bool pendingEnded = false;
+    XrTime pendingDisplayTime = 0;
+    int64_t latestGpuNs = -1;
+
+    Sample window[WINDOW] = {};
+    uint32_t windowCount = 0;
+    uint32_t windowNext = 0;
+    uint64_t totals[(int)FrameBound::Count] = {};
+    int64_t phaseTotalNs[PHASES] = {};
+    int64_t phaseMaxNs[PHASES] = {};
+    uint64_t phaseFrames = 0;
+    FrameBound last = FrameBound::Idle;
+    FrameBound reportedDominant = FrameBound::Count;
+};
+
+#endif //ANDROIDSAMSUNG_FRAME_ANALYZER_H
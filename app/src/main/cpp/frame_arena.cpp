@@ -0,0 +1,75 @@
+#include "frame_arena.h"
+
+#include <algorithm>
+
+static size_t alignUp(size_t value, size_t alignment) {
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+FrameArena::FrameArena(size_t bytesPerFrame, uint32_t framesInFlight, std::pmr::memory_resource* upstream)
+    : upstream(upstream),
+      regionSize(alignUp(bytesPerFrame, alignof(std::max_align_t))),
+      regionCount(framesInFlight < 1 ? 1 : framesInFlight) {
+    storage = static_cast<uint8_t*>(upstream->allocate(regionSize * regionCount, alignof(std::max_align_t)));
+    overflowLists = new Overflow*[regionCount]();
+    frameStats.capacityPerFrame = regionSize;
+}
+
+FrameArena::~FrameArena() {
+    for (uint32_t region = 0; region < regionCount; ++region) {
+        releaseOverflow(region);
+    }
+    delete[] overflowLists;
+    upstream->deallocate(storage, regionSize * regionCount, alignof(std::max_align_t));
+}
+
+void FrameArena::beginFrame() {
+    frameStats.lastFrameBytes = frameBytes;
+    frameStats.highWaterBytes = std::max(frameStats.highWaterBytes, frameBytes);
+
+    current = (current + 1) % regionCount;
+    releaseOverflow(current);
+    offset = 0;
+    frameBytes = 0;
+}
+
+void FrameArena::releaseOverflow(uint32_t region) {
+    Overflow* block = overflowLists[region];
+    while (block) {
+        Overflow* next = block->next;
+        upstream->deallocate(block, block->bytes, block->alignment);
+        block = next;
+    }
+    overflowLists[region] = nullptr;
+}
+
+void* FrameArena::do_allocate(size_t bytes, size_t alignment) {
+    frameBytes += bytes;
+
+    size_t start = alignUp(offset, alignment);
+    if (start + bytes <= regionSize) {
+        offset = start + bytes;
+        return storage + current * regionSize + start;
+    }
+
+    // Out of room for this frame: take it from upstream and remember it for the next reset
+    size_t blockAlignment = std::max(alignment, alignof(Overflow));
+    size_t headerSpace = alignUp(sizeof(Overflow), blockAlignment);
+    auto* block = static_cast<Overflow*>(upstream->allocate(headerSpace + bytes, blockAlignment));
+    block->next = overflowLists[current];
+    block->bytes = headerSpace + bytes;
+    block->alignment = blockAlignment;
+    overflowLists[current] = block;
+
+    frameStats.overflowAllocations++;
+    frameStats.overflowBytes += bytes;
+    return reinterpret_cast<uint8_t*>(block) + headerSpace;
+}
+
+void FrameArena::do_deallocate(void*, size_t, size_t) {
+    // Everything is released together when the region is recycled
+}
+
+bool FrameArena::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
+    return this == &other;
+}
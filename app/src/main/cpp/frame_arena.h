@@ -0,0 +1,66 @@
+#ifndef ANDROIDSAMSUNG_FRAME_ARENA_H
+#define ANDROIDSAMSUNG_FRAME_ARENA_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <memory_resource>
+
+// Bump allocator for data that only lives for one frame: layer structs, draw lists, culling
+// results, uniform staging.
+//
+// The arena owns one fixed-size region per frame in flight. beginFrame() moves to the next
+// region and resets it, so memory handed out during frame N stays valid until frame
+// N + framesInFlight starts. Deallocation is a no-op. When a frame outgrows its region, the
+// allocation falls back to the upstream resource and is released at the region's next reset.
+//
+// Use it as a std::pmr::memory_resource:
+//     std::pmr::vector<XrCompositionLayerQuad> quads(&frameArena);
+class FrameArena : public std::pmr::memory_resource {
+public:
+    struct Stats {
+        size_t capacityPerFrame = 0;
+        size_t lastFrameBytes = 0;       // bytes handed out during the last completed frame
+        size_t highWaterBytes = 0;       // largest lastFrameBytes seen so far
+        uint64_t overflowAllocations = 0; // total allocations that went to the upstream resource
+        size_t overflowBytes = 0;         // total bytes that went to the upstream resource
+    };
+
+    FrameArena(size_t bytesPerFrame, uint32_t framesInFlight = 2,
+               std::pmr::memory_resource* upstream = std::pmr::new_delete_resource());
+    ~FrameArena() override;
+
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    // Starts a new frame: finalizes the stats of the previous one and recycles the oldest region.
+    void beginFrame();
+
+    const Stats& stats() const { return frameStats; }
+
+protected:
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+private:
+    // Header placed in front of each upstream fallback block so the region can free it on reset
+    struct Overflow {
+        Overflow* next;
+        size_t bytes;
+        size_t alignment;
+    };
+
+    void releaseOverflow(uint32_t region);
+
+    std::pmr::memory_resource* upstream;
+    uint8_t* storage;
+    size_t regionSize;
+    uint32_t regionCount;
+    uint32_t current = 0;
+    size_t offset = 0;
+    size_t frameBytes = 0;
+    Overflow** overflowLists;
+    Stats frameStats;
+};
+
+#endif //ANDROIDSAMSUNG_FRAME_ARENA_H
@@ -0,0 +1,227 @@
+#include "frame_capture.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#define LOG_TAG "FrameCapture"
+#include "log.h"
+
+// stdio buffer for the capture file; a frame record is well under 1 KiB
+static const size_t WRITE_BUFFER_BYTES = 1 << 20;
+
+bool FrameCapture::start(const char* path, uint32_t frameLimit) {
+    stop();
+    file = fopen(path, "wb");
+    if (!file) {
+        LOGE("Cannot open %s for the layer capture", path);
+        return false;
+    }
+    buffer = static_cast<char*>(malloc(WRITE_BUFFER_BYTES));
+    if (buffer) setvbuf(file, buffer, _IOFBF, WRITE_BUFFER_BYTES);
+
+    FrameCaptureFileHeader header = {FRAME_CAPTURE_MAGIC, FRAME_CAPTURE_VERSION, sizeof(FrameCaptureFileHeader), 0};
+    fwrite(&header, sizeof(header), 1, file);
+
+    maxFrames = frameLimit;
+    frames = 0;
+    nextId = 1;
+    for (uint32_t i = 0; i < swapchainCount; ++i) swapchains[i].id = 0;
+    for (uint32_t i = 0; i < spaceCount; ++i) spaces[i].id = 0;
+    LOGI("Capturing up to %u frames of layers to %s", maxFrames, path);
+    return true;
+}
+
+void FrameCapture::stop() {
+    if (!file) return;
+    fclose(file);
+    free(buffer);
+    file = nullptr;
+    buffer = nullptr;
+    LOGI("Layer capture finished: %u frames", frames);
+}
+
+void FrameCapture::writeRecord(FrameCaptureTag tag, const void* payload, uint32_t size) {
+    FrameCaptureRecordHeader header = {(uint32_t)tag, size};
+    fwrite(&header, sizeof(header), 1, file);
+    fwrite(payload, size, 1, file);
+}
+
+// --- Handles ---
+
+FrameCapture::SwapchainEntry* FrameCapture::findSwapchain(XrSwapchain swapchain, bool add) {
+    for (uint32_t i = 0; i < swapchainCount; ++i) {
+        if (swapchains[i].handle == swapchain) return &swapchains[i];
+    }
+    if (!add || swapchainCount == MAX_SWAPCHAINS) return nullptr;
+    SwapchainEntry& entry = swapchains[swapchainCount++];
+    entry = {};
+    entry.handle = swapchain;
+    return &entry;
+}
+
+FrameCapture::SpaceEntry* FrameCapture::findSpace(XrSpace space, bool add) {
+    for (uint32_t i = 0; i < spaceCount; ++i) {
+        if (spaces[i].handle == space) return &spaces[i];
+    }
+    if (!add || spaceCount == MAX_SPACES) return nullptr;
+    SpaceEntry& entry = spaces[spaceCount++];
+    entry = {};
+    entry.handle = space;
+    entry.pose = {{0, 0, 0, 1}, {0, 0, 0}};
+    return &entry;
+}
+
+void FrameCapture::addSwapchain(XrSwapchain swapchain, const XrSwapchainCreateInfo& info) {
+    SwapchainEntry* entry = findSwapchain(swapchain, true);
+    if (!entry) return;
+    entry->info = info;
+    entry->info.next = nullptr;
+    entry->known = true;
+}
+
+void FrameCapture::addSpace(XrSpace space, XrReferenceSpaceType type, const XrPosef& poseInReferenceSpace) {
+    SpaceEntry* entry = findSpace(space, true);
+    if (!entry) return;
+    entry->type = type;
+    entry->pose = poseInReferenceSpace;
+}
+
+void FrameCapture::forgetHandles() {
+    swapchainCount = 0;
+    spaceCount = 0;
+}
+
+void FrameCapture::setContentHash(XrSwapchain swapchain, uint64_t hash) {
+    if (SwapchainEntry* entry = findSwapchain(swapchain, true)) entry->hash = hash;
+}
+
+uint32_t FrameCapture::swapchainId(XrSwapchain swapchain) {
+    SwapchainEntry* entry = findSwapchain(swapchain, true);
+    if (!entry) return 0;
+    if (entry->id == 0) {
+        entry->id = nextId++;
+        FrameCaptureSwapchain record = {};
+        record.id = entry->id;
+        if (entry->known) {
+            record.width = entry->info.width;
+            record.height = entry->info.height;
+            record.arraySize = entry->info.arraySize;
+            record.faceCount = entry->info.faceCount;
+            record.mipCount = entry->info.mipCount;
+            record.sampleCount = entry->info.sampleCount;
+            record.format = entry->info.format;
+            record.usageFlags = entry->info.usageFlags;
+        }
+        writeRecord(FrameCaptureTag::Swapchain, &record, sizeof(record));
+    }
+    return entry->id;
+}
+
+uint32_t FrameCapture::spaceId(XrSpace space) {
+    SpaceEntry* entry = findSpace(space, true);
+    if (!entry) return 0;
+    if (entry->id == 0) {
+        entry->id = nextId++;
+        FrameCaptureSpace record = {entry->id, (uint32_t)entry->type, entry->pose};
+        writeRecord(FrameCaptureTag::Space, &record, sizeof(record));
+    }
+    return entry->id;
+}
+
+FrameCaptureSubImage FrameCapture::subImage(const XrSwapchainSubImage& image) {
+    FrameCaptureSubImage result = {};
+    result.swapchain = swapchainId(image.swapchain);
+    result.arrayIndex = image.imageArrayIndex;
+    result.rect = image.imageRect;
+    if (SwapchainEntry* entry = findSwapchain(image.swapchain, false)) result.contentHash = entry->hash;
+    return result;
+}
+
+// --- Frames ---
+
+void FrameCapture::record(const XrFrameEndInfo& info, const XrFrameState& state, int64_t waitReturnNs,
+                          int64_t endCallNs, int64_t endReturnNs, XrResult endResult) {
+    if (!file) return;
+
+    // Layers first: their handles may need Swapchain/Space records ahead of the frame
+    FrameCaptureLayer layers[MAX_LAYERS];
+    FrameCaptureView views[MAX_LAYERS][MAX_VIEWS];
+    uint32_t layerCount = info.layerCount < MAX_LAYERS ? info.layerCount : MAX_LAYERS;
+    for (uint32_t i = 0; i < layerCount; ++i) {
+        const XrCompositionLayerBaseHeader* base = info.layers[i];
+        FrameCaptureLayer& layer = layers[i];
+        layer = {};
+        layer.type = (uint32_t)base->type;
+        layer.flags = (uint32_t)base->layerFlags;
+        layer.space = spaceId(base->space);
+        layer.pose = {{0, 0, 0, 1}, {0, 0, 0}};
+        switch (base->type) {
+            case XR_TYPE_COMPOSITION_LAYER_QUAD: {
+                auto* quad = reinterpret_cast<const XrCompositionLayerQuad*>(base);
+                layer.eyeVisibility = quad->eyeVisibility;
+                layer.pose = quad->pose;
+                layer.params[0] = quad->size.width;
+                layer.params[1] = quad->size.height;
+                layer.subImage = subImage(quad->subImage);
+                break;
+            }
+            case XR_TYPE_COMPOSITION_LAYER_CYLINDER_KHR: {
+                auto* cylinder = reinterpret_cast<const XrCompositionLayerCylinderKHR*>(base);
+                layer.eyeVisibility = cylinder->eyeVisibility;
+                layer.pose = cylinder->pose;
+                layer.params[0] = cylinder->radius;
+                layer.params[1] = cylinder->centralAngle;
+                layer.params[2] = cylinder->aspectRatio;
+                layer.subImage = subImage(cylinder->subImage);
+                break;
+            }
+            case XR_TYPE_COMPOSITION_LAYER_PROJECTION: {
+                auto* projection = reinterpret_cast<const XrCompositionLayerProjection*>(base);
+                layer.viewCount = projection->viewCount < MAX_VIEWS ? projection->viewCount : MAX_VIEWS;
+                for (uint32_t v = 0; v < layer.viewCount; ++v) {
+                    views[i][v].pose = projection->views[v].pose;
+                    views[i][v].fov = projection->views[v].fov;
+                    views[i][v].subImage = subImage(projection->views[v].subImage);
+                }
+                break;
+            }
+            default:
+                // Other layer types keep only their type, flags and space
+                break;
+        }
+    }
+
+    FrameCaptureFrame frame = {};
+    frame.frame = frames;
+    frame.layerCount = layerCount;
+    frame.displayTime = info.displayTime;
+    frame.displayPeriodNs = state.predictedDisplayPeriod;
+    frame.waitReturnNs = waitReturnNs;
+    frame.endCallNs = endCallNs;
+    frame.endReturnNs = endReturnNs;
+    frame.blendMode = (uint32_t)info.environmentBlendMode;
+    frame.shouldRender = state.shouldRender ? 1 : 0;
+    frame.endResult = (int32_t)endResult;
+
+    uint32_t size = sizeof(frame);
+    for (uint32_t i = 0; i < layerCount; ++i) size += sizeof(FrameCaptureLayer) + layers[i].viewCount * sizeof(FrameCaptureView);
+    FrameCaptureRecordHeader header = {(uint32_t)FrameCaptureTag::Frame, size};
+    fwrite(&header, sizeof(header), 1, file);
+    fwrite(&frame, sizeof(frame), 1, file);
+    for (uint32_t i = 0; i < layerCount; ++i) {
+        fwrite(&layers[i], sizeof(FrameCaptureLayer), 1, file);
+        if (layers[i].viewCount) fwrite(views[i], sizeof(FrameCaptureView), layers[i].viewCount, file);
+    }
+
+    if (++frames >= maxFrames) stop();
+}
+
+uint64_t frameCaptureHashFramebuffer(int32_t width, int32_t height) {
+    static std::vector<uint8_t> pixels;
+    pixels.resize((size_t)width * height * 4);
+    glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+    uint64_t hash = 14695981039346656037ull;
+    for (uint8_t byte : pixels) hash = (hash ^ byte) * 1099511628211ull;
+    return hash;
+}
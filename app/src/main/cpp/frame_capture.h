@@ -0,0 +1,165 @@
+#ifndef ANDROIDSAMSUNG_FRAME_CAPTURE_H
+#define ANDROIDSAMSUNG_FRAME_CAPTURE_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "xr_dispatch.h"
+
+// Records what each frame submitted to xrEndFrame, so a layer stack seen in the field can be
+// replayed offline (tools/frame_replay) against a runtime or a stand-in.
+//
+// The file is a header followed by tagged records. Swapchains and spaces are written once,
+// when first registered or referenced, and get small ids; each frame record then lists the
+// layers with their type, flags, space, pose, size, subImage (swapchain id, rect, array
+// index, content hash) and, for projection layers, every view, plus the frame's timings.
+// Everything is written in the producer's byte order with fixed-size little structs, so a
+// reader can map the records directly.
+//
+// Content hashes are whatever the app last passed to setContentHash() for a swapchain (see
+// frameCaptureHashFramebuffer()); hashing reads pixels back, so only do it while capturing.
+// Frame thread only. Writing goes through a large stdio buffer; the file is complete after
+// stop() or once `maxFrames` frames are in.
+
+static const uint32_t FRAME_CAPTURE_MAGIC = 0x43454658; // "XFEC"
+static const uint32_t FRAME_CAPTURE_VERSION = 1;
+
+enum class FrameCaptureTag : uint32_t {
+    Swapchain = 1, // FrameCaptureSwapchain
+    Space = 2,     // FrameCaptureSpace
+    Frame = 3,     // FrameCaptureFrame, then layerCount x (FrameCaptureLayer, viewCount x FrameCaptureView)
+};
+
+struct FrameCaptureFileHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t headerSize;
+    uint32_t reserved;
+};
+
+struct FrameCaptureRecordHeader {
+    uint32_t tag;  // FrameCaptureTag
+    uint32_t size; // payload bytes after this header
+};
+
+struct FrameCaptureSwapchain {
+    uint32_t id;
+    uint32_t width, height;
+    uint32_t arraySize, faceCount, mipCount, sampleCount;
+    uint32_t reserved;
+    int64_t format;
+    uint64_t usageFlags;
+};
+
+struct FrameCaptureSpace {
+    uint32_t id;
+    uint32_t referenceSpaceType; // XrReferenceSpaceType; 0 if the app did not register it
+    XrPosef poseInReferenceSpace;
+};
+
+struct FrameCaptureFrame {
+    uint32_t frame;
+    uint32_t layerCount;
+    int64_t displayTime;       // XrFrameEndInfo::displayTime, runtime clock
+    int64_t displayPeriodNs;   // XrFrameState::predictedDisplayPeriod
+    int64_t waitReturnNs;      // monotonic times of the frame's calls
+    int64_t endCallNs;
+    int64_t endReturnNs;
+    uint32_t blendMode;
+    uint32_t shouldRender;
+    int32_t endResult;
+    uint32_t reserved;
+};
+
+struct FrameCaptureSubImage {
+    uint32_t swapchain; // FrameCaptureSwapchain::id
+    uint32_t arrayIndex;
+    XrRect2Di rect;
+    uint64_t contentHash;
+};
+
+struct FrameCaptureLayer {
+    uint32_t type;       // XrStructureType of the layer
+    uint32_t flags;      // XrCompositionLayerFlags
+    uint32_t space;      // FrameCaptureSpace::id
+    uint32_t eyeVisibility;
+    uint32_t viewCount;  // projection layers only
+    uint32_t reserved;
+    XrPosef pose;
+    float params[4];     // quad: width, height; cylinder: radius, central angle, aspect ratio
+    FrameCaptureSubImage subImage;
+};
+
+struct FrameCaptureView {
+    XrPosef pose;
+    XrFovf fov;
+    FrameCaptureSubImage subImage;
+};
+
+class FrameCapture {
+public:
+    static constexpr uint32_t MAX_SWAPCHAINS = 32;
+    static constexpr uint32_t MAX_SPACES = 32;
+    static constexpr uint32_t MAX_LAYERS = 16; // per frame; layers past this are not captured
+    static constexpr uint32_t MAX_VIEWS = 2;   // per projection layer
+
+    ~FrameCapture() { stop(); }
+
+    bool start(const char* path, uint32_t maxFrames);
+    void stop();
+    bool active() const { return file != nullptr; }
+    uint32_t framesWritten() const { return frames; }
+
+    // Optional descriptions; unregistered handles are still captured, with their size or
+    // reference space unknown
+    void addSwapchain(XrSwapchain swapchain, const XrSwapchainCreateInfo& info);
+    void addSpace(XrSpace space, XrReferenceSpaceType type, const XrPosef& poseInReferenceSpace);
+
+    // Drops the registered handles, e.g. when the session they belong to is destroyed. Ids
+    // are never reused within a capture.
+    void forgetHandles();
+
+    void setContentHash(XrSwapchain swapchain, uint64_t hash);
+
+    // Call after xrEndFrame; no-op unless active
+    void record(const XrFrameEndInfo& info, const XrFrameState& state, int64_t waitReturnNs,
+                int64_t endCallNs, int64_t endReturnNs, XrResult endResult);
+
+private:
+    struct SwapchainEntry {
+        XrSwapchain handle;
+        uint32_t id;
+        XrSwapchainCreateInfo info;
+        uint64_t hash;
+        bool known;
+    };
+    struct SpaceEntry {
+        XrSpace handle;
+        uint32_t id;
+        XrReferenceSpaceType type;
+        XrPosef pose;
+    };
+
+    SwapchainEntry* findSwapchain(XrSwapchain swapchain, bool add);
+    SpaceEntry* findSpace(XrSpace space, bool add);
+    uint32_t swapchainId(XrSwapchain swapchain);
+    uint32_t spaceId(XrSpace space);
+    FrameCaptureSubImage subImage(const XrSwapchainSubImage& image);
+    void writeRecord(FrameCaptureTag tag, const void* payload, uint32_t size);
+
+    FILE* file = nullptr;
+    char* buffer = nullptr;
+    uint32_t maxFrames = 0;
+    uint32_t frames = 0;
+    SwapchainEntry swapchains[MAX_SWAPCHAINS] = {};
+    uint32_t swapchainCount = 0;
+    SpaceEntry spaces[MAX_SPACES] = {};
+    uint32_t spaceCount = 0;
+    uint32_t nextId = 1; // 0 means "none"
+};
+
+// FNV-1a over the pixels of the bound read framebuffer, read back as RGBA8. Slow (a full
+// readback) and allocates its staging buffer on first use; meant for capture mode only.
+uint64_t frameCaptureHashFramebuffer(int32_t width, int32_t height);
+
+#endif //ANDROIDSAMSUNG_FRAME_CAPTURE_H
@@ -0,0 +1,115 @@
+#include "frame_stats.h"
+#include "monotonic_clock.h"
+
+#define LOG_TAG "FrameStats"
+#include "log.h"
+
+static const int64_t NS_PER_SECOND = 1000000000;
+
+void FrameStats::onWaitFrame(const XrFrameState& frameState, int64_t nowNs) {
+    int64_t previousWaitNs = lastWaitNs.load(std::memory_order_relaxed);
+    if (previousWaitNs != 0) {
+        total.record(nowNs - previousWaitNs);
+    } else {
+        firstWaitNs.store(nowNs, std::memory_order_relaxed);
+    }
+    lastWaitNs.store(nowNs, std::memory_order_relaxed);
+    frames.fetch_add(1, std::memory_order_relaxed);
+
+    int64_t period = frameState.predictedDisplayPeriod;
+    periodNs.store(period, std::memory_order_relaxed);
+    if (lastPredicted != 0 && period > 0) {
+        int64_t gap = frameState.predictedDisplayTime - lastPredicted;
+        if (gap < period / 2) {
+            repeated.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            // Round to the nearest whole number of periods so jitter is not counted as a drop
+            int64_t periods = (gap + period / 2) / period;
+            if (periods > 1) countDrops((uint32_t)(periods - 1), nowNs);
+        }
+    }
+    lastPredicted = frameState.predictedDisplayTime;
+}
+
+void FrameStats::onEndFrame(int64_t waitReturnNs, int64_t nowNs) {
+    cpu.record(nowNs - waitReturnNs);
+}
+
+void FrameStats::countDrops(uint32_t count, int64_t nowNs) {
+    dropped.fetch_add(count, std::memory_order_relaxed);
+    int64_t second = nowNs / NS_PER_SECOND;
+    int slot = (int)(second % 60);
+    if (dropSecond[slot].load(std::memory_order_relaxed) != second) {
+        dropsBySecond[slot].store(0, std::memory_order_relaxed);
+        dropSecond[slot].store(second, std::memory_order_relaxed);
+    }
+    dropsBySecond[slot].fetch_add(count, std::memory_order_relaxed);
+}
+
+static FrameStats::Percentiles percentiles(const LogHistogram& histogram) {
+    FrameStats::Percentiles result;
+    result.count = histogram.count();
+    result.p50Ms = histogram.percentile(0.50) / 1e6;
+    result.p90Ms = histogram.percentile(0.90) / 1e6;
+    result.p99Ms = histogram.percentile(0.99) / 1e6;
+    result.p999Ms = histogram.percentile(0.999) / 1e6;
+    result.maxMs = histogram.max() / 1e6;
+    return result;
+}
+
+FrameStats::Summary FrameStats::summary() const {
+    Summary result;
+    result.frames = frames.load(std::memory_order_relaxed);
+    result.dropped = dropped.load(std::memory_order_relaxed);
+    result.repeated = repeated.load(std::memory_order_relaxed);
+    result.displayPeriodMs = periodNs.load(std::memory_order_relaxed) / 1e6;
+
+    int64_t nowSecond = monotonicNowNs() / NS_PER_SECOND;
+    result.droppedLastMinute = 0;
+    for (int slot = 0; slot < 60; ++slot) {
+        if (nowSecond - dropSecond[slot].load(std::memory_order_relaxed) < 60) {
+            result.droppedLastMinute += dropsBySecond[slot].load(std::memory_order_relaxed);
+        }
+    }
+
+    double minutes = (lastWaitNs.load(std::memory_order_relaxed) - firstWaitNs.load(std::memory_order_relaxed)) / 60e9;
+    result.droppedPerMinute = minutes > 0 ? result.dropped / minutes : 0.0;
+
+    result.total = percentiles(total);
+    result.cpu = percentiles(cpu);
+    result.gpu = percentiles(gpu);
+    return result;
+}
+
+static void logPercentiles(const char* label, const char* name, const FrameStats::Percentiles& p) {
+    if (p.count == 0) return;
+    LOGI("%s %-5s p50 %6.2f  p90 %6.2f  p99 %6.2f  p99.9 %6.2f  max %6.2f ms (%llu samples)",
+         label, name, p.p50Ms, p.p90Ms, p.p99Ms, p.p999Ms, p.maxMs, (unsigned long long)p.count);
+}
+
+void FrameStats::report(const char* label) const {
+    Summary s = summary();
+    LOGI("%s: %llu frames at %.2f ms, %llu dropped (%.1f/min, %u in the last minute), %llu repeated",
+         label, (unsigned long long)s.frames, s.displayPeriodMs, (unsigned long long)s.dropped,
+         s.droppedPerMinute, s.droppedLastMinute, (unsigned long long)s.repeated);
+    logPercentiles(label, "total", s.total);
+    logPercentiles(label, "cpu", s.cpu);
+    logPercentiles(label, "gpu", s.gpu);
+}
+
+void FrameStats::reset() {
+    total.reset();
+    cpu.reset();
+    gpu.reset();
+    frames = 0;
+    dropped = 0;
+    repeated = 0;
+    periodNs = 0;
+    firstWaitNs = 0;
+    lastWaitNs = 0;
+    lastPredicted = 0;
+    for (int slot = 0; slot < 60; ++slot) {
+        dropsBySecond[slot] = 0;
+        dropSecond[slot] = 0;
+    }
+}
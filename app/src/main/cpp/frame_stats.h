@@ -0,0 +1,72 @@
+#ifndef ANDROIDSAMSUNG_FRAME_STATS_H
+#define ANDROIDSAMSUNG_FRAME_STATS_H
+
+#include <stdint.h>
+#include <atomic>
+
+#include "log_histogram.h"
+#include "xr_dispatch.h"
+
+// Per-session frame statistics.
+//
+// onWaitFrame() compares each predictedDisplayTime with the previous one: a gap of n display
+// periods means n - 1 frames were dropped, and a gap under half a period means the runtime
+// handed out the same slot again (a repeated frame). Total frame time is the interval
+// between consecutive xrWaitFrame returns, CPU time is from xrWaitFrame returning to
+// xrEndFrame returning, and GPU time comes from GpuTimer. Each goes into a LogHistogram.
+//
+// Recording happens on the frame thread; summary() may be called from any thread.
+class FrameStats {
+public:
+    struct Percentiles {
+        uint64_t count;
+        double p50Ms, p90Ms, p99Ms, p999Ms, maxMs;
+    };
+
+    struct Summary {
+        uint64_t frames;
+        uint64_t dropped;
+        uint64_t repeated;
+        uint32_t droppedLastMinute;
+        double droppedPerMinute; // over the whole session
+        double displayPeriodMs;
+        Percentiles total, cpu, gpu;
+    };
+
+    // Call right after xrWaitFrame returns
+    void onWaitFrame(const XrFrameState& frameState, int64_t nowNs);
+    // Call right after xrEndFrame returns, with the time xrWaitFrame returned
+    void onEndFrame(int64_t waitReturnNs, int64_t nowNs);
+    void onGpuTime(int64_t gpuNs) { gpu.record(gpuNs); }
+
+    Summary summary() const;
+    uint64_t droppedFrames() const { return dropped.load(std::memory_order_relaxed); }
+
+    // Logs the summary under `label`
+    void report(const char* label) const;
+
+    // Starts over, e.g. for a new session
+    void reset();
+
+    const LogHistogram& totalHistogram() const { return total; }
+    const LogHistogram& cpuHistogram() const { return cpu; }
+    const LogHistogram& gpuHistogram() const { return gpu; }
+
+private:
+    void countDrops(uint32_t frames, int64_t nowNs);
+
+    LogHistogram total, cpu, gpu;
+    std::atomic<uint64_t> frames{0};
+    std::atomic<uint64_t> dropped{0};
+    std::atomic<uint64_t> repeated{0};
+    std::atomic<int64_t> periodNs{0};
+    std::atomic<int64_t> firstWaitNs{0};
+    std::atomic<int64_t> lastWaitNs{0};
+    XrTime lastPredicted = 0;
+
+    // Drops per second over the last minute, indexed by second % 60 and stamped with the second
+    std::atomic<uint32_t> dropsBySecond[60] = {};
+    std::atomic<int64_t> dropSecond[60] = {};
+};
+
+#endif //ANDROIDSAMSUNG_FRAME_STATS_H
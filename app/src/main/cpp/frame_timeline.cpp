@@ -0,0 +1,69 @@
+#include "frame_timeline.h"
+#include "xr_clock.h"
+
+#include <stdio.h>
+
+#define LOG_TAG "FrameTimeline"
+#include "log.h"
+
+static const char* const PHASE_NAMES[] = {
+        "xrWaitFrame", "xrBeginFrame", "xrAcquireSwapchainImage", "xrWaitSwapchainImage",
+        "xrLocateViews", "render", "xrReleaseSwapchainImage", "xrEndFrame", "predictedDisplay",
+        "xrPollEvent", "buildLayers",
+};
+static_assert(sizeof(PHASE_NAMES) / sizeof(PHASE_NAMES[0]) == (size_t)FramePhase::Count, "one name per phase");
+
+const char* framePhaseName(FramePhase phase) {
+    return phase < FramePhase::Count ? PHASE_NAMES[(int)phase] : "unknown";
+}
+
+static uint32_t roundUpPow2(uint32_t value) {
+    uint32_t result = 1;
+    while (result < value) result <<= 1;
+    return result;
+}
+
+FrameTimeline::FrameTimeline(uint32_t capacity)
+        : records(roundUpPow2(capacity < 2 ? 2 : capacity)), mask(records.size() - 1) {}
+
+void FrameTimeline::recordFrameState(const XrFrameState& frameState) {
+    int64_t displayNs = xrTimeToMonotonicNs(frameState.predictedDisplayTime);
+    record(FramePhase::Display, displayNs, displayNs);
+    records[(written - 1) & mask].shouldRender = frameState.shouldRender ? 1 : 0;
+}
+
+const FrameTimelineRecord& FrameTimeline::at(uint64_t i) const {
+    uint64_t first = written - size();
+    return records[(first + i) & mask];
+}
+
+bool FrameTimeline::exportChromeTrace(const char* path) const {
+    FILE* file = fopen(path, "w");
+    if (!file) {
+        LOGE("Cannot open %s for the frame timeline", path);
+        return false;
+    }
+
+    // Phases go on the frame thread's track, display markers on their own
+    fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    fprintf(file, "{\"ph\":\"M\",\"pid\":1,\"tid\":1,\"name\":\"thread_name\",\"args\":{\"name\":\"frame loop\"}},\n");
+    fprintf(file, "{\"ph\":\"M\",\"pid\":1,\"tid\":2,\"name\":\"thread_name\",\"args\":{\"name\":\"display\"}}");
+    uint64_t count = size();
+    for (uint64_t i = 0; i < count; ++i) {
+        const FrameTimelineRecord& r = at(i);
+        const char* name = framePhaseName((FramePhase)r.phase);
+        if (r.phase == (uint8_t)FramePhase::Display) {
+            fprintf(file, ",\n{\"ph\":\"i\",\"s\":\"t\",\"pid\":1,\"tid\":2,\"name\":\"%s\",\"ts\":%.3f,"
+                          "\"args\":{\"frame\":%u,\"shouldRender\":%s}}",
+                    name, r.startNs / 1e3, r.frame, r.shouldRender ? "true" : "false");
+        } else {
+            fprintf(file, ",\n{\"ph\":\"X\",\"pid\":1,\"tid\":1,\"name\":\"%s\",\"ts\":%.3f,\"dur\":%.3f,"
+                          "\"args\":{\"frame\":%u,\"swapchain\":%u}}",
+                    name, r.startNs / 1e3, (r.endNs - r.startNs) / 1e3, r.frame, r.swapchain);
+        }
+    }
+    fprintf(file, "\n]}\n");
+    bool ok = fclose(file) == 0;
+    LOGI("Wrote %llu timeline records to %s", (unsigned long long)count, path);
+    return ok;
+}
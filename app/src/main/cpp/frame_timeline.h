@@ -0,0 +1,120 @@
+#ifndef ANDROIDSAMSUNG_FRAME_TIMELINE_H
+#define ANDROIDSAMSUNG_FRAME_TIMELINE_H
+
+#include <stdint.h>
+#include <vector>
+
+#include "monotonic_clock.h"
+#include "xr_dispatch.h"
+
+// Phases of one OpenXR frame as the frame loops see them. New phases go at the end, before
+// Count.
+enum class FramePhase : uint8_t {
+    Wait,         // xrWaitFrame
+    Begin,        // xrBeginFrame
+    Acquire,      // xrAcquireSwapchainImage
+    WaitImage,    // xrWaitSwapchainImage
+    LocateViews,  // xrLocateViews
+    Render,       // GL draw submission
+    Release,      // xrReleaseSwapchainImage
+    End,          // xrEndFrame
+    Display,      // marker: predicted display time and shouldRender from xrWaitFrame
+    Poll,         // xrPollEvent until the queue is empty, before the frame starts
+    BuildLayers,  // filling in the XrCompositionLayer* structs for xrEndFrame
+    Count
+};
+
+// Name used in traces and reports, e.g. "xrWaitFrame"
+const char* framePhaseName(FramePhase phase);
+
+// One entry of the ring. Times are monotonicNowNs(); for Display, startNs is the
+// predicted display time converted through xr_clock and endNs equals it.
+struct FrameTimelineRecord {
+    int64_t startNs;
+    int64_t endNs;
+    uint32_t frame;
+    uint8_t phase;       // FramePhase
+    uint8_t swapchain;   // which swapchain, for per-swapchain phases
+    uint8_t shouldRender;
+    uint8_t reserved;
+};
+
+// Records the phases of every frame into a fixed ring of FrameTimelineRecord, overwriting
+// the oldest once full. Recording is two clock reads and a store, so it stays on in all
+// builds. The ring can be written out on demand as Chrome trace JSON (loads in
+// chrome://tracing and ui.perfetto.dev).
+//
+// Single-threaded: record from the frame thread and export from it too.
+//
+//     timeline.beginFrame();
+//     { FramePhaseScope scope(timeline, FramePhase::Wait); xr.WaitFrame(...); }
+class FrameTimeline {
+public:
+    static constexpr uint32_t DEFAULT_CAPACITY = 8192;
+
+    // capacity is rounded up to a power of two; allocated here, never on the frame path
+    FrameTimeline() : FrameTimeline(DEFAULT_CAPACITY) {}
+    explicit FrameTimeline(uint32_t capacity);
+
+    // Starts the next frame; later records are tagged with its index
+    void beginFrame() { frame++; }
+    uint32_t currentFrame() const { return frame; }
+
+    void record(FramePhase phase, int64_t startNs, int64_t endNs, uint32_t swapchain = 0) {
+        FrameTimelineRecord& r = records[written & mask];
+        r.startNs = startNs;
+        r.endNs = endNs;
+        r.frame = frame;
+        r.phase = (uint8_t)phase;
+        r.swapchain = (uint8_t)swapchain;
+        r.shouldRender = 0;
+        r.reserved = 0;
+        written++;
+    }
+
+    // Adds the Display marker for the current frame from xrWaitFrame's output
+    void recordFrameState(const XrFrameState& frameState);
+
+    // Calls fn(record) for each record of `frame` still in the ring, newest first. Stops at
+    // the first record of another frame, so it is cheap for the current frame.
+    template <typename Fn>
+    void forEachInFrame(uint32_t frameIndex, Fn&& fn) const {
+        for (uint64_t i = written; i > 0 && written - i < records.size(); --i) {
+            const FrameTimelineRecord& r = records[(i - 1) & mask];
+            if (r.frame != frameIndex) break;
+            fn(r);
+        }
+    }
+
+    // Records currently held, oldest first
+    uint64_t size() const { return written < records.size() ? written : records.size(); }
+
+    bool exportChromeTrace(const char* path) const;
+
+private:
+    const FrameTimelineRecord& at(uint64_t i) const;
+
+    std::vector<FrameTimelineRecord> records;
+    uint64_t mask;
+    uint64_t written = 0;
+    uint32_t frame = 0;
+};
+
+// Times its own lifetime as one phase of the current frame
+class FramePhaseScope {
+public:
+    FramePhaseScope(FrameTimeline& timeline, FramePhase phase, uint32_t swapchain = 0)
+            : timeline(timeline), phase(phase), swapchain(swapchain), startNs(monotonicNowNs()) {}
+    ~FramePhaseScope() { timeline.record(phase, startNs, monotonicNowNs(), swapchain); }
+
+    FramePhaseScope(const FramePhaseScope&) = delete;
+    FramePhaseScope& operator=(const FramePhaseScope&) = delete;
+
+private:
+    FrameTimeline& timeline;
+    FramePhase phase;
+    uint32_t swapchain;
+    int64_t startNs;
+};
+
+#endif //ANDROIDSAMSUNG_FRAME_TIMELINE_H
@@ -0,0 +1,344 @@
+#define XR_GL_CAPTURE_NO_MACROS
+#include "gl_capture.h"
+
+#if XR_GL_CAPTURE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+#include "alloc_guard.h"
+
+#define LOG_TAG "GlCapture"
+#include "log.h"
+
+bool glCaptureRecording = false;
+
+namespace {
+
+struct TextureDescription {
+    GLuint name;
+    GlCaptureTexture texture;
+};
+
+FILE* file = nullptr;
+uint32_t framesLeft = 0;
+uint32_t frameIndex = 0;
+bool armed = false;
+
+// Commands of the frame being recorded; written out as one Frame record at the boundary
+std::vector<uint32_t> commands;
+uint32_t commandCount = 0;
+
+// Objects already written to this capture
+std::vector<GLuint> buffers, vertexArrays, programs, renderbuffers, textures, framebuffers;
+
+std::vector<TextureDescription> textureDescriptions;
+GlCaptureSurface surface = {0, 0};
+
+bool seen(std::vector<GLuint>& names, GLuint name) {
+    for (GLuint n : names) {
+        if (n == name) return true;
+    }
+    names.push_back(name);
+    return false;
+}
+
+void writeRecord(GlCaptureTag tag, const std::vector<uint32_t>& payload) {
+    GlCaptureRecordHeader header = {(uint32_t)tag, (uint32_t)(payload.size() * sizeof(uint32_t))};
+    fwrite(&header, sizeof(header), 1, file);
+    if (!payload.empty()) fwrite(payload.data(), sizeof(uint32_t), payload.size(), file);
+}
+
+template <typename T>
+void append(std::vector<uint32_t>& out, const T& value) {
+    static_assert(sizeof(T) % sizeof(uint32_t) == 0, "records are made of 32-bit words");
+    size_t at = out.size();
+    out.resize(at + sizeof(T) / sizeof(uint32_t));
+    memcpy(out.data() + at, &value, sizeof(T));
+}
+
+void appendBytes(std::vector<uint32_t>& out, const void* data, size_t size) {
+    size_t at = out.size();
+    out.resize(at + (size + 3) / 4, 0);
+    memcpy(out.data() + at, data, size);
+}
+
+void writeFrame() {
+    GlCaptureFrame frame = {frameIndex++, commandCount};
+    GlCaptureRecordHeader header = {(uint32_t)GlCaptureTag::Frame,
+                                    (uint32_t)(sizeof(frame) + commands.size() * sizeof(uint32_t))};
+    fwrite(&header, sizeof(header), 1, file);
+    fwrite(&frame, sizeof(frame), 1, file);
+    if (!commands.empty()) fwrite(commands.data(), sizeof(uint32_t), commands.size(), file);
+    commands.clear();
+    commandCount = 0;
+}
+
+} // namespace
+
+// --- Control ---
+
+bool glCaptureStart(const char* path, uint32_t frames) {
+    glCaptureStop();
+    file = fopen(path, "wb");
+    if (!file) {
+        LOGE("Cannot open %s for the GL capture", path);
+        return false;
+    }
+    GlCaptureFileHeader header = {GL_CAPTURE_MAGIC, GL_CAPTURE_VERSION, sizeof(GlCaptureFileHeader), 0};
+    fwrite(&header, sizeof(header), 1, file);
+    std::vector<uint32_t> payload;
+    append(payload, surface);
+    writeRecord(GlCaptureTag::Surface, payload);
+
+    for (auto* names : {&buffers, &vertexArrays, &programs, &renderbuffers, &textures, &framebuffers}) names->clear();
+    framesLeft = frames;
+    frameIndex = 0;
+    armed = frames > 0;
+    LOGI("Capturing the GL calls of the next %u frames to %s", frames, path);
+    return true;
+}
+
+void glCaptureStop() {
+    if (!file) return;
+    if (glCaptureRecording) writeFrame();
+    fclose(file);
+    file = nullptr;
+    glCaptureRecording = false;
+    armed = false;
+    LOGI("GL capture finished: %u frames", frameIndex);
+}
+
+bool glCaptureActive() {
+    return file != nullptr;
+}
+
+void glCaptureFrame() {
+    if (!file) return;
+    if (glCaptureRecording) {
+        writeFrame();
+        if (--framesLeft == 0) {
+            glCaptureRecording = false;
+            glCaptureStop();
+            return;
+        }
+    } else if (armed) {
+        armed = false;
+        glCaptureRecording = true;
+        commands.reserve(4096);
+    }
+    // Snapshots and the command list allocate; keep the frames after a capture in warm-up
+    allocGuardReset();
+}
+
+void glCaptureDescribeTexture(GLuint texture, GLenum target, GLenum internalFormat, uint32_t width, uint32_t height, uint32_t layers) {
+    GlCaptureTexture description = {texture, target, internalFormat, width, height, layers};
+    for (TextureDescription& entry : textureDescriptions) {
+        if (entry.name == texture) {
+            entry.texture = description;
+            return;
+        }
+    }
+    textureDescriptions.push_back({texture, description});
+}
+
+void glCaptureDescribeDefaultFramebuffer(uint32_t width, uint32_t height) {
+    surface = {width, height};
+}
+
+// --- Commands ---
+
+void glCaptureRecord(GlCaptureOp op, const void* args, uint32_t size) {
+    GlCaptureCommand command = {(uint16_t)op, (uint16_t)size};
+    append(commands, command);
+    if (size) appendBytes(commands, args, size);
+    ++commandCount;
+}
+
+void glCaptureUniformLocation(GLuint program, GLint location, const GLchar* name) {
+    std::vector<uint32_t> args = {program, (uint32_t)location};
+    appendBytes(args, name, strlen(name) + 1);
+    glCaptureRecord(GlCaptureOp::GetUniformLocation, args.data(), (uint32_t)(args.size() * sizeof(uint32_t)));
+}
+
+// --- Snapshots ---
+// Each runs before the call that references the object, restores every binding it touches,
+// and writes the object's record ahead of the frame that uses it.
+
+static void snapshotBuffer(GLuint buffer) {
+    if (buffer == 0 || seen(buffers, buffer)) return;
+    GLint previous = 0, size = 0, usage = GL_STATIC_DRAW;
+    glGetIntegerv(GL_COPY_READ_BUFFER_BINDING, &previous);
+    glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+    glGetBufferParameteriv(GL_COPY_READ_BUFFER, GL_BUFFER_SIZE, &size);
+    glGetBufferParameteriv(GL_COPY_READ_BUFFER, GL_BUFFER_USAGE, &usage);
+
+    std::vector<uint32_t> payload;
+    GlCaptureBuffer record = {buffer, (uint32_t)usage, (uint32_t)size};
+    append(payload, record);
+    const void* data = size > 0 ? glMapBufferRange(GL_COPY_READ_BUFFER, 0, size, GL_MAP_READ_BIT) : nullptr;
+    if (data) {
+        appendBytes(payload, data, (size_t)size);
+        glUnmapBuffer(GL_COPY_READ_BUFFER);
+    } else {
+        if (size > 0) LOGW("Cannot read back buffer %u; it replays as zeros", buffer);
+        payload.resize(payload.size() + ((size_t)size + 3) / 4, 0);
+    }
+    glBindBuffer(GL_COPY_READ_BUFFER, (GLuint)previous);
+    writeRecord(GlCaptureTag::Buffer, payload);
+}
+
+void glCaptureUseVertexArray(GLuint array) {
+    if (array == 0 || seen(vertexArrays, array)) return;
+    GLint previous = 0, maxAttribs = 0, elementBuffer = 0;
+    glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &previous);
+    glGetIntegerv(GL_MAX_VERTEX_ATTRIBS, &maxAttribs);
+    glBindVertexArray(array);
+    glGetIntegerv(GL_ELEMENT_ARRAY_BUFFER_BINDING, &elementBuffer);
+
+    std::vector<GlCaptureAttrib> attribs;
+    for (GLint i = 0; i < maxAttribs; ++i) {
+        GLint enabled = 0;
+        glGetVertexAttribiv((GLuint)i, GL_VERTEX_ATTRIB_ARRAY_ENABLED, &enabled);
+        if (!enabled) continue;
+        GlCaptureAttrib attrib = {};
+        GLint value = 0;
+        void* pointer = nullptr;
+        attrib.index = (uint32_t)i;
+        glGetVertexAttribiv((GLuint)i, GL_VERTEX_ATTRIB_ARRAY_BUFFER_BINDING, &value);
+        attrib.buffer = (uint32_t)value;
+        glGetVertexAttribiv((GLuint)i, GL_VERTEX_ATTRIB_ARRAY_SIZE, &attrib.size);
+        glGetVertexAttribiv((GLuint)i, GL_VERTEX_ATTRIB_ARRAY_TYPE, &value);
+        attrib.type = (uint32_t)value;
+        glGetVertexAttribiv((GLuint)i, GL_VERTEX_ATTRIB_ARRAY_NORMALIZED, &value);
+        attrib.normalized = (uint32_t)value;
+        glGetVertexAttribiv((GLuint)i, GL_VERTEX_ATTRIB_ARRAY_STRIDE, &attrib.stride);
+        glGetVertexAttribiv((GLuint)i, GL_VERTEX_ATTRIB_ARRAY_INTEGER, &value);
+        attrib.integer = (uint32_t)value;
+        glGetVertexAttribPointerv((GLuint)i, GL_VERTEX_ATTRIB_ARRAY_POINTER, &pointer);
+        attrib.offset = (uint32_t)(uintptr_t)pointer;
+        attribs.push_back(attrib);
+    }
+    glBindVertexArray((GLuint)previous);
+
+    snapshotBuffer((GLuint)elementBuffer);
+    for (const GlCaptureAttrib& attrib : attribs) snapshotBuffer(attrib.buffer);
+
+    std::vector<uint32_t> payload;
+    GlCaptureVertexArray record = {array, (uint32_t)elementBuffer, (uint32_t)attribs.size()};
+    append(payload, record);
+    for (const GlCaptureAttrib& attrib : attribs) append(payload, attrib);
+    writeRecord(GlCaptureTag::VertexArray, payload);
+}
+
+void glCaptureUseProgram(GLuint program) {
+    if (program == 0 || seen(programs, program)) return;
+    GLuint shaders[4];
+    GLsizei shaderCount = 0;
+    glGetAttachedShaders(program, 4, &shaderCount, shaders);
+
+    std::vector<uint32_t> payload;
+    GlCaptureProgram record = {program, (uint32_t)shaderCount, 0};
+    append(payload, record);
+    for (GLsizei i = 0; i < shaderCount; ++i) {
+        GLint type = 0, length = 0;
+        glGetShaderiv(shaders[i], GL_SHADER_TYPE, &type);
+        glGetShaderiv(shaders[i], GL_SHADER_SOURCE_LENGTH, &length);
+        std::vector<char> source((size_t)length + 1, '\0');
+        if (length > 0) glGetShaderSource(shaders[i], length, nullptr, source.data());
+        uint32_t sourceLength = (uint32_t)strlen(source.data());
+        GlCaptureShader shader = {(uint32_t)type, (sourceLength + 3) & ~3u};
+        append(payload, shader);
+        appendBytes(payload, source.data(), sourceLength);
+    }
+
+    // Float uniforms set before the capture; the replay sets them again after linking
+    GLint uniformCount = 0;
+    glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &uniformCount);
+    uint32_t captured = 0;
+    for (GLint i = 0; i < uniformCount; ++i) {
+        GlCaptureUniform uniform = {};
+        GLint arraySize = 0;
+        GLenum type = 0;
+        glGetActiveUniform(program, (GLuint)i, sizeof(uniform.name), nullptr, &arraySize, &type, uniform.name);
+        if (type != GL_FLOAT && type != GL_FLOAT_VEC2 && type != GL_FLOAT_VEC3 && type != GL_FLOAT_VEC4 && type != GL_FLOAT_MAT4) continue;
+        GLint location = glGetUniformLocation(program, uniform.name);
+        if (location < 0) continue;
+        uniform.type = type;
+        glGetUniformfv(program, location, uniform.value);
+        append(payload, uniform);
+        ++captured;
+    }
+    reinterpret_cast<GlCaptureProgram*>(payload.data())->uniformCount = captured;
+    writeRecord(GlCaptureTag::Program, payload);
+}
+
+void glCaptureUseRenderbuffer(GLuint renderbuffer) {
+    if (renderbuffer == 0 || seen(renderbuffers, renderbuffer)) return;
+    GLint previous = 0, format = 0, width = 0, height = 0, samples = 0;
+    glGetIntegerv(GL_RENDERBUFFER_BINDING, &previous);
+    glBindRenderbuffer(GL_RENDERBUFFER, renderbuffer);
+    glGetRenderbufferParameteriv(GL_RENDERBUFFER, GL_RENDERBUFFER_INTERNAL_FORMAT, &format);
+    glGetRenderbufferParameteriv(GL_RENDERBUFFER, GL_RENDERBUFFER_WIDTH, &width);
+    glGetRenderbufferParameteriv(GL_RENDERBUFFER, GL_RENDERBUFFER_HEIGHT, &height);
+    glGetRenderbufferParameteriv(GL_RENDERBUFFER, GL_RENDERBUFFER_SAMPLES, &samples);
+    glBindRenderbuffer(GL_RENDERBUFFER, (GLuint)previous);
+
+    std::vector<uint32_t> payload;
+    GlCaptureRenderbuffer record = {renderbuffer, (uint32_t)format, (uint32_t)width, (uint32_t)height, (uint32_t)samples};
+    append(payload, record);
+    writeRecord(GlCaptureTag::Renderbuffer, payload);
+}
+
+void glCaptureUseTexture(GLuint texture) {
+    if (texture == 0 || seen(textures, texture)) return;
+    GlCaptureTexture record = {texture, GL_TEXTURE_2D, GL_RGBA8, 0, 0, 1};
+    bool described = false;
+    for (const TextureDescription& entry : textureDescriptions) {
+        if (entry.name == texture) {
+            record = entry.texture;
+            described = true;
+        }
+    }
+    if (!described) LOGW("Texture %u was never described; the replay guesses its size", texture);
+    std::vector<uint32_t> payload;
+    append(payload, record);
+    writeRecord(GlCaptureTag::Texture, payload);
+}
+
+static GlCaptureAttachment snapshotAttachment(GLenum attachment) {
+    GlCaptureAttachment result = {};
+    GLint value = GL_NONE;
+    glGetFramebufferAttachmentParameteriv(GL_FRAMEBUFFER, attachment, GL_FRAMEBUFFER_ATTACHMENT_OBJECT_TYPE, &value);
+    result.objectType = (uint32_t)value;
+    if (value == GL_NONE) return result;
+    glGetFramebufferAttachmentParameteriv(GL_FRAMEBUFFER, attachment, GL_FRAMEBUFFER_ATTACHMENT_OBJECT_NAME, &value);
+    result.object = (uint32_t)value;
+    if (result.objectType == GL_TEXTURE) {
+        glGetFramebufferAttachmentParameteriv(GL_FRAMEBUFFER, attachment, GL_FRAMEBUFFER_ATTACHMENT_TEXTURE_LEVEL, &value);
+        result.level = (uint32_t)value;
+        glGetFramebufferAttachmentParameteriv(GL_FRAMEBUFFER, attachment, GL_FRAMEBUFFER_ATTACHMENT_TEXTURE_LAYER, &value);
+        result.layer = (uint32_t)value;
+    }
+    return result;
+}
+
+void glCaptureUseFramebuffer(GLuint framebuffer) {
+    if (framebuffer == 0 || seen(framebuffers, framebuffer)) return;
+    GLint previous = 0;
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previous);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    GlCaptureFramebuffer record = {framebuffer, 0, snapshotAttachment(GL_COLOR_ATTACHMENT0), snapshotAttachment(GL_DEPTH_ATTACHMENT)};
+    glBindFramebuffer(GL_FRAMEBUFFER, (GLuint)previous);
+
+    for (const GlCaptureAttachment* attachment : {&record.color, &record.depth}) {
+        if (attachment->objectType == GL_TEXTURE) glCaptureUseTexture(attachment->object);
+        if (attachment->objectType == GL_RENDERBUFFER) glCaptureUseRenderbuffer(attachment->object);
+    }
+    std::vector<uint32_t> payload;
+    append(payload, record);
+    writeRecord(GlCaptureTag::Framebuffer, payload);
+}
+
+#endif
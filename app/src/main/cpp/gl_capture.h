@@ -0,0 +1,374 @@
+#ifndef ANDROIDSAMSUNG_GL_CAPTURE_H
+#define ANDROIDSAMSUNG_GL_CAPTURE_H
+
+#include <GLES3/gl3.h>
+#include <stdint.h>
+#include <string.h>
+
+// Records the GL calls of a few frames, with the data they reference, so the render work can
+// be replayed and timed elsewhere (tools/gl_replay) without the app, the runtime or a headset.
+//
+// Translation units that include this header have the GL calls the frame path makes replaced
+// by the inline glc* wrappers below. Outside a capture a wrapper costs one branch. While
+// capturing, each call is appended to the frame's command list, and the first reference to
+// a program, vertex array, framebuffer, renderbuffer or texture snapshots that object. Buffer
+// contents, shader sources, uniform values and attachments are read back from GL at that
+// point. Textures and the default framebuffer cannot be queried in GLES 3.0, so their owners
+// describe them up front (glCaptureDescribeTexture, glCaptureDescribeDefaultFramebuffer);
+// a replay stands in blank storage of that size for them.
+//
+// The file is a header followed by tagged records like FrameCapture's: object snapshots,
+// each written before the first frame that uses it, then one Frame record per frame holding
+// its commands. Frame thread only, like GL itself.
+//
+// XR_GL_CAPTURE defaults to 1 in debug builds and 0 with NDEBUG. At 0 no call is wrapped and
+// every function below is an inline no-op. Define XR_GL_CAPTURE_NO_MACROS before including
+// this header to get the file format without the wrappers (the recorder and the replayer).
+
+#ifndef XR_GL_CAPTURE
+#ifdef NDEBUG
+#define XR_GL_CAPTURE 0
+#else
+#define XR_GL_CAPTURE 1
+#endif
+#endif
+
+// --- File format ---
+
+static const uint32_t GL_CAPTURE_MAGIC = 0x434c4758; // "XGLC"
+static const uint32_t GL_CAPTURE_VERSION = 1;
+
+enum class GlCaptureTag : uint32_t {
+    Surface = 1,      // GlCaptureSurface
+    Buffer = 2,       // GlCaptureBuffer, then `size` bytes of contents
+    VertexArray = 3,  // GlCaptureVertexArray, then attribCount x GlCaptureAttrib
+    Program = 4,      // GlCaptureProgram, then shaderCount x (GlCaptureShader, source), uniformCount x GlCaptureUniform
+    Renderbuffer = 5, // GlCaptureRenderbuffer
+    Texture = 6,      // GlCaptureTexture
+    Framebuffer = 7,  // GlCaptureFramebuffer
+    Frame = 8,        // GlCaptureFrame, then commandCount commands
+};
+
+struct GlCaptureFileHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t headerSize;
+    uint32_t reserved;
+};
+
+struct GlCaptureRecordHeader {
+    uint32_t tag;  // GlCaptureTag
+    uint32_t size; // payload bytes after this header, a multiple of 4
+};
+
+// Size of framebuffer 0; 0x0 if the app never described it
+struct GlCaptureSurface {
+    uint32_t width, height;
+};
+
+struct GlCaptureBuffer {
+    uint32_t name;
+    uint32_t usage;
+    uint32_t size;
+};
+
+struct GlCaptureAttrib {
+    uint32_t index;
+    uint32_t buffer;
+    int32_t size;
+    uint32_t type;
+    uint32_t normalized;
+    int32_t stride;
+    uint32_t offset;
+    uint32_t integer;
+};
+
+struct GlCaptureVertexArray {
+    uint32_t name;
+    uint32_t elementBuffer;
+    uint32_t attribCount; // enabled attributes only
+};
+
+struct GlCaptureProgram {
+    uint32_t name;
+    uint32_t shaderCount;
+    uint32_t uniformCount;
+};
+
+struct GlCaptureShader {
+    uint32_t type;   // GL_VERTEX_SHADER or GL_FRAGMENT_SHADER
+    uint32_t length; // source bytes that follow, padded to 4
+};
+
+// Value of a float uniform at snapshot time, found again by name on replay
+struct GlCaptureUniform {
+    char name[56];
+    uint32_t type; // GL_FLOAT, GL_FLOAT_VEC2..4 or GL_FLOAT_MAT4
+    uint32_t reserved;
+    float value[16];
+};
+
+struct GlCaptureRenderbuffer {
+    uint32_t name;
+    uint32_t internalFormat;
+    uint32_t width, height;
+    uint32_t samples;
+};
+
+struct GlCaptureTexture {
+    uint32_t name;
+    uint32_t target; // GL_TEXTURE_2D or GL_TEXTURE_2D_ARRAY
+    uint32_t internalFormat;
+    uint32_t width, height, layers; // 0x0 if the owner never described it
+};
+
+struct GlCaptureAttachment {
+    uint32_t objectType; // GL_NONE, GL_TEXTURE or GL_RENDERBUFFER
+    uint32_t object;
+    uint32_t level;
+    uint32_t layer;
+};
+
+struct GlCaptureFramebuffer {
+    uint32_t name;
+    uint32_t reserved;
+    GlCaptureAttachment color, depth;
+};
+
+struct GlCaptureFrame {
+    uint32_t frame;
+    uint32_t commandCount;
+};
+
+// Commands: a GlCaptureCommand, then `size` bytes of arguments as 32-bit words (floats
+// bit-copied), in the order the GL function takes them
+enum class GlCaptureOp : uint16_t {
+    Viewport = 1,                // x, y, width, height
+    Scissor,                     // x, y, width, height
+    ClearColor,                  // r, g, b, a
+    Clear,                       // mask
+    Enable,                      // cap
+    Disable,                     // cap
+    DepthFunc,                   // func
+    DepthMask,                   // flag
+    BlendFunc,                   // sfactor, dfactor
+    BindFramebuffer,             // target, framebuffer
+    FramebufferTexture2D,        // target, attachment, textarget, texture, level
+    FramebufferTextureLayer,     // target, attachment, texture, level, layer
+    FramebufferRenderbuffer,     // target, attachment, renderbuffertarget, renderbuffer
+    BindVertexArray,             // array
+    UseProgram,                  // program
+    GetUniformLocation,          // program, result, then the name, NUL-padded to 4
+    UniformMatrix4fv,            // location, count, transpose, then count x 16 floats
+    Uniform3f,                   // location, x, y, z
+    Uniform1f,                   // location, x
+    DrawElements,                // mode, count, type, offset
+    Flush,
+    Finish,
+};
+
+struct GlCaptureCommand {
+    uint16_t op;   // GlCaptureOp
+    uint16_t size; // argument bytes after this header
+};
+
+// --- Control ---
+
+#if XR_GL_CAPTURE
+
+// Arms a capture of the next `frames` frames into `path`; it begins at the next
+// glCaptureFrame(). False if the file cannot be created.
+bool glCaptureStart(const char* path, uint32_t frames);
+void glCaptureStop();
+bool glCaptureActive();
+
+// Frame boundary: call once at the top of every rendered frame. Ends the frame being
+// recorded, if any, and starts recording an armed capture.
+void glCaptureFrame();
+
+// Storage the app did not create through glTexStorage* (e.g. swapchain images), and the
+// size of framebuffer 0. Remembered across captures.
+void glCaptureDescribeTexture(GLuint texture, GLenum target, GLenum internalFormat, uint32_t width, uint32_t height, uint32_t layers);
+void glCaptureDescribeDefaultFramebuffer(uint32_t width, uint32_t height);
+
+// --- Wrappers ---
+
+extern bool glCaptureRecording;
+
+void glCaptureRecord(GlCaptureOp op, const void* args, uint32_t size);
+void glCaptureUseFramebuffer(GLuint framebuffer);
+void glCaptureUseVertexArray(GLuint array);
+void glCaptureUseProgram(GLuint program);
+void glCaptureUseTexture(GLuint texture);
+void glCaptureUseRenderbuffer(GLuint renderbuffer);
+void glCaptureUniformLocation(GLuint program, GLint location, const GLchar* name);
+
+inline uint32_t glCaptureWord(uint32_t v) { return v; }
+inline uint32_t glCaptureWord(int32_t v) { return (uint32_t)v; }
+inline uint32_t glCaptureWord(uint8_t v) { return v; }
+inline uint32_t glCaptureWord(float v) {
+    uint32_t word;
+    memcpy(&word, &v, sizeof(word));
+    return word;
+}
+
+template <typename... Args>
+inline void glCaptureArgs(GlCaptureOp op, Args... args) {
+    const uint32_t words[] = {glCaptureWord(args)...};
+    glCaptureRecord(op, words, sizeof(words));
+}
+
+inline void glcViewport(GLint x, GLint y, GLsizei width, GLsizei height) {
+    if (glCaptureRecording) glCaptureArgs(GlCaptureOp::Viewport, x, y, width, height);
+    glViewport(x, y, width, height);
+}
+inline void glcScissor(GLint x, GLint y, GLsizei width, GLsizei height) {
+    if (glCaptureRecording) glCaptureArgs(GlCaptureOp::Scissor, x, y, width, height);
+    glScissor(x, y, width, height);
+}
+inline void glcClearColor(GLfloat r, GLfloat g, GLfloat b, GLfloat a) {
+    if (glCaptureRecording) glCaptureArgs(GlCaptureOp::ClearColor, r, g, b, a);
+    glClearColor(r, g, b, a);
+}
+inline void glcClear(GLbitfield mask) {
+    if (glCaptureRecording) glCaptureArgs(GlCaptureOp::Clear, mask);
+    glClear(mask);
+}
+inline void glcEnable(GLenum cap) {
+    if (glCaptureRecording) glCaptureArgs(GlCaptureOp::Enable, cap);
+    glEnable(cap);
+}
+inline void glcDisable(GLenum cap) {
+    if (glCaptureRecording) glCaptureArgs(GlCaptureOp::Disable, cap);
+    glDisable(cap);
+}
+inline void glcDepthFunc(GLenum func) {
+    if (glCaptureRecording) glCaptureArgs(GlCaptureOp::DepthFunc, func);
+    glDepthFunc(func);
+}
+inline void glcDepthMask(GLboolean flag) {
+    if (glCaptureRecording) glCaptureArgs(GlCaptureOp::DepthMask, flag);
+    glDepthMask(flag);
+}
+inline void glcBlendFunc(GLenum sfactor, GLenum dfactor) {
+    if (glCaptureRecording) glCaptureArgs(GlCaptureOp::BlendFunc, sfactor, dfactor);
+    glBlendFunc(sfactor, dfactor);
+}
+inline void glcBindFramebuffer(GLenum target, GLuint framebuffer) {
+    if (glCaptureRecording) {
+        glCaptureUseFramebuffer(framebuffer);
+        glCaptureArgs(GlCaptureOp::BindFramebuffer, target, framebuffer);
+    }
+    glBindFramebuffer(target, framebuffer);
+}
+inline void glcFramebufferTexture2D(GLenum target, GLenum attachment, GLenum textarget, GLuint texture, GLint level) {
+    if (glCaptureRecording) {
+        glCaptureUseTexture(texture);
+        glCaptureArgs(GlCaptureOp::FramebufferTexture2D, target, attachment, textarget, texture, level);
+    }
+    glFramebufferTexture2D(target, attachment, textarget, texture, level);
+}
+inline void glcFramebufferTextureLayer(GLenum target, GLenum attachment, GLuint texture, GLint level, GLint layer) {
+    if (glCaptureRecording) {
+        glCaptureUseTexture(texture);
+        glCaptureArgs(GlCaptureOp::FramebufferTextureLayer, target, attachment, texture, level, layer);
+    }
+    glFramebufferTextureLayer(target, attachment, texture, level, layer);
+}
+inline void glcFramebufferRenderbuffer(GLenum target, GLenum attachment, GLenum renderbuffertarget, GLuint renderbuffer) {
+    if (glCaptureRecording) {
+        glCaptureUseRenderbuffer(renderbuffer);
+        glCaptureArgs(GlCaptureOp::FramebufferRenderbuffer, target, attachment, renderbuffertarget, renderbuffer);
+    }
+    glFramebufferRenderbuffer(target, attachment, renderbuffertarget, renderbuffer);
+}
+inline void glcBindVertexArray(GLuint array) {
+    if (glCaptureRecording) {
+        glCaptureUseVertexArray(array);
+        glCaptureArgs(GlCaptureOp::BindVertexArray, array);
+    }
+    glBindVertexArray(array);
+}
+inline void glcUseProgram(GLuint program) {
+    if (glCaptureRecording) {
+        glCaptureUseProgram(program);
+        glCaptureArgs(GlCaptureOp::UseProgram, program);
+    }
+    glUseProgram(program);
+}
+inline GLint glcGetUniformLocation(GLuint program, const GLchar* name) {
+    GLint location = glGetUniformLocation(program, name);
+    if (glCaptureRecording) glCaptureUniformLocation(program, location, name);
+    return location;
+}
+inline void glcUniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value) {
+    if (glCaptureRecording) {
+        uint32_t args[3 + 16 * 4];
+        if (count >= 1 && count <= 4) {
+            args[0] = glCaptureWord(location);
+            args[1] = glCaptureWord(count);
+            args[2] = glCaptureWord(transpose);
+            memcpy(args + 3, value, sizeof(float) * 16 * count);
+            glCaptureRecord(GlCaptureOp::UniformMatrix4fv, args, sizeof(uint32_t) * (3 + 16 * count));
+        }
+    }
+    glUniformMatrix4fv(location, count, transpose, value);
+}
+inline void glcUniform3f(GLint location, GLfloat x, GLfloat y, GLfloat z) {
+    if (glCaptureRecording) glCaptureArgs(GlCaptureOp::Uniform3f, location, x, y, z);
+    glUniform3f(location, x, y, z);
+}
+inline void glcUniform1f(GLint location, GLfloat x) {
+    if (glCaptureRecording) glCaptureArgs(GlCaptureOp::Uniform1f, location, x);
+    glUniform1f(location, x);
+}
+inline void glcDrawElements(GLenum mode, GLsizei count, GLenum type, const void* indices) {
+    if (glCaptureRecording) glCaptureArgs(GlCaptureOp::DrawElements, mode, count, type, (uint32_t)(uintptr_t)indices);
+    glDrawElements(mode, count, type, indices);
+}
+inline void glcFlush() {
+    if (glCaptureRecording) glCaptureRecord(GlCaptureOp::Flush, nullptr, 0);
+    glFlush();
+}
+inline void glcFinish() {
+    if (glCaptureRecording) glCaptureRecord(GlCaptureOp::Finish, nullptr, 0);
+    glFinish();
+}
+
+#if !defined(XR_GL_CAPTURE_NO_MACROS)
+#define glViewport glcViewport
+#define glScissor glcScissor
+#define glClearColor glcClearColor
+#define glClear glcClear
+#define glEnable glcEnable
+#define glDisable glcDisable
+#define glDepthFunc glcDepthFunc
+#define glDepthMask glcDepthMask
+#define glBlendFunc glcBlendFunc
+#define glBindFramebuffer glcBindFramebuffer
+#define glFramebufferTexture2D glcFramebufferTexture2D
+#define glFramebufferTextureLayer glcFramebufferTextureLayer
+#define glFramebufferRenderbuffer glcFramebufferRenderbuffer
+#define glBindVertexArray glcBindVertexArray
+#define glUseProgram glcUseProgram
+#define glGetUniformLocation glcGetUniformLocation
+#define glUniformMatrix4fv glcUniformMatrix4fv
+#define glUniform3f glcUniform3f
+#define glUniform1f glcUniform1f
+#define glDrawElements glcDrawElements
+#define glFlush glcFlush
+#define glFinish glcFinish
+#endif
+
+#else
+
+inline bool glCaptureStart(const char*, uint32_t) { return false; }
+inline void glCaptureStop() {}
+inline bool glCaptureActive() { return false; }
+inline void glCaptureFrame() {}
+inline void glCaptureDescribeTexture(GLuint, GLenum, GLenum, uint32_t, uint32_t, uint32_t) {}
+inline void glCaptureDescribeDefaultFramebuffer(uint32_t, uint32_t) {}
+
+#endif
+
+#endif //ANDROIDSAMSUNG_GL_CAPTURE_H
@@ -0,0 +1,62 @@
+#include "gpu_timer.h"
+
+#include <string.h>
+#include <EGL/egl.h>
+
+#define LOG_TAG "GpuTimer"
+#include "log.h"
+
+bool GpuTimer::init() {
+    const char* extensions = (const char*)glGetString(GL_EXTENSIONS);
+    if (!extensions || !strstr(extensions, "GL_EXT_disjoint_timer_query")) {
+        LOGI("GL_EXT_disjoint_timer_query unavailable; GPU frame time will not be measured");
+        return false;
+    }
+    getResult = (PFNGLGETQUERYOBJECTUI64VEXTPROC)eglGetProcAddress("glGetQueryObjectui64vEXT");
+    if (!getResult) return false;
+
+    glGenQueries(QUERY_LATENCY, queries);
+    issued = retired = 0;
+    inSpan = false;
+    // Reading the flag clears it, so earlier disjoint events do not discard the first spans
+    GLint disjoint = 0;
+    glGetIntegerv(GL_GPU_DISJOINT_EXT, &disjoint);
+    return true;
+}
+
+void GpuTimer::destroy() {
+    if (!available()) return;
+    glDeleteQueries(QUERY_LATENCY, queries);
+    getResult = nullptr;
+}
+
+void GpuTimer::begin() {
+    // With every query still in flight this frame goes unmeasured rather than waiting
+    if (!available() || inSpan || issued - retired == QUERY_LATENCY) return;
+    glBeginQuery(GL_TIME_ELAPSED_EXT, queries[issued % QUERY_LATENCY]);
+    inSpan = true;
+}
+
+void GpuTimer::end() {
+    if (!inSpan) return;
+    glEndQuery(GL_TIME_ELAPSED_EXT);
+    issued++;
+    inSpan = false;
+}
+
+bool GpuTimer::poll(int64_t* gpuNs) {
+    if (!available() || retired == issued) return false;
+    GLuint query = queries[retired % QUERY_LATENCY];
+    GLuint ready = 0;
+    glGetQueryObjectuiv(query, GL_QUERY_RESULT_AVAILABLE, &ready);
+    if (!ready) return false;
+
+    GLint disjoint = 0;
+    glGetIntegerv(GL_GPU_DISJOINT_EXT, &disjoint);
+    GLuint64 elapsed = 0;
+    getResult(query, GL_QUERY_RESULT, &elapsed);
+    retired++;
+    if (disjoint) return false;
+    *gpuNs = (int64_t)elapsed;
+    return true;
+}
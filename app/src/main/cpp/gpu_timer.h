@@ -0,0 +1,38 @@
+#ifndef ANDROIDSAMSUNG_GPU_TIMER_H
+#define ANDROIDSAMSUNG_GPU_TIMER_H
+
+#include <stdint.h>
+#include <GLES3/gl3.h>
+#include <GLES2/gl2ext.h>
+
+// GPU time of one span per frame through GL_EXT_disjoint_timer_query.
+//
+// begin()/end() bracket the frame's GL work with a GL_TIME_ELAPSED_EXT query. Results are
+// read QUERY_LATENCY frames later, when the GPU has long finished, so nothing stalls.
+// Spans that overlap a disjoint event (frequency change, preemption) are discarded.
+// Without the extension every call is a no-op and poll() never returns a value.
+class GpuTimer {
+public:
+    static constexpr uint32_t QUERY_LATENCY = 4;
+
+    // Needs a current GL context; returns false if the extension is missing
+    bool init();
+    void destroy();
+
+    bool available() const { return getResult != nullptr; }
+
+    void begin();
+    void end();
+
+    // Oldest finished span, if any. Call once per frame, after end().
+    bool poll(int64_t* gpuNs);
+
+private:
+    GLuint queries[QUERY_LATENCY] = {};
+    uint32_t issued = 0;
+    uint32_t retired = 0;
+    bool inSpan = false;
+    PFNGLGETQUERYOBJECTUI64VEXTPROC getResult = nullptr;
+};
+
+#endif //ANDROIDSAMSUNG_GPU_TIMER_H
@@ -0,0 +1,209 @@
+#include "knob_console.h"
+#include "knobs.h"
+#include "profiler.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stddef.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#define LOG_TAG "KnobConsole"
+#include "log.h"
+
+// Longest request line accepted; longer ones are answered with an error and dropped
+static const size_t MAX_LINE = 512;
+
+#if defined(__ANDROID__)
+// adbd runs as the shell user, so `adb forward` connections arrive from it
+static const uid_t SHELL_UID = 2000;
+#endif
+
+// Anyone on the device can connect to an abstract socket; only let our own user in
+static bool peerAllowed(int fd) {
+    ucred credentials = {};
+    socklen_t length = sizeof(credentials);
+    if (getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &credentials, &length) != 0) return false;
+#if defined(__ANDROID__)
+    if (credentials.uid == SHELL_UID) return true;
+#endif
+    return credentials.uid == getuid();
+}
+
+void KnobConsole::addCommand(const char* name, const char* help, Command command) {
+    commands.push_back({name, help, std::move(command)});
+}
+
+bool KnobConsole::start(const char* socketName) {
+    stop();
+#if !XR_KNOB_CONSOLE
+    LOGI("Tuning console is not built in (XR_KNOB_CONSOLE=0); not listening on %s", socketName);
+    return false;
+#endif
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    size_t nameLength = strlen(socketName);
+    if (nameLength == 0 || nameLength >= sizeof(address.sun_path)) {
+        LOGE("Console socket name '%s' is empty or too long", socketName);
+        return false;
+    }
+    memcpy(address.sun_path, socketName, nameLength);
+    bool abstract = socketName[0] == '@';
+    if (abstract) {
+        address.sun_path[0] = '\0';
+    } else {
+        path = socketName;
+        unlink(socketName);
+    }
+    socklen_t addressLength = (socklen_t)(offsetof(sockaddr_un, sun_path) + nameLength + (abstract ? 0 : 1));
+
+    listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listenFd < 0 || bind(listenFd, (const sockaddr*)&address, addressLength) != 0 || listen(listenFd, 1) != 0 ||
+        pipe2(wakeFd, O_CLOEXEC) != 0) {
+        LOGE("Cannot listen on %s: %s", socketName, strerror(errno));
+        stop();
+        return false;
+    }
+
+    thread = std::thread([this] { serve(); });
+    LOGI("Tuning console listening on %s (%d knobs)", socketName, knobCount());
+    return true;
+}
+
+void KnobConsole::stop() {
+    if (thread.joinable()) {
+        char wake = 1;
+        (void)!write(wakeFd[1], &wake, 1);
+        thread.join();
+    }
+    if (listenFd >= 0) close(listenFd);
+    if (wakeFd[0] >= 0) close(wakeFd[0]);
+    if (wakeFd[1] >= 0) close(wakeFd[1]);
+    listenFd = wakeFd[0] = wakeFd[1] = -1;
+    if (!path.empty()) unlink(path.c_str());
+    path.clear();
+}
+
+static bool writeAll(int fd, const std::string& text) {
+    size_t written = 0;
+    while (written < text.size()) {
+        ssize_t n = send(fd, text.data() + written, text.size() - written, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        written += (size_t)n;
+    }
+    return true;
+}
+
+void KnobConsole::serve() {
+    profilerSetThreadName("knob-console");
+    int client = -1;
+    std::string pending;
+    while (true) {
+        pollfd fds[2] = {{wakeFd[0], POLLIN, 0}, {client >= 0 ? client : listenFd, POLLIN, 0}};
+        if (poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        if (fds[0].revents) break;
+        if (!fds[1].revents) continue;
+
+        if (client < 0) {
+            client = accept4(listenFd, nullptr, nullptr, SOCK_CLOEXEC);
+            if (client >= 0 && !peerAllowed(client)) {
+                LOGW("Rejected a console connection from another user");
+                close(client);
+                client = -1;
+            }
+            pending.clear();
+            continue;
+        }
+
+        char buffer[256];
+        ssize_t n = recv(client, buffer, sizeof(buffer), 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) {
+            close(client);
+            client = -1;
+            continue;
+        }
+        pending.append(buffer, (size_t)n);
+
+        size_t newline;
+        bool connected = true;
+        while (connected && (newline = pending.find('\n')) != std::string::npos) {
+            std::string line = pending.substr(0, newline);
+            pending.erase(0, newline + 1);
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            if (line.empty()) continue;
+            connected = writeAll(client, handle(line));
+        }
+        if (connected && pending.size() > MAX_LINE) {
+            pending.clear();
+            connected = writeAll(client, "error line too long\n");
+        }
+        if (!connected) {
+            close(client);
+            client = -1;
+        }
+    }
+    if (client >= 0) close(client);
+}
+
+// --- Commands ---
+
+static std::string describe(const KnobBase& knob) {
+    char value[64], range[128];
+    knob.format(value, sizeof(value));
+    knob.formatRange(range, sizeof(range));
+    return std::string(knob.name()) + " = " + value + "  " + range + "  " + knob.help() + "\n";
+}
+
+std::string KnobConsole::handle(const std::string& line) {
+    size_t split = line.find(' ');
+    std::string verb = line.substr(0, split);
+    std::string args;
+    size_t argsStart = split == std::string::npos ? std::string::npos : line.find_first_not_of(' ', split);
+    if (argsStart != std::string::npos) args = line.substr(argsStart);
+
+    if (verb == "help") {
+        std::string reply = "list | get <knob> | set <knob> <value> | reset <knob>\n";
+        for (const Entry& entry : commands) reply += entry.name + "  " + entry.help + "\n";
+        return reply + "ok\n";
+    }
+    if (verb == "list") {
+        std::string reply;
+        for (int i = 0; i < knobCount(); ++i) reply += describe(*knobAt(i));
+        return reply + "ok\n";
+    }
+    if (verb == "get" || verb == "set" || verb == "reset") {
+        size_t nameEnd = args.find(' ');
+        std::string name = args.substr(0, nameEnd);
+        KnobBase* knob = findKnob(name.c_str());
+        if (!knob) return "error no knob '" + name + "'\n";
+        if (verb == "set") {
+            std::string value = nameEnd == std::string::npos ? std::string() : args.substr(nameEnd + 1);
+            if (!knob->set(value.c_str())) {
+                char range[128];
+                knob->formatRange(range, sizeof(range));
+                return "error '" + value + "' is not a valid value for " + name + " " + range + "\n";
+            }
+            LOGI("%s set to %s", name.c_str(), value.c_str());
+        } else if (verb == "reset") {
+            knob->reset();
+        }
+        char value[64];
+        knob->format(value, sizeof(value));
+        return "ok " + name + " = " + value + "\n";
+    }
+    for (const Entry& entry : commands) {
+        if (entry.name == verb) {
+            std::string reply = entry.command(args);
+            return reply + "ok\n";
+        }
+    }
+    return "error unknown command '" + verb + "' (try help)\n";
+}
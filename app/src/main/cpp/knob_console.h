@@ -0,0 +1,63 @@
+#ifndef ANDROIDSAMSUNG_KNOB_CONSOLE_H
+#define ANDROIDSAMSUNG_KNOB_CONSOLE_H
+
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Line-based tuning console on a local Unix-domain socket, served from a background thread.
+//
+//     list                  every knob with its value, range and help
+//     get <knob>            current value
+//     set <knob> <value>    range-checked; the frame loop sees it on its next read
+//     reset <knob>          back to the default
+//     <command> [args]      anything added with addCommand(), e.g. "capture"
+//
+// Each reply is one or more lines, the last starting with "ok" or "error". A name starting
+// with '@' is in the abstract namespace, which on Android is reachable from a desktop with
+// `adb forward tcp:5555 localabstract:<name>` and then `nc localhost 5555`; anything else is
+// a filesystem path. One client at a time, and only from the app's own user (or, on Android,
+// the shell user that adb forwards as); other peers are disconnected.
+//
+// XR_KNOB_CONSOLE defaults to 1 in debug builds and 0 with NDEBUG, like XR_PROFILER. At 0,
+// start() opens no socket and returns false.
+
+#ifndef XR_KNOB_CONSOLE
+#ifdef NDEBUG
+#define XR_KNOB_CONSOLE 0
+#else
+#define XR_KNOB_CONSOLE 1
+#endif
+#endif
+
+class KnobConsole {
+public:
+    // Runs on the console thread; returns the reply text (without the trailing "ok")
+    using Command = std::function<std::string(const std::string& args)>;
+
+    ~KnobConsole() { stop(); }
+
+    // Call before start()
+    void addCommand(const char* name, const char* help, Command command);
+
+    bool start(const char* socketName);
+    void stop();
+
+private:
+    struct Entry {
+        std::string name, help;
+        Command command;
+    };
+
+    void serve();
+    std::string handle(const std::string& line);
+
+    std::vector<Entry> commands;
+    int listenFd = -1;
+    int wakeFd[2] = {-1, -1};
+    std::thread thread;
+    std::string path; // filesystem socket to unlink on stop
+};
+
+#endif //ANDROIDSAMSUNG_KNOB_CONSOLE_H
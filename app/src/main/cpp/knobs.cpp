@@ -0,0 +1,108 @@
+#include "knobs.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define LOG_TAG "Knobs"
+#include "log.h"
+
+// Constant-initialised, so knobs constructed during static initialisation can register in
+// any order. Registration happens before the console thread starts; later reads need no lock.
+static KnobBase* knobs[MAX_KNOBS];
+static int registered = 0;
+
+KnobBase::KnobBase(const char* name, const char* help, KnobType type)
+        : knobName(name), knobHelp(help), knobType(type) {
+    if (registered < MAX_KNOBS) {
+        knobs[registered++] = this;
+    } else {
+        LOGE("Too many knobs; %s is not tunable", name);
+    }
+}
+
+KnobBase* findKnob(const char* name) {
+    for (int i = 0; i < registered; ++i) {
+        if (strcmp(knobs[i]->name(), name) == 0) return knobs[i];
+    }
+    return nullptr;
+}
+
+int knobCount() {
+    return registered;
+}
+
+KnobBase* knobAt(int index) {
+    return index >= 0 && index < registered ? knobs[index] : nullptr;
+}
+
+// --- Typed knobs ---
+
+template <typename T>
+static constexpr KnobType knobTypeOf();
+template <> constexpr KnobType knobTypeOf<bool>() { return KnobType::Bool; }
+template <> constexpr KnobType knobTypeOf<int32_t>() { return KnobType::Int; }
+template <> constexpr KnobType knobTypeOf<float>() { return KnobType::Float; }
+
+template <typename T>
+Knob<T>::Knob(const char* name, T defaultValue, T minValue, T maxValue, const char* help)
+        : KnobBase(name, help, knobTypeOf<T>()), value(defaultValue), defaultValue(defaultValue),
+          minValue(minValue), maxValue(maxValue) {}
+
+static void formatValue(char* out, size_t size, bool v) { snprintf(out, size, "%s", v ? "true" : "false"); }
+static void formatValue(char* out, size_t size, int32_t v) { snprintf(out, size, "%d", v); }
+static void formatValue(char* out, size_t size, float v) { snprintf(out, size, "%g", v); }
+
+static bool parseValue(const char* text, bool* out) {
+    if (strcmp(text, "1") == 0 || strcmp(text, "true") == 0 || strcmp(text, "on") == 0) {
+        *out = true;
+    } else if (strcmp(text, "0") == 0 || strcmp(text, "false") == 0 || strcmp(text, "off") == 0) {
+        *out = false;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+static bool parseValue(const char* text, int32_t* out) {
+    char* end;
+    errno = 0;
+    long v = strtol(text, &end, 0);
+    if (end == text || *end != '\0' || errno != 0 || v < INT32_MIN || v > INT32_MAX) return false;
+    *out = (int32_t)v;
+    return true;
+}
+
+static bool parseValue(const char* text, float* out) {
+    char* end;
+    errno = 0;
+    float v = strtof(text, &end);
+    if (end == text || *end != '\0' || errno != 0 || v != v) return false;
+    *out = v;
+    return true;
+}
+
+template <typename T>
+void Knob<T>::format(char* out, size_t size) const {
+    formatValue(out, size, get());
+}
+
+template <typename T>
+void Knob<T>::formatRange(char* out, size_t size) const {
+    char low[32], high[32], initial[32];
+    formatValue(low, sizeof(low), minValue);
+    formatValue(high, sizeof(high), maxValue);
+    formatValue(initial, sizeof(initial), defaultValue);
+    snprintf(out, size, "[%s, %s] default %s", low, high, initial);
+}
+
+template <typename T>
+bool Knob<T>::set(const char* text) {
+    T v;
+    return parseValue(text, &v) && setValue(v);
+}
+
+template class Knob<bool>;
+template class Knob<int32_t>;
+template class Knob<float>;
@@ -0,0 +1,80 @@
+#ifndef ANDROIDSAMSUNG_KNOBS_H
+#define ANDROIDSAMSUNG_KNOBS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+
+// Runtime-tunable parameters ("knobs") for performance work.
+//
+// A knob is a typed, range-checked value with a name, declared as a global next to the code
+// that reads it. The frame loop reads it with get(), a relaxed atomic load; the tuning
+// console (knob_console.h) sets it from its own thread through the registry. Every knob
+// registers itself on construction, so declaring one is all it takes to make it tunable.
+//
+//     Knob<float> renderScale("render.scale", 1.0f, 0.25f, 1.0f, "fraction of the recommended eye size");
+//     ...
+//     float scale = renderScale.get();
+
+enum class KnobType : uint8_t { Bool, Int, Float };
+
+class KnobBase {
+public:
+    KnobBase(const char* name, const char* help, KnobType type);
+    virtual ~KnobBase() = default;
+    KnobBase(const KnobBase&) = delete;
+    KnobBase& operator=(const KnobBase&) = delete;
+
+    const char* name() const { return knobName; }
+    const char* help() const { return knobHelp; }
+    KnobType type() const { return knobType; }
+
+    // Text forms used by the console. set() rejects values that do not parse or are out of range.
+    virtual void format(char* out, size_t size) const = 0;
+    virtual void formatRange(char* out, size_t size) const = 0;
+    virtual bool set(const char* text) = 0;
+    virtual void reset() = 0;
+
+private:
+    const char* knobName;
+    const char* knobHelp;
+    KnobType knobType;
+};
+
+template <typename T>
+class Knob : public KnobBase {
+public:
+    Knob(const char* name, T defaultValue, T minValue, T maxValue, const char* help);
+
+    T get() const { return value.load(std::memory_order_relaxed); }
+    // False and unchanged if `v` is outside [min, max]
+    bool setValue(T v) {
+        if (v < minValue || v > maxValue) return false;
+        value.store(v, std::memory_order_relaxed);
+        return true;
+    }
+
+    void format(char* out, size_t size) const override;
+    void formatRange(char* out, size_t size) const override;
+    bool set(const char* text) override;
+    void reset() override { value.store(defaultValue, std::memory_order_relaxed); }
+
+private:
+    std::atomic<T> value;
+    T defaultValue, minValue, maxValue;
+};
+
+extern template class Knob<bool>;
+extern template class Knob<int32_t>;
+extern template class Knob<float>;
+
+// --- Registry ---
+
+static constexpr int MAX_KNOBS = 64;
+
+// nullptr if there is no knob called `name`
+KnobBase* findKnob(const char* name);
+int knobCount();
+KnobBase* knobAt(int index);
+
+#endif //ANDROIDSAMSUNG_KNOBS_H
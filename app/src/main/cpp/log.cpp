@@ -0,0 +1,113 @@
+#include "log.h"
+#include "monotonic_clock.h"
+#include "thread_ring_registry.h"
+
+#include <chrono>
+#include <mutex>
+
+#if defined(__ANDROID__)
+#include <android/log.h>
+#endif
+
+// One captured message. Tag and format are string literals, so only their pointers are kept.
+struct LogRecord {
+    int64_t timestampNs;
+    const char* tag;
+    const char* format;
+    LogFormatter formatter;
+    uint8_t level;
+    uint8_t argBytes;
+    uint8_t args[LOG_ARG_BYTES];
+};
+
+// Messages each thread can have in flight before new ones are dropped
+static const size_t LOG_RING_CAPACITY = 256;
+
+// How often the background thread looks for new messages
+static const auto LOG_DRAIN_INTERVAL = std::chrono::milliseconds(5);
+
+static void emitRecord(const LogRecord& record, uint32_t threadIndex);
+static void afterDrain();
+
+// The writer thread drains every thread's ring into the log
+static ThreadRingRegistry<LogRecord, LOG_RING_CAPACITY> rings(emitRecord, afterDrain, LOG_DRAIN_INTERVAL);
+
+static uint64_t reportedDropped = 0;
+
+#if !defined(__ANDROID__)
+static FILE* logFile = nullptr;
+
+bool logSetFile(const char* path) {
+    FILE* file = fopen(path, "a");
+    if (!file) return false;
+    std::lock_guard<std::mutex> lock(rings.consumerMutex());
+    if (logFile) fclose(logFile);
+    logFile = file;
+    return true;
+}
+#endif
+
+static void emit(int level, const char* tag, int64_t timestampNs, const char* text) {
+#if defined(__ANDROID__)
+    (void)timestampNs;
+    __android_log_write(level, tag, text);
+#else
+    static const char levels[] = "??VDIWE";
+    FILE* out = logFile ? logFile : stdout;
+    fprintf(out, "%lld.%06lld %c %s: %s\n", (long long)(timestampNs / 1000000000),
+            (long long)(timestampNs % 1000000000) / 1000, level < 7 ? levels[level] : '?', tag, text);
+#endif
+}
+
+static void emitRecord(const LogRecord& record, uint32_t) {
+    char text[512];
+    record.formatter(record.format, record.args, text, sizeof(text));
+    emit(record.level, record.tag, record.timestampNs, text);
+}
+
+// Runs on the writer after each pass over the rings
+static void afterDrain() {
+    uint64_t dropped = logDroppedCount();
+    if (dropped != reportedDropped) {
+        char text[96];
+        snprintf(text, sizeof(text), "%llu log messages dropped (ring full)", (unsigned long long)(dropped - reportedDropped));
+        emit(XR_LOG_LEVEL_WARN, "Log", monotonicNowNs(), text);
+        reportedDropped = dropped;
+    }
+
+#if !defined(__ANDROID__)
+    fflush(logFile ? logFile : stdout);
+#endif
+}
+
+void logEnqueue(int level, const char* tag, const char* format, LogFormatter formatter,
+                const uint8_t* args, size_t argBytes) {
+    LogRecord record;
+    record.timestampNs = monotonicNowNs();
+    record.tag = tag;
+    record.format = format;
+    record.formatter = formatter;
+    record.level = (uint8_t)level;
+    record.argBytes = (uint8_t)argBytes;
+    if (argBytes > 0) memcpy(record.args, args, argBytes);
+
+    if (rings.stopped()) {
+        // After shutdown there is nobody to drain a ring; write directly
+        std::lock_guard<std::mutex> lock(rings.consumerMutex());
+        emitRecord(record, 0);
+        return;
+    }
+    rings.push(record);
+}
+
+void logFlush() {
+    rings.flush();
+}
+
+void logShutdown() {
+    rings.shutdown();
+}
+
+uint64_t logDroppedCount() {
+    return rings.droppedCount();
+}
@@ -0,0 +1,187 @@
+#ifndef ANDROIDSAMSUNG_LOG_H
+#define ANDROIDSAMSUNG_LOG_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdio.h>
+#include <tuple>
+#include <type_traits>
+
+// Asynchronous logging.
+//
+// LOGx() copies its raw arguments (strings by value) into a per-thread lock-free ring and
+// returns; a background thread formats the message and hands it to the platform sink
+// (logcat on Android, stdout or a file elsewhere). Messages that do not fit because the ring
+// is full are dropped and counted. Levels below XR_LOG_LEVEL compile to nothing, arguments
+// included.
+//
+// Each source file defines LOG_TAG before using the macros.
+
+#define XR_LOG_LEVEL_VERBOSE 2
+#define XR_LOG_LEVEL_DEBUG 3
+#define XR_LOG_LEVEL_INFO 4
+#define XR_LOG_LEVEL_WARN 5
+#define XR_LOG_LEVEL_ERROR 6
+#define XR_LOG_LEVEL_NONE 7
+
+#ifndef XR_LOG_LEVEL
+#ifdef NDEBUG
+#define XR_LOG_LEVEL XR_LOG_LEVEL_INFO
+#else
+#define XR_LOG_LEVEL XR_LOG_LEVEL_DEBUG
+#endif
+#endif
+
+// Bytes of argument data one message can carry (LogRecord is 256 bytes with it). Numbers and
+// pointers take their size; string arguments share what is left, and a string cut to fit ends
+// in "..." in the output.
+const size_t LOG_ARG_BYTES = 220;
+
+// Formats a captured message back into text; generated per argument list by the macros
+typedef int (*LogFormatter)(const char* format, const uint8_t* args, char* out, size_t outSize);
+
+// Enqueues one message on the calling thread's ring. Used by the macros below.
+void logEnqueue(int level, const char* tag, const char* format, LogFormatter formatter,
+                const uint8_t* args, size_t argBytes);
+
+// Blocks until every message enqueued so far has been written. Call before abort() or exit.
+void logFlush();
+
+// Stops the background thread after flushing. Messages logged afterwards are written inline.
+void logShutdown();
+
+// Messages dropped because a thread's ring was full, since startup
+uint64_t logDroppedCount();
+
+#if !defined(__ANDROID__)
+// Sends output to a file instead of stdout (host builds only). Returns false if it cannot be opened.
+bool logSetFile(const char* path);
+#endif
+
+namespace logdetail {
+
+template <typename T>
+using Stored = typename std::conditional<
+        std::is_same<typename std::decay<T>::type, char*>::value ||
+        std::is_same<typename std::decay<T>::type, const char*>::value,
+        const char*, typename std::decay<T>::type>::type;
+
+template <typename T>
+constexpr size_t fixedSize() {
+    return std::is_same<Stored<T>, const char*>::value ? 1 : sizeof(Stored<T>);
+}
+
+template <typename T>
+inline void encode(uint8_t*& cursor, size_t&, const T& value) {
+    static_assert(std::is_arithmetic<T>::value || std::is_enum<T>::value || std::is_pointer<T>::value,
+                  "log arguments must be numbers, enums, pointers or C strings");
+    memcpy(cursor, &value, sizeof(T));
+    cursor += sizeof(T);
+}
+
+// strnlen stops at the terminator, so a literal shorter than the bound is fine; only GCC
+// knows the warning
+#pragma GCC diagnostic push
+#if !defined(__clang__)
+#pragma GCC diagnostic ignored "-Wstringop-overread"
+#endif
+inline void encode(uint8_t*& cursor, size_t& stringRoom, const char* value) {
+    size_t length = value ? strnlen(value, stringRoom) : 0;
+    if (value) memcpy(cursor, value, length);
+    // strnlen stopped at the bound rather than the terminator: mark the cut
+    if (value && value[length] != '\0' && length >= 3) memcpy(cursor + length - 3, "...", 3);
+    cursor[length] = '\0';
+    cursor += length + 1;
+    stringRoom -= length;
+}
+#pragma GCC diagnostic pop
+
+template <typename T>
+inline T decode(const uint8_t*& cursor) {
+    T value;
+    memcpy(&value, cursor, sizeof(T));
+    cursor += sizeof(T);
+    return value;
+}
+
+template <>
+inline const char* decode<const char*>(const uint8_t*& cursor) {
+    const char* value = reinterpret_cast<const char*>(cursor);
+    cursor += strlen(value) + 1;
+    return value;
+}
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wformat-nonliteral"
+#pragma GCC diagnostic ignored "-Wformat-security"
+template <typename... Args>
+int format(const char* fmt, const uint8_t* args, char* out, size_t outSize) {
+    [[maybe_unused]] const uint8_t* cursor = args;
+    // Braced initialization decodes the arguments left to right
+    std::tuple<Args...> values{decode<Args>(cursor)...};
+    return std::apply([&](auto... value) { return snprintf(out, outSize, fmt, value...); }, values);
+}
+#pragma GCC diagnostic pop
+
+template <typename... Args>
+inline void write(int level, const char* tag, const char* fmt, const Args&... args) {
+    constexpr size_t fixedBytes = (size_t(0) + ... + fixedSize<Args>());
+    static_assert(fixedBytes <= LOG_ARG_BYTES, "too many log arguments");
+
+    if constexpr (sizeof...(Args) == 0) {
+        logEnqueue(level, tag, fmt, &format<>, nullptr, 0);
+    } else {
+        uint8_t buffer[LOG_ARG_BYTES];
+        uint8_t* cursor = buffer;
+        size_t stringRoom = LOG_ARG_BYTES - fixedBytes;
+        (encode(cursor, stringRoom, static_cast<Stored<Args>>(args)), ...);
+        logEnqueue(level, tag, fmt, &format<Stored<Args>...>, buffer, cursor - buffer);
+    }
+}
+
+// Never called; gives the macros printf-style format checking at compile time
+inline void checkFormat(const char*, ...) __attribute__((format(printf, 1, 2)));
+inline void checkFormat(const char*, ...) {}
+
+} // namespace logdetail
+
+#define XR_LOG_EMIT(level, ...) \
+    do { \
+        if (false) logdetail::checkFormat(__VA_ARGS__); \
+        logdetail::write(level, LOG_TAG, __VA_ARGS__); \
+    } while (0)
+
+#if XR_LOG_LEVEL <= XR_LOG_LEVEL_VERBOSE
+#define LOGV(...) XR_LOG_EMIT(XR_LOG_LEVEL_VERBOSE, __VA_ARGS__)
+#else
+#define LOGV(...) ((void)0)
+#endif
+
+#if XR_LOG_LEVEL <= XR_LOG_LEVEL_DEBUG
+#define LOGD(...) XR_LOG_EMIT(XR_LOG_LEVEL_DEBUG, __VA_ARGS__)
+#else
+#define LOGD(...) ((void)0)
+#endif
+
+// Each message carries at most LOG_ARG_BYTES of arguments; long strings (paths, lists, joined
+// text) are cut to fit and end in "...". Log long content in several messages.
+#if XR_LOG_LEVEL <= XR_LOG_LEVEL_INFO
+#define LOGI(...) XR_LOG_EMIT(XR_LOG_LEVEL_INFO, __VA_ARGS__)
+#else
+#define LOGI(...) ((void)0)
+#endif
+
+#if XR_LOG_LEVEL <= XR_LOG_LEVEL_WARN
+#define LOGW(...) XR_LOG_EMIT(XR_LOG_LEVEL_WARN, __VA_ARGS__)
+#else
+#define LOGW(...) ((void)0)
+#endif
+
+#if XR_LOG_LEVEL <= XR_LOG_LEVEL_ERROR
+#define LOGE(...) XR_LOG_EMIT(XR_LOG_LEVEL_ERROR, __VA_ARGS__)
+#else
+#define LOGE(...) ((void)0)
+#endif
+
+#endif //ANDROIDSAMSUNG_LOG_H
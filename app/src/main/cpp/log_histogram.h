@@ -0,0 +1,72 @@
+#ifndef ANDROIDSAMSUNG_LOG_HISTOGRAM_H
+#define ANDROIDSAMSUNG_LOG_HISTOGRAM_H
+
+#include <stdint.h>
+#include <algorithm>
+#include <atomic>
+
+// Histogram of durations in nanoseconds with log-spaced buckets: each power of two from
+// 1 us to ~17 s is split into 8 linear sub-buckets, so any percentile is within ~6% of the
+// true value. Recording is one relaxed atomic increment, safe from any thread; reads see a
+// slightly stale but never torn picture. Fixed size, no allocation.
+class LogHistogram {
+public:
+    static constexpr int SUB_BITS = 3;
+    static constexpr int MIN_EXP = 10; // 1024 ns; anything shorter lands in bucket 0
+    static constexpr int MAX_EXP = 34; // ~17 s; anything longer lands in the last bucket
+    static constexpr int BUCKETS = 1 + (MAX_EXP - MIN_EXP) * (1 << SUB_BITS);
+
+    void record(int64_t ns) {
+        buckets[bucketFor(ns)].fetch_add(1, std::memory_order_relaxed);
+        total.fetch_add(1, std::memory_order_relaxed);
+        int64_t previous = maxNs.load(std::memory_order_relaxed);
+        while (ns > previous && !maxNs.compare_exchange_weak(previous, ns, std::memory_order_relaxed)) {}
+    }
+
+    uint64_t count() const { return total.load(std::memory_order_relaxed); }
+    int64_t max() const { return maxNs.load(std::memory_order_relaxed); }
+
+    // Value below which `fraction` (0..1) of the samples fall: the bucket midpoint, capped at
+    // the largest sample. 0 if empty.
+    int64_t percentile(double fraction) const {
+        uint64_t n = count();
+        if (n == 0) return 0;
+        uint64_t rank = (uint64_t)(fraction * (double)n);
+        if (rank >= n) rank = n - 1;
+        uint64_t seen = 0;
+        for (int i = 0; i < BUCKETS; ++i) {
+            seen += buckets[i].load(std::memory_order_relaxed);
+            if (seen > rank) return std::min(bucketMidpoint(i), max());
+        }
+        return max();
+    }
+
+    void reset() {
+        for (auto& bucket : buckets) bucket.store(0, std::memory_order_relaxed);
+        total.store(0, std::memory_order_relaxed);
+        maxNs.store(0, std::memory_order_relaxed);
+    }
+
+    static int bucketFor(int64_t ns) {
+        if (ns < (int64_t(1) << MIN_EXP)) return 0;
+        int exponent = 63 - __builtin_clzll((uint64_t)ns);
+        if (exponent >= MAX_EXP) return BUCKETS - 1;
+        int sub = (int)((uint64_t)ns >> (exponent - SUB_BITS)) & ((1 << SUB_BITS) - 1);
+        return 1 + (exponent - MIN_EXP) * (1 << SUB_BITS) + sub;
+    }
+
+    static int64_t bucketMidpoint(int bucket) {
+        if (bucket == 0) return (int64_t(1) << MIN_EXP) / 2;
+        int exponent = MIN_EXP + (bucket - 1) / (1 << SUB_BITS);
+        int sub = (bucket - 1) % (1 << SUB_BITS);
+        int64_t width = int64_t(1) << (exponent - SUB_BITS);
+        return ((int64_t)((1 << SUB_BITS) + sub) << (exponent - SUB_BITS)) + width / 2;
+    }
+
+private:
+    std::atomic<uint32_t> buckets[BUCKETS] = {};
+    std::atomic<uint64_t> total{0};
+    std::atomic<int64_t> maxNs{0};
+};
+
+#endif //ANDROIDSAMSUNG_LOG_HISTOGRAM_H
@@ -1,8 +1,6 @@
-#include <android/log.h>
-#include "android_native_app_glue.h"
+#include "platform.h"
 #include <EGL/egl.h>
 #include <GLES3/gl3.h>
-#include <android/input.h> // Include for input event handling
 
 // =================================================================================================
 // --- Mobile Test Mode Switch ---
@@ -14,11 +12,18 @@
 
 
 #if !defined(TEST_ON_MOBILE)
-// XR_USE_PLATFORM_ANDROID and XR_USE_GRAPHICS_API_OPENGL_ES must be defined before including openxr headers
-#define XR_USE_PLATFORM_ANDROID
-#define XR_USE_GRAPHICS_API_OPENGL_ES
-#include "openxr/include/openxr/openxr.h"
-#include "openxr/include/openxr/openxr_platform.h"
+// The XR_USE_PLATFORM_* / XR_USE_GRAPHICS_API_* defines live in xr_platform.h
+#include "frame_analyzer.h"
+#include "frame_capture.h"
+#include "frame_stats.h"
+#include "frame_timeline.h"
+#include "gpu_timer.h"
+#include "perf_hud.h"
+#include "pose_latency.h"
+#include "refresh_rate.h"
+#include "shared_metrics.h"
+#include "xr_clock.h"
+#include "xr_dispatch.h"
 #endif
 
 #include <vector>
@@ -27,10 +32,22 @@
 #include <cstring>
 #include <unistd.h>
 #include <array>
+#include <memory_resource>
+
+#include "alloc_guard.h"
+#include "fixed_vector.h"
+#include "frame_arena.h"
+#include "gl_capture.h"
+#include "knob_console.h"
+#include "knobs.h"
+#include "monotonic_clock.h"
+#include "pipeline_warmup.h"
+#include "profiler.h"
+#include "startup_graph.h"
+#include "xr_math.h"
 
 #define LOG_TAG "XR_App_Test"
-#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
-#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
+#include "log.h"
 
 // --- Globals ---
 EGLDisplay eglDisplay = EGL_NO_DISPLAY;
@@ -50,6 +67,50 @@ XrSession session = XR_NULL_HANDLE;
 XrSpace appSpace = XR_NULL_HANDLE;
 XrSwapchain swapchain = XR_NULL_HANDLE;
 
+// Runtime entry points for `instance`, used for every call on the frame path
+XrDispatchTable xr;
+
+// The scene is head-locked and still, but it is a full-view projection layer redrawn every
+// frame, where 60 Hz flicker is visible; 72 Hz is the lowest comfortable rate for it.
+Knob<float> sceneRefreshHz("display.refresh_hz", 72.0f, 60.0f, 120.0f, "lowest refresh rate the scene asks for");
+RefreshRateManager refreshRate;
+
+// Eye images are rendered into this fraction of the recommended size and submitted as a
+// sub-rectangle of the full-size swapchain, so it can change without reallocating anything
+Knob<float> renderScale("render.scale", 1.0f, 0.25f, 1.0f, "eye render size as a fraction of the recommended size");
+
+// Phase timings of recent frames, written out as a Chrome trace on exit
+FrameTimeline frameTimeline;
+
+// Drops and frame-time percentiles for the current session; GPU time of the eye renders
+FrameStats frameStats;
+GpuTimer gpuTimer;
+
+// What limits each frame: CPU, GPU, compositor or nothing
+FrameAnalyzer frameAnalyzer;
+
+// Head-locked stats quad on top of the scene; created with every session, submitted while enabled
+Knob<bool> showPerfHud("hud.enabled", true, false, true, "show the performance HUD");
+PerfHud perfHud;
+
+// Live frame metrics for tools/metrics_reader, published once per frame after xrEndFrame
+SharedMetrics sharedMetrics;
+struct FrameMetricIds {
+    int frames = -1, dropped = -1, layers = -1;
+    int displayPeriodMs = -1, refreshHz = -1, poseToPhotonMs = -1, frameBound = -1;
+    int frameTime = -1, cpuTime = -1, gpuTime = -1, poseToPhoton = -1;
+} metricIds;
+int64_t lastPublishedWaitNs = 0;
+
+// Age of the head pose at display time; warns past two display periods at 72 Hz by default
+Knob<float> poseLatencyBudgetMs("pose.budget_ms", 2000.0f / 72.0f, 5.0f, 100.0f, "pose-to-photon warning threshold");
+PoseLatency poseLatency((int64_t)(poseLatencyBudgetMs.get() * 1e6));
+
+// Layer stacks submitted to xrEndFrame, recorded on request for tools/frame_replay
+FrameCapture layerCapture;
+std::atomic<uint32_t> layerCaptureRequested{0}; // frames to record; set from the console
+uint32_t layerCaptureCount = 0;
+
 // Swapchain images
 struct SwapchainImage {
     XrSwapchainImageOpenGLESKHR khr;
@@ -63,16 +124,41 @@ struct Framebuffer {
 };
 Framebuffer renderFramebuffer;
 
+// Depth storage size currently allocated for renderFramebuffer.depthbuffer
+uint32_t depthbufferWidth = 0;
+uint32_t depthbufferHeight = 0;
+
 // App state
 bool sessionRunning = false;
 XrSessionState sessionState = XR_SESSION_STATE_UNKNOWN;
 
+// --- Recovery State ---
+// What the runtime has invalidated and still needs to be rebuilt. The EGL context, programs
+// and static buffers are never part of this; they survive session and instance recreation.
+enum class XrRecovery { None, Session, Instance };
+XrRecovery xrRecovery = XrRecovery::None;
+int64_t nextRecoveryAttemptNs = 0;
+const int64_t RECOVERY_RETRY_INTERVAL_NS = 1000000000; // Retry instance creation once a second
+
+// Upper bound on layers submitted per frame; the per-frame layer list lives on the stack
+const size_t MAX_COMPOSITION_LAYERS = 4;
+// renderFrameVR submits the projection layer and, when shown, the perf HUD quad
+static_assert(MAX_COMPOSITION_LAYERS >= 2, "room for the projection and HUD layers");
+
 // View configuration
 std::vector<XrViewConfigurationView> viewConfigViews;
 std::vector<XrView> views;
 std::vector<XrCompositionLayerProjectionView> projectionViews;
 #endif
 
+// Tuning console for the knobs; `capture` asks the main loop to write out what it has collected
+const char* const CONSOLE_SOCKET = "@xr_knobs";
+KnobConsole console;
+std::atomic<bool> captureRequested{false};
+uint32_t captureCount = 0;
+std::atomic<uint32_t> glCaptureRequested{0}; // frames of GL calls to record; set from the console
+uint32_t glCaptureCount = 0;
+
 // Simple vertex shader
 const char* vertexShaderSource = R"(#version 300 es
 layout (location = 0) in vec3 aPos;
@@ -107,82 +193,47 @@ GLuint shaderProgram = 0;
 GLuint overlayShaderProgram = 0;
 GLuint VAO = 0;
 GLuint VBO = 0;
+GLuint EBO = 0;
+
+// Every program/blend/depth combination drawn by the render functions
+PipelineRegistry pipelines;
+int backgroundPipeline = -1;   // opaque, depth tested (VR background quad)
+int overlayPipeline = -1;      // blended, depth tested, no depth writes (VR overlays)
+int overlay2dPipeline = -1;    // blended, no depth (mobile quads)
+
+// Transient per-frame data (draw lists, layer structs) is bump-allocated from here and
+// recycled two frames later
+FrameArena frameArena(16 * 1024, 2);
+
+// One quad of the VR scene, rebuilt every frame into the frame arena
+struct QuadDraw {
+    int pipeline;
+    float x, y, z;
+    float r, g, b, alpha;
+};
 
-// --- Matrix Math ---
-void matrix_identity(float* m) {
-    m[0] = 1; m[4] = 0; m[8] = 0;  m[12] = 0;
-    m[1] = 0; m[5] = 1; m[9] = 0;  m[13] = 0;
-    m[2] = 0; m[6] = 0; m[10] = 1; m[14] = 0;
-    m[3] = 0; m[7] = 0; m[11] = 0; m[15] = 1;
-}
-
-void matrix_multiply(const float* a, const float* b, float* r) {
-    for (int i = 0; i < 4; ++i) {
-        for (int j = 0; j < 4; ++j) {
-            r[i * 4 + j] = 0;
-            for (int k = 0; k < 4; ++k) {
-                r[i * 4 + j] += a[k * 4 + j] * b[i * 4 + k];
-            }
-        }
+// --- Time-To-First-Frame ---
+// Set when a (re)start begins and cleared once the first frame reaches the display.
+int64_t resumeStartNs = 0;
+const char* resumeReason = nullptr;
+
+void markResumeStart(const char* reason) {
+    // Keep the earliest start if several rebuild steps overlap (e.g. window + session)
+    if (resumeReason == nullptr) {
+        resumeStartNs = monotonicNowNs();
+        resumeReason = reason;
+        allocGuardReset();
     }
 }
 
-void matrix_translate(float x, float y, float z, float* m) {
-    matrix_identity(m);
-    m[12] = x;
-    m[13] = y;
-    m[14] = z;
-}
-
-void matrix_scale(float sx, float sy, float sz, float* m) {
-    matrix_identity(m);
-    m[0] = sx;
-    m[5] = sy;
-    m[10] = sz;
+// displayNs is when the frame reaches the display, on the monotonicNowNs() clock
+void markFirstFrameDisplayed(int64_t displayNs) {
+    if (resumeReason == nullptr) return;
+    LOGI("Time to first frame after %s: %.2f ms submitted, %.2f ms displayed", resumeReason,
+         (monotonicNowNs() - resumeStartNs) / 1e6, (displayNs - resumeStartNs) / 1e6);
+    resumeReason = nullptr;
 }
 
-
-#if !defined(TEST_ON_MOBILE)
-void matrix_create_projection_from_fov(const XrFovf& fov, float nearZ, float farZ, float* m) {
-    const float tan_left = tanf(fov.angleLeft);
-    const float tan_right = tanf(fov.angleRight);
-    const float tan_down = tanf(fov.angleDown);
-    const float tan_up = tanf(fov.angleUp);
-    const float tan_width = tan_right - tan_left;
-    const float tan_height = tan_up - tan_down;
-    m[0] = 2.0f / tan_width;
-    m[1] = 0.0f;
-    m[2] = 0.0f;
-    m[3] = 0.0f;
-    m[4] = 0.0f;
-    m[5] = 2.0f / tan_height;
-    m[6] = 0.0f;
-    m[7] = 0.0f;
-    m[8] = (tan_right + tan_left) / tan_width;
-    m[9] = (tan_up + tan_down) / tan_height;
-    m[10] = -(farZ + nearZ) / (farZ - nearZ);
-    m[11] = -1.0f;
-    m[12] = 0.0f;
-    m[13] = 0.0f;
-    m[14] = -2.0f * farZ * nearZ / (farZ - nearZ);
-    m[15] = 0.0f;
-}
-
-void matrix_create_view_from_pose(const XrPosef& pose, float* m) {
-    const XrQuaternionf& q = pose.orientation;
-    const XrVector3f& p = pose.position;
-    float x2 = q.x + q.x, y2 = q.y + q.y, z2 = q.z + q.z;
-    float xx = q.x * x2, xy = q.x * y2, xz = q.x * z2;
-    float yy = q.y * y2, yz = q.y * z2, zz = q.z * z2;
-    float wx = q.w * x2, wy = q.w * y2, wz = q.w * z2;
-    m[0] = 1 - (yy + zz); m[4] = xy - wz;     m[8] = xz + wy;      m[12] = -(m[0] * p.x + m[4] * p.y + m[8] * p.z);
-    m[1] = xy + wz;      m[5] = 1 - (xx + zz); m[9] = yz - wx;      m[13] = -(m[1] * p.x + m[5] * p.y + m[9] * p.z);
-    m[2] = xz - wy;      m[6] = yz + wx;      m[10] = 1 - (xx + yy); m[14] = -(m[2] * p.x + m[6] * p.y + m[10] * p.z);
-    m[3] = 0;            m[7] = 0;            m[11] = 0;             m[15] = 1;
-}
-#endif
-
-
 // --- Initialization and Cleanup ---
 
 GLuint compileShader(GLenum type, const char* source) {
@@ -202,6 +253,7 @@ GLuint compileShader(GLenum type, const char* source) {
 }
 
 bool initOpenGL() {
+    PROFILE_ZONE("initOpenGL");
     GLuint vertexShader = compileShader(GL_VERTEX_SHADER, vertexShaderSource);
     GLuint fragmentShader = compileShader(GL_FRAGMENT_SHADER, fragmentShaderSource);
     shaderProgram = glCreateProgram();
@@ -227,7 +279,6 @@ bool initOpenGL() {
 
     glGenVertexArrays(1, &VAO);
     glGenBuffers(1, &VBO);
-    GLuint EBO;
     glGenBuffers(1, &EBO);
 
     glBindVertexArray(VAO);
@@ -239,15 +290,34 @@ bool initOpenGL() {
     glEnableVertexAttribArray(0);
     glBindVertexArray(0);
 
+    if (backgroundPipeline < 0) {
+        backgroundPipeline = pipelines.add({"background", shaderProgram, true, true, false});
+        overlayPipeline = pipelines.add({"overlay", overlayShaderProgram, true, false, true});
+        overlay2dPipeline = pipelines.add({"overlay-2d", overlayShaderProgram, false, true, true});
+    }
+#if !defined(TEST_ON_MOBILE)
+    gpuTimer.init();
+#endif
+
     LOGI("OpenGL base initialized successfully");
     return true;
 }
 
-bool initEGL(android_app* app) {
-    eglDisplay = eglGetDisplay(EGL_DEFAULT_DISPLAY);
-    eglInitialize(eglDisplay, nullptr, nullptr);
+bool initEGL(PlatformApp* app) {
+    PROFILE_ZONE("initEGL");
+    eglDisplay = platformEglDisplay();
+    if (eglDisplay == EGL_NO_DISPLAY) {
+        LOGE("Failed to initialize EGL display: 0x%x", eglGetError());
+        return false;
+    }
 
-    EGLint configAttribs[] = { EGL_RENDERABLE_TYPE, EGL_OPENGL_ES3_BIT, EGL_RED_SIZE, 8, EGL_GREEN_SIZE, 8, EGL_BLUE_SIZE, 8, EGL_ALPHA_SIZE, 8, EGL_DEPTH_SIZE, 24, EGL_NONE };
+#if defined(TEST_ON_MOBILE)
+    const EGLint surfaceType = EGL_WINDOW_BIT;
+#else
+    // Surfaceless displays (Mesa on a headless host) have no window configs at all
+    const EGLint surfaceType = EGL_PBUFFER_BIT;
+#endif
+    EGLint configAttribs[] = { EGL_RENDERABLE_TYPE, EGL_OPENGL_ES3_BIT, EGL_SURFACE_TYPE, surfaceType, EGL_RED_SIZE, 8, EGL_GREEN_SIZE, 8, EGL_BLUE_SIZE, 8, EGL_ALPHA_SIZE, 8, EGL_DEPTH_SIZE, 24, EGL_NONE };
     EGLint numConfigs;
     eglChooseConfig(eglDisplay, configAttribs, &eglConfig, 1, &numConfigs);
 
@@ -268,32 +338,101 @@ bool initEGL(android_app* app) {
 #if defined(TEST_ON_MOBILE)
     eglQuerySurface(eglDisplay, eglSurface, EGL_WIDTH, &windowWidth);
     eglQuerySurface(eglDisplay, eglSurface, EGL_HEIGHT, &windowHeight);
+    glCaptureDescribeDefaultFramebuffer((uint32_t)windowWidth, (uint32_t)windowHeight);
 #endif
 
     LOGI("EGL initialized successfully");
     return true;
 }
 
+#if defined(TEST_ON_MOBILE)
+// Re-attaches the surviving context to a new window. Programs and buffers live in the
+// context, so nothing else has to be rebuilt.
+bool createWindowSurface(PlatformApp* app) {
+    eglSurface = eglCreateWindowSurface(eglDisplay, eglConfig, app->window, nullptr);
+    if (eglSurface == EGL_NO_SURFACE) {
+        LOGE("Failed to create window surface: 0x%x", eglGetError());
+        return false;
+    }
+    eglMakeCurrent(eglDisplay, eglSurface, eglSurface, eglContext);
+    eglQuerySurface(eglDisplay, eglSurface, EGL_WIDTH, &windowWidth);
+    eglQuerySurface(eglDisplay, eglSurface, EGL_HEIGHT, &windowHeight);
+    glCaptureDescribeDefaultFramebuffer((uint32_t)windowWidth, (uint32_t)windowHeight);
+    return true;
+}
+
+// Only the window surface dies with the window; the context stays alive (surfaceless).
+void destroyWindowSurface() {
+    if (eglDisplay == EGL_NO_DISPLAY || eglSurface == EGL_NO_SURFACE) return;
+    eglMakeCurrent(eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, eglContext);
+    eglDestroySurface(eglDisplay, eglSurface);
+    eglSurface = EGL_NO_SURFACE;
+}
+#endif
+
+#if !defined(TEST_ON_MOBILE)
+// Releases everything owned by the session. The GL framebuffer objects are kept and
+// re-pointed at the new swapchain images when the session comes back.
+void destroyOpenXRSession() {
+    if (session) {
+        refreshRate.shutdown();
+        refreshRate.report();
+        frameStats.report("Session");
+        poseLatency.report("Session");
+        frameAnalyzer.report("Session");
+    }
+    frameStats.reset();
+    poseLatency.reset();
+    frameAnalyzer.reset();
+    perfHud.destroy();
+    layerCapture.forgetHandles();
+    if (sessionRunning) xr.EndSession(session);
+    sessionRunning = false;
+    sessionState = XR_SESSION_STATE_UNKNOWN;
+    if (swapchain) xrDestroySwapchain(swapchain);
+    if (appSpace) xrDestroySpace(appSpace);
+    if (session) xrDestroySession(session);
+    swapchain = XR_NULL_HANDLE;
+    appSpace = XR_NULL_HANDLE;
+    session = XR_NULL_HANDLE;
+    swapchainImages.clear();
+}
+
+void destroyOpenXRInstance() {
+    destroyOpenXRSession();
+    xrClockShutdown();
+    if (instance) xrDestroyInstance(instance);
+    instance = XR_NULL_HANDLE;
+    xr = {};
+    systemId = XR_NULL_SYSTEM_ID;
+}
+#endif
+
 void cleanup() {
+    PROFILE_ZONE("cleanup");
     LOGI("Starting cleanup");
 
+    const FrameArena::Stats& arenaStats = frameArena.stats();
+    LOGI("Frame arena: high-water %zu of %zu bytes/frame, %llu overflow allocations (%zu bytes)",
+         arenaStats.highWaterBytes, arenaStats.capacityPerFrame,
+         (unsigned long long)arenaStats.overflowAllocations, arenaStats.overflowBytes);
+
 #if !defined(TEST_ON_MOBILE)
-    if (sessionRunning) xrEndSession(session);
+    destroyOpenXRInstance();
     if (renderFramebuffer.framebuffer) glDeleteFramebuffers(1, &renderFramebuffer.framebuffer);
     if (renderFramebuffer.depthbuffer) glDeleteRenderbuffers(1, &renderFramebuffer.depthbuffer);
+    renderFramebuffer = {};
+    depthbufferWidth = depthbufferHeight = 0;
+    gpuTimer.destroy();
 #endif
 
     if (VAO) glDeleteVertexArrays(1, &VAO);
     if (VBO) glDeleteBuffers(1, &VBO);
+    if (EBO) glDeleteBuffers(1, &EBO);
     if (shaderProgram) glDeleteProgram(shaderProgram);
     if (overlayShaderProgram) glDeleteProgram(overlayShaderProgram);
-
-#if !defined(TEST_ON_MOBILE)
-    if (swapchain) xrDestroySwapchain(swapchain);
-    if (appSpace) xrDestroySpace(appSpace);
-    if (session) xrDestroySession(session);
-    if (instance) xrDestroyInstance(instance);
-#endif
+    VAO = VBO = EBO = 0;
+    shaderProgram = overlayShaderProgram = 0;
 
     if (eglDisplay != EGL_NO_DISPLAY) {
         eglMakeCurrent(eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
@@ -301,22 +440,43 @@ void cleanup() {
         if (eglContext != EGL_NO_CONTEXT) eglDestroyContext(eglDisplay, eglContext);
         eglTerminate(eglDisplay);
     }
+    eglDisplay = EGL_NO_DISPLAY;
+    eglSurface = EGL_NO_SURFACE;
+    eglContext = EGL_NO_CONTEXT;
     LOGI("Cleanup completed");
 }
 
 #if !defined(TEST_ON_MOBILE)
 // --- VR-ONLY FUNCTIONS ---
 
-bool initOpenXR(android_app* app) {
-    const char* extensions[] = { XR_KHR_ANDROID_CREATE_INSTANCE_EXTENSION_NAME, XR_KHR_OPENGL_ES_ENABLE_EXTENSION_NAME };
-    XrInstanceCreateInfoAndroidKHR androidInfo{XR_TYPE_INSTANCE_CREATE_INFO_ANDROID_KHR};
-    androidInfo.applicationVM = app->activity->vm;
-    androidInfo.applicationActivity = app->activity->clazz;
+bool initOpenXRLoader(PlatformApp* app) {
+    PROFILE_ZONE("initOpenXRLoader");
+    static bool loaderInitialized = false;
+    if (loaderInitialized) return true;
+
+    if (!platformInitXrLoader(app)) {
+        LOGE("Failed to initialize OpenXR loader!");
+        return false;
+    }
+    LOGI("OpenXR Loader Initialized Successfully.");
+    loaderInitialized = true;
+    return true;
+}
 
+bool initOpenXRInstance(PlatformApp* app) {
+    PROFILE_ZONE("initOpenXRInstance");
+    std::vector<const char*> extensions;
+    platformXrInstanceExtensions(app, &extensions);
+    if (runtimeSupportsExtension(XR_KHR_CONVERT_TIMESPEC_TIME_EXTENSION_NAME)) {
+        extensions.push_back(XR_KHR_CONVERT_TIMESPEC_TIME_EXTENSION_NAME);
+    }
+    if (runtimeSupportsExtension(XR_FB_DISPLAY_REFRESH_RATE_EXTENSION_NAME)) {
+        extensions.push_back(XR_FB_DISPLAY_REFRESH_RATE_EXTENSION_NAME);
+    }
     XrInstanceCreateInfo createInfo{XR_TYPE_INSTANCE_CREATE_INFO};
-    createInfo.next = &androidInfo;
-    createInfo.enabledExtensionCount = sizeof(extensions) / sizeof(extensions[0]);
-    createInfo.enabledExtensionNames = extensions;
+    createInfo.next = platformXrInstanceNext(app);
+    createInfo.enabledExtensionCount = (uint32_t)extensions.size();
+    createInfo.enabledExtensionNames = extensions.data();
     strcpy(createInfo.applicationInfo.applicationName, "OpenXR Overlay Demo");
     createInfo.applicationInfo.applicationVersion = 1;
     strcpy(createInfo.applicationInfo.engineName, "Custom Engine");
@@ -327,7 +487,16 @@ bool initOpenXR(android_app* app) {
         LOGE("Failed to create OpenXR instance");
         return false;
     }
+    if (!xrDispatchLoad(instance, &xr)) {
+        LOGE("Failed to resolve OpenXR dispatch table");
+        return false;
+    }
+    xrClockInit(&xr, instance);
+    return true;
+}
 
+bool initOpenXRSystem() {
+    PROFILE_ZONE("initOpenXRSystem");
     XrSystemGetInfo systemInfo{XR_TYPE_SYSTEM_GET_INFO, nullptr, XR_FORM_FACTOR_HEAD_MOUNTED_DISPLAY};
     if (XR_FAILED(xrGetSystem(instance, &systemInfo, &systemId))) {
         LOGE("Failed to get OpenXR system");
@@ -340,13 +509,14 @@ bool initOpenXR(android_app* app) {
     views.resize(viewCount, {XR_TYPE_VIEW});
     projectionViews.resize(viewCount);
     xrEnumerateViewConfigurationViews(instance, systemId, XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO, viewCount, &viewCount, viewConfigViews.data());
+    return true;
+}
 
-    XrGraphicsBindingOpenGLESAndroidKHR graphicsBinding{XR_TYPE_GRAPHICS_BINDING_OPENGL_ES_ANDROID_KHR};
-    graphicsBinding.display = eglDisplay;
-    graphicsBinding.config = eglConfig;
-    graphicsBinding.context = eglContext;
+bool initOpenXRSession(PlatformApp* app) {
+    PROFILE_ZONE("initOpenXRSession");
+    const void* graphicsBinding = platformXrGraphicsBinding(app, instance, systemId, eglDisplay, eglConfig, eglContext);
 
-    XrSessionCreateInfo sessionInfo{XR_TYPE_SESSION_CREATE_INFO, &graphicsBinding, 0, systemId};
+    XrSessionCreateInfo sessionInfo{XR_TYPE_SESSION_CREATE_INFO, graphicsBinding, 0, systemId};
     if (XR_FAILED(xrCreateSession(instance, &sessionInfo, &session))) {
         LOGE("Failed to create OpenXR session");
         return false;
@@ -357,7 +527,23 @@ bool initOpenXR(android_app* app) {
         LOGE("Failed to create reference space");
         return false;
     }
+    layerCapture.addSpace(appSpace, spaceInfo.referenceSpaceType, spaceInfo.poseInReferenceSpace);
+
+    if (refreshRate.init(&xr, session)) {
+        refreshRate.setRequiredRate(sceneRefreshHz.get());
+    }
+    if (perfHud.init(&xr, session, platformXrSwapchainImageType(app))) {
+        layerCapture.addSwapchain(perfHud.swapchainHandle(), perfHud.swapchainCreateInfo());
+        const XrReferenceSpaceCreateInfo& hudSpaceInfo = perfHud.spaceCreateInfo();
+        layerCapture.addSpace(perfHud.spaceHandle(), hudSpaceInfo.referenceSpaceType, hudSpaceInfo.poseInReferenceSpace);
+    }
 
+    LOGI("OpenXR session initialized successfully");
+    return true;
+}
+
+bool initOpenXRSwapchain(PlatformApp* app) {
+    PROFILE_ZONE("initOpenXRSwapchain");
     XrSwapchainCreateInfo swapchainInfo{XR_TYPE_SWAPCHAIN_CREATE_INFO};
     swapchainInfo.usageFlags = XR_SWAPCHAIN_USAGE_SAMPLED_BIT | XR_SWAPCHAIN_USAGE_COLOR_ATTACHMENT_BIT;
     swapchainInfo.format = GL_RGBA8;
@@ -365,125 +551,252 @@ bool initOpenXR(android_app* app) {
     swapchainInfo.width = viewConfigViews[0].recommendedImageRectWidth;
     swapchainInfo.height = viewConfigViews[0].recommendedImageRectHeight;
     swapchainInfo.faceCount = 1;
-    swapchainInfo.arraySize = viewCount;
+    swapchainInfo.arraySize = (uint32_t)viewConfigViews.size();
     swapchainInfo.mipCount = 1;
 
     if (XR_FAILED(xrCreateSwapchain(session, &swapchainInfo, &swapchain))) {
         LOGE("Failed to create swapchain");
         return false;
     }
+    layerCapture.addSwapchain(swapchain, swapchainInfo);
 
     uint32_t imageCount;
     xrEnumerateSwapchainImages(swapchain, 0, &imageCount, nullptr);
     swapchainImages.resize(imageCount);
     for (uint32_t i = 0; i < imageCount; i++) {
-        swapchainImages[i].khr = {XR_TYPE_SWAPCHAIN_IMAGE_OPENGL_ES_KHR};
+        swapchainImages[i].khr = {platformXrSwapchainImageType(app)};
     }
     xrEnumerateSwapchainImages(swapchain, imageCount, &imageCount, reinterpret_cast<XrSwapchainImageBaseHeader*>(swapchainImages.data()));
+    for (const SwapchainImage& image : swapchainImages) {
+        glCaptureDescribeTexture(image.khr.image, GL_TEXTURE_2D_ARRAY, GL_RGBA8, swapchainInfo.width, swapchainInfo.height, swapchainInfo.arraySize);
+    }
 
-    glGenFramebuffers(1, &renderFramebuffer.framebuffer);
-    glGenRenderbuffers(1, &renderFramebuffer.depthbuffer);
-    glBindRenderbuffer(GL_RENDERBUFFER, renderFramebuffer.depthbuffer);
-    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, swapchainInfo.width, swapchainInfo.height);
+    // The framebuffer and depth buffer outlive the session; only reallocate depth storage
+    // if the runtime now recommends a different size.
+    if (!renderFramebuffer.framebuffer) glGenFramebuffers(1, &renderFramebuffer.framebuffer);
+    if (!renderFramebuffer.depthbuffer) glGenRenderbuffers(1, &renderFramebuffer.depthbuffer);
+    if (depthbufferWidth != swapchainInfo.width || depthbufferHeight != swapchainInfo.height) {
+        glBindRenderbuffer(GL_RENDERBUFFER, renderFramebuffer.depthbuffer);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, swapchainInfo.width, swapchainInfo.height);
+        depthbufferWidth = swapchainInfo.width;
+        depthbufferHeight = swapchainInfo.height;
+    }
+    return true;
+}
 
+bool initOpenXR(PlatformApp* app) {
+    if (instance == XR_NULL_HANDLE && !(initOpenXRLoader(app) && initOpenXRInstance(app) && initOpenXRSystem())) return false;
+    if (session == XR_NULL_HANDLE && !(initOpenXRSession(app) && initOpenXRSwapchain(app))) return false;
     LOGI("OpenXR initialized successfully");
     return true;
 }
 
+// Rebuilds only what the runtime invalidated. Instance creation can keep failing for a
+// while after a loss (e.g. the runtime is being updated), so it is retried on an interval.
+void recoverOpenXR(PlatformApp* app) {
+    if (xrRecovery == XrRecovery::None || eglContext == EGL_NO_CONTEXT) return;
+    int64_t now = monotonicNowNs();
+    if (now < nextRecoveryAttemptNs) return;
+
+    // Rebuilding allocates; the frames after it get a fresh warm-up period
+    allocGuardReset();
+    if (xrRecovery == XrRecovery::Instance) {
+        destroyOpenXRInstance();
+    } else {
+        destroyOpenXRSession();
+    }
+
+    if (initOpenXR(app)) {
+        LOGI("OpenXR %s recovered", xrRecovery == XrRecovery::Instance ? "instance" : "session");
+        xrRecovery = XrRecovery::None;
+    } else {
+        // A failed session can leave a half-built instance behind; start over from it next time
+        xrRecovery = XrRecovery::Instance;
+        nextRecoveryAttemptNs = now + RECOVERY_RETRY_INTERVAL_NS;
+    }
+}
+
+// Registers the frame metrics; without a region every id stays -1 and publishing is a no-op
+void openSharedMetrics(const char* path) {
+    if (!sharedMetrics.open(path)) return;
+    metricIds.frames = sharedMetrics.addCounter("frames");
+    metricIds.dropped = sharedMetrics.addCounter("frames.dropped");
+    metricIds.layers = sharedMetrics.addGauge("layers");
+    metricIds.displayPeriodMs = sharedMetrics.addGauge("display.period_ms");
+    metricIds.refreshHz = sharedMetrics.addGauge("display.refresh_hz");
+    metricIds.poseToPhotonMs = sharedMetrics.addGauge("pose_to_photon_ms");
+    metricIds.frameBound = sharedMetrics.addGauge("frame.bound"); // FrameBound of the last classified frame
+    metricIds.frameTime = sharedMetrics.addHistogram("time.frame");
+    metricIds.cpuTime = sharedMetrics.addHistogram("time.cpu");
+    metricIds.gpuTime = sharedMetrics.addHistogram("time.gpu");
+    metricIds.poseToPhoton = sharedMetrics.addHistogram("time.pose_to_photon");
+}
+
+void publishFrameMetrics(const XrFrameState& frameState, int64_t waitReturnNs, int64_t endNs, uint32_t layerCount, int64_t gpuNs) {
+    if (!sharedMetrics.isOpen()) return;
+    sharedMetrics.beginUpdate();
+    sharedMetrics.addToCounter(metricIds.frames, 1);
+    sharedMetrics.setCounter(metricIds.dropped, frameStats.droppedFrames());
+    sharedMetrics.setGauge(metricIds.layers, layerCount);
+    sharedMetrics.setGauge(metricIds.displayPeriodMs, frameState.predictedDisplayPeriod / 1e6);
+    sharedMetrics.setGauge(metricIds.refreshHz, refreshRate.currentRate());
+    sharedMetrics.setGauge(metricIds.frameBound, (double)frameAnalyzer.lastBound());
+    if (lastPublishedWaitNs != 0) sharedMetrics.recordHistogram(metricIds.frameTime, waitReturnNs - lastPublishedWaitNs);
+    sharedMetrics.recordHistogram(metricIds.cpuTime, endNs - waitReturnNs);
+    if (gpuNs >= 0) sharedMetrics.recordHistogram(metricIds.gpuTime, gpuNs);
+    if (frameState.shouldRender) {
+        sharedMetrics.setGauge(metricIds.poseToPhotonMs, poseLatency.lastPoseToPhotonNs() / 1e6);
+        sharedMetrics.recordHistogram(metricIds.poseToPhoton, poseLatency.lastPoseToPhotonNs());
+    }
+    sharedMetrics.endUpdate(endNs);
+    lastPublishedWaitNs = waitReturnNs;
+}
+
 void renderFrameVR() {
     if (!sessionRunning) return;
+    glCaptureFrame();
+    // Knobs may have been changed from the console since the last frame
+    refreshRate.setRequiredRate(sceneRefreshHz.get());
+    poseLatency.setBudgetNs((int64_t)(poseLatencyBudgetMs.get() * 1e6));
 
+    frameTimeline.beginFrame();
     XrFrameWaitInfo waitInfo{XR_TYPE_FRAME_WAIT_INFO};
     XrFrameState frameState{XR_TYPE_FRAME_STATE};
-    xrWaitFrame(session, &waitInfo, &frameState);
-
-    xrBeginFrame(session, nullptr);
+    XrResult waitResult;
+    {
+        FramePhaseScope phase(frameTimeline, FramePhase::Wait);
+        waitResult = xr.WaitFrame(session, &waitInfo, &frameState);
+    }
+    int64_t waitReturnNs = monotonicNowNs();
+    if (waitResult == XR_ERROR_SESSION_LOST || waitResult == XR_ERROR_INSTANCE_LOST) {
+        LOGE("xrWaitFrame reported %s lost", waitResult == XR_ERROR_SESSION_LOST ? "session" : "instance");
+        sessionRunning = false;
+        xrRecovery = waitResult == XR_ERROR_SESSION_LOST ? XrRecovery::Session : XrRecovery::Instance;
+        markResumeStart(waitResult == XR_ERROR_SESSION_LOST ? "session loss" : "instance loss");
+        return;
+    }
+    frameArena.beginFrame();
+    xrClockRefresh(monotonicNowNs());
+    frameTimeline.recordFrameState(frameState);
+    frameStats.onWaitFrame(frameState, waitReturnNs);
+    poseLatency.onWaitFrame(waitReturnNs, frameState.predictedDisplayTime);
+    frameAnalyzer.onWaitFrame(frameState);
+
+    {
+        FramePhaseScope phase(frameTimeline, FramePhase::Begin);
+        xr.BeginFrame(session, nullptr);
+    }
 
-    std::vector<XrCompositionLayerBaseHeader*> layers;
+    FixedVector<XrCompositionLayerBaseHeader*, MAX_COMPOSITION_LAYERS> layers;
     XrCompositionLayerProjection layer{XR_TYPE_COMPOSITION_LAYER_PROJECTION};
 
     if (frameState.shouldRender) {
         uint32_t imageIndex;
-        xrAcquireSwapchainImage(swapchain, nullptr, &imageIndex);
+        {
+            FramePhaseScope phase(frameTimeline, FramePhase::Acquire);
+            xr.AcquireSwapchainImage(swapchain, nullptr, &imageIndex);
+        }
 
         XrSwapchainImageWaitInfo waitImageInfo{XR_TYPE_SWAPCHAIN_IMAGE_WAIT_INFO, nullptr, XR_INFINITE_DURATION};
-        xrWaitSwapchainImage(swapchain, &waitImageInfo);
+        {
+            FramePhaseScope phase(frameTimeline, FramePhase::WaitImage);
+            xr.WaitSwapchainImage(swapchain, &waitImageInfo);
+        }
+
+        // Scene for this frame, drawn once per eye: opaque background, then two blended overlays
+        std::pmr::vector<QuadDraw> drawList(&frameArena);
+        drawList.reserve(3);
+        drawList.push_back({backgroundPipeline, 0.0f, 0.0f, -3.0f, 0.2f, 0.3f, 0.8f, 1.0f});
+        drawList.push_back({overlayPipeline, 0.3f, 0.2f, -1.5f, 1.0f, 0.2f, 0.2f, 0.7f});
+        drawList.push_back({overlayPipeline, -0.3f, -0.2f, -2.0f, 0.2f, 1.0f, 0.2f, 0.6f});
 
         XrViewState viewState{XR_TYPE_VIEW_STATE};
         XrViewLocateInfo viewLocateInfo{XR_TYPE_VIEW_LOCATE_INFO, nullptr, XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO, frameState.predictedDisplayTime, appSpace};
         uint32_t viewCountOutput;
-        xrLocateViews(session, &viewLocateInfo, &viewState, views.size(), &viewCountOutput, views.data());
+        int64_t locateNs = monotonicNowNs();
+        {
+            FramePhaseScope phase(frameTimeline, FramePhase::LocateViews);
+            xr.LocateViews(session, &viewLocateInfo, &viewState, views.size(), &viewCountOutput, views.data());
+        }
+        poseLatency.onLocateViews(locateNs, frameState.predictedDisplayTime);
 
+        float scale = renderScale.get();
+        int64_t renderStartNs = monotonicNowNs();
+        gpuTimer.begin();
         glBindFramebuffer(GL_FRAMEBUFFER, renderFramebuffer.framebuffer);
+        uint64_t contentHash = 0;
 
         for (uint32_t eye = 0; eye < viewCountOutput; ++eye) {
             glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, swapchainImages[imageIndex].khr.image, 0, eye);
             glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, renderFramebuffer.depthbuffer);
 
             const auto& vp = viewConfigViews[eye];
-            glViewport(0, 0, vp.recommendedImageRectWidth, vp.recommendedImageRectHeight);
+            int32_t eyeWidth = (int32_t)(vp.recommendedImageRectWidth * scale);
+            int32_t eyeHeight = (int32_t)(vp.recommendedImageRectHeight * scale);
+            glViewport(0, 0, eyeWidth, eyeHeight);
 
             glClearColor(0.1f, 0.2f, 0.3f, 1.0f);
             glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-            float projMatrix[16];
-            float viewMatrix[16];
-            matrix_create_projection_from_fov(views[eye].fov, 0.1f, 100.0f, projMatrix);
-            matrix_create_view_from_pose(views[eye].pose, viewMatrix);
-
             float viewProjMatrix[16];
-            matrix_multiply(projMatrix, viewMatrix, viewProjMatrix);
-
-            glEnable(GL_DEPTH_TEST);
-            glDepthFunc(GL_LESS);
-            glUseProgram(shaderProgram);
-            float modelMatrix[16], mvp[16];
-            matrix_translate(0.0f, 0.0f, -3.0f, modelMatrix);
-            matrix_multiply(viewProjMatrix, modelMatrix, mvp);
-            glUniformMatrix4fv(glGetUniformLocation(shaderProgram, "mvp"), 1, GL_FALSE, mvp);
-            glUniform3f(glGetUniformLocation(shaderProgram, "color"), 0.2f, 0.3f, 0.8f);
+            {
+                PROFILE_ZONE("eye matrices");
+                float projMatrix[16];
+                float viewMatrix[16];
+                matrix_create_projection_from_fov(views[eye].fov, 0.1f, 100.0f, projMatrix);
+                matrix_create_view_from_pose(views[eye].pose, viewMatrix);
+                matrix_multiply(projMatrix, viewMatrix, viewProjMatrix);
+            }
+
             glBindVertexArray(VAO);
-            glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
-
-            glEnable(GL_BLEND);
-            glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-            glDepthMask(GL_FALSE);
-            glUseProgram(overlayShaderProgram);
-
-            matrix_translate(0.3f, 0.2f, -1.5f, modelMatrix);
-            matrix_multiply(viewProjMatrix, modelMatrix, mvp);
-            glUniformMatrix4fv(glGetUniformLocation(overlayShaderProgram, "mvp"), 1, GL_FALSE, mvp);
-            glUniform3f(glGetUniformLocation(overlayShaderProgram, "color"), 1.0f, 0.2f, 0.2f);
-            glUniform1f(glGetUniformLocation(overlayShaderProgram, "alpha"), 0.7f);
-            glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
-
-            matrix_translate(-0.3f, -0.2f, -2.0f, modelMatrix);
-            matrix_multiply(viewProjMatrix, modelMatrix, mvp);
-            glUniformMatrix4fv(glGetUniformLocation(overlayShaderProgram, "mvp"), 1, GL_FALSE, mvp);
-            glUniform3f(glGetUniformLocation(overlayShaderProgram, "color"), 0.2f, 1.0f, 0.2f);
-            glUniform1f(glGetUniformLocation(overlayShaderProgram, "alpha"), 0.6f);
-            glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
-
-            glDepthMask(GL_TRUE);
-            glDisable(GL_BLEND);
-            glDisable(GL_DEPTH_TEST);
+            int boundPipeline = -1;
+            for (const QuadDraw& quad : drawList) {
+                if (quad.pipeline != boundPipeline) {
+                    pipelines.bind(quad.pipeline);
+                    boundPipeline = quad.pipeline;
+                }
+                GLuint program = pipelines.state(quad.pipeline).program;
+                float modelMatrix[16], mvp[16];
+                matrix_translate(quad.x, quad.y, quad.z, modelMatrix);
+                matrix_multiply(viewProjMatrix, modelMatrix, mvp);
+                glUniformMatrix4fv(glGetUniformLocation(program, "mvp"), 1, GL_FALSE, mvp);
+                glUniform3f(glGetUniformLocation(program, "color"), quad.r, quad.g, quad.b);
+                // The opaque program has no alpha uniform; location -1 makes this a no-op there
+                glUniform1f(glGetUniformLocation(program, "alpha"), quad.alpha);
+                pipelines.draw(GL_TRIANGLES, 6, GL_UNSIGNED_INT);
+            }
+
+            pipelines.unbind();
+            // Stalls on a readback per eye, so only while the layers are being recorded
+            if (layerCapture.active()) contentHash = contentHash * 31 + frameCaptureHashFramebuffer(eyeWidth, eyeHeight);
 
             projectionViews[eye] = {XR_TYPE_COMPOSITION_LAYER_PROJECTION_VIEW};
             projectionViews[eye].pose = views[eye].pose;
             projectionViews[eye].fov = views[eye].fov;
             projectionViews[eye].subImage.swapchain = swapchain;
             projectionViews[eye].subImage.imageRect.offset = {0, 0};
-            projectionViews[eye].subImage.imageRect.extent = {(int32_t)vp.recommendedImageRectWidth, (int32_t)vp.recommendedImageRectHeight};
+            projectionViews[eye].subImage.imageRect.extent = {eyeWidth, eyeHeight};
             projectionViews[eye].subImage.imageArrayIndex = eye;
         }
 
         glBindFramebuffer(GL_FRAMEBUFFER, 0);
-        xrReleaseSwapchainImage(swapchain, nullptr);
+        if (layerCapture.active()) layerCapture.setContentHash(swapchain, contentHash);
+        gpuTimer.end();
+        frameTimeline.record(FramePhase::Render, renderStartNs, monotonicNowNs());
+        {
+            FramePhaseScope phase(frameTimeline, FramePhase::Release);
+            xr.ReleaseSwapchainImage(swapchain, nullptr);
+        }
 
         layer.space = appSpace;
         layer.viewCount = viewCountOutput;
         layer.views = projectionViews.data();
-        layers.push_back(reinterpret_cast<XrCompositionLayerBaseHeader*>(&layer));
+        if (!layers.push_back(reinterpret_cast<XrCompositionLayerBaseHeader*>(&layer))) {
+            LOGE("Layer list full (%zu); projection layer dropped", MAX_COMPOSITION_LAYERS);
+        }
+        if (XrCompositionLayerBaseHeader* hudLayer = showPerfHud.get() ? perfHud.layer() : nullptr) {
+            if (!layers.push_back(hudLayer)) LOGE("Layer list full (%zu); HUD layer dropped", MAX_COMPOSITION_LAYERS);
+        }
     }
 
     XrFrameEndInfo endInfo{XR_TYPE_FRAME_END_INFO};
@@ -491,13 +804,41 @@ void renderFrameVR() {
     endInfo.environmentBlendMode = XR_ENVIRONMENT_BLEND_MODE_OPAQUE;
     endInfo.layerCount = layers.size();
     endInfo.layers = layers.data();
-    xrEndFrame(session, &endInfo);
+    XrResult endResult;
+    int64_t endCallNs = monotonicNowNs();
+    {
+        FramePhaseScope phase(frameTimeline, FramePhase::End);
+        endResult = xr.EndFrame(session, &endInfo);
+    }
+    int64_t endNs = monotonicNowNs();
+    layerCapture.record(endInfo, frameState, waitReturnNs, endCallNs, endNs, endResult);
+    frameStats.onEndFrame(waitReturnNs, endNs);
+    int64_t gpuNs = -1;
+    if (gpuTimer.poll(&gpuNs)) {
+        frameStats.onGpuTime(gpuNs);
+        frameAnalyzer.onGpuTime(gpuNs);
+        perfHud.onGpuTime(gpuNs);
+    }
+    frameAnalyzer.onEndFrame(frameTimeline);
+    publishFrameMetrics(frameState, waitReturnNs, endNs, endInfo.layerCount, gpuNs);
+    if (showPerfHud.get()) {
+        // The HUD keeps showing its last image between redraws, so its hash only changes here
+        perfHud.setHashContent(layerCapture.active());
+        if (perfHud.onEndFrame(waitReturnNs, endNs, frameStats.droppedFrames(), endInfo.layerCount,
+                               frameState.predictedDisplayPeriod) &&
+            layerCapture.active()) {
+            layerCapture.setContentHash(perfHud.swapchainHandle(), perfHud.contentHash());
+        }
+    }
+    if (XR_SUCCEEDED(endResult) && endInfo.layerCount > 0) {
+        markFirstFrameDisplayed(xrTimeToMonotonicNs(frameState.predictedDisplayTime));
+    }
 }
 
-void pollEvents() {
+void pollEvents(PlatformApp* app) {
     if (instance == XR_NULL_HANDLE) return;
     XrEventDataBuffer eventData{XR_TYPE_EVENT_DATA_BUFFER};
-    while (xrPollEvent(instance, &eventData) == XR_SUCCESS) {
+    while (xr.PollEvent(instance, &eventData) == XR_SUCCESS) {
         switch (eventData.type) {
             case XR_TYPE_EVENT_DATA_SESSION_STATE_CHANGED: {
                 auto* stateEvent = reinterpret_cast<XrEventDataSessionStateChanged*>(&eventData);
@@ -505,19 +846,43 @@ void pollEvents() {
                 LOGI("Session state changed to %d", sessionState);
                 if (sessionState == XR_SESSION_STATE_READY) {
                     XrSessionBeginInfo beginInfo{XR_TYPE_SESSION_BEGIN_INFO, nullptr, XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO};
-                    if (XR_SUCCEEDED(xrBeginSession(session, &beginInfo))) {
+                    if (XR_SUCCEEDED(xr.BeginSession(session, &beginInfo))) {
                         sessionRunning = true;
                         LOGI("Session started successfully");
                     }
                 } else if (sessionState == XR_SESSION_STATE_STOPPING) {
-                    xrEndSession(session);
+                    xr.EndSession(session);
+                    sessionRunning = false;
+                    // Ending a session is a transition, not a steady-state frame
+                    allocGuardReset();
+                } else if (sessionState == XR_SESSION_STATE_EXITING) {
+                    // The runtime or the user asked the app to quit; no new session. platformMain
+                    // destroys it outside the allocation-checked frame.
+                    LOGI("Session exiting, shutting down");
+                    if (sessionRunning) xr.EndSession(session);
                     sessionRunning = false;
+                    platformFinish(app);
+                    allocGuardReset();
+                    return;
+                } else if (sessionState == XR_SESSION_STATE_LOSS_PENDING) {
+                    // The runtime is done with this session; build a new one but keep the instance
+                    if (xrRecovery == XrRecovery::None) xrRecovery = XrRecovery::Session;
+                    markResumeStart("session loss");
                 }
                 break;
             }
-            case XR_TYPE_EVENT_DATA_INSTANCE_LOSS_PENDING:
-                LOGI("Instance loss pending. Exiting.");
+            case XR_TYPE_EVENT_DATA_INSTANCE_LOSS_PENDING: {
+                LOGI("Instance loss pending. Recreating instance, keeping GL resources.");
                 sessionRunning = false;
+                xrRecovery = XrRecovery::Instance;
+                // Give the runtime one retry interval before trying to create a new instance
+                nextRecoveryAttemptNs = monotonicNowNs() + RECOVERY_RETRY_INTERVAL_NS;
+                markResumeStart("instance loss");
+                // The instance must not be used any more, so stop polling it
+                return;
+            }
+            case XR_TYPE_EVENT_DATA_DISPLAY_REFRESH_RATE_CHANGED_FB:
+                refreshRate.onRefreshRateChanged(*reinterpret_cast<XrEventDataDisplayRefreshRateChangedFB*>(&eventData));
                 break;
             default: break;
         }
@@ -529,18 +894,17 @@ void pollEvents() {
 // --- MOBILE-ONLY RENDER FUNCTION ---
 #if defined(TEST_ON_MOBILE)
 void renderFrameMobile() {
-    if (eglDisplay == EGL_NO_DISPLAY) {
+    if (eglDisplay == EGL_NO_DISPLAY || eglSurface == EGL_NO_SURFACE) {
         return;
     }
+    glCaptureFrame();
 
     glViewport(0, 0, windowWidth, windowHeight);
     // Set background to cyan as per the problem statement's resulting image
     glClearColor(0.0f, 1.0f, 1.0f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-    glUseProgram(overlayShaderProgram);
+    pipelines.bind(overlay2dPipeline);
     glBindVertexArray(VAO);
 
     float translateMatrix[16];
@@ -554,7 +918,7 @@ void renderFrameMobile() {
     glUniformMatrix4fv(glGetUniformLocation(overlayShaderProgram, "mvp"), 1, GL_FALSE, mvp);
     glUniform3f(glGetUniformLocation(overlayShaderProgram, "color"), 0.0f, 0.0f, 1.0f); // Blue
     glUniform1f(glGetUniformLocation(overlayShaderProgram, "alpha"), 1.0f);
-    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+    pipelines.draw(GL_TRIANGLES, 6, GL_UNSIGNED_INT);
 
     // --- Magenta Quad (Middle) ---
     matrix_translate(0.0f, 0.0f, 0.0f, translateMatrix);
@@ -563,7 +927,7 @@ void renderFrameMobile() {
     glUniformMatrix4fv(glGetUniformLocation(overlayShaderProgram, "mvp"), 1, GL_FALSE, mvp);
     glUniform3f(glGetUniformLocation(overlayShaderProgram, "color"), 1.0f, 0.0f, 1.0f); // Magenta
     glUniform1f(glGetUniformLocation(overlayShaderProgram, "alpha"), 1.0f);
-    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+    pipelines.draw(GL_TRIANGLES, 6, GL_UNSIGNED_INT);
 
     // --- Green Quad (Right) ---
     matrix_translate(0.4f, 0.0f, 0.0f, translateMatrix);
@@ -572,116 +936,247 @@ void renderFrameMobile() {
     glUniformMatrix4fv(glGetUniformLocation(overlayShaderProgram, "mvp"), 1, GL_FALSE, mvp);
     glUniform3f(glGetUniformLocation(overlayShaderProgram, "color"), 0.0f, 1.0f, 0.0f); // Green
     glUniform1f(glGetUniformLocation(overlayShaderProgram, "alpha"), 1.0f);
-    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
-
+    pipelines.draw(GL_TRIANGLES, 6, GL_UNSIGNED_INT);
 
-    glDisable(GL_BLEND);
+    pipelines.unbind();
 
-    eglSwapBuffers(eglDisplay, eglSurface);
+    if (eglSwapBuffers(eglDisplay, eglSurface)) {
+        markFirstFrameDisplayed(monotonicNowNs());
+    }
 }
 #endif
 
 // --- Main App Logic ---
 
-void handleAppCmd(android_app* app, int32_t cmd) {
+// First-time startup. EGL setup, shader compilation and pipeline warm-up run on a worker
+// thread while the OpenXR loader, instance and system are created here; the context is then
+// handed over to this thread, which owns it for session creation and rendering.
+bool coldStart(PlatformApp* app) {
+    StartupGraph graph;
+    int glLane = graph.addLane("gl");
+
+    auto egl = graph.addTask("egl", glLane, [app] { return initEGL(app); });
+    auto programs = graph.addTask("programs+buffers", glLane, [] { return initOpenGL(); }, {egl});
+    auto warmup = graph.addTask("pipeline-warmup", glLane, [] {
+        pipelines.warmUp(VAO, 6, GL_UNSIGNED_INT);
+        return true;
+    }, {programs});
+    auto release = graph.addTask("egl-release", glLane, [] {
+        glFlush();
+        return eglMakeCurrent(eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT) == EGL_TRUE;
+    }, {warmup});
+#if defined(TEST_ON_MOBILE)
+    graph.addTask("egl-bind", StartupGraph::MAIN_LANE, [] {
+        return eglMakeCurrent(eglDisplay, eglSurface, eglSurface, eglContext) == EGL_TRUE;
+    }, {release});
+#else
+    auto loader = graph.addTask("xr-loader", StartupGraph::MAIN_LANE, [app] { return initOpenXRLoader(app); });
+    auto xrInstance = graph.addTask("xr-instance", StartupGraph::MAIN_LANE, [app] { return initOpenXRInstance(app); }, {loader});
+    auto xrSystem = graph.addTask("xr-system", StartupGraph::MAIN_LANE, [] { return initOpenXRSystem(); }, {xrInstance});
+    auto bind = graph.addTask("egl-bind", StartupGraph::MAIN_LANE, [] {
+        return eglMakeCurrent(eglDisplay, eglSurface, eglSurface, eglContext) == EGL_TRUE;
+    }, {release});
+    auto xrSession = graph.addTask("xr-session", StartupGraph::MAIN_LANE, [app] { return initOpenXRSession(app); }, {xrSystem, bind});
+    graph.addTask("xr-swapchain", StartupGraph::MAIN_LANE, [app] { return initOpenXRSwapchain(app); }, {xrSession});
+#endif
+
+    bool ok = graph.run();
+    graph.report();
+    return ok;
+}
+
+void handleAppCmd(PlatformApp* app, PlatformCmd cmd) {
     switch (cmd) {
-        case APP_CMD_INIT_WINDOW:
-            if (app->window != nullptr) {
-                initEGL(app);
-                initOpenGL();
-#if !defined(TEST_ON_MOBILE)
-                initOpenXR(app);
+        case PlatformCmd::InitWindow: {
+            // Mobile mode draws into the window; VR renders through a pbuffer, so a headless
+            // platform without one is fine
+#if defined(TEST_ON_MOBILE)
+            if (app->window == 0) break;
+#endif
+            bool ready;
+            if (eglContext == EGL_NO_CONTEXT) {
+                // Cold start: nothing to reuse
+                markResumeStart("cold start");
+                ready = coldStart(app);
+            } else {
+                markResumeStart("window resume");
+#if defined(TEST_ON_MOBILE)
+                ready = createWindowSurface(app);
+#else
+                ready = initOpenXR(app);
+#endif
+            }
+            if (!ready) {
+#if defined(TEST_ON_MOBILE)
+                LOGE("Failed to prepare rendering for the new window");
+#else
+                // Whichever OpenXR step failed is retried from the instance up
+                if (eglContext != EGL_NO_CONTEXT) {
+                    xrRecovery = XrRecovery::Instance;
+                    nextRecoveryAttemptNs = monotonicNowNs() + RECOVERY_RETRY_INTERVAL_NS;
+                }
 #endif
             }
             break;
-        case APP_CMD_TERM_WINDOW:
-            cleanup();
+        }
+        case PlatformCmd::TermWindow:
+            // Keep the context, programs and buffers; a full cleanup only happens on destroy.
+            // In VR mode the context renders through a pbuffer, so the window is not needed at all.
+#if defined(TEST_ON_MOBILE)
+            destroyWindowSurface();
+#endif
             break;
+        default: break;
     }
 }
 
-int32_t handle_input(struct android_app* app, AInputEvent* event) {
-    if (AInputEvent_getType(event) == AINPUT_EVENT_TYPE_MOTION) {
-        int32_t action = AMotionEvent_getAction(event);
-        if (action == AMOTION_EVENT_ACTION_DOWN) {
-            float x = AMotionEvent_getX(event, 0);
-            float y = AMotionEvent_getY(event, 0);
-
-            // Convert screen pixel coordinates to Normalized Device Coordinates (NDC) [-1, 1]
-            float ndc_x = (x / (float)windowWidth) * 2.0f - 1.0f;
-            float ndc_y = -((y / (float)windowHeight) * 2.0f - 1.0f); // Y is inverted in OpenGL
-
-            // Define bounding boxes for each quad in NDC
-            // BBox: {minX, maxX, minY, maxY}
-            float blue_bbox[]   = {-0.65f, -0.15f, 0.15f, 0.65f};
-            float magenta_bbox[]= {-0.25f, 0.25f, -0.25f, 0.25f};
-            float green_bbox[]  = {0.15f, 0.65f, -0.25f, 0.25f};
-
-            if (ndc_x > blue_bbox[0] && ndc_x < blue_bbox[1] && ndc_y > blue_bbox[2] && ndc_y < blue_bbox[3]) {
-                LOGI("Blue Quad Tapped!");
-            } else if (ndc_x > magenta_bbox[0] && ndc_x < magenta_bbox[1] && ndc_y > magenta_bbox[2] && ndc_y < magenta_bbox[3]) {
-                LOGI("Magenta Quad Tapped!");
-            } else if (ndc_x > green_bbox[0] && ndc_x < green_bbox[1] && ndc_y > green_bbox[2] && ndc_y < green_bbox[3]) {
-                LOGI("Green Quad Tapped!");
-            } else {
-                LOGI("Background Tapped.");
-            }
+bool handle_input(PlatformApp*, const PlatformInput& input) {
+    if (input.action == PlatformInput::Down) {
+        float x = input.x;
+        float y = input.y;
+
+        // Convert screen pixel coordinates to Normalized Device Coordinates (NDC) [-1, 1]
+        float ndc_x = (x / (float)windowWidth) * 2.0f - 1.0f;
+        float ndc_y = -((y / (float)windowHeight) * 2.0f - 1.0f); // Y is inverted in OpenGL
+
+        // Define bounding boxes for each quad in NDC
+        // BBox: {minX, maxX, minY, maxY}
+        float blue_bbox[]   = {-0.65f, -0.15f, 0.15f, 0.65f};
+        float magenta_bbox[]= {-0.25f, 0.25f, -0.25f, 0.25f};
+        float green_bbox[]  = {0.15f, 0.65f, -0.25f, 0.25f};
+
+        if (ndc_x > blue_bbox[0] && ndc_x < blue_bbox[1] && ndc_y > blue_bbox[2] && ndc_y < blue_bbox[3]) {
+            LOGI("Blue Quad Tapped!");
+        } else if (ndc_x > magenta_bbox[0] && ndc_x < magenta_bbox[1] && ndc_y > magenta_bbox[2] && ndc_y < magenta_bbox[3]) {
+            LOGI("Magenta Quad Tapped!");
+        } else if (ndc_x > green_bbox[0] && ndc_x < green_bbox[1] && ndc_y > green_bbox[2] && ndc_y < green_bbox[3]) {
+            LOGI("Green Quad Tapped!");
+        } else {
+            LOGI("Background Tapped.");
         }
-        return 1;
     }
-    return 0;
+    return true;
+}
+
+// Writes the traces and stats collected so far next to the exit-time ones, numbered
+void writeCapture(PlatformApp* app) {
+    std::string prefix = std::string(app->dataPath) + "/capture" + std::to_string(++captureCount);
+#if !defined(TEST_ON_MOBILE)
+    frameTimeline.exportChromeTrace((prefix + "_frame_timeline.json").c_str());
+    frameStats.report("Capture");
+    poseLatency.report("Capture");
+    frameAnalyzer.report("Capture");
+#endif
+    profilerReport();
+    profilerExportChromeTrace((prefix + "_profile.json").c_str());
+    LOGI("Capture %u written to %s_*.json", captureCount, prefix.c_str());
+    // Exporting allocates; the frames after it get a fresh warm-up period
+    allocGuardReset();
 }
 
-void android_main(android_app* app) {
-    app->onAppCmd = handleAppCmd;
-    app->onInputEvent = handle_input;
+// Starts recording the GL calls of the next `frames` frames for tools/gl_replay
+void startGlCapture(PlatformApp* app, uint32_t frames) {
+    std::string path = std::string(app->dataPath) + "/gl" + std::to_string(++glCaptureCount) + ".xglc";
+    if (!glCaptureStart(path.c_str(), frames)) LOGW("GL capture is not available in this build");
+}
 
 #if !defined(TEST_ON_MOBILE)
-    // Initialize OpenXR loader for VR mode
-    PFN_xrInitializeLoaderKHR xrInitializeLoaderKHR = nullptr;
-    xrGetInstanceProcAddr(XR_NULL_HANDLE, "xrInitializeLoaderKHR", (PFN_xrVoidFunction*)&xrInitializeLoaderKHR);
-    if (xrInitializeLoaderKHR == nullptr) {
-        LOGE("Failed to get xrInitializeLoaderKHR function pointer!");
-        return;
-    }
+// Starts recording the next `frames` layer stacks to a numbered file for tools/frame_replay
+void startLayerCapture(PlatformApp* app, uint32_t frames) {
+    std::string path = std::string(app->dataPath) + "/layers" +
+                       std::to_string(++layerCaptureCount) + ".xfec";
+    layerCapture.start(path.c_str(), frames);
+    // Opening the file allocates
+    allocGuardReset();
+}
+#endif
 
-    XrLoaderInitInfoAndroidKHR loaderInitInfo{XR_TYPE_LOADER_INIT_INFO_ANDROID_KHR};
-    loaderInitInfo.applicationVM = app->activity->vm;
-    loaderInitInfo.applicationContext = app->activity->clazz;
-    if (XR_FAILED(xrInitializeLoaderKHR( (const XrLoaderInitInfoBaseHeaderKHR*)&loaderInitInfo ))) {
-        LOGE("Failed to initialize OpenXR loader!");
+void platformMain(PlatformApp* app) {
+    if (app->noGraphics) {
+        // The layer and swapchain paths here are one; only the multi-overlay app has a graphics-free loop
+        LOGE("This app does not support running without graphics");
+        app->exitCode = 2;
         return;
     }
-    LOGI("OpenXR Loader Initialized Successfully.");
+    app->onCmd = handleAppCmd;
+    app->onInput = handle_input;
+#if !defined(TEST_ON_MOBILE)
+    openSharedMetrics((std::string(app->dataPath) + "/metrics.shm").c_str());
 #endif
+    console.addCommand("capture", "write the frame timeline, profile and stats collected so far", [app](const std::string&) {
+        captureRequested = true;
+        platformWake(app);
+        return std::string("capture requested\n");
+    });
+    console.addCommand("glcapture", "<frames>: record the GL calls of the next frames (default 10)", [app](const std::string& args) {
+        long frames = args.empty() ? 10 : strtol(args.c_str(), nullptr, 10);
+        if (frames <= 0) return std::string("frame count must be positive\n");
+        glCaptureRequested = (uint32_t)frames;
+        platformWake(app);
+        return "capturing GL calls of " + std::to_string(frames) + " frames\n";
+    });
+#if !defined(TEST_ON_MOBILE)
+    console.addCommand("record", "<frames>: record the layers submitted by the next frames (default 300)", [app](const std::string& args) {
+        long frames = args.empty() ? 300 : strtol(args.c_str(), nullptr, 10);
+        if (frames <= 0) return std::string("frame count must be positive\n");
+        layerCaptureRequested = (uint32_t)frames;
+        platformWake(app);
+        return "recording " + std::to_string(frames) + " frames\n";
+    });
+#endif
+    console.start(CONSOLE_SOCKET);
 
     while (true) {
-        int events;
-        android_poll_source* source;
         int timeoutMs = 0; // Always poll for events
 
 #if !defined(TEST_ON_MOBILE)
-        // For VR, block if the session isn't running
-        timeoutMs = !sessionRunning && app->destroyRequested == 0 ? -1 : 0;
+        // For VR, block if the session isn't running, but keep ticking while a recovery or a
+        // freshly recreated session is waiting on the runtime
+        if (!sessionRunning && !app->destroyRequested) {
+            timeoutMs = (xrRecovery != XrRecovery::None || session != XR_NULL_HANDLE) ? 100 : -1;
+        }
 #endif
 
-        if (ALooper_pollOnce(timeoutMs, nullptr, &events, (void**)&source) >= 0) {
-            if (source) {
-                source->process(app, source);
-            }
-        }
+        platformPollEvent(app, timeoutMs);
+#if !defined(TEST_ON_MOBILE)
+        // pollEvents saw XR_SESSION_STATE_EXITING and asked the platform to finish
+        if (sessionState == XR_SESSION_STATE_EXITING) destroyOpenXRSession();
+#endif
 
         if (app->destroyRequested) {
+#if !defined(TEST_ON_MOBILE)
+            std::string tracePath = std::string(app->dataPath) + "/frame_timeline.json";
+            frameTimeline.exportChromeTrace(tracePath.c_str());
+#endif
+            console.stop();
+            glCaptureStop();
             cleanup();
+#if !defined(TEST_ON_MOBILE)
+            layerCapture.stop();
+            sharedMetrics.close();
+#endif
+            profilerReport();
+            profilerExportChromeTrace((std::string(app->dataPath) + "/profile.json").c_str());
+            logFlush();
             return;
         }
 
+        if (captureRequested.exchange(false)) writeCapture(app);
+        if (uint32_t frames = glCaptureRequested.exchange(0)) startGlCapture(app, frames);
+#if !defined(TEST_ON_MOBILE)
+        if (uint32_t frames = layerCaptureRequested.exchange(0)) startLayerCapture(app, frames);
+#endif
+
+        // The frame itself must run without touching the heap; debug builds check it. Shutdown
+        // and the console's capture commands above are free to allocate.
+        AllocGuardFrame frameGuard;
 #if defined(TEST_ON_MOBILE)
         if (eglDisplay != EGL_NO_DISPLAY) {
             renderFrameMobile();
         }
 #else
-        pollEvents();
+        recoverOpenXR(app);
+        pollEvents(app);
         if (sessionRunning) {
             renderFrameVR();
         }
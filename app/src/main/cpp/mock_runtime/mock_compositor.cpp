@@ -0,0 +1,187 @@
+#include "mock_compositor.h"
+#include "mock_pose.h"
+#include "monotonic_clock.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+namespace {
+
+XrVector3f scale(const XrVector3f& v, float s) {
+    return {v.x * s, v.y * s, v.z * s};
+}
+
+XrVector3f add(const XrVector3f& a, const XrVector3f& b) {
+    return {a.x + b.x, a.y + b.y, a.z + b.z};
+}
+
+// Nearest texel at (u, v) in [0, 1), v down from the top of the rect
+inline const uint8_t* texel(const CompositorImage& image, float u, float v) {
+    int32_t x = (int32_t)(u * (float)image.width);
+    int32_t y = (int32_t)(v * (float)image.height);
+    if (x >= image.width) x = image.width - 1;
+    if (y >= image.height) y = image.height - 1;
+    return image.pixels + y * image.stride + x * 4;
+}
+
+inline uint32_t mul255(uint32_t a, uint32_t b) {
+    return (a * b + 127) / 255;
+}
+
+inline void write(uint8_t* dst, const uint8_t* src, const CompositorLayer& layer) {
+    if (!layer.blend) {
+        dst[0] = src[0];
+        dst[1] = src[1];
+        dst[2] = src[2];
+        dst[3] = 255;
+        return;
+    }
+    uint32_t alpha = src[3];
+    for (int c = 0; c < 3; c++) {
+        uint32_t color = layer.unpremultiplied ? mul255(src[c], alpha) : src[c];
+        color += mul255(dst[c], 255 - alpha);
+        dst[c] = (uint8_t)(color > 255 ? 255 : color);
+    }
+    dst[3] = (uint8_t)(alpha + mul255(dst[3], 255 - alpha));
+}
+
+struct FovTangents {
+    float left, right, up, down;
+    explicit FovTangents(const XrFovf& fov)
+        : left(tanf(fov.angleLeft)), right(tanf(fov.angleRight)), up(tanf(fov.angleUp)), down(tanf(fov.angleDown)) {}
+};
+
+// Where a ray in the layer's frame lands on the layer, as (u, v) in [0, 1); false on a miss
+inline bool hitProjection(const XrVector3f& d, const FovTangents& fov, float* u, float* v) {
+    if (d.z >= 0.0f) return false;
+    float tx = d.x / -d.z;
+    float ty = d.y / -d.z;
+    *u = (tx - fov.left) / (fov.right - fov.left);
+    *v = (fov.up - ty) / (fov.up - fov.down);
+    return true;
+}
+
+inline bool hitQuad(const XrVector3f& o, const XrVector3f& d, const XrExtent2Df& size, float* u, float* v) {
+    if (d.z == 0.0f) return false;
+    float t = -o.z / d.z;
+    if (t <= 0.0f) return false;
+    *u = (o.x + t * d.x) / size.width + 0.5f;
+    *v = 0.5f - (o.y + t * d.y) / size.height;
+    return true;
+}
+
+// The image lies on the inside of the arc centred on -Z, around the Y axis
+inline bool hitCylinder(const XrVector3f& o, const XrVector3f& d, const CompositorLayer& layer, float* u, float* v) {
+    float a = d.x * d.x + d.z * d.z;
+    if (a == 0.0f) return false;
+    float b = 2.0f * (o.x * d.x + o.z * d.z);
+    float c = o.x * o.x + o.z * o.z - layer.radius * layer.radius;
+    float discriminant = b * b - 4.0f * a * c;
+    if (discriminant < 0.0f) return false;
+    float t = (-b + sqrtf(discriminant)) / (2.0f * a);
+    if (t <= 0.0f) return false;
+    XrVector3f p{o.x + t * d.x, o.y + t * d.y, o.z + t * d.z};
+    float angle = atan2f(p.x, -p.z);
+    float arcHeight = layer.radius * layer.centralAngle / layer.aspectRatio;
+    *u = angle / layer.centralAngle + 0.5f;
+    *v = 0.5f - p.y / arcHeight;
+    return true;
+}
+
+} // namespace
+
+void MockCompositor::setEyes(uint32_t width, uint32_t height, const XrPosef pose[EYE_COUNT], const XrFovf fov[EYE_COUNT]) {
+    eyeWidth = width;
+    eyeHeight = height;
+    for (uint32_t eye = 0; eye < EYE_COUNT; eye++) {
+        eyePose[eye] = pose[eye];
+        eyeFov[eye] = fov[eye];
+        eyes[eye].assign((size_t)width * height * 4, 0);
+    }
+}
+
+void MockCompositor::beginFrame() {
+    for (std::vector<uint8_t>& eye : eyes) {
+        for (size_t i = 0; i < eye.size(); i += 4) {
+            eye[i] = eye[i + 1] = eye[i + 2] = 0;
+            eye[i + 3] = 255;
+        }
+    }
+}
+
+MockCompositor::Rays MockCompositor::raysIn(uint32_t eye, const XrPosef& frame) const {
+    FovTangents fov(eyeFov[eye]);
+    float columnStep = (fov.right - fov.left) / (float)eyeWidth;
+    float rowStep = (fov.up - fov.down) / (float)eyeHeight;
+
+    // Eye space to the layer's frame
+    XrQuaternionf rotation = quatMultiply(quatConjugate(frame.orientation), eyePose[eye].orientation);
+    Rays rays;
+    rays.origin = poseTransform(poseInvert(frame), eyePose[eye].position);
+    rays.rowStart = quatRotate(rotation, {fov.left + 0.5f * columnStep, fov.up - 0.5f * rowStep, -1.0f});
+    rays.perColumn = quatRotate(rotation, {columnStep, 0.0f, 0.0f});
+    rays.perRow = quatRotate(rotation, {0.0f, -rowStep, 0.0f});
+    return rays;
+}
+
+void MockCompositor::compositeEye(const CompositorLayer& layer, uint32_t eye, CompositorLayerCost* cost) {
+    bool projection = layer.type == CompositorLayer::Projection;
+    const CompositorImage& image = layer.images[projection ? eye : 0];
+    if (image.pixels == nullptr || image.width <= 0 || image.height <= 0) return;
+    Rays rays = raysIn(eye, projection ? layer.viewPose[eye] : layer.pose);
+    FovTangents viewFov(layer.viewFov[eye]);
+
+    uint64_t touched = 0;
+    uint8_t* row = eyes[eye].data();
+    for (uint32_t y = 0; y < eyeHeight; y++, row += eyeWidth * 4) {
+        XrVector3f d = add(rays.rowStart, scale(rays.perRow, (float)y));
+        for (uint32_t x = 0; x < eyeWidth; x++, d = add(d, rays.perColumn)) {
+            float u, v;
+            bool hit;
+            switch (layer.type) {
+                case CompositorLayer::Projection: hit = hitProjection(d, viewFov, &u, &v); break;
+                case CompositorLayer::Quad: hit = hitQuad(rays.origin, d, layer.size, &u, &v); break;
+                default: hit = hitCylinder(rays.origin, d, layer, &u, &v); break;
+            }
+            if (!hit || u < 0.0f || u >= 1.0f || v < 0.0f || v >= 1.0f) continue;
+            write(row + x * 4, texel(image, u, v), layer);
+            touched++;
+        }
+    }
+    cost->pixelsTouched += touched;
+    cost->bytesRead += touched * 4;
+}
+
+CompositorLayerCost MockCompositor::composite(const CompositorLayer& layer) {
+    CompositorLayerCost cost;
+    int64_t start = monotonicNowNs();
+    for (uint32_t eye = 0; eye < EYE_COUNT; eye++) {
+        if (layer.type != CompositorLayer::Projection &&
+            ((layer.eyeVisibility == XR_EYE_VISIBILITY_LEFT && eye != 0) ||
+             (layer.eyeVisibility == XR_EYE_VISIBILITY_RIGHT && eye != 1))) {
+            continue;
+        }
+        compositeEye(layer, eye, &cost);
+    }
+    cost.ns = monotonicNowNs() - start;
+    return cost;
+}
+
+bool MockCompositor::writePpm(const char* path) const {
+    FILE* file = fopen(path, "wb");
+    if (file == nullptr) return false;
+    fprintf(file, "P6\n%u %u\n255\n", eyeWidth * EYE_COUNT, eyeHeight);
+    std::vector<uint8_t> row(eyeWidth * EYE_COUNT * 3);
+    for (uint32_t y = 0; y < eyeHeight; y++) {
+        for (uint32_t eye = 0; eye < EYE_COUNT; eye++) {
+            const uint8_t* src = eyes[eye].data() + (size_t)y * eyeWidth * 4;
+            uint8_t* dst = row.data() + eye * eyeWidth * 3;
+            for (uint32_t x = 0; x < eyeWidth; x++) {
+                memcpy(dst + x * 3, src + x * 4, 3);
+            }
+        }
+        fwrite(row.data(), 1, row.size(), file);
+    }
+    return fclose(file) == 0;
+}
@@ -0,0 +1,94 @@
+#ifndef ANDROIDSAMSUNG_MOCK_COMPOSITOR_H
+#define ANDROIDSAMSUNG_MOCK_COMPOSITOR_H
+
+#include <openxr/openxr.h>
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+// CPU reference compositor: resolves a layer stack into two RGBA8 eye buffers the way a
+// runtime compositor would, so the cost of a layer stack can be counted rather than guessed.
+//
+// Every eye pixel casts a ray from the eye through the pixel centre. A quad is hit on its
+// plane, a cylinder on the inside of its arc, and a projection view is sampled along the
+// ray's direction (rotation-only reprojection). Sampling is nearest-texel from the layer's
+// subImage rect; a layer with XR_COMPOSITION_LAYER_BLEND_TEXTURE_SOURCE_ALPHA_BIT is blended
+// over what is below it (premultiplied unless UNPREMULTIPLIED_ALPHA_BIT), any other layer
+// replaces it. Layers are composited in submission order over black.
+//
+// Per layer it reports the eye pixels written, the texel bytes read and the CPU time, which
+// is what a compositor pays for each layer whatever the app drew into it.
+
+// The subImage rect of a layer's image, RGBA8. Row 0 is the top of the rect; stride may be
+// negative for images stored bottom-up (GL readback).
+struct CompositorImage {
+    const uint8_t* pixels = nullptr;
+    int32_t width = 0;
+    int32_t height = 0;
+    ptrdiff_t stride = 0;
+};
+
+struct CompositorLayer {
+    enum Type { Projection, Quad, Cylinder };
+    Type type = Quad;
+    bool blend = false;            // BLEND_TEXTURE_SOURCE_ALPHA_BIT
+    bool unpremultiplied = false;  // UNPREMULTIPLIED_ALPHA_BIT
+    XrEyeVisibility eyeVisibility = XR_EYE_VISIBILITY_BOTH;
+    // Quad and cylinder: pose in the eyes' frame, and one image for both eyes
+    XrPosef pose{};
+    XrExtent2Df size{};            // quad
+    float radius = 0.0f;           // cylinder
+    float centralAngle = 0.0f;
+    float aspectRatio = 1.0f;
+    // Projection: per eye, the submitted view's pose and fov, and its image
+    XrPosef viewPose[2]{};
+    XrFovf viewFov[2]{};
+    CompositorImage images[2];
+};
+
+struct CompositorLayerCost {
+    uint64_t pixelsTouched = 0;    // eye pixels written, both eyes
+    uint64_t bytesRead = 0;        // texel bytes sampled
+    int64_t ns = 0;
+};
+
+class MockCompositor {
+public:
+    static const uint32_t EYE_COUNT = 2;
+
+    // Eye buffers of width x height; the eyes see through pose/fov (same frame as the layers)
+    void setEyes(uint32_t width, uint32_t height, const XrPosef pose[EYE_COUNT], const XrFovf fov[EYE_COUNT]);
+
+    // Clears both eye buffers to opaque black
+    void beginFrame();
+
+    CompositorLayerCost composite(const CompositorLayer& layer);
+
+    uint32_t width() const { return eyeWidth; }
+    uint32_t height() const { return eyeHeight; }
+    const uint8_t* eyePixels(uint32_t eye) const { return eyes[eye].data(); }
+
+    // Both eyes side by side as a binary PPM. Returns false if the file cannot be written.
+    bool writePpm(const char* path) const;
+
+private:
+    // Ray through pixel (x, y) of an eye is origin + (rowStart + x * perColumn + y * perRow)
+    struct Rays {
+        XrVector3f origin;
+        XrVector3f rowStart;
+        XrVector3f perColumn;
+        XrVector3f perRow;
+    };
+
+    Rays raysIn(uint32_t eye, const XrPosef& frame) const;
+    void compositeEye(const CompositorLayer& layer, uint32_t eye, CompositorLayerCost* cost);
+
+    uint32_t eyeWidth = 0;
+    uint32_t eyeHeight = 0;
+    XrPosef eyePose[EYE_COUNT]{};
+    XrFovf eyeFov[EYE_COUNT]{};
+    std::vector<uint8_t> eyes[EYE_COUNT];
+};
+
+#endif //ANDROIDSAMSUNG_MOCK_COMPOSITOR_H
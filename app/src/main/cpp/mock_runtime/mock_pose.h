@@ -0,0 +1,49 @@
+#ifndef ANDROIDSAMSUNG_MOCK_POSE_H
+#define ANDROIDSAMSUNG_MOCK_POSE_H
+
+#include <openxr/openxr.h>
+
+// Rigid transforms for the mock runtime and its compositor. compose(a, b) maps b's frame
+// into the frame a is expressed in: a point in b, then b into a.
+
+inline XrQuaternionf quatMultiply(const XrQuaternionf& a, const XrQuaternionf& b) {
+    return {a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y,
+            a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x,
+            a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w,
+            a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z};
+}
+
+inline XrQuaternionf quatConjugate(const XrQuaternionf& q) {
+    return {-q.x, -q.y, -q.z, q.w};
+}
+
+inline XrVector3f quatRotate(const XrQuaternionf& q, const XrVector3f& v) {
+    // v + 2w(q x v) + 2 q x (q x v)
+    XrVector3f t{2.0f * (q.y * v.z - q.z * v.y), 2.0f * (q.z * v.x - q.x * v.z), 2.0f * (q.x * v.y - q.y * v.x)};
+    return {v.x + q.w * t.x + (q.y * t.z - q.z * t.y),
+            v.y + q.w * t.y + (q.z * t.x - q.x * t.z),
+            v.z + q.w * t.z + (q.x * t.y - q.y * t.x)};
+}
+
+inline XrPosef poseIdentity() {
+    return {{0.0f, 0.0f, 0.0f, 1.0f}, {0.0f, 0.0f, 0.0f}};
+}
+
+inline XrPosef poseCompose(const XrPosef& a, const XrPosef& b) {
+    XrVector3f p = quatRotate(a.orientation, b.position);
+    return {quatMultiply(a.orientation, b.orientation), {a.position.x + p.x, a.position.y + p.y, a.position.z + p.z}};
+}
+
+inline XrPosef poseInvert(const XrPosef& pose) {
+    XrQuaternionf q = quatConjugate(pose.orientation);
+    XrVector3f p = quatRotate(q, pose.position);
+    return {q, {-p.x, -p.y, -p.z}};
+}
+
+// A point in the pose's frame, expressed in the parent frame
+inline XrVector3f poseTransform(const XrPosef& pose, const XrVector3f& v) {
+    XrVector3f p = quatRotate(pose.orientation, v);
+    return {pose.position.x + p.x, pose.position.y + p.y, pose.position.z + p.z};
+}
+
+#endif //ANDROIDSAMSUNG_MOCK_POSE_H
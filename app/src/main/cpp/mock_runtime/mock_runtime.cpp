@@ -0,0 +1,1476 @@
+// Mock OpenXR runtime for frame-loop benchmarks (see mock_runtime.h).
+//
+// One instance and one session at a time. Core entry points keep their API names and are
+// exported so the library can stand in for libopenxr_loader.so; the library is linked with
+// -Bsymbolic-functions so the pointers xrGetInstanceProcAddr hands out are always these,
+// never the loader's trampolines of the same name. Extension functions are only reachable
+// through xrGetInstanceProcAddr, as with a real runtime.
+
+#include "mock_runtime.h"
+#include "mock_compositor.h"
+#include "mock_pose.h"
+#include "monotonic_clock.h"
+#include "xr_platform.h"
+
+#include <openxr/openxr_reflection.h>
+
+#include <errno.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#define MOCK_EXPORT extern "C" __attribute__((visibility("default")))
+
+// --- Loader negotiation ---
+// Mirrors openxr_loader_negotiation.h, which this tree does not vendor.
+
+enum XrLoaderInterfaceStructs {
+    XR_LOADER_INTERFACE_STRUCT_UNINTIALIZED = 0,
+    XR_LOADER_INTERFACE_STRUCT_LOADER_INFO,
+    XR_LOADER_INTERFACE_STRUCT_API_LAYER_REQUEST,
+    XR_LOADER_INTERFACE_STRUCT_RUNTIME_REQUEST,
+    XR_LOADER_INTERFACE_STRUCT_API_LAYER_CREATE_INFO,
+    XR_LOADER_INTERFACE_STRUCT_API_LAYER_NEXT_INFO,
+    XR_LOADER_INTERFACE_STRUCTS_MAX_ENUM = 0x7FFFFFFF
+};
+
+#define XR_LOADER_INFO_STRUCT_VERSION 1
+#define XR_RUNTIME_INFO_STRUCT_VERSION 1
+#define XR_CURRENT_LOADER_RUNTIME_VERSION 1
+
+struct XrNegotiateLoaderInfo {
+    XrLoaderInterfaceStructs structType;
+    uint32_t structVersion;
+    size_t structSize;
+    uint32_t minInterfaceVersion;
+    uint32_t maxInterfaceVersion;
+    XrVersion minApiVersion;
+    XrVersion maxApiVersion;
+};
+
+struct XrNegotiateRuntimeRequest {
+    XrLoaderInterfaceStructs structType;
+    uint32_t structVersion;
+    size_t structSize;
+    uint32_t runtimeInterfaceVersion;
+    XrVersion runtimeApiVersion;
+    PFN_xrGetInstanceProcAddr getInstanceProcAddr;
+};
+
+namespace {
+
+// --- Extensions ---
+
+enum MockExtension {
+    EXT_OPENGL_ES,
+#if defined(XR_USE_PLATFORM_ANDROID)
+    EXT_ANDROID_CREATE_INSTANCE,
+#endif
+#if defined(XR_USE_PLATFORM_EGL)
+    EXT_EGL,
+#endif
+    EXT_TIMESPEC,
+    EXT_CYLINDER,
+    EXT_LOCATE_SPACES,
+    EXT_REFRESH_RATE,
+    EXT_OVERLAY,
+    EXT_HEADLESS,
+    EXT_COUNT,
+    EXT_NONE = EXT_COUNT
+};
+
+struct ExtensionInfo {
+    const char* name;
+    uint32_t version;
+};
+
+const ExtensionInfo EXTENSIONS[EXT_COUNT] = {
+        {XR_KHR_OPENGL_ES_ENABLE_EXTENSION_NAME, XR_KHR_opengl_es_enable_SPEC_VERSION},
+#if defined(XR_USE_PLATFORM_ANDROID)
+        {XR_KHR_ANDROID_CREATE_INSTANCE_EXTENSION_NAME, XR_KHR_android_create_instance_SPEC_VERSION},
+#endif
+#if defined(XR_USE_PLATFORM_EGL)
+        {XR_MNDX_EGL_ENABLE_EXTENSION_NAME, XR_MNDX_egl_enable_SPEC_VERSION},
+#endif
+        {XR_KHR_CONVERT_TIMESPEC_TIME_EXTENSION_NAME, XR_KHR_convert_timespec_time_SPEC_VERSION},
+        {XR_KHR_COMPOSITION_LAYER_CYLINDER_EXTENSION_NAME, XR_KHR_composition_layer_cylinder_SPEC_VERSION},
+        {XR_KHR_LOCATE_SPACES_EXTENSION_NAME, XR_KHR_locate_spaces_SPEC_VERSION},
+        {XR_FB_DISPLAY_REFRESH_RATE_EXTENSION_NAME, XR_FB_display_refresh_rate_SPEC_VERSION},
+        {XR_EXTX_OVERLAY_EXTENSION_NAME, XR_EXTX_overlay_SPEC_VERSION},
+        {XR_MND_HEADLESS_EXTENSION_NAME, XR_MND_headless_SPEC_VERSION},
+};
+
+// --- Handles ---
+
+const uint32_t MOCK_MAGIC = 0x6b636f6d; // "mock"
+const XrSystemId MOCK_SYSTEM_ID = 1;
+const uint32_t MAX_LAYERS = XR_MOCK_MAX_LAYERS;
+const uint32_t VIEW_COUNT = 2;
+const uint32_t SWAPCHAIN_IMAGE_COUNT = 3;
+const size_t EVENT_QUEUE_RESERVE = 16; // a whole session lifecycle's worth of events
+const uint32_t MAX_IMAGE_SIZE = 4096;
+const float IPD_M = 0.063f;
+const float EYE_HEIGHT_M = 1.6f;   // LOCAL origin above the STAGE floor
+const float STAGE_HALF_EXTENT_M = 1.0f;
+
+enum class MockType : uint32_t { Instance, Session, Space, Swapchain };
+
+// Handles are pointers to these. The magic is cleared on destruction so a stale handle is
+// usually caught rather than used.
+struct MockObject {
+    uint32_t magic = MOCK_MAGIC;
+    MockType type;
+    explicit MockObject(MockType type) : type(type) {}
+    ~MockObject() { magic = 0; }
+};
+
+template <typename T, typename Handle>
+T* lookup(Handle handle) {
+    auto object = reinterpret_cast<MockObject*>(handle);
+    if (object == nullptr || object->magic != MOCK_MAGIC || object->type != T::TYPE) return nullptr;
+    return static_cast<T*>(object);
+}
+
+template <typename Handle>
+Handle toHandle(MockObject* object) {
+    return reinterpret_cast<Handle>(object);
+}
+
+struct MockSession;
+
+struct MockInstance : MockObject {
+    static const MockType TYPE = MockType::Instance;
+    // Room reserved up front, so queueing an event inside the app's frame does not allocate
+    MockInstance() : MockObject(TYPE) { events.reserve(EVENT_QUEUE_RESERVE); }
+
+    XrMockConfig config;
+    bool enabled[EXT_COUNT] = {};
+    std::vector<XrEventDataBuffer> events; // oldest first
+    std::vector<std::string> paths; // XrPath n is paths[n - 1]
+    MockSession* session = nullptr;
+    uint64_t rng = 0;
+    int64_t virtualNowNs = 0;
+};
+
+struct MockSpace : MockObject {
+    static const MockType TYPE = MockType::Space;
+    MockSpace() : MockObject(TYPE) {}
+
+    MockSession* session = nullptr;
+    XrReferenceSpaceType referenceType = XR_REFERENCE_SPACE_TYPE_LOCAL;
+    XrPosef pose{};
+};
+
+struct MockSwapchain : MockObject {
+    static const MockType TYPE = MockType::Swapchain;
+    MockSwapchain() : MockObject(TYPE) {}
+
+    MockSession* session = nullptr;
+    XrSwapchainCreateInfo info{};
+    GLenum target = GL_TEXTURE_2D;
+    std::vector<GLuint> images;
+    // Images are acquired, waited and released in ring order
+    uint32_t oldestAcquired = 0;
+    uint32_t acquired = 0;
+    uint32_t waited = 0;
+    int32_t lastReleased = -1;
+};
+
+struct MockSession : MockObject {
+    static const MockType TYPE = MockType::Session;
+    MockSession() : MockObject(TYPE) {}
+
+    MockInstance* instance = nullptr;
+    XrSessionState state = XR_SESSION_STATE_UNKNOWN;
+    bool running = false;
+    bool exitRequested = false;
+    bool overlay = false;
+    bool headless = false;
+    std::vector<MockSpace*> spaces;
+    std::vector<MockSwapchain*> swapchains;
+
+    // Display
+    std::vector<float> refreshRates;
+    float refreshHz = 0.0f;
+    int64_t periodNs = 0;
+    int64_t lastVsyncNs = 0;    // vsync the most recent xrWaitFrame targeted
+
+    // Frame loop
+    uint32_t framesWaited = 0;  // waited and not yet begun
+    bool frameBegun = false;
+    int64_t waitedVsyncNs = 0;
+    int64_t begunVsyncNs = 0;
+    uint64_t frameIndex = 0;
+
+    // Reference compositor, when configured
+    std::unique_ptr<MockCompositor> compositor;
+    GLuint readFramebuffer = 0;
+    std::vector<uint8_t> readback[MAX_LAYERS * VIEW_COUNT];
+    FILE* csv = nullptr;
+};
+
+// --- Runtime state ---
+
+std::mutex runtimeMutex;
+XrMockConfig pendingConfig;
+bool pendingConfigSet = false;
+MockInstance* currentInstance = nullptr;
+XrMockStats stats;
+
+void readEnvironment(XrMockConfig* config) {
+    const char* value;
+    if ((value = getenv("XR_MOCK_PERIOD_MS")) && atof(value) > 0) config->displayPeriodNs = (int64_t)(atof(value) * 1e6);
+    if ((value = getenv("XR_MOCK_LATENCY_MS"))) config->compositorLatencyNs = (int64_t)(atof(value) * 1e6);
+    if ((value = getenv("XR_MOCK_JITTER_MS"))) config->jitterNs = (int64_t)(atof(value) * 1e6);
+    if ((value = getenv("XR_MOCK_SEED"))) config->seed = strtoull(value, nullptr, 0);
+    if ((value = getenv("XR_MOCK_SHOULD_RENDER")) && *value) {
+        snprintf(config->shouldRender, sizeof(config->shouldRender), "%s", value);
+    }
+    if ((value = getenv("XR_MOCK_CLOCK"))) config->virtualClock = strcmp(value, "virtual") == 0;
+    if ((value = getenv("XR_MOCK_EXIT_AFTER"))) config->exitAfterFrames = strtoull(value, nullptr, 0);
+    if ((value = getenv("XR_MOCK_VIEW_SIZE"))) {
+        unsigned width = 0, height = 0;
+        if (sscanf(value, "%ux%u", &width, &height) == 2 && width > 0 && height > 0) {
+            config->viewWidth = width;
+            config->viewHeight = height;
+        }
+    }
+    if ((value = getenv("XR_MOCK_REPORT"))) config->report = atoi(value) != 0;
+    if ((value = getenv("XR_MOCK_COMPOSITOR"))) config->composite = atoi(value) != 0;
+    if ((value = getenv("XR_MOCK_EYE_SIZE"))) {
+        unsigned width = 0, height = 0;
+        if (sscanf(value, "%ux%u", &width, &height) == 2 && width > 0 && height > 0) {
+            config->eyeWidth = width;
+            config->eyeHeight = height;
+        }
+    }
+    if ((value = getenv("XR_MOCK_COMPOSITOR_CSV"))) snprintf(config->compositorCsv, sizeof(config->compositorCsv), "%s", value);
+    if ((value = getenv("XR_MOCK_COMPOSITOR_DUMP"))) snprintf(config->compositorDump, sizeof(config->compositorDump), "%s", value);
+}
+
+int64_t nowNs(const MockInstance* instance) {
+    return instance->config.virtualClock ? instance->virtualNowNs : monotonicNowNs();
+}
+
+// splitmix64: the jitter sequence depends only on the seed and the number of frames
+uint64_t nextRandom(MockInstance* instance) {
+    uint64_t z = (instance->rng += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+void sleepUntilNs(int64_t deadlineNs) {
+    timespec ts{(time_t)(deadlineNs / 1000000000), (long)(deadlineNs % 1000000000)};
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR) {
+    }
+}
+
+// Two-call idiom: reports the count, fills nothing for a zero capacity
+template <typename Fill>
+XrResult enumerate(uint32_t capacity, uint32_t* countOutput, uint32_t count, bool haveOutput, Fill fill) {
+    if (countOutput == nullptr) return XR_ERROR_VALIDATION_FAILURE;
+    *countOutput = count;
+    if (capacity == 0) return XR_SUCCESS;
+    if (capacity < count) return XR_ERROR_SIZE_INSUFFICIENT;
+    if (!haveOutput) return XR_ERROR_VALIDATION_FAILURE;
+    for (uint32_t i = 0; i < count; i++) fill(i);
+    return XR_SUCCESS;
+}
+
+// --- Events ---
+
+template <typename Event>
+void pushEvent(MockInstance* instance, const Event& event) {
+    static_assert(sizeof(Event) <= sizeof(XrEventDataBuffer), "event does not fit an XrEventDataBuffer");
+    XrEventDataBuffer buffer{};
+    memcpy(&buffer, &event, sizeof(Event));
+    instance->events.push_back(buffer);
+}
+
+void setState(MockSession* session, XrSessionState state) {
+    session->state = state;
+    XrEventDataSessionStateChanged event{XR_TYPE_EVENT_DATA_SESSION_STATE_CHANGED};
+    event.session = toHandle<XrSession>(session);
+    event.state = state;
+    event.time = nowNs(session->instance);
+    pushEvent(session->instance, event);
+}
+
+// Walks a running session down to STOPPING; xrEndSession then takes it to EXITING
+void stopSession(MockSession* session) {
+    session->exitRequested = true;
+    if (session->state == XR_SESSION_STATE_FOCUSED) setState(session, XR_SESSION_STATE_VISIBLE);
+    if (session->state == XR_SESSION_STATE_VISIBLE) setState(session, XR_SESSION_STATE_SYNCHRONIZED);
+    if (session->state == XR_SESSION_STATE_SYNCHRONIZED) setState(session, XR_SESSION_STATE_STOPPING);
+}
+
+// --- Poses ---
+// The head stays at the LOCAL origin looking down -Z; STAGE and LOCAL_FLOOR sit on the floor
+// below it.
+
+const XrFovf EYE_FOV = {-0.785398f, 0.785398f, 0.837758f, -0.872665f};
+
+XrPosef eyePose(uint32_t eye) {
+    XrPosef pose = poseIdentity();
+    pose.position.x = (eye == 0 ? -0.5f : 0.5f) * IPD_M;
+    return pose;
+}
+
+XrPosef spaceInLocal(const MockSpace* space) {
+    XrPosef origin = poseIdentity();
+    if (space->referenceType == XR_REFERENCE_SPACE_TYPE_STAGE ||
+        space->referenceType == XR_REFERENCE_SPACE_TYPE_LOCAL_FLOOR) {
+        origin.position.y = -EYE_HEIGHT_M;
+    }
+    return poseCompose(origin, space->pose);
+}
+
+const XrSpaceLocationFlags FULLY_TRACKED =
+        XR_SPACE_LOCATION_ORIENTATION_VALID_BIT | XR_SPACE_LOCATION_POSITION_VALID_BIT |
+        XR_SPACE_LOCATION_ORIENTATION_TRACKED_BIT | XR_SPACE_LOCATION_POSITION_TRACKED_BIT;
+
+// --- Swapchain images ---
+
+const int64_t SWAPCHAIN_FORMATS[] = {GL_RGBA8, GL_SRGB8_ALPHA8, GL_RGB10_A2, GL_RGBA16F,
+                                     GL_DEPTH_COMPONENT16, GL_DEPTH_COMPONENT24, GL_DEPTH_COMPONENT32F,
+                                     GL_DEPTH24_STENCIL8};
+
+bool formatSupported(int64_t format) {
+    for (int64_t supported : SWAPCHAIN_FORMATS) {
+        if (supported == format) return true;
+    }
+    return false;
+}
+
+// Allocates the images in the app's current context, leaving its texture binding as it was
+bool createImages(MockSwapchain* swapchain, uint32_t count) {
+    const XrSwapchainCreateInfo& info = swapchain->info;
+    GLenum binding;
+    if (info.faceCount == 6) {
+        swapchain->target = GL_TEXTURE_CUBE_MAP;
+        binding = GL_TEXTURE_BINDING_CUBE_MAP;
+    } else if (info.arraySize > 1) {
+        swapchain->target = GL_TEXTURE_2D_ARRAY;
+        binding = GL_TEXTURE_BINDING_2D_ARRAY;
+    } else {
+        swapchain->target = GL_TEXTURE_2D;
+        binding = GL_TEXTURE_BINDING_2D;
+    }
+    while (glGetError() != GL_NO_ERROR) {
+    }
+    GLint previous = 0;
+    glGetIntegerv(binding, &previous);
+    swapchain->images.resize(count);
+    glGenTextures((GLsizei)count, swapchain->images.data());
+    for (GLuint image : swapchain->images) {
+        glBindTexture(swapchain->target, image);
+        if (swapchain->target == GL_TEXTURE_2D_ARRAY) {
+            glTexStorage3D(swapchain->target, (GLsizei)info.mipCount, (GLenum)info.format, (GLsizei)info.width,
+                           (GLsizei)info.height, (GLsizei)info.arraySize);
+        } else {
+            glTexStorage2D(swapchain->target, (GLsizei)info.mipCount, (GLenum)info.format, (GLsizei)info.width,
+                           (GLsizei)info.height);
+        }
+    }
+    glBindTexture(swapchain->target, (GLuint)previous);
+    return glGetError() == GL_NO_ERROR;
+}
+
+void destroySwapchain(MockSwapchain* swapchain) {
+    // Textures belong to the app's context; without it current they go with the context
+    if (!swapchain->images.empty() && eglGetCurrentContext() != EGL_NO_CONTEXT) {
+        glDeleteTextures((GLsizei)swapchain->images.size(), swapchain->images.data());
+    }
+    delete swapchain;
+}
+
+void destroySession(MockSession* session) {
+    const XrMockConfig& config = session->instance->config;
+    if (session->compositor != nullptr && stats.framesComposited > 0 && config.compositorDump[0] != '\0' &&
+        !session->compositor->writePpm(config.compositorDump)) {
+        fprintf(stderr, "xr_mock_runtime: cannot write %s\n", config.compositorDump);
+    }
+    if (session->csv != nullptr) fclose(session->csv);
+    if (session->readFramebuffer != 0 && eglGetCurrentContext() != EGL_NO_CONTEXT) {
+        glDeleteFramebuffers(1, &session->readFramebuffer);
+    }
+    for (MockSwapchain* swapchain : session->swapchains) destroySwapchain(swapchain);
+    for (MockSpace* space : session->spaces) delete space;
+    // Queued state changes would hand the app a dangling handle
+    XrSession handle = toHandle<XrSession>(session);
+    std::vector<XrEventDataBuffer>& events = session->instance->events;
+    for (auto it = events.begin(); it != events.end();) {
+        const auto* changed = reinterpret_cast<const XrEventDataSessionStateChanged*>(&*it);
+        if (it->type == XR_TYPE_EVENT_DATA_SESSION_STATE_CHANGED && changed->session == handle) {
+            it = events.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    session->instance->session = nullptr;
+    delete session;
+}
+
+void printReport() {
+    double layersPerFrame = stats.framesEnded ? (double)stats.layersSubmitted / stats.framesEnded : 0.0;
+    fprintf(stderr,
+            "xr_mock_runtime: %llu frames waited, %llu ended, %llu discarded, %llu missed vsyncs, %llu late, "
+            "%.2f layers/frame, %.1f ms blocked in xrWaitFrame\n",
+            (unsigned long long)stats.framesWaited, (unsigned long long)stats.framesEnded,
+            (unsigned long long)stats.framesDiscarded, (unsigned long long)stats.missedVsyncs,
+            (unsigned long long)stats.lateFrames, layersPerFrame, stats.waitBlockedNs / 1e6);
+    if (stats.framesComposited == 0) return;
+    double frames = (double)stats.framesComposited;
+    fprintf(stderr, "xr_mock_runtime: composited %llu frames, %.2f ms/frame (+%.2f ms/frame GL readback)\n",
+            (unsigned long long)stats.framesComposited, stats.compositeNs / 1e6 / frames, stats.readbackNs / 1e6 / frames);
+    for (uint32_t i = 0; i < MAX_LAYERS; i++) {
+        const XrMockLayerStats& layer = stats.layers[i];
+        if (layer.frames == 0) continue;
+        fprintf(stderr, "  layer %2u: %8.0f px  %10.0f bytes read  %7.3f ms  per frame (%llu frames)\n", i,
+                (double)layer.pixelsTouched / layer.frames, (double)layer.bytesRead / layer.frames,
+                layer.compositeNs / 1e6 / layer.frames, (unsigned long long)layer.frames);
+    }
+}
+
+} // namespace
+
+// --- Instance ---
+
+MOCK_EXPORT XRAPI_ATTR XrResult XRAPI_CALL xrEnumerateApiLayerProperties(uint32_t capacity, uint32_t* count,
+                                                                         XrApiLayerProperties* properties) {
+    return enumerate(capacity, count, 0, properties != nullptr, [](uint32_t) {});
+}
+
+MOCK_EXPORT XRAPI_ATTR XrResult XRAPI_CALL xrEnumerateInstanceExtensionProperties(const char* layerName, uint32_t capacity,
+                                                                                  uint32_t* count, XrExtensionProperties* properties) {
+    if (layerName != nullptr) return XR_ERROR_API_LAYER_NOT_PRESENT;
+    return enumerate(capacity, count, EXT_COUNT, properties != nullptr, [&](uint32_t i) {
+        snprintf(properties[i].extensionName, XR_MAX_EXTENSION_NAME_SIZE, "%s", EXTENSIONS[i].name);
+        properties[i].extensionVersion = EXTENSIONS[i].version;
+    });
+}
+
+MOCK_EXPORT XRAPI_ATTR XrResult XRAPI_CALL xrCreateInstance(const XrInstanceCreateInfo* info, XrInstance* out) {
+    if (info == nullptr || info->type != XR_TYPE_INSTANCE_CREATE_INFO || out == nullptr) return XR_ERROR_VALIDATION_FAILURE;
+    XrVersion apiVersion = info->applicationInfo.apiVersion;
+    if (XR_VERSION_MAJOR(apiVersion) != 1 || XR_VERSION_MINOR(apiVersion) > 1) return XR_ERROR_API_VERSION_UNSUPPORTED;
+    if (info->enabledApiLayerCount > 0) return XR_ERROR_API_LAYER_NOT_PRESENT;
+
+    std::lock_guard<std::mutex> lock(runtimeMutex);
+    if (currentInstance != nullptr) return XR_ERROR_LIMIT_REACHED;
+    auto instance = std::make_unique<MockInstance>();
+    for (uint32_t i = 0; i < info->enabledExtensionCount; i++) {
+        int found = -1;
+        for (int e = 0; e < EXT_COUNT; e++) {
+            if (strcmp(info->enabledExtensionNames[i], EXTENSIONS[e].name) == 0) found = e;
+        }
+        if (found < 0) return XR_ERROR_EXTENSION_NOT_PRESENT;
+        instance->enabled[found] = true;
+    }
+
+    if (!pendingConfigSet) {
+        readEnvironment(&pendingConfig);
+        pendingConfigSet = true;
+    }
+    instance->config = pendingConfig;
+    instance->rng = pendingConfig.seed;
+    instance->virtualNowNs = monotonicNowNs();
+    stats = XrMockStats();
+    currentInstance = instance.release();
+    *out = toHandle<XrInstance>(currentInstance);
+    return XR_SUCCESS;
+}
+
+MOCK_EXPORT XRAPI_ATTR XrResult XRAPI_CALL xrDestroyInstance(XrInstance handle) {
+    std::lock_guard<std::mutex> lock(runtimeMutex);
+    MockInstance* instance = lookup<MockInstance>(handle);
+    if (instance == nullptr) return XR_ERROR_HANDLE_INVALID;
+    if (instance->session != nullptr) destroySession(instance->session);
+    if (instance->config.report) printReport();
+    currentInstance = nullptr;
+    delete instance;
+    return XR_SUCCESS;
+}
+
+MOCK_EXPORT XRAPI_ATTR XrResult XRAPI_CALL xrGetInstanceProperties(XrInstance handle, XrInstanceProperties* properties) {
+    std::lock_guard<std::mutex> lock(runtimeMutex);
+    if (lookup<MockInstance>(handle) == nullptr) return XR_ERROR_HANDLE_INVALID;
+    if (properties == nullptr || properties->type != XR_TYPE_INSTANCE_PROPERTIES) return XR_ERROR_VALIDATION_FAILURE;
+    properties->runtimeVersion = XR_MAKE_VERSION(0, 1, 0);
+    snprintf(properties->runtimeName, XR_MAX_RUNTIME_NAME_SIZE, "xr_mock_runtime");
+    return XR_SUCCESS;
+}
+
+MOCK_EXPORT XRAPI_ATTR XrResult XRAPI_CALL xrPollEvent(XrInstance handle, XrEventDataBuffer* event) {
+    std::lock_guard<std::mutex> lock(runtimeMutex);
+    MockInstance* instance = lookup<MockInstance>(handle);
+    if (instance == nullptr) return XR_ERROR_HANDLE_INVALID;
+    if (event == nullptr || event->type != XR_TYPE_EVENT_DATA_BUFFER) return XR_ERROR_VALIDATION_FAILURE;
+    if (instance->events.empty()) return XR_EVENT_UNAVAILABLE;
+    *event = instance->events.front();
+    instance->events.erase(instance->events.begin());
+    return XR_SUCCESS;
+}
+
+MOCK_EXPORT XRAPI_ATTR XrResult XRAPI_CALL xrResultToString(XrInstance handle, XrResult value, char buffer[XR_MAX_RESULT_STRING_SIZE]) {
+    std::lock_guard<std::mutex> lock(runtimeMutex);
+    if (lookup<MockInstance>(handle) == nullptr) return XR_ERROR_HANDLE_INVALID;
+    switch (value) {
+#define MOCK_RESULT_CASE(name, number) \
+    case name: snprintf(buffer, XR_MAX_RESULT_STRING_SIZE, "%.*s", XR_MAX_RESULT_STRING_SIZE - 1, #name); return XR_SUCCESS;
+        XR_LIST_ENUM_XrResult(MOCK_RESULT_CASE)
+#undef MOCK_RESULT_CASE
+        default: break;
+    }
+    snprintf(buffer, XR_MAX_RESULT_STRING_SIZE, XR_SUCCEEDED(value) ? "XR_UNKNOWN_SUCCESS_%d" : "XR_UNKNOWN_FAILURE_%d", (int)value);
+    return XR_SUCCESS;
+}
+
+MOCK_EXPORT XRAPI_ATTR XrResult XRAPI_CALL xrStructureTypeToString(XrInstance handle, XrStructureType value,
+                                                                   char buffer[XR_MAX_STRUCTURE_NAME_SIZE]) {
+    std::lock_guard<std::mutex> lock(runtimeMutex);
+    if (lookup<MockInstance>(handle) == nullptr) return XR_ERROR_HANDLE_INVALID;
+    switch (value) {
+// A few extension structure names are longer than the buffer; truncate them explicitly
+#define MOCK_STRUCTURE_CASE(name, number) \
+    case name: snprintf(buffer, XR_MAX_STRUCTURE_NAME_SIZE, "%.*s", XR_MAX_STRUCTURE_NAME_SIZE - 1, #name); return XR_SUCCESS;
+        XR_LIST_ENUM_XrStructureType(MOCK_STRUCTURE_CASE)
+#undef MOCK_STRUCTURE_CASE
+        default: break;
+    }
+    snprintf(buffer, XR_MAX_STRUCTURE_NAME_SIZE, "XR_UNKNOWN_STRUCTURE_TYPE_%d", (int)value);
+    return XR_SUCCESS;
+}
+
+MOCK_EXPORT XRAPI_ATTR XrResult XRAPI_CALL xrStringToPath(XrInstance handle, const char* pathString, XrPath* path) {
+    std::lock_guard<std::mutex> lock(runtimeMutex);
+    MockInstance* instance = lookup<MockInstance>(handle);
+    if (instance == nullptr) return XR_ERROR_HANDLE_INVALID;
+    if (pathString == nullptr || path == nullptr) return XR_ERROR_VALIDATION_FAILURE;
+    size_t length = strlen(pathString);
+    if (length == 0 || pathString[0] != '/' || pathString[length - 1] == '/' || length >= XR_MAX_PATH_LENGTH) {
+        return XR_ERROR_PATH_FORMAT_INVALID;
+    }
+    for (size_t i = 0; i < instance->paths.size(); i++) {
+        if (instance->paths[i] == pathString) {
+            *path = i + 1;
+            return XR_SUCCESS;
+        }
+    }
+    instance->paths.emplace_back(pathString);
+    *path = instance->paths.size();
+    return XR_SUCCESS;
+}
+
+MOCK_EXPORT XRAPI_ATTR XrResult XRAPI_CALL xrPathToString(XrInstance handle, XrPath path, uint32_t capacity,
+                                                          uint32_t* count, char* buffer) {
+    std::lock_guard<std::mutex> lock(runtimeMutex);
+    MockInstance* instance = lookup<MockInstance>(handle);
+    if (instance == nullptr) return XR_ERROR_HANDLE_INVALID;
+    if (path == XR_NULL_PATH || path > instance->paths.size()) return XR_ERROR_PATH_INVALID;
+    const std::string& string = instance->paths[path - 1];
+    return enumerate(capacity, count, (uint32_t)string.size() + 1, buffer != nullptr,
+                     [&](uint32_t i) { buffer[i] = string.c_str()[i]; });
+}
+
+// --- System ---
+
+MOCK_EXPORT XRAPI_ATTR XrResult XRAPI_CALL xrGetSystem(XrInstance handle, const XrSystemGetInfo* info, XrSystemId* systemId) {
+    std::lock_guard<std::mutex> lock(runtimeMutex);
+    if (lookup<MockInstance>(handle) == nullptr) return XR_ERROR_HANDLE_INVALID;
+    if (info == nullptr || info->type != XR_TYPE_SYSTEM_GET_INFO || systemId == nullptr) return XR_ERROR_VALIDATION_FAILURE;
+    if (info->formFactor != XR_FORM_FACTOR_HEAD_MOUNTED_DISPLAY) return XR_ERROR_FORM_FACTOR_UNSUPPORTED;
+    *systemId = MOCK_SYSTEM_ID;
+    return XR_SUCCESS;
+}
+
+MOCK_EXPORT XRAPI_ATTR XrResult XRAPI_CALL xrGetSystemProperties(XrInstance handle, XrSystemId systemId, XrSystemProperties* properties) {
+    std::lock_guard<std::mutex> lock(runtimeMutex);
+    if (lookup<MockInstance>(handle) == nullptr) return XR_ERROR_HANDLE_INVALID;
+    if (systemId != MOCK_SYSTEM_ID) return XR_ERROR_SYSTEM_INVALID;
+    if (properties == nullptr || properties->type != XR_TYPE_SYSTEM_PROPERTIES) return XR_ERROR_VALIDATION_FAILURE;
+    properties->systemId = systemId;
+    properties->vendorId = 0;
+    snprintf(properties->systemName, XR_MAX_SYSTEM_NAME_SIZE, "Mock HMD");
+    properties->graphicsProperties.maxSwapchainImageWidth = MAX_IMAGE_SIZE;
+    properties->graphicsProperties.maxSwapchainImageHeight = MAX_IMAGE_SIZE;
+    properties->graphicsProperties.maxLayerCount = MAX_LAYERS;
+    properties->trackingProperties.orientationTracking = XR_TRUE;
+    properties->trackingProperties.positionTracking = XR_TRUE;
+    return XR_SUCCESS;
+}
+
+MOCK_EXPORT XRAPI_ATTR XrResult XRAPI_CALL xrEnumerateViewConfigurations(XrInstance handle, XrSystemId systemId, uint32_t capacity,
+                                                                         uint32_t* count, XrViewConfigurationType* types) {
+    std::lock_guard<std::mutex> lock(runtimeMutex);
+    if (lookup<MockInstance>(handle) == nullptr) return XR_ERROR_HANDLE_INVALID;
+    if (systemId != MOCK_SYSTEM_ID) return XR_ERROR_SYSTEM_INVALID;
+    return enumerate(capacity, count, 1, types != nullptr,
+                     [&](uint32_t i) { types[i] = XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO; });
+}
+
+MOCK_EXPORT XRAPI_ATTR XrResult XRAPI_CALL xrGetViewConfigurationProperties(XrInstance handle, XrSystemId systemId,
+                                                                            XrViewConfigurationType type,
+                                                                            XrViewConfigurationProperties* properties) {
+    std::lock_guard<std::mutex> lock(runtimeMutex);
+    if (lookup<MockInstance>(handle) == nullptr) return XR_ERROR_HANDLE_INVALID;
+    if (systemId != MOCK_SYSTEM_ID) return XR_ERROR_SYSTEM_INVALID;
+    if (type != XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO) return XR_ERROR_VIEW_CONFIGURATION_TYPE_UNSUPPORTED;
+    if (properties == nullptr || properties->type != XR_TYPE_VIEW_CONFIGURATION_PROPERTIES) return XR_ERROR_VALIDATION_FAILURE;
+    properties->viewConfigurationType = type;
+    properties->fovMutable = XR_FALSE;
+    return XR_SUCCESS;
+}
+
+MOCK_EXPORT XRAPI_ATTR XrResult XRAPI_CALL xrEnumerateViewConfigurationViews(XrInstance handle, XrSystemId systemId,
+                                                                             XrViewConfigurationType type, uint32_t capacity,
+                                                                             uint32_t* count, XrViewConfigurationView* views) {
+    std::lock_guard<std::mutex> lock(runtimeMutex);
+    MockInstance* instance = lookup<MockInstance>(handle);
+    if (instance == nullptr) return XR_ERROR_HANDLE_INVALID;
+    if (systemId != MOCK_SYSTEM_ID) return XR_ERROR_SYSTEM_INVALID;
+    if (type != XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO) return XR_ERROR_VIEW_CONFIGURATION_TYPE_UNSUPPORTED;
+    return enumerate(capacity, count, VIEW_COUNT, views != nullptr, [&](uint32_t i) {
+        views[i].recommendedImageRectWidth = instance->config.viewWidth;
+        views[i].maxImageRectWidth = MAX_IMAGE_SIZE;
+        views[i].recommendedImageRectHeight = instance->config.viewHeight;
+        views[i].maxImageRectHeight = MAX_IMAGE_SIZE;
+        views[i].recommendedSwapchainSampleCount = 1;
+        views[i].maxSwapchainSampleCount = 1;
+    });
+}
+
+MOCK_EXPORT XRAPI_ATTR XrResult XRAPI_CALL xrEnumerateEnvironmentBlendModes(XrInstance handle, XrSystemId systemId,
+                                                                            XrViewConfigurationType type, uint32_t capacity,
+                                                                            uint32_t* count, XrEnvironmentBlendMode* modes) {
+    std::lock_guard<std::mutex> lock(runtimeMutex);
+    if (lookup<MockInstance>(handle) == nullptr) return XR_ERROR_HANDLE_INVALID;
+    if (systemId != MOCK_SYSTEM_ID) return XR_ERROR_SYSTEM_INVALID;
+    if (type != XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO) return XR_ERROR_VIEW_CONFIGURATION_TYPE_UNSUPPORTED;
+    return enumerate(capacity, count, 1, modes != nullptr, [&](uint32_t i) { modes[i] = XR_ENVIRONMENT_BLEND_MODE_OPAQUE; });
+}
+
+// --- Session ---
+
+MOCK_EXPORT XRAPI_ATTR XrResult XRAPI_CALL xrCreateSession(XrInstance handle, const XrSessionCreateInfo* info, XrSession* out) {
+    std::lock_guard<std::mutex> lock(runtimeMutex);
+    MockInstance* instance = lookup<MockInstance>(handle);
+    if (instance == nullptr) return XR_ERROR_HANDLE_INVALID;
+    if (info == nullptr || info->type != XR_TYPE_SESSION_CREATE_INFO || out == nullptr) return XR_ERROR_VALIDATION_FAILURE;
+    if (info->systemId != MOCK_SYSTEM_ID) return XR_ERROR_SYSTEM_INVALID;
+    if (instance->session != nullptr) return XR_ERROR_LIMIT_REACHED;
+
+    bool graphics = false;
+    bool overlay = false;
+    for (auto next = reinterpret_cast<const XrBaseInStructure*>(info->next); next != nullptr; next = next->next) {
+#if defined(XR_USE_PLATFORM_ANDROID)
+        if (next->type == XR_TYPE_GRAPHICS_BINDING_OPENGL_ES_ANDROID_KHR) graphics = instance->enabled[EXT_OPENGL_ES];
+#endif
+#if defined(XR_USE_PLATFORM_EGL)
+        if (next->type == XR_TYPE_GRAPHICS_BINDING_EGL_MNDX) graphics = instance->enabled[EXT_OPENGL_ES] && instance->enabled[EXT_EGL];
+#endif
+        if (next->type == XR_TYPE_SESSION_CREATE_INFO_OVERLAY_EXTX) overlay = instance->enabled[EXT_OVERLAY];
+    }
+    if (!graphics && !instance->enabled[EXT_HEADLESS]) return XR_ERROR_GRAPHICS_DEVICE_INVALID;
+
+    auto session = new MockSession;
+    session->instance = instance;
+    session->overlay = overlay;
+    session->headless = !graphics;
+    session->periodNs = instance->config.displayPeriodNs;
+    session->refreshHz = roundf(1e11f / (float)session->periodNs) / 100.0f;
+    // The configured rate plus the usual panel rates, for XR_FB_display_refresh_rate
+    session->refreshRates.push_back(session->refreshHz);
+    for (float rate : {60.0f, 72.0f, 90.0f, 120.0f}) {
+        if (fabsf(rate - session->refreshHz) > 0.01f) session->refreshRates.push_back(rate);
+    }
+    instance->session = session;
+    setState(session, XR_SESSION_STATE_IDLE);
+    setState(session, XR_SESSION_STATE_READY);
+    *out = toHandle<XrSession>(session);
+    return XR_SUCCESS;
+}
+
+MOCK_EXPORT XRAPI_ATTR XrResult XRAPI_CALL xrDestroySession(XrSession handle) {
+    std::lock_guard<std::mutex> lock(runtimeMutex);
+    MockSession* session = lookup<MockSession>(handle);
+    if (session == nullptr) return XR_ERROR_HANDLE_INVALID;
+    destroySession(session);
+    return XR_SUCCESS;
+}
+
+MOCK_EXPORT XRAPI_ATTR XrResult XRAPI_CALL xrBeginSession(XrSession handle, const XrSessionBeginInfo* info) {
+    std::lock_guard<std::mutex> lock(runtimeMutex);
+    MockSession* session = lookup<MockSession>(handle);
+    if (session == nullptr) return XR_ERROR_HANDLE_INVALID;
+    if (info == nullptr || info->type != XR_TYPE_SESSION_BEGIN_INFO) return XR_ERROR_VALIDATION_FAILURE;
+    if (session->running) return XR_ERROR_SESSION_RUNNING;
+    if (session->state != XR_SESSION_STATE_READY) return XR_ERROR_SESSION_NOT_READY;
+    // Headless sessions have no views, so the view configuration is ignored
+    if (!session->headless && info->primaryViewConfigurationType != XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO) {
+        return XR_ERROR_VIEW_CONFIGURATION_TYPE_UNSUPPORTED;
+    }
+    session->running = true;
+    session->framesWaited = 0;
+    session->frameBegun = false;
+    session->lastVsyncNs = nowNs(session->instance);
+    const XrMockConfig& config = session->instance->config;
+    if (config.composite && !session->headless && session->compositor == nullptr) {
+        XrPosef poses[VIEW_COUNT] = {eyePose(0), eyePose(1)};
+        XrFovf fovs[VIEW_COUNT] = {EYE_FOV, EYE_FOV};
+        session->compositor.reset(new MockCompositor());
+        session->compositor->setEyes(config.eyeWidth ? config.eyeWidth : config.viewWidth,
+                                     config.eyeHeight ? config.eyeHeight : config.viewHeight, poses, fovs);
+        if (config.compositorCsv[0] != '\0') {
+            session->csv = fopen(config.compositorCsv, "w");
+            if (session->csv == nullptr) {
+                fprintf(stderr, "xr_mock_runtime: cannot write %s\n", config.compositorCsv);
+            } else {
+                fprintf(session->csv, "frame,layer,type,pixels_touched,bytes_read,composite_us,readback_us\n");
+            }
+        }
+    }
+    setState(session, XR_SESSION_STATE_SYNCHRONIZED);
+    if (session->overlay) {
+        XrEventDataMainSessionVisibilityChangedEXTX visibility{XR_TYPE_EVENT_DATA_MAIN_SESSION_VISIBILITY_CHANGED_EXTX};
+        visibility.visible = XR_TRUE;
+        pushEvent(session->instance, visibility);
+    }
+    return XR_SUCCESS;
+}
+
+MOCK_EXPORT XRAPI_ATTR XrResult XRAPI_CALL xrEndSession(XrSession handle) {
+    std::lock_guard<std::mutex> lock(runtimeMutex);
+    MockSession* session = lookup<MockSession>(handle);
+    if (session == nullptr) return XR_ERROR_HANDLE_INVALID;
+    if (!session->running) return XR_ERROR_SESSION_NOT_RUNNING;
+    if (session->state != XR_SESSION_STATE_STOPPING) return XR_ERROR_SESSION_NOT_STOPPING;
+    session->running = false;
+    setState(session, XR_SESSION_STATE_IDLE);
+    if (session->exitRequested) setState(session, XR_SESSION_STATE_EXITING);
+    return XR_SUCCESS;
+}
+
+MOCK_EXPORT XRAPI_ATTR XrResult XRAPI_CALL xrRequestExitSession(XrSession handle) {
+    std::lock_guard<std::mutex> lock(runtimeMutex);
+    MockSession* session = lookup<MockSession>(handle);
+    if (session == nullptr) return XR_ERROR_HANDLE_INVALID;
+    if (!session->running) return XR_ERROR_SESSION_NOT_RUNNING;
+    stopSession(session);
+    return XR_SUCCESS;
+}
+
+// --- Spaces ---
+
+MOCK_EXPORT XRAPI_ATTR XrResult XRAPI_CALL xrEnumerateReferenceSpaces(XrSession handle, uint32_t capacity, uint32_t* count,
+                                                                      XrReferenceSpaceType* spaces) {
+    static const XrReferenceSpaceType TYPES[] = {XR_REFERENCE_SPACE_TYPE_VIEW, XR_REFERENCE_SPACE_TYPE_LOCAL,
+                                                 XR_REFERENCE_SPACE_TYPE_STAGE, XR_REFERENCE_SPACE_TYPE_LOCAL_FLOOR};
+    std::lock_guard<std::mutex> lock(runtimeMutex);
+    if (lookup<MockSession>(handle) == nullptr) return XR_ERROR_HANDLE_INVALID;
+    return enumerate(capacity, count, 4, spaces != nullptr, [&](uint32_t i) { spaces[i] = TYPES[i]; });
+}
+
+MOCK_EXPORT XRAPI_ATTR XrResult XRAPI_CALL xrCreateReferenceSpace(XrSession handle, const XrReferenceSpaceCreateInfo* info, XrSpace* out) {
+    std::lock_guard<std::mutex> lock(runtimeMutex);
+    MockSession* session = lookup<MockSession>(handle);
+    if (session == nullptr) return XR_ERROR_HANDLE_INVALID;
+    if (info == nullptr || info->type != XR_TYPE_REFERENCE_SPACE_CREATE_INFO || out == nullptr) return XR_ERROR_VALIDATION_FAILURE;
+    switch (info->referenceSpaceType) {
+        case XR_REFERENCE_SPACE_TYPE_VIEW:
+        case XR_REFERENCE_SPACE_TYPE_LOCAL:
+        case XR_REFERENCE_SPACE_TYPE_STAGE:
+        case XR_REFERENCE_SPACE_TYPE_LOCAL_FLOOR: break;
+        default: return XR_ERROR_REFERENCE_SPACE_UNSUPPORTED;
+    }
+    const XrQuaternionf& q = info->poseInReferenceSpace.orientation;
+    if (fabsf(q.x * q.x + q.y * q.y + q.z * q.z + q.w * q.w - 1.0f) > 0.01f) return XR_ERROR_POSE_INVALID;
+
+    auto space = new MockSpace;
+    space->session = session;
+    space->referenceType = info->referenceSpaceType;
+    space->pose = info->poseInReferenceSpace;
+    session->spaces.push_back(space);
+    *out = toHandle<XrSpace>(space);
+    return XR_SUCCESS;
+}
+
+MOCK_EXPORT XRAPI_ATTR XrResult XRAPI_CALL xrGetReferenceSpaceBoundsRect(XrSession handle, XrReferenceSpaceType type, XrExtent2Df* bounds) {
+    std::lock_guard<std::mutex> lock(runtimeMutex);
+    if (lookup<MockSession>(handle) == nullptr) return XR_ERROR_HANDLE_INVALID;
+    if (bounds == nullptr) return XR_ERROR_VALIDATION_FAILURE;
+    if (type == XR_REFERENCE_SPACE_TYPE_STAGE) {
+        *bounds = {2.0f * STAGE_HALF_EXTENT_M, 2.0f * STAGE_HALF_EXTENT_M};
+        return XR_SUCCESS;
+    }
+    *bounds = {0.0f, 0.0f};
+    return XR_SPACE_BOUNDS_UNAVAILABLE;
+}
+
+MOCK_EXPORT XRAPI_ATTR XrResult XRAPI_CALL xrLocateSpace(XrSpace spaceHandle, XrSpace baseHandle, XrTime time, XrSpaceLocation* location) {
+    std::lock_guard<std::mutex> lock(runtimeMutex);
+    MockSpace* space = lookup<MockSpace>(spaceHandle);
+    MockSpace* base = lookup<MockSpace>(baseHandle);
+    if (space == nullptr || base == nullptr) return XR_ERROR_HANDLE_INVALID;
+    if (location == nullptr || location->type != XR_TYPE_SPACE_LOCATION) return XR_ERROR_VALIDATION_FAILURE;
+    if (time <= 0) return XR_ERROR_TIME_INVALID;
+    location->locationFlags = FULLY_TRACKED;
+    location->pose = poseCompose(poseInvert(spaceInLocal(base)), spaceInLocal(space));
+    for (auto next = reinterpret_cast<XrBaseOutStructure*>(location->next); next != nullptr; next = next->next) {
+        if (next->type == XR_TYPE_SPACE_VELOCITY) {
+            auto velocity = reinterpret_cast<XrSpaceVelocity*>(next);
+            velocity->velocityFlags = XR_SPACE_VELOCITY_LINEAR_VALID_BIT | XR_SPACE_VELOCITY_ANGULAR_VALID_BIT;
+            velocity->linearVelocity = {0.0f, 0.0f, 0.0f};
+            velocity->angularVelocity = {0.0f, 0.0f, 0.0f};
+        }
+    }
+    return XR_SUCCESS;
+}
+
+MOCK_EXPORT XRAPI_ATTR XrResult XRAPI_CALL xrLocateSpaces(XrSession handle, const XrSpacesLocateInfo* info, XrSpaceLocations* locations) {
+    std::lock_guard<std::mutex> lock(runtimeMutex);
+    if (lookup<MockSession>(handle) == nullptr) return XR_ERROR_HANDLE_INVALID;
+    if (info == nullptr || info->type != XR_TYPE_SPACES_LOCATE_INFO || locations == nullptr ||
+        locations->type != XR_TYPE_SPACE_LOCATIONS || locations->locationCount != info->spaceCount) {
+        return XR_ERROR_VALIDATION_FAILURE;
+    }
+    if (info->time <= 0) return XR_ERROR_TIME_INVALID;
+    MockSpace* base = lookup<MockSpace>(info->baseSpace);
+    if (base == nullptr) return XR_ERROR_HANDLE_INVALID;
+    XrPosef fromLocal = poseInvert(spaceInLocal(base));
+    for (uint32_t i = 0; i < info->spaceCount; i++) {
+        MockSpace* space = lookup<MockSpace>(info->spaces[i]);
+        if (space == nullptr) return XR_ERROR_HANDLE_INVALID;
+        locations->locations[i].locationFlags = FULLY_TRACKED;
+        locations->locations[i].pose = poseCompose(fromLocal, spaceInLocal(space));
+    }
+    return XR_SUCCESS;
+}
+
+MOCK_EXPORT XRAPI_ATTR XrResult XRAPI_CALL xrDestroySpace(XrSpace handle) {
+    std::lock_guard<std::mutex> lock(runtimeMutex);
+    MockSpace* space = lookup<MockSpace>(handle);
+    if (space == nullptr) return XR_ERROR_HANDLE_INVALID;
+    std::vector<MockSpace*>& spaces = space->session->spaces;
+    spaces.erase(std::remove(spaces.begin(), spaces.end(), space), spaces.end());
+    delete space;
+    return XR_SUCCESS;
+}
+
+// --- Views ---
+
+MOCK_EXPORT XRAPI_ATTR XrResult XRAPI_CALL xrLocateViews(XrSession handle, const XrViewLocateInfo* info, XrViewState* viewState,
+                                                         uint32_t capacity, uint32_t* count, XrView* views) {
+    std::lock_guard<std::mutex> lock(runtimeMutex);
+    MockSession* session = lookup<MockSession>(handle);
+    if (session == nullptr) return XR_ERROR_HANDLE_INVALID;
+    if (info == nullptr || info->type != XR_TYPE_VIEW_LOCATE_INFO || viewState == nullptr || viewState->type != XR_TYPE_VIEW_STATE) {
+        return XR_ERROR_VALIDATION_FAILURE;
+    }
+    if (info->viewConfigurationType != XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO) return XR_ERROR_VIEW_CONFIGURATION_TYPE_UNSUPPORTED;
+    if (info->displayTime <= 0) return XR_ERROR_TIME_INVALID;
+    MockSpace* base = lookup<MockSpace>(info->space);
+    if (base == nullptr) return XR_ERROR_HANDLE_INVALID;
+
+    XrPosef fromLocal = poseInvert(spaceInLocal(base));
+    viewState->viewStateFlags = XR_VIEW_STATE_ORIENTATION_VALID_BIT | XR_VIEW_STATE_POSITION_VALID_BIT |
+                                XR_VIEW_STATE_ORIENTATION_TRACKED_BIT | XR_VIEW_STATE_POSITION_TRACKED_BIT;
+    return enumerate(capacity, count, VIEW_COUNT, views != nullptr, [&](uint32_t i) {
+        views[i].pose = poseCompose(fromLocal, eyePose(i));
+        views[i].fov = EYE_FOV;
+    });
+}
+
+// --- Swapchains ---
+
+MOCK_EXPORT XRAPI_ATTR XrResult XRAPI_CALL xrEnumerateSwapchainFormats(XrSession handle, uint32_t capacity, uint32_t* count, int64_t* formats) {
+    std::lock_guard<std::mutex> lock(runtimeMutex);
+    MockSession* session = lookup<MockSession>(handle);
+    if (session == nullptr) return XR_ERROR_HANDLE_INVALID;
+    uint32_t formatCount = session->headless ? 0 : sizeof(SWAPCHAIN_FORMATS) / sizeof(SWAPCHAIN_FORMATS[0]);
+    return enumerate(capacity, count, formatCount, formats != nullptr, [&](uint32_t i) { formats[i] = SWAPCHAIN_FORMATS[i]; });
+}
+
+MOCK_EXPORT XRAPI_ATTR XrResult XRAPI_CALL xrCreateSwapchain(XrSession handle, const XrSwapchainCreateInfo* info, XrSwapchain* out) {
+    std::lock_guard<std::mutex> lock(runtimeMutex);
+    MockSession* session = lookup<MockSession>(handle);
+    if (session == nullptr) return XR_ERROR_HANDLE_INVALID;
+    if (info == nullptr || info->type != XR_TYPE_SWAPCHAIN_CREATE_INFO || out == nullptr) return XR_ERROR_VALIDATION_FAILURE;
+    // A headless session has no graphics to make images with
+    if (session->headless) return XR_ERROR_VALIDATION_FAILURE;
+    if (!formatSupported(info->format)) return XR_ERROR_SWAPCHAIN_FORMAT_UNSUPPORTED;
+    if (info->width == 0 || info->height == 0 || info->width > MAX_IMAGE_SIZE || info->height > MAX_IMAGE_SIZE ||
+        info->arraySize == 0 || info->mipCount == 0 || (info->faceCount != 1 && info->faceCount != 6)) {
+        return XR_ERROR_VALIDATION_FAILURE;
+    }
+    if (info->sampleCount != 1 || (info->faceCount == 6 && info->arraySize > 1)) return XR_ERROR_FEATURE_UNSUPPORTED;
+    if (eglGetCurrentContext() == EGL_NO_CONTEXT) {
+        fprintf(stderr, "xr_mock_runtime: xrCreateSwapchain needs the session's GL context current\n");
+        return XR_ERROR_RUNTIME_FAILURE;
+    }
+
+    auto swapchain = std::make_unique<MockSwapchain>();
+    swapchain->session = session;
+    swapchain->info = *info;
+    swapchain->info.next = nullptr;
+    bool isStatic = (info->createFlags & XR_SWAPCHAIN_CREATE_STATIC_IMAGE_BIT) != 0;
+    if (!createImages(swapchain.get(), isStatic ? 1 : SWAPCHAIN_IMAGE_COUNT)) {
+        destroySwapchain(swapchain.release());
+        return XR_ERROR_RUNTIME_FAILURE;
+    }
+    session->swapchains.push_back(swapchain.get());
+    *out = toHandle<XrSwapchain>(swapchain.release());
+    return XR_SUCCESS;
+}
+
+MOCK_EXPORT XRAPI_ATTR XrResult XRAPI_CALL xrDestroySwapchain(XrSwapchain handle) {
+    std::lock_guard<std::mutex> lock(runtimeMutex);
+    MockSwapchain* swapchain = lookup<MockSwapchain>(handle);
+    if (swapchain == nullptr) return XR_ERROR_HANDLE_INVALID;
+    std::vector<MockSwapchain*>& swapchains = swapchain->session->swapchains;
+    swapchains.erase(std::remove(swapchains.begin(), swapchains.end(), swapchain), swapchains.end());
+    destroySwapchain(swapchain);
+    return XR_SUCCESS;
+}
+
+MOCK_EXPORT XRAPI_ATTR XrResult XRAPI_CALL xrEnumerateSwapchainImages(XrSwapchain handle, uint32_t capacity, uint32_t* count,
+                                                                      XrSwapchainImageBaseHeader* images) {
+    std::lock_guard<std::mutex> lock(runtimeMutex);
+    MockSwapchain* swapchain = lookup<MockSwapchain>(handle);
+    if (swapchain == nullptr) return XR_ERROR_HANDLE_INVALID;
+    if (images != nullptr && capacity > 0 && images->type != XR_TYPE_SWAPCHAIN_IMAGE_OPENGL_ES_KHR) return XR_ERROR_VALIDATION_FAILURE;
+    auto glesImages = reinterpret_cast<XrSwapchainImageOpenGLESKHR*>(images);
+    return enumerate(capacity, count, (uint32_t)swapchain->images.size(), images != nullptr,
+                     [&](uint32_t i) { glesImages[i].image = swapchain->images[i]; });
+}
+
+MOCK_EXPORT XRAPI_ATTR XrResult XRAPI_CALL xrAcquireSwapchainImage(XrSwapchain handle, const XrSwapchainImageAcquireInfo* info, uint32_t* index) {
+    std::lock_guard<std::mutex> lock(runtimeMutex);
+    MockSwapchain* swapchain = lookup<MockSwapchain>(handle);
+    if (swapchain == nullptr) return XR_ERROR_HANDLE_INVALID;
+    if ((info != nullptr && info->type != XR_TYPE_SWAPCHAIN_IMAGE_ACQUIRE_INFO) || index == nullptr) return XR_ERROR_VALIDATION_FAILURE;
+    uint32_t imageCount = (uint32_t)swapchain->images.size();
+    if (swapchain->acquired == imageCount) return XR_ERROR_CALL_ORDER_INVALID;
+    // A static image can be acquired exactly once
+    bool isStatic = (swapchain->info.createFlags & XR_SWAPCHAIN_CREATE_STATIC_IMAGE_BIT) != 0;
+    if (isStatic && swapchain->lastReleased >= 0) return XR_ERROR_CALL_ORDER_INVALID;
+    *index = (swapchain->oldestAcquired + swapchain->acquired) % imageCount;
+    swapchain->acquired++;
+    return XR_SUCCESS;
+}
+
+MOCK_EXPORT XRAPI_ATTR XrResult XRAPI_CALL xrWaitSwapchainImage(XrSwapchain handle, const XrSwapchainImageWaitInfo* info) {
+    std::lock_guard<std::mutex> lock(runtimeMutex);
+    MockSwapchain* swapchain = lookup<MockSwapchain>(handle);
+    if (swapchain == nullptr) return XR_ERROR_HANDLE_INVALID;
+    if (info == nullptr || info->type != XR_TYPE_SWAPCHAIN_IMAGE_WAIT_INFO) return XR_ERROR_VALIDATION_FAILURE;
+    if (swapchain->waited == swapchain->acquired) return XR_ERROR_CALL_ORDER_INVALID;
+    // Nothing reads the images asynchronously, so they are always ready
+    swapchain->waited++;
+    return XR_SUCCESS;
+}
+
+MOCK_EXPORT XRAPI_ATTR XrResult XRAPI_CALL xrReleaseSwapchainImage(XrSwapchain handle, const XrSwapchainImageReleaseInfo* info) {
+    std::lock_guard<std::mutex> lock(runtimeMutex);
+    MockSwapchain* swapchain = lookup<MockSwapchain>(handle);
+    if (swapchain == nullptr) return XR_ERROR_HANDLE_INVALID;
+    if (info != nullptr && info->type != XR_TYPE_SWAPCHAIN_IMAGE_RELEASE_INFO) return XR_ERROR_VALIDATION_FAILURE;
+    if (swapchain->waited == 0) return XR_ERROR_CALL_ORDER_INVALID;
+    swapchain->lastReleased = (int32_t)swapchain->oldestAcquired;
+    swapchain->oldestAcquired = (swapchain->oldestAcquired + 1) % (uint32_t)swapchain->images.size();
+    swapchain->acquired--;
+    swapchain->waited--;
+    return XR_SUCCESS;
+}
+
+// --- Frame loop ---
+
+MOCK_EXPORT XRAPI_ATTR XrResult XRAPI_CALL xrWaitFrame(XrSession handle, const XrFrameWaitInfo* info, XrFrameState* state) {
+    std::unique_lock<std::mutex> lock(runtimeMutex);
+    MockSession* session = lookup<MockSession>(handle);
+    if (session == nullptr) return XR_ERROR_HANDLE_INVALID;
+    if ((info != nullptr && info->type != XR_TYPE_FRAME_WAIT_INFO) || state == nullptr || state->type != XR_TYPE_FRAME_STATE) {
+        return XR_ERROR_VALIDATION_FAILURE;
+    }
+    if (!session->running) return XR_ERROR_SESSION_NOT_RUNNING;
+    MockInstance* instance = session->instance;
+    const XrMockConfig& config = instance->config;
+
+    // The next vsync after the previous frame's, or the first one not already past
+    int64_t periodNs = session->periodNs;
+    int64_t now = nowNs(instance);
+    int64_t vsync = session->lastVsyncNs + periodNs;
+    if (vsync < now) {
+        int64_t skipped = (now - vsync + periodNs - 1) / periodNs;
+        vsync += skipped * periodNs;
+        stats.missedVsyncs += skipped;
+    }
+    int64_t wakeNs = vsync;
+    if (config.jitterNs > 0) wakeNs += (int64_t)(nextRandom(instance) % (uint64_t)(config.jitterNs + 1));
+
+    bool visible = session->state == XR_SESSION_STATE_VISIBLE || session->state == XR_SESSION_STATE_FOCUSED;
+    size_t patternLength = strlen(config.shouldRender);
+    bool patternRender = patternLength == 0 || config.shouldRender[session->frameIndex % patternLength] != '0';
+
+    session->lastVsyncNs = vsync;
+    session->waitedVsyncNs = vsync;
+    session->framesWaited++;
+    session->frameIndex++;
+    stats.framesWaited++;
+    state->predictedDisplayTime = vsync + periodNs + config.compositorLatencyNs;
+    state->predictedDisplayPeriod = periodNs;
+    state->shouldRender = visible && patternRender ? XR_TRUE : XR_FALSE;
+
+    if (config.virtualClock) {
+        if (wakeNs > instance->virtualNowNs) instance->virtualNowNs = wakeNs;
+        return XR_SUCCESS;
+    }
+    lock.unlock();
+    int64_t sleepStart = monotonicNowNs();
+    if (wakeNs > sleepStart) sleepUntilNs(wakeNs);
+    int64_t blockedNs = monotonicNowNs() - sleepStart;
+    lock.lock();
+    stats.waitBlockedNs += blockedNs;
+    return XR_SUCCESS;
+}
+
+MOCK_EXPORT XRAPI_ATTR XrResult XRAPI_CALL xrBeginFrame(XrSession handle, const XrFrameBeginInfo* info) {
+    std::lock_guard<std::mutex> lock(runtimeMutex);
+    MockSession* session = lookup<MockSession>(handle);
+    if (session == nullptr) return XR_ERROR_HANDLE_INVALID;
+    if (info != nullptr && info->type != XR_TYPE_FRAME_BEGIN_INFO) return XR_ERROR_VALIDATION_FAILURE;
+    if (!session->running) return XR_ERROR_SESSION_NOT_RUNNING;
+    if (session->framesWaited == 0) return XR_ERROR_CALL_ORDER_INVALID;
+    session->framesWaited--;
+    XrResult result = XR_SUCCESS;
+    if (session->frameBegun) {
+        stats.framesDiscarded++;
+        result = XR_FRAME_DISCARDED;
+    }
+    session->frameBegun = true;
+    session->begunVsyncNs = session->waitedVsyncNs;
+    stats.framesBegun++;
+    return result;
+}
+
+namespace {
+
+XrResult validateSubImage(MockSession* session, const XrSwapchainSubImage& subImage) {
+    MockSwapchain* swapchain = lookup<MockSwapchain>(subImage.swapchain);
+    if (swapchain == nullptr || swapchain->session != session) return XR_ERROR_HANDLE_INVALID;
+    if (swapchain->lastReleased < 0) return XR_ERROR_LAYER_INVALID;
+    const XrRect2Di& rect = subImage.imageRect;
+    if (rect.offset.x < 0 || rect.offset.y < 0 || rect.extent.width <= 0 || rect.extent.height <= 0 ||
+        rect.offset.x + rect.extent.width > (int32_t)swapchain->info.width ||
+        rect.offset.y + rect.extent.height > (int32_t)swapchain->info.height) {
+        return XR_ERROR_SWAPCHAIN_RECT_INVALID;
+    }
+    if (subImage.imageArrayIndex >= swapchain->info.arraySize) return XR_ERROR_VALIDATION_FAILURE;
+    return XR_SUCCESS;
+}
+
+XrResult validateLayer(MockSession* session, const XrCompositionLayerBaseHeader* layer) {
+    if (layer == nullptr) return XR_ERROR_LAYER_INVALID;
+    MockSpace* space = lookup<MockSpace>(layer->space);
+    if (space == nullptr || space->session != session) return XR_ERROR_HANDLE_INVALID;
+    switch (layer->type) {
+        case XR_TYPE_COMPOSITION_LAYER_PROJECTION: {
+            auto projection = reinterpret_cast<const XrCompositionLayerProjection*>(layer);
+            if (projection->viewCount != VIEW_COUNT || projection->views == nullptr) return XR_ERROR_VALIDATION_FAILURE;
+            for (uint32_t i = 0; i < projection->viewCount; i++) {
+                XrResult result = validateSubImage(session, projection->views[i].subImage);
+                if (XR_FAILED(result)) return result;
+            }
+            return XR_SUCCESS;
+        }
+        case XR_TYPE_COMPOSITION_LAYER_QUAD:
+            return validateSubImage(session, reinterpret_cast<const XrCompositionLayerQuad*>(layer)->subImage);
+        case XR_TYPE_COMPOSITION_LAYER_CYLINDER_KHR:
+            if (!session->instance->enabled[EXT_CYLINDER]) return XR_ERROR_LAYER_INVALID;
+            return validateSubImage(session, reinterpret_cast<const XrCompositionLayerCylinderKHR*>(layer)->subImage);
+        default:
+            return XR_ERROR_LAYER_INVALID;
+    }
+}
+
+// --- Reference compositor ---
+
+// Copies the subImage rect of the swapchain's last released image out of GL into pixels,
+// leaving the app's framebuffer and pack state as they were. Only 8-bit RGBA formats can be
+// composited; sRGB ones are taken as stored, without decoding.
+bool readSubImage(MockSession* session, const XrSwapchainSubImage& subImage, std::vector<uint8_t>* pixels,
+                  CompositorImage* image) {
+    MockSwapchain* swapchain = lookup<MockSwapchain>(subImage.swapchain);
+    if (swapchain->info.format != GL_RGBA8 && swapchain->info.format != GL_SRGB8_ALPHA8) return false;
+    if (swapchain->target == GL_TEXTURE_CUBE_MAP) return false;
+
+    GLint previousFramebuffer = 0, previousPackBuffer = 0, previousAlignment = 4, previousRowLength = 0;
+    glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &previousFramebuffer);
+    glGetIntegerv(GL_PIXEL_PACK_BUFFER_BINDING, &previousPackBuffer);
+    glGetIntegerv(GL_PACK_ALIGNMENT, &previousAlignment);
+    glGetIntegerv(GL_PACK_ROW_LENGTH, &previousRowLength);
+    if (session->readFramebuffer == 0) glGenFramebuffers(1, &session->readFramebuffer);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, session->readFramebuffer);
+    GLuint texture = swapchain->images[(size_t)swapchain->lastReleased];
+    if (swapchain->target == GL_TEXTURE_2D_ARRAY) {
+        glFramebufferTextureLayer(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, texture, 0, (GLint)subImage.imageArrayIndex);
+    } else {
+        glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture, 0);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glPixelStorei(GL_PACK_ROW_LENGTH, 0);
+
+    const XrRect2Di& rect = subImage.imageRect;
+    pixels->resize((size_t)rect.extent.width * rect.extent.height * 4);
+    glReadPixels(rect.offset.x, rect.offset.y, rect.extent.width, rect.extent.height, GL_RGBA, GL_UNSIGNED_BYTE,
+                 pixels->data());
+
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, (GLuint)previousFramebuffer);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, (GLuint)previousPackBuffer);
+    glPixelStorei(GL_PACK_ALIGNMENT, previousAlignment);
+    glPixelStorei(GL_PACK_ROW_LENGTH, previousRowLength);
+
+    // GL rows run bottom-up: start at the last one and walk backwards
+    image->width = rect.extent.width;
+    image->height = rect.extent.height;
+    image->stride = -(ptrdiff_t)rect.extent.width * 4;
+    image->pixels = pixels->data() + (size_t)(rect.extent.height - 1) * rect.extent.width * 4;
+    return true;
+}
+
+const char* layerTypeName(CompositorLayer::Type type) {
+    switch (type) {
+        case CompositorLayer::Projection: return "projection";
+        case CompositorLayer::Quad: return "quad";
+        default: return "cylinder";
+    }
+}
+
+// Resolves a validated layer stack into the session's eye buffers, in LOCAL space
+void compositeFrame(MockSession* session, const XrFrameEndInfo* info) {
+    if (eglGetCurrentContext() == EGL_NO_CONTEXT) return;
+    MockCompositor* compositor = session->compositor.get();
+    compositor->beginFrame();
+    int64_t frameCompositeNs = 0;
+    for (uint32_t i = 0; i < info->layerCount; i++) {
+        const XrCompositionLayerBaseHeader* header = info->layers[i];
+        XrPosef spacePose = spaceInLocal(lookup<MockSpace>(header->space));
+        CompositorLayer layer;
+        layer.blend = (header->layerFlags & XR_COMPOSITION_LAYER_BLEND_TEXTURE_SOURCE_ALPHA_BIT) != 0;
+        layer.unpremultiplied = (header->layerFlags & XR_COMPOSITION_LAYER_UNPREMULTIPLIED_ALPHA_BIT) != 0;
+
+        int64_t readStart = monotonicNowNs();
+        bool readable = true;
+        if (header->type == XR_TYPE_COMPOSITION_LAYER_PROJECTION) {
+            auto projection = reinterpret_cast<const XrCompositionLayerProjection*>(header);
+            layer.type = CompositorLayer::Projection;
+            for (uint32_t view = 0; view < VIEW_COUNT; view++) {
+                layer.viewPose[view] = poseCompose(spacePose, projection->views[view].pose);
+                layer.viewFov[view] = projection->views[view].fov;
+                readable = readable && readSubImage(session, projection->views[view].subImage,
+                                                    &session->readback[i * VIEW_COUNT + view], &layer.images[view]);
+            }
+        } else if (header->type == XR_TYPE_COMPOSITION_LAYER_QUAD) {
+            auto quad = reinterpret_cast<const XrCompositionLayerQuad*>(header);
+            layer.type = CompositorLayer::Quad;
+            layer.eyeVisibility = quad->eyeVisibility;
+            layer.pose = poseCompose(spacePose, quad->pose);
+            layer.size = quad->size;
+            readable = readSubImage(session, quad->subImage, &session->readback[i * VIEW_COUNT], &layer.images[0]);
+        } else {
+            auto cylinder = reinterpret_cast<const XrCompositionLayerCylinderKHR*>(header);
+            layer.type = CompositorLayer::Cylinder;
+            layer.eyeVisibility = cylinder->eyeVisibility;
+            layer.pose = poseCompose(spacePose, cylinder->pose);
+            layer.radius = cylinder->radius;
+            layer.centralAngle = cylinder->centralAngle;
+            layer.aspectRatio = cylinder->aspectRatio;
+            readable = readSubImage(session, cylinder->subImage, &session->readback[i * VIEW_COUNT], &layer.images[0]);
+        }
+        int64_t readNs = monotonicNowNs() - readStart;
+        stats.readbackNs += readNs;
+        if (!readable) continue;
+
+        CompositorLayerCost cost = compositor->composite(layer);
+        XrMockLayerStats& layerStats = stats.layers[i];
+        layerStats.frames++;
+        layerStats.pixelsTouched += cost.pixelsTouched;
+        layerStats.bytesRead += cost.bytesRead;
+        layerStats.compositeNs += cost.ns;
+        frameCompositeNs += cost.ns;
+        if (session->csv != nullptr) {
+            fprintf(session->csv, "%llu,%u,%s,%llu,%llu,%.1f,%.1f\n", (unsigned long long)stats.framesEnded, i,
+                    layerTypeName(layer.type), (unsigned long long)cost.pixelsTouched,
+                    (unsigned long long)cost.bytesRead, cost.ns / 1e3, readNs / 1e3);
+        }
+    }
+    stats.framesComposited++;
+    stats.compositeNs += frameCompositeNs;
+}
+
+} // namespace
+
+MOCK_EXPORT XRAPI_ATTR XrResult XRAPI_CALL xrEndFrame(XrSession handle, const XrFrameEndInfo* info) {
+    std::lock_guard<std::mutex> lock(runtimeMutex);
+    MockSession* session = lookup<MockSession>(handle);
+    if (session == nullptr) return XR_ERROR_HANDLE_INVALID;
+    if (info == nullptr || info->type != XR_TYPE_FRAME_END_INFO) return XR_ERROR_VALIDATION_FAILURE;
+    if (!session->running) return XR_ERROR_SESSION_NOT_RUNNING;
+    if (!session->frameBegun) return XR_ERROR_CALL_ORDER_INVALID;
+    if (info->displayTime <= 0) return XR_ERROR_TIME_INVALID;
+    if (info->environmentBlendMode != XR_ENVIRONMENT_BLEND_MODE_OPAQUE) return XR_ERROR_ENVIRONMENT_BLEND_MODE_UNSUPPORTED;
+    if (info->layerCount > MAX_LAYERS) return XR_ERROR_LAYER_LIMIT_EXCEEDED;
+    if (info->layerCount > 0 && info->layers == nullptr) return XR_ERROR_VALIDATION_FAILURE;
+    // Like Monado, a headless session has no compositor to hand the layers to, so they are
+    // counted but not looked at: their swapchains cannot exist
+    for (uint32_t i = 0; i < info->layerCount && !session->headless; i++) {
+        XrResult result = validateLayer(session, info->layers[i]);
+        if (XR_FAILED(result)) return result;
+    }
+
+    MockInstance* instance = session->instance;
+    session->frameBegun = false;
+    stats.framesEnded++;
+    stats.layersSubmitted += info->layerCount;
+    // Composited at the vsync after the one the frame woke at; ending after it is too late
+    if (nowNs(instance) > session->begunVsyncNs + session->periodNs) stats.lateFrames++;
+    if (session->compositor != nullptr) compositeFrame(session, info);
+
+    if (session->state == XR_SESSION_STATE_SYNCHRONIZED && !session->exitRequested) {
+        setState(session, XR_SESSION_STATE_VISIBLE);
+        setState(session, XR_SESSION_STATE_FOCUSED);
+    }
+    if (instance->config.exitAfterFrames > 0 && stats.framesEnded == instance->config.exitAfterFrames) {
+        stopSession(session);
+    }
+    return XR_SUCCESS;
+}
+
+// --- Extensions ---
+
+namespace {
+
+XRAPI_ATTR XrResult XRAPI_CALL mockGetOpenGLESGraphicsRequirementsKHR(XrInstance handle, XrSystemId systemId,
+                                                                      XrGraphicsRequirementsOpenGLESKHR* requirements) {
+    std::lock_guard<std::mutex> lock(runtimeMutex);
+    if (lookup<MockInstance>(handle) == nullptr) return XR_ERROR_HANDLE_INVALID;
+    if (systemId != MOCK_SYSTEM_ID) return XR_ERROR_SYSTEM_INVALID;
+    if (requirements == nullptr || requirements->type != XR_TYPE_GRAPHICS_REQUIREMENTS_OPENGL_ES_KHR) return XR_ERROR_VALIDATION_FAILURE;
+    requirements->minApiVersionSupported = XR_MAKE_VERSION(3, 0, 0);
+    requirements->maxApiVersionSupported = XR_MAKE_VERSION(3, 2, 0);
+    return XR_SUCCESS;
+}
+
+// XrTime is CLOCK_MONOTONIC nanoseconds (the virtual clock starts from it too)
+XRAPI_ATTR XrResult XRAPI_CALL mockConvertTimespecTimeToTimeKHR(XrInstance handle, const struct timespec* timespecTime, XrTime* time) {
+    std::lock_guard<std::mutex> lock(runtimeMutex);
+    if (lookup<MockInstance>(handle) == nullptr) return XR_ERROR_HANDLE_INVALID;
+    if (timespecTime == nullptr || time == nullptr) return XR_ERROR_VALIDATION_FAILURE;
+    *time = (XrTime)timespecTime->tv_sec * 1000000000 + timespecTime->tv_nsec;
+    return XR_SUCCESS;
+}
+
+XRAPI_ATTR XrResult XRAPI_CALL mockConvertTimeToTimespecTimeKHR(XrInstance handle, XrTime time, struct timespec* timespecTime) {
+    std::lock_guard<std::mutex> lock(runtimeMutex);
+    if (lookup<MockInstance>(handle) == nullptr) return XR_ERROR_HANDLE_INVALID;
+    if (timespecTime == nullptr) return XR_ERROR_VALIDATION_FAILURE;
+    if (time <= 0) return XR_ERROR_TIME_INVALID;
+    timespecTime->tv_sec = (time_t)(time / 1000000000);
+    timespecTime->tv_nsec = (long)(time % 1000000000);
+    return XR_SUCCESS;
+}
+
+XRAPI_ATTR XrResult XRAPI_CALL mockEnumerateDisplayRefreshRatesFB(XrSession handle, uint32_t capacity, uint32_t* count, float* rates) {
+    std::lock_guard<std::mutex> lock(runtimeMutex);
+    MockSession* session = lookup<MockSession>(handle);
+    if (session == nullptr) return XR_ERROR_HANDLE_INVALID;
+    return enumerate(capacity, count, (uint32_t)session->refreshRates.size(), rates != nullptr,
+                     [&](uint32_t i) { rates[i] = session->refreshRates[i]; });
+}
+
+XRAPI_ATTR XrResult XRAPI_CALL mockGetDisplayRefreshRateFB(XrSession handle, float* rate) {
+    std::lock_guard<std::mutex> lock(runtimeMutex);
+    MockSession* session = lookup<MockSession>(handle);
+    if (session == nullptr) return XR_ERROR_HANDLE_INVALID;
+    if (rate == nullptr) return XR_ERROR_VALIDATION_FAILURE;
+    *rate = session->refreshHz;
+    return XR_SUCCESS;
+}
+
+// Takes effect from the next xrWaitFrame, which targets a vsync one new period after the last
+XRAPI_ATTR XrResult XRAPI_CALL mockRequestDisplayRefreshRateFB(XrSession handle, float rate) {
+    std::lock_guard<std::mutex> lock(runtimeMutex);
+    MockSession* session = lookup<MockSession>(handle);
+    if (session == nullptr) return XR_ERROR_HANDLE_INVALID;
+    if (rate == 0.0f) rate = session->refreshRates[0];
+    float matched = 0.0f;
+    for (float supported : session->refreshRates) {
+        if (fabsf(supported - rate) <= 0.01f) matched = supported;
+    }
+    if (matched == 0.0f) return XR_ERROR_DISPLAY_REFRESH_RATE_UNSUPPORTED_FB;
+    if (matched == session->refreshHz) return XR_SUCCESS;
+
+    XrEventDataDisplayRefreshRateChangedFB event{XR_TYPE_EVENT_DATA_DISPLAY_REFRESH_RATE_CHANGED_FB};
+    event.fromDisplayRefreshRate = session->refreshHz;
+    event.toDisplayRefreshRate = matched;
+    pushEvent(session->instance, event);
+    session->refreshHz = matched;
+    session->periodNs = matched == session->refreshRates[0] ? session->instance->config.displayPeriodNs
+                                                            : (int64_t)llroundf(1e9f / matched);
+    return XR_SUCCESS;
+}
+
+// The loader intercepts this; it is here for apps that link the runtime directly
+XRAPI_ATTR XrResult XRAPI_CALL mockInitializeLoaderKHR(const XrLoaderInitInfoBaseHeaderKHR* info) {
+    return info != nullptr ? XR_SUCCESS : XR_ERROR_VALIDATION_FAILURE;
+}
+
+// Actions, input and haptics resolve to this: the frame-loop benchmarks take no input
+XRAPI_ATTR XrResult XRAPI_CALL mockUnsupported() {
+    return XR_ERROR_FUNCTION_UNSUPPORTED;
+}
+
+struct MockFunction {
+    const char* name;
+    PFN_xrVoidFunction function;
+    MockExtension extension;
+    bool global;  // resolvable without an instance
+};
+
+#define MOCK_CORE(name) {"xr" #name, reinterpret_cast<PFN_xrVoidFunction>(xr##name), EXT_NONE, false}
+#define MOCK_GLOBAL(name) {"xr" #name, reinterpret_cast<PFN_xrVoidFunction>(xr##name), EXT_NONE, true}
+#define MOCK_EXTENSION(name, extension) {"xr" #name, reinterpret_cast<PFN_xrVoidFunction>(mock##name), extension, false}
+
+const MockFunction FUNCTIONS[] = {
+        MOCK_GLOBAL(EnumerateApiLayerProperties),
+        MOCK_GLOBAL(EnumerateInstanceExtensionProperties),
+        MOCK_GLOBAL(CreateInstance),
+        {"xrInitializeLoaderKHR", reinterpret_cast<PFN_xrVoidFunction>(mockInitializeLoaderKHR), EXT_NONE, true},
+        MOCK_CORE(DestroyInstance),
+        MOCK_CORE(GetInstanceProperties),
+        MOCK_CORE(PollEvent),
+        MOCK_CORE(ResultToString),
+        MOCK_CORE(StructureTypeToString),
+        MOCK_CORE(StringToPath),
+        MOCK_CORE(PathToString),
+        MOCK_CORE(GetSystem),
+        MOCK_CORE(GetSystemProperties),
+        MOCK_CORE(EnumerateViewConfigurations),
+        MOCK_CORE(GetViewConfigurationProperties),
+        MOCK_CORE(EnumerateViewConfigurationViews),
+        MOCK_CORE(EnumerateEnvironmentBlendModes),
+        MOCK_CORE(CreateSession),
+        MOCK_CORE(DestroySession),
+        MOCK_CORE(BeginSession),
+        MOCK_CORE(EndSession),
+        MOCK_CORE(RequestExitSession),
+        MOCK_CORE(EnumerateReferenceSpaces),
+        MOCK_CORE(CreateReferenceSpace),
+        MOCK_CORE(GetReferenceSpaceBoundsRect),
+        MOCK_CORE(LocateSpace),
+        MOCK_CORE(LocateSpaces),
+        MOCK_CORE(DestroySpace),
+        MOCK_CORE(LocateViews),
+        MOCK_CORE(EnumerateSwapchainFormats),
+        MOCK_CORE(CreateSwapchain),
+        MOCK_CORE(DestroySwapchain),
+        MOCK_CORE(EnumerateSwapchainImages),
+        MOCK_CORE(AcquireSwapchainImage),
+        MOCK_CORE(WaitSwapchainImage),
+        MOCK_CORE(ReleaseSwapchainImage),
+        MOCK_CORE(WaitFrame),
+        MOCK_CORE(BeginFrame),
+        MOCK_CORE(EndFrame),
+        MOCK_EXTENSION(GetOpenGLESGraphicsRequirementsKHR, EXT_OPENGL_ES),
+        MOCK_EXTENSION(ConvertTimespecTimeToTimeKHR, EXT_TIMESPEC),
+        MOCK_EXTENSION(ConvertTimeToTimespecTimeKHR, EXT_TIMESPEC),
+        {"xrLocateSpacesKHR", reinterpret_cast<PFN_xrVoidFunction>(xrLocateSpaces), EXT_LOCATE_SPACES, false},
+        MOCK_EXTENSION(EnumerateDisplayRefreshRatesFB, EXT_REFRESH_RATE),
+        MOCK_EXTENSION(GetDisplayRefreshRateFB, EXT_REFRESH_RATE),
+        MOCK_EXTENSION(RequestDisplayRefreshRateFB, EXT_REFRESH_RATE),
+};
+
+#undef MOCK_CORE
+#undef MOCK_GLOBAL
+#undef MOCK_EXTENSION
+
+bool isCoreFunction(const char* name) {
+#define MOCK_IS_CORE(fn, feature) || strcmp(name, "xr" #fn) == 0
+    return false XR_LIST_FUNCTIONS_XR_VERSION_1_0(MOCK_IS_CORE);
+#undef MOCK_IS_CORE
+}
+
+} // namespace
+
+MOCK_EXPORT XRAPI_ATTR XrResult XRAPI_CALL xrGetInstanceProcAddr(XrInstance handle, const char* name, PFN_xrVoidFunction* function) {
+    if (name == nullptr || function == nullptr) return XR_ERROR_VALIDATION_FAILURE;
+    *function = nullptr;
+    if (strcmp(name, "xrGetInstanceProcAddr") == 0) {
+        *function = reinterpret_cast<PFN_xrVoidFunction>(xrGetInstanceProcAddr);
+        return XR_SUCCESS;
+    }
+    const MockFunction* entry = nullptr;
+    for (const MockFunction& candidate : FUNCTIONS) {
+        if (strcmp(candidate.name, name) == 0) entry = &candidate;
+    }
+    if (handle == XR_NULL_HANDLE) {
+        if (entry == nullptr || !entry->global) return XR_ERROR_HANDLE_INVALID;
+        *function = entry->function;
+        return XR_SUCCESS;
+    }
+
+    std::lock_guard<std::mutex> lock(runtimeMutex);
+    MockInstance* instance = lookup<MockInstance>(handle);
+    if (instance == nullptr) return XR_ERROR_HANDLE_INVALID;
+    if (entry != nullptr && (entry->extension == EXT_NONE || instance->enabled[entry->extension])) {
+        *function = entry->function;
+        return XR_SUCCESS;
+    }
+    if (entry == nullptr && isCoreFunction(name)) {
+        *function = reinterpret_cast<PFN_xrVoidFunction>(mockUnsupported);
+        return XR_SUCCESS;
+    }
+    return XR_ERROR_FUNCTION_UNSUPPORTED;
+}
+
+MOCK_EXPORT XrResult xrNegotiateLoaderRuntimeInterface(const XrNegotiateLoaderInfo* loaderInfo, XrNegotiateRuntimeRequest* request) {
+    if (loaderInfo == nullptr || request == nullptr ||
+        loaderInfo->structType != XR_LOADER_INTERFACE_STRUCT_LOADER_INFO ||
+        loaderInfo->structVersion != XR_LOADER_INFO_STRUCT_VERSION || loaderInfo->structSize != sizeof(XrNegotiateLoaderInfo) ||
+        request->structType != XR_LOADER_INTERFACE_STRUCT_RUNTIME_REQUEST ||
+        request->structVersion != XR_RUNTIME_INFO_STRUCT_VERSION || request->structSize != sizeof(XrNegotiateRuntimeRequest)) {
+        return XR_ERROR_INITIALIZATION_FAILED;
+    }
+    if (loaderInfo->minInterfaceVersion > XR_CURRENT_LOADER_RUNTIME_VERSION ||
+        loaderInfo->maxInterfaceVersion < XR_CURRENT_LOADER_RUNTIME_VERSION ||
+        XR_VERSION_MAJOR(loaderInfo->minApiVersion) > 1 || XR_VERSION_MAJOR(loaderInfo->maxApiVersion) < 1) {
+        return XR_ERROR_INITIALIZATION_FAILED;
+    }
+    request->runtimeInterfaceVersion = XR_CURRENT_LOADER_RUNTIME_VERSION;
+    request->runtimeApiVersion = XR_CURRENT_API_VERSION;
+    request->getInstanceProcAddr = xrGetInstanceProcAddr;
+    return XR_SUCCESS;
+}
+
+// --- Configuration ---
+
+MOCK_EXPORT void xrMockConfigure(const XrMockConfig* config) {
+    std::lock_guard<std::mutex> lock(runtimeMutex);
+    pendingConfig = *config;
+    if (pendingConfig.displayPeriodNs <= 0) pendingConfig.displayPeriodNs = XrMockConfig().displayPeriodNs;
+    pendingConfigSet = true;
+}
+
+MOCK_EXPORT void xrMockGetStats(XrMockStats* out) {
+    std::lock_guard<std::mutex> lock(runtimeMutex);
+    *out = stats;
+}
@@ -0,0 +1,87 @@
+#ifndef ANDROIDSAMSUNG_MOCK_RUNTIME_H
+#define ANDROIDSAMSUNG_MOCK_RUNTIME_H
+
+#include <stdint.h>
+
+// Deterministic OpenXR runtime for benchmarking the frame loop on a Linux box with no headset
+// and no GPU. Swapchain images are GL textures created in the app's current context, which
+// Mesa's llvmpipe provides; with XR_MND_headless a session needs no graphics at all.
+//
+// Load it through the loader (XR_RUNTIME_JSON=<build>/mock_runtime/mock_runtime.json), or
+// link libxr_mock_runtime.so in place of libopenxr_loader.so: it exports the core xr* entry
+// points and xrGetInstanceProcAddr itself, so tools/frame_replay --runtime can dlopen it too.
+//
+// Display model: a vsync every displayPeriodNs. xrWaitFrame returns at the first vsync after
+// the previous frame's that has not already passed, late by up to jitterNs, and predicts
+// display at that vsync plus one period plus compositorLatencyNs. Vsyncs skipped because the
+// app came back too late are counted as missed; an xrEndFrame after the vsync its frame was
+// due to be composited at is counted as late. With a virtual clock xrWaitFrame never sleeps:
+// time jumps straight to the wakeup, so a run is reproducible regardless of machine load.
+//
+// The session walks IDLE -> READY on creation, SYNCHRONIZED on xrBeginSession, and VISIBLE
+// -> FOCUSED once its first frame is submitted. shouldRender follows the configured pattern
+// while visible.
+//
+// With composite set, every submitted frame is read back from its swapchains and resolved by
+// the CPU reference compositor (mock_compositor.h) into eye buffers, and the cost of each
+// layer lands in XrMockStats::layers.
+
+const uint32_t XR_MOCK_MAX_LAYERS = 16;
+
+struct XrMockConfig {
+    int64_t displayPeriodNs = 11111111;  // 90 Hz
+    int64_t compositorLatencyNs = 0;     // from the compositing vsync to photons
+    int64_t jitterNs = 0;                // xrWaitFrame wakes up to this much after its vsync
+    uint64_t seed = 1;                   // jitter sequence
+    char shouldRender[64] = "1";         // '1'/'0' per frame, repeating
+    bool virtualClock = false;
+    uint64_t exitAfterFrames = 0;        // runtime stops the session after this many frames; 0: never
+    uint32_t viewWidth = 1440;
+    uint32_t viewHeight = 1584;
+    bool report = false;                 // print XrMockStats to stderr when the instance is destroyed
+    bool composite = false;              // run the reference compositor on every submitted frame
+    uint32_t eyeWidth = 0;               // compositor eye buffers; 0: the view size
+    uint32_t eyeHeight = 0;
+    char compositorCsv[256] = "";        // per-layer cost of every composited frame
+    char compositorDump[256] = "";       // last composited frame, as a PPM, when the session ends
+};
+
+// Compositor cost of the layer at one position in the submitted stack
+struct XrMockLayerStats {
+    uint64_t frames = 0;
+    uint64_t pixelsTouched = 0;
+    uint64_t bytesRead = 0;
+    int64_t compositeNs = 0;
+};
+
+// Counters for the current instance (or the last one destroyed)
+struct XrMockStats {
+    uint64_t framesWaited = 0;
+    uint64_t framesBegun = 0;
+    uint64_t framesEnded = 0;
+    uint64_t framesDiscarded = 0;  // begun and then begun again without xrEndFrame
+    uint64_t missedVsyncs = 0;
+    uint64_t lateFrames = 0;
+    uint64_t layersSubmitted = 0;
+    int64_t waitBlockedNs = 0;     // real time spent sleeping in xrWaitFrame
+    uint64_t framesComposited = 0;
+    int64_t compositeNs = 0;
+    int64_t readbackNs = 0;        // copying layer images out of GL, not part of compositeNs
+    XrMockLayerStats layers[XR_MOCK_MAX_LAYERS];
+};
+
+extern "C" {
+
+// Replaces the configuration for instances created afterwards. Until it is called the
+// configuration comes from the environment at the first xrCreateInstance:
+//     XR_MOCK_PERIOD_MS, XR_MOCK_LATENCY_MS, XR_MOCK_JITTER_MS, XR_MOCK_SEED,
+//     XR_MOCK_SHOULD_RENDER (e.g. "1110"), XR_MOCK_CLOCK=virtual, XR_MOCK_EXIT_AFTER (frames),
+//     XR_MOCK_VIEW_SIZE (WxH), XR_MOCK_REPORT=1, XR_MOCK_COMPOSITOR=1, XR_MOCK_EYE_SIZE (WxH),
+//     XR_MOCK_COMPOSITOR_CSV (path), XR_MOCK_COMPOSITOR_DUMP (path)
+void xrMockConfigure(const XrMockConfig* config);
+
+void xrMockGetStats(XrMockStats* stats);
+
+}
+
+#endif //ANDROIDSAMSUNG_MOCK_RUNTIME_H
@@ -0,0 +1,14 @@
+#ifndef ANDROIDSAMSUNG_MONOTONIC_CLOCK_H
+#define ANDROIDSAMSUNG_MONOTONIC_CLOCK_H
+
+#include <stdint.h>
+#include <time.h>
+
+// Single timebase for every timing measurement in the app (CLOCK_MONOTONIC, nanoseconds).
+inline int64_t monotonicNowNs() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+#endif //ANDROIDSAMSUNG_MONOTONIC_CLOCK_H
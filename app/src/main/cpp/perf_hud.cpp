@@ -0,0 +1,262 @@
+#include "perf_hud.h"
+#include "frame_capture.h"
+#include "gl_capture.h"
+
+#include <stdio.h>
+#include <ctype.h>
+#include <unistd.h>
+
+#define LOG_TAG "PerfHud"
+#include "log.h"
+
+// --- 5x7 bitmap font; each row is 5 bits, most significant bit leftmost ---
+static const int GLYPH_W = 5, GLYPH_H = 7;
+static const int SCALE = 2;                       // HUD pixels per font pixel
+static const int ADVANCE = (GLYPH_W + 1) * SCALE;
+static const int LINE_HEIGHT = (GLYPH_H + 2) * SCALE;
+static const int MARGIN = 4;
+
+static const uint8_t DIGITS[10][GLYPH_H] = {
+        {0x0E, 0x11, 0x13, 0x15, 0x19, 0x11, 0x0E}, {0x04, 0x0C, 0x04, 0x04, 0x04, 0x04, 0x0E},
+        {0x0E, 0x11, 0x01, 0x02, 0x04, 0x08, 0x1F}, {0x1F, 0x02, 0x04, 0x02, 0x01, 0x11, 0x0E},
+        {0x02, 0x06, 0x0A, 0x12, 0x1F, 0x02, 0x02}, {0x1F, 0x10, 0x1E, 0x01, 0x01, 0x11, 0x0E},
+        {0x06, 0x08, 0x10, 0x1E, 0x11, 0x11, 0x0E}, {0x1F, 0x01, 0x02, 0x04, 0x08, 0x08, 0x08},
+        {0x0E, 0x11, 0x11, 0x0E, 0x11, 0x11, 0x0E}, {0x0E, 0x11, 0x11, 0x0F, 0x01, 0x02, 0x0C},
+};
+
+static const uint8_t LETTERS[26][GLYPH_H] = {
+        {0x0E, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11}, {0x1E, 0x11, 0x11, 0x1E, 0x11, 0x11, 0x1E}, // A B
+        {0x0E, 0x11, 0x10, 0x10, 0x10, 0x11, 0x0E}, {0x1C, 0x12, 0x11, 0x11, 0x11, 0x12, 0x1C}, // C D
+        {0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x1F}, {0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x10}, // E F
+        {0x0E, 0x11, 0x10, 0x17, 0x11, 0x11, 0x0F}, {0x11, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11}, // G H
+        {0x0E, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0E}, {0x07, 0x02, 0x02, 0x02, 0x02, 0x12, 0x0C}, // I J
+        {0x11, 0x12, 0x14, 0x18, 0x14, 0x12, 0x11}, {0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x1F}, // K L
+        {0x11, 0x1B, 0x15, 0x15, 0x11, 0x11, 0x11}, {0x11, 0x11, 0x19, 0x15, 0x13, 0x11, 0x11}, // M N
+        {0x0E, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E}, {0x1E, 0x11, 0x11, 0x1E, 0x10, 0x10, 0x10}, // O P
+        {0x0E, 0x11, 0x11, 0x11, 0x15, 0x12, 0x0D}, {0x1E, 0x11, 0x11, 0x1E, 0x14, 0x12, 0x11}, // Q R
+        {0x0F, 0x10, 0x10, 0x0E, 0x01, 0x01, 0x1E}, {0x1F, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04}, // S T
+        {0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E}, {0x11, 0x11, 0x11, 0x11, 0x11, 0x0A, 0x04}, // U V
+        {0x11, 0x11, 0x11, 0x15, 0x15, 0x15, 0x0A}, {0x11, 0x11, 0x0A, 0x04, 0x0A, 0x11, 0x11}, // W X
+        {0x11, 0x11, 0x11, 0x0A, 0x04, 0x04, 0x04}, {0x1F, 0x01, 0x02, 0x04, 0x08, 0x10, 0x1F}, // Y Z
+};
+
+static const uint8_t BLANK[GLYPH_H] = {};
+static const uint8_t DOT[GLYPH_H] = {0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C};
+static const uint8_t COLON[GLYPH_H] = {0x00, 0x0C, 0x0C, 0x00, 0x0C, 0x0C, 0x00};
+static const uint8_t SLASH[GLYPH_H] = {0x00, 0x01, 0x02, 0x04, 0x08, 0x10, 0x00};
+static const uint8_t PERCENT[GLYPH_H] = {0x18, 0x19, 0x02, 0x04, 0x08, 0x13, 0x03};
+static const uint8_t DASH[GLYPH_H] = {0x00, 0x00, 0x00, 0x1F, 0x00, 0x00, 0x00};
+
+static const uint8_t* glyphFor(char c) {
+    if (c >= '0' && c <= '9') return DIGITS[c - '0'];
+    c = (char)toupper((unsigned char)c);
+    if (c >= 'A' && c <= 'Z') return LETTERS[c - 'A'];
+    switch (c) {
+        case '.': return DOT;
+        case ':': return COLON;
+        case '/': return SLASH;
+        case '%': return PERCENT;
+        case '-': return DASH;
+        default: return BLANK;
+    }
+}
+
+// Resident set size from /proc/self/statm, 0 if unavailable
+static uint64_t residentBytes() {
+    FILE* file = fopen("/proc/self/statm", "r");
+    if (!file) return 0;
+    unsigned long long size = 0, resident = 0;
+    int fields = fscanf(file, "%llu %llu", &size, &resident);
+    fclose(file);
+    return fields == 2 ? resident * (uint64_t)sysconf(_SC_PAGESIZE) : 0;
+}
+
+bool PerfHud::init(const XrDispatchTable* dispatch, XrSession session, XrStructureType imageType) {
+    xr = dispatch;
+
+    swapchainInfo = {XR_TYPE_SWAPCHAIN_CREATE_INFO};
+    swapchainInfo.usageFlags = XR_SWAPCHAIN_USAGE_COLOR_ATTACHMENT_BIT;
+    swapchainInfo.format = GL_RGBA8;
+    swapchainInfo.sampleCount = 1;
+    swapchainInfo.width = WIDTH;
+    swapchainInfo.height = HEIGHT;
+    swapchainInfo.faceCount = 1;
+    swapchainInfo.arraySize = 1;
+    swapchainInfo.mipCount = 1;
+    if (XR_FAILED(xr->CreateSwapchain(session, &swapchainInfo, &swapchain))) {
+        LOGE("Failed to create the HUD swapchain");
+        swapchain = XR_NULL_HANDLE;
+        return false;
+    }
+
+    spaceInfo = {XR_TYPE_REFERENCE_SPACE_CREATE_INFO, nullptr, XR_REFERENCE_SPACE_TYPE_VIEW, {{0, 0, 0, 1}, {0, 0, 0}}};
+    if (XR_FAILED(xr->CreateReferenceSpace(session, &spaceInfo, &space))) {
+        LOGE("Failed to create the HUD space");
+        space = XR_NULL_HANDLE;
+        destroy();
+        return false;
+    }
+
+    // The GL and GLES image structs share a layout; only the type differs
+    uint32_t imageCount = 0;
+    std::vector<XrSwapchainImageOpenGLESKHR> images;
+    XrResult result = xr->EnumerateSwapchainImages(swapchain, 0, &imageCount, nullptr);
+    if (XR_SUCCEEDED(result)) {
+        images.resize(imageCount, {imageType});
+        result = xr->EnumerateSwapchainImages(swapchain, imageCount, &imageCount,
+                                              reinterpret_cast<XrSwapchainImageBaseHeader*>(images.data()));
+    }
+    if (XR_FAILED(result) || imageCount == 0) {
+        LOGE("Failed to enumerate the HUD swapchain images: %d", result);
+        destroy();
+        return false;
+    }
+    framebuffers.resize(imageCount);
+    glGenFramebuffers(imageCount, framebuffers.data());
+    for (uint32_t i = 0; i < imageCount; ++i) {
+        glCaptureDescribeTexture(images[i].image, GL_TEXTURE_2D, GL_RGBA8, WIDTH, HEIGHT, 1);
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffers[i]);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, images[i].image, 0);
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    // Low in the field of view, 0.8 m out; one millimetre per HUD pixel
+    quad = {XR_TYPE_COMPOSITION_LAYER_QUAD};
+    quad.layerFlags = XR_COMPOSITION_LAYER_BLEND_TEXTURE_SOURCE_ALPHA_BIT;
+    quad.space = space;
+    quad.eyeVisibility = XR_EYE_VISIBILITY_BOTH;
+    quad.subImage = {swapchain, {{0, 0}, {(int32_t)WIDTH, (int32_t)HEIGHT}}, 0};
+    quad.pose = {{0, 0, 0, 1}, {0.0f, -0.25f, -0.8f}};
+    quad.size = {WIDTH / 1000.0f, HEIGHT / 1000.0f};
+
+    drawn = false;
+    intervalStartNs = 0;
+    lastWaitNs = 0;
+    LOGI("HUD ready: %ux%u, %u images", WIDTH, HEIGHT, imageCount);
+    return true;
+}
+
+void PerfHud::destroy() {
+    if (!framebuffers.empty()) glDeleteFramebuffers((GLsizei)framebuffers.size(), framebuffers.data());
+    framebuffers.clear();
+    if (space) xr->DestroySpace(space);
+    if (swapchain) xr->DestroySwapchain(swapchain);
+    space = XR_NULL_HANDLE;
+    swapchain = XR_NULL_HANDLE;
+    drawn = false;
+}
+
+void PerfHud::onGpuTime(int64_t gpuNs) {
+    gpuSumNs += gpuNs;
+    gpuSamples++;
+}
+
+bool PerfHud::onEndFrame(int64_t waitReturnNs, int64_t nowNs, uint64_t droppedFrames, uint32_t layerCount,
+                         int64_t displayPeriodNs) {
+    if (!swapchain) return false;
+    if (lastWaitNs != 0) {
+        int64_t frameNs = waitReturnNs - lastWaitNs;
+        if (frameNs > worstFrameNs) worstFrameNs = frameNs;
+    }
+    lastWaitNs = waitReturnNs;
+    int64_t cpuNs = nowNs - waitReturnNs;
+    cpuSumNs += cpuNs;
+    if (cpuNs > cpuMaxNs) cpuMaxNs = cpuNs;
+    frames++;
+
+    if (intervalStartNs == 0) intervalStartNs = nowNs;
+    if (nowNs - intervalStartNs < REDRAW_INTERVAL_NS && drawn) return false;
+    bool redrew = redraw(nowNs, droppedFrames, layerCount, displayPeriodNs);
+
+    intervalStartNs = nowNs;
+    frames = 0;
+    cpuSumNs = cpuMaxNs = worstFrameNs = 0;
+    gpuSumNs = 0;
+    gpuSamples = 0;
+    return redrew;
+}
+
+void PerfHud::fill(int x, int y, int width, int height) const {
+    glScissor(x, (GLint)HEIGHT - y - height, width, height);
+    glClear(GL_COLOR_BUFFER_BIT);
+}
+
+void PerfHud::drawText(int column, int line, const char* text) const {
+    int originX = MARGIN + column * ADVANCE;
+    int originY = MARGIN + line * LINE_HEIGHT;
+    for (int i = 0; text[i] && originX + (i + 1) * ADVANCE <= (int)WIDTH; ++i) {
+        const uint8_t* glyph = glyphFor(text[i]);
+        int x0 = originX + i * ADVANCE;
+        for (int row = 0; row < GLYPH_H; ++row) {
+            uint8_t bits = glyph[row];
+            // One clear per run of lit pixels
+            for (int col = 0; col < GLYPH_W;) {
+                if (!(bits & (0x10 >> col))) {
+                    col++;
+                    continue;
+                }
+                int start = col;
+                while (col < GLYPH_W && (bits & (0x10 >> col))) col++;
+                fill(x0 + start * SCALE, originY + row * SCALE, (col - start) * SCALE, SCALE);
+            }
+        }
+    }
+}
+
+bool PerfHud::redraw(int64_t nowNs, uint64_t droppedFrames, uint32_t layerCount, int64_t displayPeriodNs) {
+    history[historyNext] = worstFrameNs;
+    historyNext = (historyNext + 1) % HISTORY;
+
+    uint32_t imageIndex;
+    if (XR_FAILED(xr->AcquireSwapchainImage(swapchain, nullptr, &imageIndex))) return false;
+    XrSwapchainImageWaitInfo waitInfo{XR_TYPE_SWAPCHAIN_IMAGE_WAIT_INFO, nullptr, XR_INFINITE_DURATION};
+    xr->WaitSwapchainImage(swapchain, &waitInfo);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffers[imageIndex]);
+    glViewport(0, 0, WIDTH, HEIGHT);
+    glClearColor(0.0f, 0.0f, 0.0f, 0.6f);
+    glClear(GL_COLOR_BUFFER_BIT);
+    glEnable(GL_SCISSOR_TEST);
+
+    double seconds = (nowNs - intervalStartNs) / 1e9;
+    char line[40];
+    glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
+    snprintf(line, sizeof(line), "FPS %5.1f  DROP %llu", seconds > 0 ? frames / seconds : 0.0, (unsigned long long)droppedFrames);
+    drawText(0, 0, line);
+    snprintf(line, sizeof(line), "CPU %5.2f MS MAX %5.2f", frames ? cpuSumNs / 1e6 / frames : 0.0, cpuMaxNs / 1e6);
+    drawText(0, 1, line);
+    if (gpuSamples > 0) {
+        snprintf(line, sizeof(line), "GPU %5.2f MS", gpuSumNs / 1e6 / gpuSamples);
+    } else {
+        snprintf(line, sizeof(line), "GPU  -");
+    }
+    drawText(0, 2, line);
+    snprintf(line, sizeof(line), "LAYERS %u  MEM %llu MB", layerCount, (unsigned long long)(residentBytes() >> 20));
+    drawText(0, 3, line);
+
+    // Sparkline of the worst frame per redraw, scaled to two display periods, with a line
+    // at one period; columns over it are red
+    int sparkTop = MARGIN + 4 * LINE_HEIGHT + MARGIN;
+    int sparkHeight = (int)HEIGHT - MARGIN - sparkTop;
+    int columnWidth = (int)WIDTH / HISTORY;
+    int64_t scaleNs = displayPeriodNs > 0 ? 2 * displayPeriodNs : 2 * 16666667;
+    glClearColor(0.5f, 0.5f, 0.5f, 1.0f);
+    fill(0, sparkTop + sparkHeight / 2, WIDTH, 1);
+    for (int i = 0; i < HISTORY; ++i) {
+        int64_t ns = history[(historyNext + i) % HISTORY];
+        if (ns <= 0) continue;
+        int height = (int)(ns * sparkHeight / scaleNs);
+        if (height > sparkHeight) height = sparkHeight;
+        if (height < 1) height = 1;
+        bool late = ns > scaleNs / 2 + scaleNs / 40; // more than 5% over one period
+        glClearColor(late ? 1.0f : 0.2f, late ? 0.2f : 1.0f, 0.2f, 1.0f);
+        fill(i * columnWidth, sparkTop + sparkHeight - height, columnWidth - 1, height);
+    }
+
+    glDisable(GL_SCISSOR_TEST);
+    if (hashContent) lastHash = frameCaptureHashFramebuffer(WIDTH, HEIGHT);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    xr->ReleaseSwapchainImage(swapchain, nullptr);
+    drawn = true;
+    return true;
+}
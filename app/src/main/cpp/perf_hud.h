@@ -0,0 +1,90 @@
+#ifndef ANDROIDSAMSUNG_PERF_HUD_H
+#define ANDROIDSAMSUNG_PERF_HUD_H
+
+#include <stdint.h>
+#include <vector>
+
+#include "xr_dispatch.h"
+
+// Head-locked performance readout: FPS, CPU and GPU frame time, dropped frames, layer count
+// and resident memory, above a sparkline of the worst frame time in each redraw interval.
+//
+// The HUD is a quad layer with its own small swapchain. It is only redrawn every
+// REDRAW_INTERVAL_NS; between redraws the compositor keeps showing the last released image,
+// so most frames pay for nothing more than one extra layer. Text is drawn without shaders
+// as scissored clears of a 5x7 bitmap font, one clear per horizontal run of lit pixels.
+//
+// Frame thread only, with the session's GL context current.
+//
+//     hud.init(&xr, session, platformXrSwapchainImageType(app));
+//     capture.addSwapchain(hud.swapchainHandle(), hud.swapchainCreateInfo()); // if recording layers
+//     ...
+//     if (XrCompositionLayerBaseHeader* hudLayer = hud.layer()) layers.push_back(hudLayer);
+//     xr.EndFrame(...);
+//     if (hud.onEndFrame(waitReturnNs, monotonicNowNs(), stats.droppedFrames(), layerCount, period)) ...
+class PerfHud {
+public:
+    static constexpr uint32_t WIDTH = 320;
+    static constexpr uint32_t HEIGHT = 160;
+    static constexpr int64_t REDRAW_INTERVAL_NS = 250000000;
+    static constexpr int HISTORY = 64; // sparkline columns, one per redraw
+
+    // Creates the swapchain and a VIEW space to hold the quad. `imageType` is the swapchain
+    // image struct of the graphics binding in use (platformXrSwapchainImageType()). `xr` must
+    // stay valid until destroy().
+    bool init(const XrDispatchTable* xr, XrSession session, XrStructureType imageType);
+    void destroy();
+
+    // Accumulates one frame and redraws if the interval is up; true if it redrew. Call after
+    // xrEndFrame with the time xrWaitFrame returned; a GPU result, when there is one, goes to
+    // onGpuTime() first.
+    bool onEndFrame(int64_t waitReturnNs, int64_t nowNs, uint64_t droppedFrames, uint32_t layerCount,
+                    int64_t displayPeriodNs);
+    void onGpuTime(int64_t gpuNs);
+
+    // The quad to submit, or nullptr before the first redraw
+    XrCompositionLayerBaseHeader* layer() {
+        return drawn ? reinterpret_cast<XrCompositionLayerBaseHeader*>(&quad) : nullptr;
+    }
+
+    // What init() created, so a FrameCapture can describe the quad
+    XrSwapchain swapchainHandle() const { return swapchain; }
+    const XrSwapchainCreateInfo& swapchainCreateInfo() const { return swapchainInfo; }
+    XrSpace spaceHandle() const { return space; }
+    const XrReferenceSpaceCreateInfo& spaceCreateInfo() const { return spaceInfo; }
+
+    // While set, each redraw hashes the image it drew into contentHash(). A full readback, so
+    // only while capturing.
+    void setHashContent(bool enabled) { hashContent = enabled; }
+    uint64_t contentHash() const { return lastHash; }
+
+private:
+    bool redraw(int64_t nowNs, uint64_t droppedFrames, uint32_t layerCount, int64_t displayPeriodNs);
+    void drawText(int column, int line, const char* text) const;
+    void fill(int x, int y, int width, int height) const; // top-left origin
+
+    const XrDispatchTable* xr = nullptr;
+    XrSwapchain swapchain = XR_NULL_HANDLE;
+    XrSpace space = XR_NULL_HANDLE;
+    XrSwapchainCreateInfo swapchainInfo = {XR_TYPE_SWAPCHAIN_CREATE_INFO};
+    XrReferenceSpaceCreateInfo spaceInfo = {XR_TYPE_REFERENCE_SPACE_CREATE_INFO};
+    std::vector<GLuint> framebuffers;
+    XrCompositionLayerQuad quad = {XR_TYPE_COMPOSITION_LAYER_QUAD};
+    bool drawn = false;
+    bool hashContent = false;
+    uint64_t lastHash = 0;
+
+    // Current interval
+    int64_t intervalStartNs = 0;
+    int64_t lastWaitNs = 0;
+    uint32_t frames = 0;
+    int64_t cpuSumNs = 0, cpuMaxNs = 0, worstFrameNs = 0;
+    int64_t gpuSumNs = 0;
+    uint32_t gpuSamples = 0;
+
+    // Worst frame time per redraw, oldest first from historyNext
+    int64_t history[HISTORY] = {};
+    int historyNext = 0;
+};
+
+#endif //ANDROIDSAMSUNG_PERF_HUD_H
@@ -0,0 +1,109 @@
+#include "pipeline_warmup.h"
+#include "gl_capture.h"
+#include "monotonic_clock.h"
+#include "profiler.h"
+
+#define LOG_TAG "PipelineWarmup"
+#include "log.h"
+
+// Warm-up target. Formats match the swapchain and depth buffer used for real rendering so the
+// driver builds the same variants.
+static const GLsizei WARMUP_SIZE = 4;
+
+static const float IDENTITY[16] = {1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1};
+
+int PipelineRegistry::add(const PipelineState& state) {
+    Entry entry;
+    entry.state = state;
+    entries.push_back(entry);
+    return (int)entries.size() - 1;
+}
+
+void PipelineRegistry::bind(int id) {
+    const PipelineState& state = entries[id].state;
+    glUseProgram(state.program);
+    if (state.depthTest) {
+        glEnable(GL_DEPTH_TEST);
+        glDepthFunc(GL_LESS);
+    } else {
+        glDisable(GL_DEPTH_TEST);
+    }
+    glDepthMask(state.depthWrite ? GL_TRUE : GL_FALSE);
+    if (state.blend) {
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    } else {
+        glDisable(GL_BLEND);
+    }
+    bound = id;
+}
+
+void PipelineRegistry::unbind() {
+    glDepthMask(GL_TRUE);
+    glDisable(GL_BLEND);
+    glDisable(GL_DEPTH_TEST);
+    bound = -1;
+}
+
+void PipelineRegistry::draw(GLenum mode, GLsizei count, GLenum type) {
+    if (bound < 0 || entries[bound].used) {
+        glDrawElements(mode, count, type, 0);
+        return;
+    }
+
+    Entry& entry = entries[bound];
+    int64_t start = monotonicNowNs();
+    glDrawElements(mode, count, type, 0);
+    float ms = (monotonicNowNs() - start) / 1e6f;
+    entry.used = true;
+    if (ms > hitchThresholdMs) {
+        LOGW("First draw with pipeline '%s' took %.2f ms (threshold %.2f ms, warm-up took %.2f ms)",
+             entry.state.name, ms, hitchThresholdMs, entry.warmUpMs);
+    }
+}
+
+void PipelineRegistry::warmUp(GLuint vao, GLsizei indexCount, GLenum indexType) {
+    PROFILE_ZONE("pipeline warm-up");
+    GLuint color = 0, depth = 0, framebuffer = 0;
+    glGenRenderbuffers(1, &color);
+    glBindRenderbuffer(GL_RENDERBUFFER, color);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, WARMUP_SIZE, WARMUP_SIZE);
+    glGenRenderbuffers(1, &depth);
+    glBindRenderbuffer(GL_RENDERBUFFER, depth);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, WARMUP_SIZE, WARMUP_SIZE);
+
+    glGenFramebuffers(1, &framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, color);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depth);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        LOGE("Warm-up framebuffer incomplete, skipping pipeline warm-up");
+    } else {
+        glViewport(0, 0, WARMUP_SIZE, WARMUP_SIZE);
+        glBindVertexArray(vao);
+        int64_t total = monotonicNowNs();
+        for (int id = 0; id < (int)entries.size(); ++id) {
+            int64_t start = monotonicNowNs();
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+            bind(id);
+            // Location -1, for a uniform the program does not have, makes these no-ops
+            GLuint program = entries[id].state.program;
+            glUniformMatrix4fv(glGetUniformLocation(program, "mvp"), 1, GL_FALSE, IDENTITY);
+            glUniform3f(glGetUniformLocation(program, "color"), 1.0f, 1.0f, 1.0f);
+            glUniform1f(glGetUniformLocation(program, "alpha"), 1.0f);
+            glDrawElements(GL_TRIANGLES, indexCount, indexType, 0);
+            // Wait for the draw so any deferred compilation is attributed to this state
+            glFinish();
+            entries[id].warmUpMs = (monotonicNowNs() - start) / 1e6f;
+            LOGI("Warmed pipeline '%s' in %.2f ms", entries[id].state.name, entries[id].warmUpMs);
+        }
+        unbind();
+        glBindVertexArray(0);
+        LOGI("Pipeline warm-up of %d states took %.2f ms", (int)entries.size(), (monotonicNowNs() - total) / 1e6);
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glDeleteFramebuffers(1, &framebuffer);
+    glDeleteRenderbuffers(1, &depth);
+    glDeleteRenderbuffers(1, &color);
+}
@@ -0,0 +1,55 @@
+#ifndef ANDROIDSAMSUNG_PIPELINE_WARMUP_H
+#define ANDROIDSAMSUNG_PIPELINE_WARMUP_H
+
+#include <GLES3/gl3.h>
+#include <stdint.h>
+#include <vector>
+
+// One program + fixed-function combination the renderer draws with.
+struct PipelineState {
+    const char* name;
+    GLuint program;
+    bool depthTest;
+    bool depthWrite;
+    bool blend;
+};
+
+// Registry of every pipeline state the renderer uses.
+//
+// Drivers tend to finish compiling a program, and build the variant for the current blend and
+// depth state, on the first draw that uses it. warmUp() pays that cost up front by drawing each
+// registered state once into a tiny offscreen target. Draws issued through draw() are timed the
+// first time each state is used for real, and logged if they still exceed the hitch threshold.
+class PipelineRegistry {
+public:
+    int add(const PipelineState& state);
+    const PipelineState& state(int id) const { return entries[id].state; }
+
+    // Draws every registered state into a 4x4 target using the given geometry, with an identity
+    // `mvp` and opaque white `color`/`alpha` wherever a program has those uniforms, so the
+    // triangles are not degenerate and actually get rasterised. Must run on the thread that owns
+    // the context, after the programs are linked.
+    void warmUp(GLuint vao, GLsizei indexCount, GLenum indexType);
+
+    // Applies the program, depth and blend state of a registered pipeline.
+    void bind(int id);
+    // Restores depth test/blend off and depth writes on, the defaults the rest of the app expects.
+    void unbind();
+
+    // glDrawElements with the bound pipeline, timing the first real use of each state.
+    void draw(GLenum mode, GLsizei count, GLenum type);
+
+    float hitchThresholdMs = 1.0f;
+
+private:
+    struct Entry {
+        PipelineState state;
+        bool used = false; // drawn through draw() at least once
+        float warmUpMs = 0.0f;
+    };
+
+    std::vector<Entry> entries;
+    int bound = -1;
+};
+
+#endif //ANDROIDSAMSUNG_PIPELINE_WARMUP_H
@@ -0,0 +1,91 @@
+#ifndef ANDROIDSAMSUNG_PLATFORM_H
+#define ANDROIDSAMSUNG_PLATFORM_H
+
+#include "xr_platform.h"
+
+#include <stdint.h>
+#include <vector>
+
+// What the apps need from the OS, so the same frame loop runs as an Android NativeActivity
+// (platform_android.cpp, over android_native_app_glue) and as a headless Linux program
+// (platform_linux.cpp, over Mesa's surfaceless EGL) for workstations and CI.
+//
+// The app implements platformMain(), which the platform calls on the thread that owns the
+// lifecycle: android_main on Android, main() on Linux. Lifecycle commands and input arrive
+// through the callbacks, from inside platformPollEvent(), exactly like the glue's onAppCmd
+// and onInputEvent.
+
+enum class PlatformCmd {
+    InitWindow,  // window (if any) available; Linux sends it once at startup
+    TermWindow,
+    Resume,
+    Pause,
+};
+
+struct PlatformInput {
+    enum Action { Down, Move, Up };
+    Action action;
+    float x, y;  // window pixels
+};
+
+struct PlatformState;
+
+struct PlatformApp {
+    void* userData = nullptr;
+    void (*onCmd)(PlatformApp* app, PlatformCmd cmd) = nullptr;
+    // Returns true if the event was handled
+    bool (*onInput)(PlatformApp* app, const PlatformInput& input) = nullptr;
+
+    // Native window for window surfaces; 0 when headless
+    EGLNativeWindowType window = 0;
+    // Writable directory for traces, captures and metrics
+    const char* dataPath = ".";
+    bool destroyRequested = false;
+    // Run the frame loop without graphics: no EGL context, no swapchains, and an XR_MND_headless
+    // session in place of a graphics binding. For measuring the CPU side of the loop; Linux only.
+    bool noGraphics = false;
+    // Set by the app when it could not run as asked; the Linux process exits with it
+    int exitCode = 0;
+
+    PlatformState* state = nullptr;
+};
+
+// Implemented by the app
+void platformMain(PlatformApp* app);
+
+// Waits up to timeoutMs (-1: forever) for one event and dispatches it to the callbacks.
+// Returns false if the wait ended without one (timeout or platformWake()).
+bool platformPollEvent(PlatformApp* app, int timeoutMs);
+
+// Ends a platformPollEvent() wait early; callable from any thread
+void platformWake(PlatformApp* app);
+
+// Asks the platform to shut the app down; destroyRequested follows
+void platformFinish(PlatformApp* app);
+
+// Initialised display for the app's context: the default display on Android, Mesa's
+// surfaceless platform (falling back to the default display) on Linux
+EGLDisplay platformEglDisplay();
+
+// --- OpenXR ---
+
+// xrInitializeLoaderKHR, where the platform's loader needs it
+bool platformInitXrLoader(PlatformApp* app);
+
+// Platform and graphics extensions to enable, and the struct chained to XrInstanceCreateInfo.
+// Call platformXrInstanceExtensions() first: on Linux it picks the graphics extension, or
+// XR_MND_headless for noGraphics.
+void platformXrInstanceExtensions(PlatformApp* app, std::vector<const char*>* extensions);
+const void* platformXrInstanceNext(PlatformApp* app);
+
+// Checks the runtime's graphics requirements (which it needs called before xrCreateSession)
+// and returns the binding for the given context, to chain to XrSessionCreateInfo. Valid
+// until the next call.
+const void* platformXrGraphicsBinding(PlatformApp* app, XrInstance instance, XrSystemId systemId,
+                                      EGLDisplay display, EGLConfig config, EGLContext context);
+
+// Structure type for xrEnumerateSwapchainImages. Every choice has the same layout as
+// XrSwapchainImageOpenGLESKHR.
+XrStructureType platformXrSwapchainImageType(PlatformApp* app);
+
+#endif //ANDROIDSAMSUNG_PLATFORM_H
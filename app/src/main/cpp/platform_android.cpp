@@ -0,0 +1,137 @@
+#include "platform.h"
+
+#include "android_native_app_glue.h"
+#include <android/input.h>
+
+#define LOG_TAG "Platform"
+#include "log.h"
+
+struct PlatformState {
+    android_app* android = nullptr;
+    XrInstanceCreateInfoAndroidKHR instanceInfo{XR_TYPE_INSTANCE_CREATE_INFO_ANDROID_KHR};
+    XrGraphicsBindingOpenGLESAndroidKHR binding{XR_TYPE_GRAPHICS_BINDING_OPENGL_ES_ANDROID_KHR};
+};
+
+namespace {
+
+void handleAppCmd(android_app* android, int32_t cmd) {
+    auto* app = static_cast<PlatformApp*>(android->userData);
+    if (app->onCmd == nullptr) return;
+    switch (cmd) {
+        case APP_CMD_INIT_WINDOW:
+            app->window = android->window;
+            app->onCmd(app, PlatformCmd::InitWindow);
+            break;
+        case APP_CMD_TERM_WINDOW:
+            app->onCmd(app, PlatformCmd::TermWindow);
+            app->window = nullptr;
+            break;
+        case APP_CMD_RESUME: app->onCmd(app, PlatformCmd::Resume); break;
+        case APP_CMD_PAUSE: app->onCmd(app, PlatformCmd::Pause); break;
+        default: break;
+    }
+}
+
+int32_t handleInputEvent(android_app* android, AInputEvent* event) {
+    auto* app = static_cast<PlatformApp*>(android->userData);
+    if (app->onInput == nullptr || AInputEvent_getType(event) != AINPUT_EVENT_TYPE_MOTION) return 0;
+    PlatformInput input;
+    switch (AMotionEvent_getAction(event) & AMOTION_EVENT_ACTION_MASK) {
+        case AMOTION_EVENT_ACTION_DOWN: input.action = PlatformInput::Down; break;
+        case AMOTION_EVENT_ACTION_UP:
+        case AMOTION_EVENT_ACTION_CANCEL: input.action = PlatformInput::Up; break;
+        default: input.action = PlatformInput::Move; break;
+    }
+    input.x = AMotionEvent_getX(event, 0);
+    input.y = AMotionEvent_getY(event, 0);
+    return app->onInput(app, input) ? 1 : 0;
+}
+
+} // namespace
+
+void android_main(android_app* android) {
+    PlatformState state;
+    state.android = android;
+    PlatformApp app;
+    app.state = &state;
+    app.dataPath = android->activity->internalDataPath;
+    android->userData = &app;
+    android->onAppCmd = handleAppCmd;
+    android->onInputEvent = handleInputEvent;
+    platformMain(&app);
+}
+
+bool platformPollEvent(PlatformApp* app, int timeoutMs) {
+    android_app* android = app->state->android;
+    int events;
+    android_poll_source* source = nullptr;
+    bool dispatched = false;
+    if (ALooper_pollOnce(timeoutMs, nullptr, &events, (void**)&source) >= 0 && source != nullptr) {
+        source->process(android, source);
+        dispatched = true;
+    }
+    app->destroyRequested = android->destroyRequested != 0;
+    return dispatched;
+}
+
+void platformWake(PlatformApp* app) {
+    ALooper_wake(app->state->android->looper);
+}
+
+void platformFinish(PlatformApp* app) {
+    ANativeActivity_finish(app->state->android->activity);
+}
+
+EGLDisplay platformEglDisplay() {
+    EGLDisplay display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    if (display == EGL_NO_DISPLAY || !eglInitialize(display, nullptr, nullptr)) return EGL_NO_DISPLAY;
+    return display;
+}
+
+// --- OpenXR ---
+
+bool platformInitXrLoader(PlatformApp* app) {
+    PFN_xrInitializeLoaderKHR xrInitializeLoaderKHR = nullptr;
+    xrGetInstanceProcAddr(XR_NULL_HANDLE, "xrInitializeLoaderKHR", (PFN_xrVoidFunction*)&xrInitializeLoaderKHR);
+    if (xrInitializeLoaderKHR == nullptr) {
+        LOGE("Failed to get xrInitializeLoaderKHR");
+        return false;
+    }
+    XrLoaderInitInfoAndroidKHR loaderInitInfo{XR_TYPE_LOADER_INIT_INFO_ANDROID_KHR};
+    loaderInitInfo.applicationVM = app->state->android->activity->vm;
+    loaderInitInfo.applicationContext = app->state->android->activity->clazz;
+    return XR_SUCCEEDED(xrInitializeLoaderKHR((const XrLoaderInitInfoBaseHeaderKHR*)&loaderInitInfo));
+}
+
+void platformXrInstanceExtensions(PlatformApp*, std::vector<const char*>* extensions) {
+    extensions->push_back(XR_KHR_ANDROID_CREATE_INSTANCE_EXTENSION_NAME);
+    extensions->push_back(XR_KHR_OPENGL_ES_ENABLE_EXTENSION_NAME);
+}
+
+const void* platformXrInstanceNext(PlatformApp* app) {
+    XrInstanceCreateInfoAndroidKHR& info = app->state->instanceInfo;
+    info = {XR_TYPE_INSTANCE_CREATE_INFO_ANDROID_KHR};
+    info.applicationVM = app->state->android->activity->vm;
+    info.applicationActivity = app->state->android->activity->clazz;
+    return &info;
+}
+
+const void* platformXrGraphicsBinding(PlatformApp* app, XrInstance instance, XrSystemId systemId,
+                                      EGLDisplay display, EGLConfig config, EGLContext context) {
+    PFN_xrGetOpenGLESGraphicsRequirementsKHR getRequirements = nullptr;
+    xrGetInstanceProcAddr(instance, "xrGetOpenGLESGraphicsRequirementsKHR", (PFN_xrVoidFunction*)&getRequirements);
+    if (getRequirements != nullptr) {
+        XrGraphicsRequirementsOpenGLESKHR requirements{XR_TYPE_GRAPHICS_REQUIREMENTS_OPENGL_ES_KHR};
+        getRequirements(instance, systemId, &requirements);
+    }
+    XrGraphicsBindingOpenGLESAndroidKHR& binding = app->state->binding;
+    binding = {XR_TYPE_GRAPHICS_BINDING_OPENGL_ES_ANDROID_KHR};
+    binding.display = display;
+    binding.config = config;
+    binding.context = context;
+    return &binding;
+}
+
+XrStructureType platformXrSwapchainImageType(PlatformApp*) {
+    return XR_TYPE_SWAPCHAIN_IMAGE_OPENGL_ES_KHR;
+}
@@ -0,0 +1,213 @@
+#include "platform.h"
+
+#include "alloc_guard.h"
+#include "monotonic_clock.h"
+#include "tools/headless_egl.h"
+#include "xr_dispatch.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <deque>
+
+#define LOG_TAG "Platform"
+#include "log.h"
+
+// Headless: there is no window and no input. The app is resumed and handed its "window" at
+// startup, and paused and torn down on SIGINT/SIGTERM, platformFinish() or --seconds.
+//
+//     <app> [--data <dir>] [--seconds <s>] [--no-graphics] [--alloc-guard-fatal]
+//
+// --no-graphics runs the frame loop with no GL at all, on an XR_MND_headless session (Monado,
+// or the mock runtime), to measure what the loop itself costs on the CPU. An app that has no
+// such loop refuses it and exits with PlatformApp::exitCode (2).
+//
+// In debug builds a steady-state frame that allocates (alloc_guard.h) makes the exit status 3.
+// --alloc-guard-fatal, or XR_ALLOC_GUARD_FATAL=1, aborts on the first one instead, for CI.
+//
+// EGL comes from Mesa's surfaceless platform, so it runs on llvmpipe with no X or Wayland
+// server (EGL_PLATFORM=surfaceless). OpenXR goes through whatever runtime the loader finds
+// (XR_RUNTIME_JSON), or the library linked in its place.
+
+struct PlatformState {
+    int wakeFd[2] = {-1, -1};
+    std::deque<PlatformCmd> pending;
+    int64_t deadlineNs = 0;  // 0: run until told to stop
+    bool finishing = false;
+    bool desktopGl = false;  // XR_KHR_opengl_enable rather than XR_KHR_opengl_es_enable
+    XrGraphicsBindingEGLMNDX binding{XR_TYPE_GRAPHICS_BINDING_EGL_MNDX};
+};
+
+namespace {
+
+volatile sig_atomic_t stopSignal = 0;
+int signalWakeFd = -1;
+
+void handleStopSignal(int) {
+    stopSignal = 1;
+    if (signalWakeFd >= 0) {
+        char byte = 0;
+        ssize_t ignored = write(signalWakeFd, &byte, 1);
+        (void)ignored;
+    }
+}
+
+// Same order the Android glue delivers them in when an activity goes away
+void beginShutdown(PlatformApp* app) {
+    PlatformState* state = app->state;
+    if (state->finishing) return;
+    state->finishing = true;
+    state->pending.push_back(PlatformCmd::Pause);
+    state->pending.push_back(PlatformCmd::TermWindow);
+}
+
+void usage(const char* program) {
+    fprintf(stderr, "usage: %s [--data <dir>] [--seconds <s>] [--no-graphics] [--alloc-guard-fatal]\n", program);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const char* fatal = getenv("XR_ALLOC_GUARD_FATAL");
+    if (fatal != nullptr && atoi(fatal) != 0) allocGuardSetFatal(true);
+    PlatformState state;
+    PlatformApp app;
+    app.state = &state;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--data") == 0 && i + 1 < argc) {
+            app.dataPath = argv[++i];
+        } else if (strcmp(argv[i], "--seconds") == 0 && i + 1 < argc) {
+            double seconds = atof(argv[++i]);
+            if (seconds > 0) state.deadlineNs = monotonicNowNs() + (int64_t)(seconds * 1e9);
+        } else if (strcmp(argv[i], "--no-graphics") == 0) {
+            app.noGraphics = true;
+        } else if (strcmp(argv[i], "--alloc-guard-fatal") == 0) {
+            allocGuardSetFatal(true);
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    if (pipe2(state.wakeFd, O_CLOEXEC | O_NONBLOCK) != 0) {
+        perror("pipe2");
+        return 1;
+    }
+    signalWakeFd = state.wakeFd[1];
+    struct sigaction action = {};
+    action.sa_handler = handleStopSignal;
+    sigaction(SIGINT, &action, nullptr);
+    sigaction(SIGTERM, &action, nullptr);
+
+    state.pending.push_back(PlatformCmd::Resume);
+    state.pending.push_back(PlatformCmd::InitWindow);
+    platformMain(&app);
+
+    signalWakeFd = -1;
+    close(state.wakeFd[0]);
+    close(state.wakeFd[1]);
+    if (app.exitCode != 0) return app.exitCode;
+    if (uint32_t violations = allocGuardViolations()) {
+        fprintf(stderr, "%u steady-state frame(s) allocated\n", violations);
+        return 3;
+    }
+    return 0;
+}
+
+bool platformPollEvent(PlatformApp* app, int timeoutMs) {
+    PlatformState* state = app->state;
+    if (stopSignal || (state->deadlineNs != 0 && monotonicNowNs() >= state->deadlineNs)) beginShutdown(app);
+
+    if (!state->pending.empty()) {
+        PlatformCmd cmd = state->pending.front();
+        state->pending.pop_front();
+        if (app->onCmd != nullptr) app->onCmd(app, cmd);
+        if (state->finishing && state->pending.empty()) app->destroyRequested = true;
+        return true;
+    }
+    if (app->destroyRequested) return false;
+
+    if (state->deadlineNs != 0) {
+        int64_t remainingMs = (state->deadlineNs - monotonicNowNs()) / 1000000 + 1;
+        if (timeoutMs < 0 || timeoutMs > remainingMs) timeoutMs = (int)remainingMs;
+    }
+    pollfd wake{state->wakeFd[0], POLLIN, 0};
+    if (poll(&wake, 1, timeoutMs) > 0) {
+        char drain[64];
+        while (read(state->wakeFd[0], drain, sizeof(drain)) > 0) {
+        }
+    }
+    return false;
+}
+
+void platformWake(PlatformApp* app) {
+    char byte = 0;
+    ssize_t ignored = write(app->state->wakeFd[1], &byte, 1);
+    (void)ignored;
+}
+
+void platformFinish(PlatformApp* app) {
+    beginShutdown(app);
+    platformWake(app);
+}
+
+EGLDisplay platformEglDisplay() {
+    return headlessEglDisplay();
+}
+
+// --- OpenXR ---
+
+bool platformInitXrLoader(PlatformApp*) {
+    // The desktop loader finds its runtime through XR_RUNTIME_JSON and the active_runtime.json
+    // search path; there is nothing to hand it
+    return true;
+}
+
+void platformXrInstanceExtensions(PlatformApp* app, std::vector<const char*>* extensions) {
+    if (app->noGraphics) {
+        if (!runtimeSupportsExtension(XR_MND_HEADLESS_EXTENSION_NAME)) LOGE("Runtime has no XR_MND_headless");
+        extensions->push_back(XR_MND_HEADLESS_EXTENSION_NAME);
+        return;
+    }
+    extensions->push_back(XR_MNDX_EGL_ENABLE_EXTENSION_NAME);
+    app->state->desktopGl = !runtimeSupportsExtension(XR_KHR_OPENGL_ES_ENABLE_EXTENSION_NAME) &&
+                            runtimeSupportsExtension(XR_KHR_OPENGL_ENABLE_EXTENSION_NAME);
+    extensions->push_back(app->state->desktopGl ? XR_KHR_OPENGL_ENABLE_EXTENSION_NAME
+                                                : XR_KHR_OPENGL_ES_ENABLE_EXTENSION_NAME);
+    if (app->state->desktopGl) LOGI("Runtime has no XR_KHR_opengl_es_enable; binding through XR_KHR_opengl_enable");
+}
+
+const void* platformXrInstanceNext(PlatformApp*) {
+    return nullptr;
+}
+
+const void* platformXrGraphicsBinding(PlatformApp* app, XrInstance instance, XrSystemId systemId,
+                                      EGLDisplay display, EGLConfig config, EGLContext context) {
+    if (app->state->desktopGl) {
+        PFN_xrGetOpenGLGraphicsRequirementsKHR getRequirements = nullptr;
+        xrGetInstanceProcAddr(instance, "xrGetOpenGLGraphicsRequirementsKHR", (PFN_xrVoidFunction*)&getRequirements);
+        XrGraphicsRequirementsOpenGLKHR requirements{XR_TYPE_GRAPHICS_REQUIREMENTS_OPENGL_KHR};
+        if (getRequirements != nullptr) getRequirements(instance, systemId, &requirements);
+    } else {
+        PFN_xrGetOpenGLESGraphicsRequirementsKHR getRequirements = nullptr;
+        xrGetInstanceProcAddr(instance, "xrGetOpenGLESGraphicsRequirementsKHR", (PFN_xrVoidFunction*)&getRequirements);
+        XrGraphicsRequirementsOpenGLESKHR requirements{XR_TYPE_GRAPHICS_REQUIREMENTS_OPENGL_ES_KHR};
+        if (getRequirements != nullptr) getRequirements(instance, systemId, &requirements);
+    }
+    XrGraphicsBindingEGLMNDX& binding = app->state->binding;
+    binding = {XR_TYPE_GRAPHICS_BINDING_EGL_MNDX};
+    binding.getProcAddress = reinterpret_cast<PFN_xrEglGetProcAddressMNDX>(eglGetProcAddress);
+    binding.display = display;
+    binding.config = config;
+    binding.context = context;
+    return &binding;
+}
+
+XrStructureType platformXrSwapchainImageType(PlatformApp* app) {
+    return app->state->desktopGl ? XR_TYPE_SWAPCHAIN_IMAGE_OPENGL_KHR : XR_TYPE_SWAPCHAIN_IMAGE_OPENGL_ES_KHR;
+}
@@ -0,0 +1,55 @@
+#include "pose_latency.h"
+#include "xr_clock.h"
+
+#include <stdlib.h>
+
+#define LOG_TAG "PoseLatency"
+#include "log.h"
+
+// Over-budget warnings are batched to at most one per interval
+static const int64_t ALERT_INTERVAL_NS = 1000000000;
+
+void PoseLatency::onWaitFrame(int64_t waitReturnNs, XrTime predictedDisplayTime) {
+    int64_t horizonNs = xrTimeToMonotonicNs(predictedDisplayTime) - waitReturnNs;
+    horizon.record(horizonNs);
+    if (lastHorizonNs >= 0) jitter.record(llabs(horizonNs - lastHorizonNs));
+    lastHorizonNs = horizonNs;
+}
+
+void PoseLatency::onLocateViews(int64_t locateNs, XrTime predictedDisplayTime) {
+    int64_t ageNs = xrTimeToMonotonicNs(predictedDisplayTime) - locateNs;
+    poseAge.record(ageNs);
+    lastAgeNs = ageNs;
+
+    int64_t limit = budget();
+    if (ageNs <= limit) return;
+    uint64_t over = overBudget.fetch_add(1, std::memory_order_relaxed) + 1;
+    if (locateNs - lastAlertNs >= ALERT_INTERVAL_NS) {
+        LOGW("Pose-to-photon %.2f ms over the %.2f ms budget (%llu frame(s) over since the last warning)",
+             ageNs / 1e6, limit / 1e6, (unsigned long long)(over - overBudgetAtLastAlert));
+        lastAlertNs = locateNs;
+        overBudgetAtLastAlert = over;
+    }
+}
+
+void PoseLatency::report(const char* label) const {
+    if (poseAge.count() == 0) return;
+    LOGI("%s pose-to-photon p50 %.2f  p90 %.2f  p99 %.2f  max %.2f ms, %llu of %llu frames over %.2f ms%s",
+         label, poseAge.percentile(0.5) / 1e6, poseAge.percentile(0.9) / 1e6, poseAge.percentile(0.99) / 1e6,
+         poseAge.max() / 1e6, (unsigned long long)overBudgetFrames(), (unsigned long long)poseAge.count(),
+         budget() / 1e6, xrClockCalibrated() ? "" : " (clock offset assumed)");
+    LOGI("%s prediction horizon p50 %.2f  p99 %.2f ms, frame-to-frame change p50 %.3f  p99 %.3f ms",
+         label, horizon.percentile(0.5) / 1e6, horizon.percentile(0.99) / 1e6,
+         jitter.percentile(0.5) / 1e6, jitter.percentile(0.99) / 1e6);
+}
+
+void PoseLatency::reset() {
+    poseAge.reset();
+    horizon.reset();
+    jitter.reset();
+    overBudget = 0;
+    lastHorizonNs = -1;
+    lastAgeNs = 0;
+    lastAlertNs = 0;
+    overBudgetAtLastAlert = 0;
+}
@@ -0,0 +1,51 @@
+#ifndef ANDROIDSAMSUNG_POSE_LATENCY_H
+#define ANDROIDSAMSUNG_POSE_LATENCY_H
+
+#include <stdint.h>
+#include <atomic>
+
+#include "log_histogram.h"
+#include "xr_dispatch.h"
+
+// How old the head pose is when its frame reaches the display.
+//
+// Pose-to-photon is the time from the xrLocateViews call that sampled the pose to the
+// frame's predictedDisplayTime (converted through xr_clock). The prediction horizon is the
+// same distance measured from xrWaitFrame returning; its frame-to-frame change shows how
+// steady the runtime's scheduling is. All three go into LogHistograms.
+//
+// Frames whose pose-to-photon exceeds the budget are counted and reported with a warning at
+// most once per second. Record from the frame thread; read from anywhere.
+class PoseLatency {
+public:
+    explicit PoseLatency(int64_t budgetNs) : budgetNs(budgetNs) {}
+
+    void setBudgetNs(int64_t ns) { budgetNs.store(ns, std::memory_order_relaxed); }
+    int64_t budget() const { return budgetNs.load(std::memory_order_relaxed); }
+
+    // Call when xrWaitFrame returns
+    void onWaitFrame(int64_t waitReturnNs, XrTime predictedDisplayTime);
+    // Call with the time just before xrLocateViews for the frame's views
+    void onLocateViews(int64_t locateNs, XrTime predictedDisplayTime);
+
+    // Pose-to-photon of the most recent frame
+    int64_t lastPoseToPhotonNs() const { return lastAgeNs; }
+    uint64_t overBudgetFrames() const { return overBudget.load(std::memory_order_relaxed); }
+    const LogHistogram& poseToPhoton() const { return poseAge; }
+    const LogHistogram& predictionHorizon() const { return horizon; }
+    const LogHistogram& horizonJitter() const { return jitter; }
+
+    void report(const char* label) const;
+    void reset();
+
+private:
+    LogHistogram poseAge, horizon, jitter;
+    std::atomic<int64_t> budgetNs;
+    std::atomic<uint64_t> overBudget{0};
+    int64_t lastHorizonNs = -1;
+    int64_t lastAgeNs = 0;
+    int64_t lastAlertNs = 0;
+    uint64_t overBudgetAtLastAlert = 0;
+};
+
+#endif //ANDROIDSAMSUNG_POSE_LATENCY_H
@@ -0,0 +1,156 @@
+#include "profiler.h"
+
+#if XR_PROFILER
+
+#include "thread_ring_registry.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#define LOG_TAG "Profiler"
+#include "log.h"
+
+struct ProfileRecord {
+    const ProfileSite* site;
+    int64_t startNs;
+    int64_t endNs;
+    uint32_t depth;
+};
+
+// Zones each thread can have in flight before new ones are dropped
+static const size_t PROFILE_RING_CAPACITY = 4096;
+
+// Most recent zones kept for trace export
+static const size_t PROFILE_CAPTURE_CAPACITY = 65536;
+
+// How often the collector drains the rings
+static const auto PROFILE_DRAIN_INTERVAL = std::chrono::milliseconds(10);
+
+struct ZoneTotals {
+    const ProfileSite* site;
+    uint64_t count = 0;
+    int64_t totalNs = 0;
+    int64_t maxNs = 0;
+};
+
+struct CapturedZone {
+    const ProfileSite* site;
+    int64_t startNs;
+    int64_t endNs;
+    uint32_t depth;
+    uint32_t threadIndex;
+};
+
+thread_local uint32_t profilerDepth = 0;
+
+static std::mutex namesMutex;
+static std::vector<std::string> threadNames; // by threadIndex, guarded by namesMutex; may be short
+
+// Everything below is guarded by rings.consumerMutex()
+static std::unordered_map<const ProfileSite*, ZoneTotals> totals;
+static std::vector<CapturedZone> capture;
+static uint64_t captured = 0;
+
+static void collect(const ProfileRecord& record, uint32_t threadIndex) {
+    ZoneTotals& zone = totals[record.site];
+    zone.site = record.site;
+    int64_t durationNs = record.endNs - record.startNs;
+    zone.count++;
+    zone.totalNs += durationNs;
+    zone.maxNs = std::max(zone.maxNs, durationNs);
+
+    if (capture.empty()) capture.resize(PROFILE_CAPTURE_CAPACITY);
+    capture[captured % PROFILE_CAPTURE_CAPACITY] = {record.site, record.startNs, record.endNs, record.depth, threadIndex};
+    captured++;
+}
+
+// The collector thread drains every thread's ring into totals and capture
+static ThreadRingRegistry<ProfileRecord, PROFILE_RING_CAPACITY> rings(collect, nullptr, PROFILE_DRAIN_INTERVAL);
+
+void profilerRecord(const ProfileSite* site, int64_t startNs, int64_t endNs, uint32_t depth) {
+    if (rings.stopped()) return;
+    rings.push({site, startNs, endNs, depth});
+}
+
+void profilerSetThreadName(const char* name) {
+    uint32_t index = rings.threadIndex();
+    std::lock_guard<std::mutex> lock(namesMutex);
+    if (threadNames.size() <= index) threadNames.resize(index + 1);
+    threadNames[index] = std::string(name).substr(0, 31);
+}
+
+void profilerFlush() {
+    rings.flush();
+}
+
+void profilerReport() {
+    std::vector<ZoneTotals> zones;
+    {
+        std::lock_guard<std::mutex> lock(rings.consumerMutex());
+        rings.drainLocked();
+        for (const auto& entry : totals) zones.push_back(entry.second);
+    }
+    std::sort(zones.begin(), zones.end(), [](const ZoneTotals& a, const ZoneTotals& b) { return a.totalNs > b.totalNs; });
+    for (const ZoneTotals& zone : zones) {
+        LOGI("%-28s %8llu calls  total %9.3f ms  mean %9.3f us  max %9.3f us", zone.site->name,
+             (unsigned long long)zone.count, zone.totalNs / 1e6, zone.totalNs / 1e3 / zone.count, zone.maxNs / 1e3);
+    }
+    uint64_t dropped = profilerDroppedCount();
+    if (dropped) LOGW("%llu profiler zones dropped (ring full)", (unsigned long long)dropped);
+}
+
+bool profilerExportChromeTrace(const char* path) {
+    FILE* file = fopen(path, "w");
+    if (!file) {
+        LOGE("Cannot open %s for the profiler trace", path);
+        return false;
+    }
+
+    std::vector<std::string> names(rings.threadCount());
+    {
+        std::lock_guard<std::mutex> lock(namesMutex);
+        for (size_t i = 0; i < names.size(); ++i) {
+            names[i] = i < threadNames.size() && !threadNames[i].empty() ? threadNames[i] : "thread " + std::to_string(i);
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(rings.consumerMutex());
+    rings.drainLocked();
+    fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    bool first = true;
+    for (size_t i = 0; i < names.size(); ++i) {
+        fprintf(file, "%s{\"ph\":\"M\",\"pid\":1,\"tid\":%zu,\"name\":\"thread_name\",\"args\":{\"name\":\"%s\"}}",
+                first ? "" : ",\n", i + 100, names[i].c_str());
+        first = false;
+    }
+    uint64_t count = std::min<uint64_t>(captured, PROFILE_CAPTURE_CAPACITY);
+    for (uint64_t i = captured - count; i < captured; ++i) {
+        const CapturedZone& zone = capture[i % PROFILE_CAPTURE_CAPACITY];
+        // Thread ids start at 100 so they do not collide with the frame timeline's tracks
+        fprintf(file, "%s{\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"name\":\"%s\",\"ts\":%.3f,\"dur\":%.3f,"
+                      "\"args\":{\"file\":\"%s\",\"line\":%u,\"depth\":%u}}",
+                first ? "" : ",\n", zone.threadIndex + 100, zone.site->name, zone.startNs / 1e3,
+                (zone.endNs - zone.startNs) / 1e3, zone.site->file, zone.site->line, zone.depth);
+        first = false;
+    }
+    fprintf(file, "\n]}\n");
+    bool ok = fclose(file) == 0;
+    LOGI("Wrote %llu profiler zones to %s", (unsigned long long)count, path);
+    return ok;
+}
+
+void profilerShutdown() {
+    rings.shutdown();
+}
+
+uint64_t profilerDroppedCount() {
+    return rings.droppedCount();
+}
+
+#endif
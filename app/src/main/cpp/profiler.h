@@ -0,0 +1,103 @@
+#ifndef ANDROIDSAMSUNG_PROFILER_H
+#define ANDROIDSAMSUNG_PROFILER_H
+
+#include <stdint.h>
+
+#include "monotonic_clock.h"
+
+// Scoped CPU profiler zones.
+//
+//     void initOpenXR() {
+//         PROFILE_ZONE("initOpenXR");
+//         ...
+//     }
+//
+// Each zone site is a static constexpr ProfileSite (name, file, line and an FNV-1a hash of
+// the name as a stable ID), so the hot path only passes a pointer. When the zone closes,
+// its start and end times go into the calling thread's lock-free ring; a collector thread
+// drains every ring into per-zone totals and a capture buffer for trace export.
+//
+// XR_PROFILER defaults to 1 in debug builds and 0 with NDEBUG. At 0, PROFILE_ZONE expands
+// to nothing and every function below is an inline no-op.
+
+#ifndef XR_PROFILER
+#ifdef NDEBUG
+#define XR_PROFILER 0
+#else
+#define XR_PROFILER 1
+#endif
+#endif
+
+struct ProfileSite {
+    const char* name;
+    const char* file;
+    uint32_t line;
+    uint32_t id;
+};
+
+constexpr uint32_t profileHash(const char* text, uint32_t hash = 2166136261u) {
+    return *text ? profileHash(text + 1, (hash ^ (uint8_t)*text) * 16777619u) : hash;
+}
+
+#if XR_PROFILER
+
+// Names the calling thread in reports and traces (truncated to 31 characters)
+void profilerSetThreadName(const char* name);
+
+// Blocks until every zone closed so far has been collected
+void profilerFlush();
+
+// Logs count, total, mean and max time per zone, largest total first
+void profilerReport();
+
+// Writes the captured zones (the most recent ones, up to the capture size) as Chrome trace JSON
+bool profilerExportChromeTrace(const char* path);
+
+// Stops the collector after a final flush
+void profilerShutdown();
+
+// Zones dropped because a thread's ring was full, since startup
+uint64_t profilerDroppedCount();
+
+// Used by ProfileZone
+void profilerRecord(const ProfileSite* site, int64_t startNs, int64_t endNs, uint32_t depth);
+extern thread_local uint32_t profilerDepth;
+
+class ProfileZone {
+public:
+    explicit ProfileZone(const ProfileSite* site) : site(site), depth(profilerDepth++), startNs(monotonicNowNs()) {}
+    ~ProfileZone() {
+        int64_t endNs = monotonicNowNs();
+        profilerDepth--;
+        profilerRecord(site, startNs, endNs, depth);
+    }
+
+    ProfileZone(const ProfileZone&) = delete;
+    ProfileZone& operator=(const ProfileZone&) = delete;
+
+private:
+    const ProfileSite* site;
+    uint32_t depth;
+    int64_t startNs;
+};
+
+#define XR_PROFILE_CONCAT2(a, b) a##b
+#define XR_PROFILE_CONCAT(a, b) XR_PROFILE_CONCAT2(a, b)
+#define PROFILE_ZONE(name) \
+    static constexpr ProfileSite XR_PROFILE_CONCAT(profileSite, __LINE__){name, __FILE__, __LINE__, profileHash(name)}; \
+    ProfileZone XR_PROFILE_CONCAT(profileZone, __LINE__)(&XR_PROFILE_CONCAT(profileSite, __LINE__))
+
+#else
+
+inline void profilerSetThreadName(const char*) {}
+inline void profilerFlush() {}
+inline void profilerReport() {}
+inline bool profilerExportChromeTrace(const char*) { return false; }
+inline void profilerShutdown() {}
+inline uint64_t profilerDroppedCount() { return 0; }
+
+#define PROFILE_ZONE(name) ((void)0)
+
+#endif
+
+#endif //ANDROIDSAMSUNG_PROFILER_H
@@ -0,0 +1,103 @@
+#include "refresh_rate.h"
+#include "monotonic_clock.h"
+
+#include <algorithm>
+#include <cmath>
+
+#define LOG_TAG "RefreshRate"
+#include "log.h"
+
+bool RefreshRateManager::init(const XrDispatchTable* xr, XrSession newSession) {
+    rates.clear();
+    timeNs.clear();
+    current = requested = refused = -1;
+    session = XR_NULL_HANDLE;
+    if (!xr->EnumerateDisplayRefreshRatesFB || !xr->GetDisplayRefreshRateFB || !xr->RequestDisplayRefreshRateFB) {
+        LOGI("XR_FB_display_refresh_rate unavailable; using the runtime's refresh rate");
+        return false;
+    }
+
+    uint32_t count = 0;
+    xr->EnumerateDisplayRefreshRatesFB(newSession, 0, &count, nullptr);
+    count = std::min(count, MAX_RATES);
+    float supported[MAX_RATES];
+    if (count == 0 || XR_FAILED(xr->EnumerateDisplayRefreshRatesFB(newSession, count, &count, supported))) {
+        LOGE("Failed to enumerate display refresh rates");
+        return false;
+    }
+    std::sort(supported, supported + count);
+    for (uint32_t i = 0; i < count; ++i) {
+        rates.push_back(supported[i]);
+        timeNs.push_back(0);
+        LOGI("Supported refresh rate: %.1f Hz", supported[i]);
+    }
+
+    dispatch = xr;
+    session = newSession;
+    float now = 0.0f;
+    if (XR_SUCCEEDED(xr->GetDisplayRefreshRateFB(session, &now))) {
+        enterRate(findRate(now));
+    }
+    return true;
+}
+
+void RefreshRateManager::shutdown() {
+    enterRate(-1);
+    session = XR_NULL_HANDLE;
+    dispatch = nullptr;
+}
+
+int RefreshRateManager::findRate(float hz) const {
+    for (size_t i = 0; i < rates.size(); ++i) {
+        if (fabsf(rates[i] - hz) < 0.5f) return (int)i;
+    }
+    return -1;
+}
+
+void RefreshRateManager::enterRate(int index) {
+    int64_t nowNs = monotonicNowNs();
+    if (current >= 0) timeNs[current] += nowNs - enteredNs;
+    current = index;
+    enteredNs = nowNs;
+}
+
+void RefreshRateManager::setRequiredRate(float minHz) {
+    if (!available() || rates.empty()) return;
+
+    int target = (int)rates.size() - 1;
+    for (size_t i = 0; i < rates.size(); ++i) {
+        if (rates[i] >= minHz - 0.5f) {
+            target = (int)i;
+            break;
+        }
+    }
+    // A refused rate is retried only once the best match has moved away from it
+    if (target == refused) return;
+    refused = -1;
+    if (target == current && requested < 0) return;
+    if (target == requested) return;
+
+    if (XR_FAILED(dispatch->RequestDisplayRefreshRateFB(session, rates[target]))) {
+        LOGE("Refresh rate request for %.1f Hz failed; not retrying until the target changes", rates[target]);
+        refused = target;
+        return;
+    }
+    LOGI("Requested %.1f Hz (content needs %.1f Hz)", rates[target], minHz);
+    requested = target == current ? -1 : target;
+}
+
+void RefreshRateManager::onRefreshRateChanged(const XrEventDataDisplayRefreshRateChangedFB& event) {
+    LOGI("Display refresh rate changed %.1f -> %.1f Hz", event.fromDisplayRefreshRate, event.toDisplayRefreshRate);
+    int index = findRate(event.toDisplayRefreshRate);
+    if (index == requested) requested = -1;
+    refused = -1;
+    enterRate(index);
+}
+
+void RefreshRateManager::report() const {
+    int64_t nowNs = monotonicNowNs();
+    for (size_t i = 0; i < rates.size(); ++i) {
+        int64_t spent = timeNs[i] + ((int)i == current ? nowNs - enteredNs : 0);
+        if (spent > 0) LOGI("Time at %.1f Hz: %.1f s", rates[i], spent / 1e9);
+    }
+}
@@ -0,0 +1,55 @@
+#ifndef ANDROIDSAMSUNG_REFRESH_RATE_H
+#define ANDROIDSAMSUNG_REFRESH_RATE_H
+
+#include <stdint.h>
+
+#include "fixed_vector.h"
+#include "xr_dispatch.h"
+
+// Picks the display refresh rate through XR_FB_display_refresh_rate.
+//
+// The app states how fast its content needs to update (setRequiredRate(); e.g. 60 Hz for a
+// static panel, 90 Hz while something animates) and the manager asks the runtime for the
+// lowest supported rate that meets it, or the highest one if none does. The runtime confirms
+// with XrEventDataDisplayRefreshRateChangedFB, which is what switches the current rate; time
+// spent at each rate is accumulated for report().
+//
+// Without the extension every call is a no-op. All calls belong on the frame thread.
+class RefreshRateManager {
+public:
+    static constexpr uint32_t MAX_RATES = 16;
+
+    // Enumerates the rates for `session`. `xr` must stay valid until shutdown().
+    bool init(const XrDispatchTable* xr, XrSession session);
+
+    // Closes the current interval and forgets the session
+    void shutdown();
+
+    // Requests a new rate if the best match for `minHz` differs from the current or pending one.
+    // A rate the runtime refused is not asked for again until the best match changes or the
+    // display switches rate, so a persistent failure is logged once.
+    void setRequiredRate(float minHz);
+
+    void onRefreshRateChanged(const XrEventDataDisplayRefreshRateChangedFB& event);
+
+    bool available() const { return session != XR_NULL_HANDLE; }
+    float currentRate() const { return current >= 0 ? rates[current] : 0.0f; }
+
+    // Logs the time spent at each rate so far
+    void report() const;
+
+private:
+    int findRate(float hz) const;
+    void enterRate(int index);
+
+    const XrDispatchTable* dispatch = nullptr;
+    XrSession session = XR_NULL_HANDLE;
+    FixedVector<float, MAX_RATES> rates;    // ascending
+    FixedVector<int64_t, MAX_RATES> timeNs; // per entry of `rates`
+    int current = -1;
+    int requested = -1;
+    int refused = -1; // last rate whose request failed
+    int64_t enteredNs = 0;
+};
+
+#endif //ANDROIDSAMSUNG_REFRESH_RATE_H
@@ -0,0 +1,180 @@
+#include "shared_metrics.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#define LOG_TAG "SharedMetrics"
+#include "log.h"
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "shared atomics must not need a lock");
+
+// Readers give up after this many torn copies; the writer holds the lock for microseconds
+static const int SNAPSHOT_ATTEMPTS = 1000;
+
+bool SharedMetrics::open(const char* path) {
+    close();
+    // A named region is built in a temporary file and renamed over `path` once its header is
+    // written. Truncating the old file instead would SIGBUS a reader still mapping it; renaming
+    // leaves that reader on the old inode.
+    char tempPath[512];
+    int fd;
+    if (path) {
+        if (snprintf(tempPath, sizeof(tempPath), "%s.%d.tmp", path, (int)getpid()) >= (int)sizeof(tempPath)) {
+            LOGE("Metrics region path %s is too long", path);
+            return false;
+        }
+        fd = ::open(tempPath, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    } else {
+        // Through syscall() so this does not depend on the libc exposing memfd_create
+        fd = (int)syscall(__NR_memfd_create, "xr_metrics", 0);
+    }
+    if (fd < 0) {
+        LOGE("Cannot create the metrics region %s", path ? path : "(memfd)");
+        return false;
+    }
+    size_t size = sizeof(SharedMetricsRegion);
+    if (ftruncate(fd, (off_t)size) != 0) {
+        LOGE("Cannot size the metrics region to %zu bytes", size);
+        ::close(fd);
+        if (path) unlink(tempPath);
+        return false;
+    }
+    void* memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (memory == MAP_FAILED) {
+        LOGE("Cannot map the metrics region");
+        ::close(fd);
+        if (path) unlink(tempPath);
+        return false;
+    }
+    // The memfd must stay open for /proc/<pid>/fd/<fd> to resolve; a named file need not
+    if (path) {
+        ::close(fd);
+    } else {
+        anonymousFd = fd;
+    }
+
+    // A fresh ftruncate'd file is zero-filled, which is a valid empty region
+    region = static_cast<SharedMetricsRegion*>(memory);
+    region->version = SHARED_METRICS_VERSION;
+    region->size = (uint32_t)size;
+    region->pid = (uint32_t)getpid();
+    std::atomic_thread_fence(std::memory_order_release);
+    region->magic = SHARED_METRICS_MAGIC;
+
+    if (path && rename(tempPath, path) != 0) {
+        LOGE("Cannot move the metrics region into place at %s", path);
+        unlink(tempPath);
+        close();
+        return false;
+    }
+
+    if (path) {
+        LOGI("Publishing metrics to %s (%zu bytes)", path, size);
+    } else {
+        LOGI("Publishing metrics to /proc/%d/fd/%d (%zu bytes)", (int)getpid(), anonymousFd, size);
+    }
+    return true;
+}
+
+void SharedMetrics::close() {
+    if (region) munmap(region, sizeof(SharedMetricsRegion));
+    if (anonymousFd >= 0) ::close(anonymousFd);
+    region = nullptr;
+    anonymousFd = -1;
+}
+
+int SharedMetrics::add(const char* name, MetricKind kind) {
+    if (!region || region->metricCount >= SharedMetricsRegion::MAX_METRICS) return -1;
+    if (kind == MetricKind::Histogram && region->histogramCount >= SharedMetricsRegion::MAX_HISTOGRAMS) return -1;
+
+    beginUpdate();
+    int id = (int)region->metricCount;
+    SharedMetric& metric = region->metrics[id];
+    strncpy(metric.name, name, sizeof(metric.name) - 1);
+    metric.kind = kind;
+    metric.value.store(kind == MetricKind::Histogram ? region->histogramCount++ : 0, std::memory_order_relaxed);
+    region->metricCount++;
+    endUpdate(region->publishedNs.load(std::memory_order_relaxed));
+    return id;
+}
+
+void SharedMetrics::beginUpdate() {
+    if (!region) return;
+    region->sequence.store(region->sequence.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+}
+
+void SharedMetrics::endUpdate(int64_t nowNs) {
+    if (!region) return;
+    region->publishedNs.store(nowNs, std::memory_order_relaxed);
+    region->sequence.store(region->sequence.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+void SharedMetrics::setGauge(int id, double value) {
+    if (id < 0) return;
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    region->metrics[id].value.store(bits, std::memory_order_relaxed);
+}
+
+void SharedMetrics::recordHistogram(int id, int64_t ns) {
+    if (id < 0) return;
+    SharedHistogram& histogram = region->histograms[region->metrics[id].value.load(std::memory_order_relaxed)];
+    std::atomic<uint32_t>& bucket = histogram.buckets[LogHistogram::bucketFor(ns)];
+    bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    histogram.count.store(histogram.count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    if (ns > histogram.maxNs.load(std::memory_order_relaxed)) histogram.maxNs.store(ns, std::memory_order_relaxed);
+}
+
+double sharedMetricGauge(const SharedMetric& metric) {
+    uint64_t bits = metric.value.load(std::memory_order_relaxed);
+    double value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+bool sharedMetricsSnapshot(const SharedMetricsRegion* source, SharedMetricsRegion* out) {
+    if (source->magic != SHARED_METRICS_MAGIC || source->version != SHARED_METRICS_VERSION ||
+        source->size != sizeof(SharedMetricsRegion)) {
+        return false;
+    }
+    for (int attempt = 0; attempt < SNAPSHOT_ATTEMPTS; ++attempt) {
+        uint32_t before = source->sequence.load(std::memory_order_acquire);
+        if (before & 1) continue;
+
+        out->magic = source->magic;
+        out->version = source->version;
+        out->size = source->size;
+        out->pid = source->pid;
+        out->metricCount = source->metricCount;
+        out->histogramCount = source->histogramCount;
+        out->publishedNs.store(source->publishedNs.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        uint32_t metricCount = out->metricCount < SharedMetricsRegion::MAX_METRICS ? out->metricCount : SharedMetricsRegion::MAX_METRICS;
+        for (uint32_t i = 0; i < metricCount; ++i) {
+            memcpy(out->metrics[i].name, source->metrics[i].name, sizeof(out->metrics[i].name));
+            out->metrics[i].name[sizeof(out->metrics[i].name) - 1] = '\0';
+            out->metrics[i].kind = source->metrics[i].kind;
+            out->metrics[i].value.store(source->metrics[i].value.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        }
+        for (uint32_t h = 0; h < SharedMetricsRegion::MAX_HISTOGRAMS; ++h) {
+            const SharedHistogram& from = source->histograms[h];
+            SharedHistogram& to = out->histograms[h];
+            to.count.store(from.count.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            to.maxNs.store(from.maxNs.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            for (int b = 0; b < LogHistogram::BUCKETS; ++b) {
+                to.buckets[b].store(from.buckets[b].load(std::memory_order_relaxed), std::memory_order_relaxed);
+            }
+        }
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (source->sequence.load(std::memory_order_relaxed) == before) {
+            out->sequence.store(before, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
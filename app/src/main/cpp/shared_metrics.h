@@ -0,0 +1,111 @@
+#ifndef ANDROIDSAMSUNG_SHARED_METRICS_H
+#define ANDROIDSAMSUNG_SHARED_METRICS_H
+
+#include <stdint.h>
+#include <atomic>
+
+#include "log_histogram.h"
+
+// Live metrics for other processes, published into a shared-memory region.
+//
+// The region is a fixed, versioned layout: a header, a table of named counters and gauges,
+// and a few LogHistogram-compatible bucket arrays. The app registers its metrics once, then
+// brackets each frame's updates with beginUpdate()/endUpdate(), a seqlock: the sequence is
+// odd while an update is in progress. Updates in between are relaxed atomic stores, i.e.
+// plain stores, with nothing on the frame path that can block or make a system call. Readers
+// copy the region and retry when the sequence was odd or changed under them (see
+// sharedMetricsSnapshot() and tools/metrics_reader).
+//
+// The backing is either a named file (e.g. /dev/shm/xr_metrics on Linux or a file in the
+// app's data directory on Android) or an anonymous memfd, which other processes open through
+// /proc/<pid>/fd/<fd>. One writer thread.
+
+static const uint32_t SHARED_METRICS_MAGIC = 0x534d5258; // "XRMS"
+static const uint32_t SHARED_METRICS_VERSION = 1;
+
+enum class MetricKind : uint32_t {
+    Counter,   // monotonically increasing count
+    Gauge,     // last value, stored as double bits
+    Histogram, // durations in ns; `value` is the histogram slot
+};
+
+struct SharedMetric {
+    char name[48];
+    MetricKind kind;
+    uint32_t reserved;
+    std::atomic<uint64_t> value;
+};
+
+struct SharedHistogram {
+    std::atomic<uint64_t> count;
+    std::atomic<int64_t> maxNs;
+    std::atomic<uint32_t> buckets[LogHistogram::BUCKETS]; // LogHistogram::bucketFor() layout
+};
+
+struct SharedMetricsRegion {
+    static constexpr uint32_t MAX_METRICS = 64;
+    static constexpr uint32_t MAX_HISTOGRAMS = 8;
+
+    uint32_t magic;
+    uint32_t version;
+    uint32_t size;       // sizeof(SharedMetricsRegion) of the writer
+    uint32_t pid;
+    std::atomic<uint32_t> sequence;
+    uint32_t metricCount;
+    uint32_t histogramCount;
+    uint32_t reserved;
+    std::atomic<int64_t> publishedNs; // monotonic time of the last endUpdate()
+
+    SharedMetric metrics[MAX_METRICS];
+    SharedHistogram histograms[MAX_HISTOGRAMS];
+};
+
+class SharedMetrics {
+public:
+    SharedMetrics() = default;
+    ~SharedMetrics() { close(); }
+    SharedMetrics(const SharedMetrics&) = delete;
+    SharedMetrics& operator=(const SharedMetrics&) = delete;
+
+    // Creates the region at `path`, replacing any old file there without disturbing readers that
+    // still map it, or an anonymous memfd when `path` is null
+    bool open(const char* path);
+    void close();
+    bool isOpen() const { return region != nullptr; }
+    // The memfd, for readers going through /proc/<pid>/fd; -1 for a named file
+    int memfd() const { return anonymousFd; }
+
+    // Registration; returns the metric id, or -1 when closed or the table is full
+    int addCounter(const char* name) { return add(name, MetricKind::Counter); }
+    int addGauge(const char* name) { return add(name, MetricKind::Gauge); }
+    int addHistogram(const char* name) { return add(name, MetricKind::Histogram); }
+
+    void beginUpdate();
+    void endUpdate(int64_t nowNs);
+
+    // Ids of -1 are ignored, so callers need not check whether the region opened
+    void setCounter(int id, uint64_t value) {
+        if (id >= 0) region->metrics[id].value.store(value, std::memory_order_relaxed);
+    }
+    void addToCounter(int id, uint64_t delta) {
+        if (id < 0) return;
+        std::atomic<uint64_t>& value = region->metrics[id].value;
+        value.store(value.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+    }
+    void setGauge(int id, double value);
+    void recordHistogram(int id, int64_t ns);
+
+private:
+    int add(const char* name, MetricKind kind);
+
+    SharedMetricsRegion* region = nullptr;
+    int anonymousFd = -1;
+};
+
+// Copies a consistent view of `source` into `out`, retrying while the writer is mid-update.
+// False if the region is not a compatible one or stayed busy for too long.
+bool sharedMetricsSnapshot(const SharedMetricsRegion* source, SharedMetricsRegion* out);
+
+double sharedMetricGauge(const SharedMetric& metric);
+
+#endif //ANDROIDSAMSUNG_SHARED_METRICS_H
@@ -0,0 +1,67 @@
+#include "space_cache.h"
+
+#define LOG_TAG "SpaceCache"
+#include "log.h"
+
+int SpaceLocationCache::add(XrSpace space) {
+    if (!spaces.push_back(space)) {
+        LOGE("Space cache full (%u spaces)", MAX_SPACES);
+        return -1;
+    }
+    locations.push_back(XrSpaceLocationData{0, {{0, 0, 0, 1}, {0, 0, 0}}});
+    return (int)spaces.size() - 1;
+}
+
+void SpaceLocationCache::clear() {
+    spaces.clear();
+    locations.clear();
+    locatedTime = 0;
+}
+
+bool SpaceLocationCache::poseValid(int id) const {
+    const XrSpaceLocationFlags valid = XR_SPACE_LOCATION_POSITION_VALID_BIT | XR_SPACE_LOCATION_ORIENTATION_VALID_BIT;
+    return id >= 0 && (locations[id].locationFlags & valid) == valid;
+}
+
+void SpaceLocationCache::update(const XrDispatchTable& xr, XrSession session, XrSpace baseSpace, XrTime time) {
+    locatedTime = time;
+    cacheStats.frames++;
+    cacheStats.lastFrameCalls = 0;
+    cacheStats.batched = false;
+    if (spaces.empty()) return;
+
+    // Both entry points share a signature; the core one wins when the instance is 1.1
+    PFN_xrLocateSpaces locateSpaces = xr.LocateSpaces ? xr.LocateSpaces : xr.LocateSpacesKHR;
+    if (locateSpaces && batchUsable) {
+        XrSpacesLocateInfo locateInfo{XR_TYPE_SPACES_LOCATE_INFO};
+        locateInfo.baseSpace = baseSpace;
+        locateInfo.time = time;
+        locateInfo.spaceCount = (uint32_t)spaces.size();
+        locateInfo.spaces = spaces.data();
+        XrSpaceLocations result{XR_TYPE_SPACE_LOCATIONS};
+        result.locationCount = (uint32_t)locations.size();
+        result.locations = locations.data();
+
+        cacheStats.lastFrameCalls++;
+        XrResult status = locateSpaces(session, &locateInfo, &result);
+        if (XR_SUCCEEDED(status)) {
+            cacheStats.batched = true;
+            cacheStats.totalCalls += cacheStats.lastFrameCalls;
+            return;
+        }
+        LOGW("Batched space location failed (%d), falling back to one call per space", status);
+        batchUsable = false;
+    }
+
+    for (size_t i = 0; i < spaces.size(); ++i) {
+        XrSpaceLocation location{XR_TYPE_SPACE_LOCATION};
+        cacheStats.lastFrameCalls++;
+        if (XR_SUCCEEDED(xr.LocateSpace(spaces[i], baseSpace, time, &location))) {
+            locations[i].locationFlags = location.locationFlags;
+            locations[i].pose = location.pose;
+        } else {
+            locations[i].locationFlags = 0;
+        }
+    }
+    cacheStats.totalCalls += cacheStats.lastFrameCalls;
+}
@@ -0,0 +1,53 @@
+#ifndef ANDROIDSAMSUNG_SPACE_CACHE_H
+#define ANDROIDSAMSUNG_SPACE_CACHE_H
+
+#include <stdint.h>
+
+#include "fixed_vector.h"
+#include "xr_dispatch.h"
+
+// Locations of every space the app cares about, resolved once per frame for the predicted
+// display time. Culling, layout and hit-testing read from here instead of calling
+// xrLocateSpace themselves.
+//
+// update() uses one xrLocateSpaces (1.1) / xrLocateSpacesKHR call for all registered spaces
+// when the runtime has it, and falls back to one xrLocateSpace per space otherwise. The
+// number of runtime calls is counted so the batching can be checked on device.
+class SpaceLocationCache {
+public:
+    static constexpr uint32_t MAX_SPACES = 16;
+
+    struct Stats {
+        uint32_t lastFrameCalls = 0; // runtime calls made by the last update()
+        uint64_t totalCalls = 0;
+        uint64_t frames = 0;
+        bool batched = false;        // whether the last update() used the batched call
+    };
+
+    // Registers a space and returns its slot, or -1 when the cache is full. Call at setup.
+    int add(XrSpace space);
+
+    // Forgets every space, e.g. when the session that owns them is destroyed
+    void clear();
+
+    // Locates every registered space relative to baseSpace at `time`
+    void update(const XrDispatchTable& xr, XrSession session, XrSpace baseSpace, XrTime time);
+
+    const XrSpaceLocationData& location(int id) const { return locations[id]; }
+
+    // True when both position and orientation of the slot were valid at the last update
+    bool poseValid(int id) const;
+
+    XrTime time() const { return locatedTime; }
+    const Stats& stats() const { return cacheStats; }
+
+private:
+    FixedVector<XrSpace, MAX_SPACES> spaces;
+    FixedVector<XrSpaceLocationData, MAX_SPACES> locations;
+    XrTime locatedTime = 0;
+    // Cleared after the batched call fails once, so a broken entry point is not retried every frame
+    bool batchUsable = true;
+    Stats cacheStats;
+};
+
+#endif //ANDROIDSAMSUNG_SPACE_CACHE_H
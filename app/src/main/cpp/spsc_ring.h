@@ -0,0 +1,45 @@
+#ifndef ANDROIDSAMSUNG_SPSC_RING_H
+#define ANDROIDSAMSUNG_SPSC_RING_H
+
+#include <stddef.h>
+#include <atomic>
+
+// Fixed-capacity single-producer/single-consumer queue. push() and pop() never block and never
+// allocate; push() returns false when the ring is full so the producer can count the drop.
+// Capacity must be a power of two.
+template <typename T, size_t Capacity>
+class SpscRing {
+    static_assert((Capacity & (Capacity - 1)) == 0, "SpscRing capacity must be a power of two");
+
+public:
+    bool push(const T& value) {
+        size_t head = writeIndex.load(std::memory_order_relaxed);
+        if (head - readIndex.load(std::memory_order_acquire) == Capacity) return false;
+        items[head & (Capacity - 1)] = value;
+        writeIndex.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(T& out) {
+        size_t tail = readIndex.load(std::memory_order_relaxed);
+        if (tail == writeIndex.load(std::memory_order_acquire)) return false;
+        out = items[tail & (Capacity - 1)];
+        readIndex.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Approximate when called from the producer while the consumer runs, and vice versa
+    size_t size() const {
+        return writeIndex.load(std::memory_order_acquire) - readIndex.load(std::memory_order_acquire);
+    }
+
+    bool empty() const { return size() == 0; }
+
+private:
+    T items[Capacity];
+    // Producer and consumer indices on separate cache lines so they do not false-share
+    alignas(64) std::atomic<size_t> writeIndex{0};
+    alignas(64) std::atomic<size_t> readIndex{0};
+};
+
+#endif //ANDROIDSAMSUNG_SPSC_RING_H
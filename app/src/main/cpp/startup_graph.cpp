@@ -0,0 +1,136 @@
+#include "startup_graph.h"
+#include "monotonic_clock.h"
+#include "profiler.h"
+
+#include <algorithm>
+#include <thread>
+
+#define LOG_TAG "StartupGraph"
+#include "log.h"
+
+StartupGraph::StartupGraph() {
+    lanes.push_back("main");
+}
+
+int StartupGraph::addLane(const char* name) {
+    lanes.push_back(name);
+    return (int)lanes.size() - 1;
+}
+
+StartupGraph::TaskId StartupGraph::addTask(const char* name, int lane, std::function<bool()> fn, std::initializer_list<TaskId> deps) {
+    Task task;
+    task.name = name;
+    task.lane = lane;
+    task.fn = std::move(fn);
+    task.deps = deps;
+    tasks.push_back(std::move(task));
+    return (TaskId)tasks.size() - 1;
+}
+
+void StartupGraph::runLane(int lane) {
+    // Worker lanes get their own track in profiler output
+    if (lane != MAIN_LANE) profilerSetThreadName(lanes[lane]);
+    for (Task& task : tasks) {
+        if (task.lane != lane) continue;
+
+        bool depsOk = true;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            for (TaskId dep : task.deps) {
+                finished.wait(lock, [&] { return tasks[dep].state != State::Pending; });
+                if (tasks[dep].state != State::Done) depsOk = false;
+            }
+        }
+
+        int64_t start = monotonicNowNs();
+        bool ok = depsOk && task.fn();
+        int64_t end = monotonicNowNs();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            task.startNs = start;
+            task.endNs = depsOk ? end : start;
+            task.state = !depsOk ? State::Skipped : ok ? State::Done : State::Failed;
+        }
+        finished.notify_all();
+
+        if (!depsOk) {
+            LOGE("Startup task '%s' skipped: a dependency did not complete", task.name);
+        } else if (!ok) {
+            LOGE("Startup task '%s' failed", task.name);
+        }
+    }
+}
+
+bool StartupGraph::run() {
+    runStartNs = monotonicNowNs();
+
+    std::vector<std::thread> workers;
+    for (int lane = 1; lane < (int)lanes.size(); ++lane) {
+        workers.emplace_back(&StartupGraph::runLane, this, lane);
+    }
+    runLane(MAIN_LANE);
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+
+    runEndNs = monotonicNowNs();
+
+    for (const Task& task : tasks) {
+        if (task.state != State::Done) return false;
+    }
+    return true;
+}
+
+std::vector<StartupGraph::TaskId> StartupGraph::criticalPath() const {
+    std::vector<TaskId> path;
+    if (tasks.empty()) return path;
+
+    // Start from whichever task finished last, then repeatedly step to the dependency (or lane
+    // predecessor) that finished last before it: that is the one the task was waiting on.
+    TaskId current = 0;
+    for (TaskId i = 1; i < (TaskId)tasks.size(); ++i) {
+        if (tasks[i].endNs > tasks[current].endNs) current = i;
+    }
+
+    while (current >= 0) {
+        path.push_back(current);
+        const Task& task = tasks[current];
+
+        TaskId blocker = -1;
+        for (TaskId dep : task.deps) {
+            if (blocker < 0 || tasks[dep].endNs > tasks[blocker].endNs) blocker = dep;
+        }
+        for (TaskId prev = current - 1; prev >= 0; --prev) {
+            if (tasks[prev].lane != task.lane) continue;
+            if (blocker < 0 || tasks[prev].endNs > tasks[blocker].endNs) blocker = prev;
+            break;
+        }
+        current = blocker;
+    }
+
+    std::reverse(path.begin(), path.end());
+    return path;
+}
+
+void StartupGraph::report() const {
+    int64_t serialNs = 0;
+    for (const Task& task : tasks) {
+        serialNs += task.endNs - task.startNs;
+        LOGI("  %-20s lane=%-6s start=+%7.2f ms  took %7.2f ms%s", task.name, lanes[task.lane],
+             (task.startNs - runStartNs) / 1e6, (task.endNs - task.startNs) / 1e6,
+             task.state == State::Done ? "" : task.state == State::Failed ? "  FAILED" : "  SKIPPED");
+    }
+
+    int64_t wallNs = runEndNs - runStartNs;
+    LOGI("Startup took %.2f ms wall (%.2f ms if run serially, %.2fx)", wallNs / 1e6, serialNs / 1e6,
+         wallNs > 0 ? (double)serialNs / wallNs : 0.0);
+
+    // One line per hop, so a long path is not cut at the logger's argument limit
+    std::vector<TaskId> path = criticalPath();
+    LOGI("Startup critical path, %zu tasks:", path.size());
+    for (size_t i = 0; i < path.size(); ++i) {
+        const Task& task = tasks[path[i]];
+        LOGI("  %zu. %-20s took %7.2f ms", i + 1, task.name, (task.endNs - task.startNs) / 1e6);
+    }
+}
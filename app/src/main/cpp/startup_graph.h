@@ -0,0 +1,59 @@
+#ifndef ANDROIDSAMSUNG_STARTUP_GRAPH_H
+#define ANDROIDSAMSUNG_STARTUP_GRAPH_H
+
+#include <stdint.h>
+#include <condition_variable>
+#include <functional>
+#include <initializer_list>
+#include <mutex>
+#include <vector>
+
+// Runs startup steps as a dependency graph.
+//
+// Every task belongs to a lane. A lane is one thread that runs its tasks in the order they
+// were added, which is how GL work stays on the thread that owns the EGL context. Lane 0 is
+// the thread calling run(); every other lane gets its own worker thread. A task starts once
+// all of its dependencies have finished; if one of them failed, the task is skipped.
+class StartupGraph {
+public:
+    using TaskId = int;
+    static const int MAIN_LANE = 0;
+
+    StartupGraph();
+
+    int addLane(const char* name);
+    TaskId addTask(const char* name, int lane, std::function<bool()> fn, std::initializer_list<TaskId> deps = {});
+
+    // Runs every lane to completion. Returns false if any task failed or was skipped.
+    bool run();
+
+    // Logs per-task timings, the total serial cost and the critical path of the last run.
+    void report() const;
+
+    // Chain of tasks that determined the wall time of the last run, first task first.
+    std::vector<TaskId> criticalPath() const;
+
+private:
+    enum class State { Pending, Done, Failed, Skipped };
+
+    struct Task {
+        const char* name;
+        int lane;
+        std::function<bool()> fn;
+        std::vector<TaskId> deps;
+        State state = State::Pending;
+        int64_t startNs = 0;
+        int64_t endNs = 0;
+    };
+
+    void runLane(int lane);
+
+    std::vector<const char*> lanes;
+    std::vector<Task> tasks;
+    std::mutex mutex;
+    std::condition_variable finished;
+    int64_t runStartNs = 0;
+    int64_t runEndNs = 0;
+};
+
+#endif //ANDROIDSAMSUNG_STARTUP_GRAPH_H
@@ -0,0 +1,174 @@
+#ifndef ANDROIDSAMSUNG_THREAD_RING_REGISTRY_H
+#define ANDROIDSAMSUNG_THREAD_RING_REGISTRY_H
+
+#include "spsc_ring.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Per-thread SpscRings drained by one background consumer thread, as used by the logger and
+// the profiler.
+//
+// push() is lock-free after a thread's first call, which allocates that thread's ring and
+// registers it. When the thread exits its ring is marked retired; the consumer frees it once
+// drained. Records that do not fit are counted as dropped. The consumer wakes every `interval`
+// and hands each record to `consume` with the index of the thread that pushed it (0, 1, ... in
+// order of first push). `afterDrain`, if set, runs after each pass.
+//
+// The thread-exit hook is shared by every registry of the same Record and Capacity, so keep one
+// registry per Record type. Destroying the registry stops and joins the consumer.
+template <typename Record, size_t Capacity>
+class ThreadRingRegistry {
+public:
+    using Consumer = void (*)(const Record& record, uint32_t threadIndex);
+
+    ThreadRingRegistry(Consumer consume, void (*afterDrain)(), std::chrono::milliseconds interval)
+        : consume(consume), afterDrain(afterDrain), interval(interval) {}
+
+    ~ThreadRingRegistry() { shutdown(); }
+
+    ThreadRingRegistry(const ThreadRingRegistry&) = delete;
+    ThreadRingRegistry& operator=(const ThreadRingRegistry&) = delete;
+
+    // Queues a record from the calling thread; false if its ring was full and the record dropped
+    bool push(const Record& record) {
+        Buffer* buffer = acquire();
+        if (buffer->ring.push(record)) return true;
+        buffer->dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    // Index the consumer sees for records from the calling thread
+    uint32_t threadIndex() { return acquire()->threadIndex; }
+
+    // Threads that have pushed so far; indices run from 0 to this minus one
+    uint32_t threadCount() {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        return threadsSeen;
+    }
+
+    // Held while records are consumed. Lock it to read state that `consume` builds up.
+    std::mutex& consumerMutex() { return drainMutex; }
+
+    // Consumes everything queued so far. Caller holds consumerMutex().
+    void drainLocked() {
+        std::vector<Buffer*> buffers;
+        {
+            std::lock_guard<std::mutex> lock(registryMutex);
+            buffers = registry;
+        }
+
+        Record record;
+        for (Buffer* buffer : buffers) {
+            // Read retired first: if set, the owning thread has pushed its last record
+            bool retired = buffer->retired.load(std::memory_order_acquire);
+            while (buffer->ring.pop(record)) {
+                consume(record, buffer->threadIndex);
+            }
+            if (retired) {
+                std::lock_guard<std::mutex> lock(registryMutex);
+                registry.erase(std::find(registry.begin(), registry.end(), buffer));
+                retiredDropped += buffer->dropped.load();
+                delete buffer;
+            }
+        }
+        if (afterDrain) afterDrain();
+    }
+
+    void flush() {
+        std::lock_guard<std::mutex> lock(drainMutex);
+        drainLocked();
+    }
+
+    // Joins the consumer and drains what is left. Records pushed afterwards are still queued but
+    // never consumed, so callers check stopped() first.
+    void shutdown() {
+        if (stoppedFlag.exchange(true)) return;
+        running = false;
+        wake.notify_all();
+        if (consumerThread.joinable()) consumerThread.join();
+        flush();
+    }
+
+    bool stopped() const { return stoppedFlag.load(std::memory_order_acquire); }
+
+    // Records dropped since the process started, across live and retired threads
+    uint64_t droppedCount() {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        uint64_t dropped = retiredDropped;
+        for (Buffer* buffer : registry) {
+            dropped += buffer->dropped.load(std::memory_order_relaxed);
+        }
+        return dropped;
+    }
+
+private:
+    struct Buffer {
+        SpscRing<Record, Capacity> ring;
+        std::atomic<uint64_t> dropped{0};
+        std::atomic<bool> retired{false};
+        uint32_t threadIndex = 0;
+    };
+
+    // Marks the thread's buffer as retired when the thread exits
+    struct Owner {
+        Buffer* buffer = nullptr;
+        ~Owner() {
+            if (buffer) buffer->retired.store(true, std::memory_order_release);
+            buffer = nullptr;
+        }
+    };
+
+    Buffer* acquire() {
+        static thread_local Owner owner;
+        if (!owner.buffer) {
+            // First record from this thread: the only allocation made on a producer thread
+            auto* buffer = new Buffer();
+            {
+                std::lock_guard<std::mutex> lock(registryMutex);
+                buffer->threadIndex = threadsSeen++;
+                registry.push_back(buffer);
+            }
+            owner.buffer = buffer;
+            std::call_once(consumerStarted, [this] {
+                running = true;
+                consumerThread = std::thread([this] { consumerLoop(); });
+            });
+        }
+        return owner.buffer;
+    }
+
+    void consumerLoop() {
+        std::unique_lock<std::mutex> lock(drainMutex);
+        while (running.load()) {
+            wake.wait_for(lock, interval);
+            drainLocked();
+        }
+        drainLocked();
+    }
+
+    const Consumer consume;
+    void (*const afterDrain)();
+    const std::chrono::milliseconds interval;
+
+    std::mutex registryMutex;
+    std::vector<Buffer*> registry;
+    uint32_t threadsSeen = 0;     // guarded by registryMutex
+    uint64_t retiredDropped = 0;  // guarded by registryMutex
+
+    std::mutex drainMutex;
+    std::condition_variable wake;
+    std::thread consumerThread;
+    std::atomic<bool> running{false};
+    std::atomic<bool> stoppedFlag{false};
+    std::once_flag consumerStarted;
+};
+
+#endif //ANDROIDSAMSUNG_THREAD_RING_REGISTRY_H
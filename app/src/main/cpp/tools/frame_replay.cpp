@@ -0,0 +1,787 @@
+// Replays a layer capture written by FrameCapture (frame_capture.h).
+//
+//     frame_replay <capture.xfec> [--runtime <lib.so>] [--loops <n>] [--period-ms <ms>]
+//                                 [--no-app-time] [--csv <file>]
+//
+// Without --runtime the capture goes to a stand-in: a virtual display at the captured (or
+// --period-ms) refresh period that takes each frame's recorded CPU time and layer stack, and
+// reports what a compositor would have had to read (pixels and bytes per frame, from the
+// subImage rects and swapchain formats), how often content changed, and which frames miss
+// their slot. It never sleeps, so the same file always gives the same numbers.
+//
+// With --runtime the stream is re-submitted to a real OpenXR runtime through a GLES context
+// on a surfaceless EGL pbuffer (XR_MNDX_egl_enable). <lib.so> must export
+// xrGetInstanceProcAddr: the loader, or a runtime that can be linked directly such as
+// mock_runtime/libxr_mock_runtime.so. Swapchains and reference spaces are recreated from the
+// capture; each swapchain is cleared to a colour derived from its content hash whenever the
+// hash changes (every frame if it was never hashed), and after xrWaitFrame the replay waits
+// out the frame's captured CPU time (--no-app-time skips that) so the runtime sees the
+// original pacing. Reports the xrWaitFrame/xrBeginFrame/xrEndFrame costs and the display
+// slots the runtime skipped.
+
+#include "frame_capture.h"
+#include "headless_egl.h"
+#include "log_histogram.h"
+#include "monotonic_clock.h"
+
+#include <dlfcn.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <map>
+#include <vector>
+
+// --- Capture file ---
+
+struct CapturedLayer {
+    FrameCaptureLayer layer;
+    FrameCaptureView views[FrameCapture::MAX_VIEWS];
+};
+
+struct CapturedFrame {
+    FrameCaptureFrame frame;
+    std::vector<CapturedLayer> layers;
+};
+
+struct Capture {
+    std::vector<FrameCaptureSwapchain> swapchains;
+    std::vector<FrameCaptureSpace> spaces;
+    std::vector<CapturedFrame> frames;
+
+    const FrameCaptureSwapchain* swapchain(uint32_t id) const {
+        for (const FrameCaptureSwapchain& s : swapchains) {
+            if (s.id == id) return &s;
+        }
+        return nullptr;
+    }
+};
+
+static bool loadCapture(const char* path, Capture* capture) {
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        perror(path);
+        return false;
+    }
+    std::vector<uint8_t> data;
+    uint8_t chunk[1 << 16];
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), file)) > 0) data.insert(data.end(), chunk, chunk + n);
+    fclose(file);
+
+    FrameCaptureFileHeader header;
+    if (data.size() < sizeof(header)) {
+        fprintf(stderr, "%s: too short for a layer capture\n", path);
+        return false;
+    }
+    memcpy(&header, data.data(), sizeof(header));
+    if (header.magic != FRAME_CAPTURE_MAGIC || header.version != FRAME_CAPTURE_VERSION) {
+        fprintf(stderr, "%s: not a version %u layer capture\n", path, FRAME_CAPTURE_VERSION);
+        return false;
+    }
+
+    size_t offset = header.headerSize;
+    while (offset + sizeof(FrameCaptureRecordHeader) <= data.size()) {
+        FrameCaptureRecordHeader record;
+        memcpy(&record, data.data() + offset, sizeof(record));
+        offset += sizeof(record);
+        if (offset + record.size > data.size()) {
+            fprintf(stderr, "%s: truncated after %zu frames\n", path, capture->frames.size());
+            break;
+        }
+        const uint8_t* payload = data.data() + offset;
+        offset += record.size;
+
+        switch ((FrameCaptureTag)record.tag) {
+            case FrameCaptureTag::Swapchain: {
+                if (record.size < sizeof(FrameCaptureSwapchain)) break;
+                FrameCaptureSwapchain swapchain;
+                memcpy(&swapchain, payload, sizeof(swapchain));
+                capture->swapchains.push_back(swapchain);
+                break;
+            }
+            case FrameCaptureTag::Space: {
+                if (record.size < sizeof(FrameCaptureSpace)) break;
+                FrameCaptureSpace space;
+                memcpy(&space, payload, sizeof(space));
+                capture->spaces.push_back(space);
+                break;
+            }
+            case FrameCaptureTag::Frame: {
+                if (record.size < sizeof(FrameCaptureFrame)) break;
+                CapturedFrame frame;
+                memcpy(&frame.frame, payload, sizeof(frame.frame));
+                size_t at = sizeof(frame.frame);
+                for (uint32_t i = 0; i < frame.frame.layerCount && at + sizeof(FrameCaptureLayer) <= record.size; ++i) {
+                    CapturedLayer layer = {};
+                    memcpy(&layer.layer, payload + at, sizeof(layer.layer));
+                    at += sizeof(layer.layer);
+                    if (layer.layer.viewCount > FrameCapture::MAX_VIEWS ||
+                        at + layer.layer.viewCount * sizeof(FrameCaptureView) > record.size) {
+                        break;
+                    }
+                    memcpy(layer.views, payload + at, layer.layer.viewCount * sizeof(FrameCaptureView));
+                    at += layer.layer.viewCount * sizeof(FrameCaptureView);
+                    frame.layers.push_back(layer);
+                }
+                capture->frames.push_back(std::move(frame));
+                break;
+            }
+            default:
+                // Records from a newer writer; their size lets us step over them
+                break;
+        }
+    }
+    return true;
+}
+
+// --- Layer cost ---
+
+static uint32_t bytesPerPixel(int64_t format) {
+    switch (format) {
+        case GL_RGBA16F:
+        case GL_RGBA16UI:
+            return 8;
+        case GL_RGBA32F:
+            return 16;
+        case GL_RGB565:
+            return 2;
+        default:
+            return 4; // RGBA8, SRGB8_ALPHA8, RGB10_A2 and anything not recorded
+    }
+}
+
+struct FrameCost {
+    uint64_t pixels = 0; // sampled by the compositor across both eyes
+    uint64_t bytes = 0;
+};
+
+static void addSubImage(const Capture& capture, const FrameCaptureSubImage& image, uint32_t eyes, FrameCost* cost) {
+    uint64_t pixels = (uint64_t)image.rect.extent.width * (uint64_t)image.rect.extent.height * eyes;
+    const FrameCaptureSwapchain* swapchain = capture.swapchain(image.swapchain);
+    cost->pixels += pixels;
+    cost->bytes += pixels * bytesPerPixel(swapchain ? swapchain->format : 0);
+}
+
+static FrameCost frameCost(const Capture& capture, const CapturedFrame& frame) {
+    FrameCost cost;
+    for (const CapturedLayer& layer : frame.layers) {
+        if (layer.layer.type == XR_TYPE_COMPOSITION_LAYER_PROJECTION) {
+            for (uint32_t v = 0; v < layer.layer.viewCount; ++v) addSubImage(capture, layer.views[v].subImage, 1, &cost);
+        } else if (layer.layer.type == XR_TYPE_COMPOSITION_LAYER_QUAD ||
+                   layer.layer.type == XR_TYPE_COMPOSITION_LAYER_CYLINDER_KHR) {
+            uint32_t eyes = layer.layer.eyeVisibility == XR_EYE_VISIBILITY_BOTH ? 2 : 1;
+            addSubImage(capture, layer.layer.subImage, eyes, &cost);
+        }
+    }
+    return cost;
+}
+
+// Calls fn(subImage) for every subImage the frame submits
+template <typename Fn>
+static void forEachSubImage(const CapturedFrame& frame, Fn&& fn) {
+    for (const CapturedLayer& layer : frame.layers) {
+        if (layer.layer.type == XR_TYPE_COMPOSITION_LAYER_PROJECTION) {
+            for (uint32_t v = 0; v < layer.layer.viewCount; ++v) fn(layer.views[v].subImage);
+        } else if (layer.layer.subImage.swapchain != 0) {
+            fn(layer.layer.subImage);
+        }
+    }
+}
+
+static const char* layerTypeName(uint32_t type) {
+    switch (type) {
+        case XR_TYPE_COMPOSITION_LAYER_PROJECTION: return "projection";
+        case XR_TYPE_COMPOSITION_LAYER_QUAD: return "quad";
+        case XR_TYPE_COMPOSITION_LAYER_CYLINDER_KHR: return "cylinder";
+        default: return "other";
+    }
+}
+
+static void printHistogram(const char* name, const LogHistogram& histogram) {
+    if (histogram.count() == 0) return;
+    printf("  %-18s p50 %7.2f  p90 %7.2f  p99 %7.2f  max %7.2f ms\n", name, histogram.percentile(0.5) / 1e6,
+           histogram.percentile(0.9) / 1e6, histogram.percentile(0.99) / 1e6, histogram.max() / 1e6);
+}
+
+static void printSummary(const Capture& capture) {
+    const CapturedFrame& first = capture.frames.front();
+    const CapturedFrame& last = capture.frames.back();
+    printf("%zu frames over %.2f s, %zu swapchains, %zu spaces, display period %.2f ms\n", capture.frames.size(),
+           (last.frame.endReturnNs - first.frame.waitReturnNs) / 1e9, capture.swapchains.size(),
+           capture.spaces.size(), first.frame.displayPeriodNs / 1e6);
+    for (const FrameCaptureSwapchain& s : capture.swapchains) {
+        printf("  swapchain %u: %ux%u x%u format 0x%llx\n", s.id, s.width, s.height, s.arraySize,
+               (unsigned long long)s.format);
+    }
+    std::map<uint32_t, uint64_t> layerTypes;
+    for (const CapturedFrame& frame : capture.frames) {
+        for (const CapturedLayer& layer : frame.layers) ++layerTypes[layer.layer.type];
+    }
+    for (const auto& entry : layerTypes) {
+        printf("  %-10s layers: %.2f per frame\n", layerTypeName(entry.first),
+               (double)entry.second / capture.frames.size());
+    }
+}
+
+// --- Stand-in ---
+
+static int replayStandIn(const Capture& capture, int loops, int64_t periodNs, FILE* csv) {
+    LogHistogram cpuTime, endFrameTime, interval;
+    uint64_t totalPixels = 0, totalBytes = 0, maxPixels = 0;
+    uint64_t contentChanges = 0, missedSlots = 0, lateFrames = 0, failedFrames = 0, skippedRenders = 0;
+    std::map<uint32_t, uint64_t> lastHash;
+    if (csv) fprintf(csv, "frame,layers,pixels,bytes,cpu_ns,end_frame_ns,slots\n");
+
+    uint64_t frameNumber = 0;
+    for (int loop = 0; loop < loops; ++loop) {
+        for (size_t i = 0; i < capture.frames.size(); ++i, ++frameNumber) {
+            const CapturedFrame& frame = capture.frames[i];
+            int64_t cpuNs = frame.frame.endCallNs - frame.frame.waitReturnNs;
+            int64_t endNs = frame.frame.endReturnNs - frame.frame.endCallNs;
+            cpuTime.record(cpuNs);
+            endFrameTime.record(endNs);
+            if (i > 0) interval.record(frame.frame.waitReturnNs - capture.frames[i - 1].frame.waitReturnNs);
+            if (frame.frame.endResult < 0) ++failedFrames;
+            if (!frame.frame.shouldRender) ++skippedRenders;
+
+            FrameCost cost = frameCost(capture, frame);
+            totalPixels += cost.pixels;
+            totalBytes += cost.bytes;
+            if (cost.pixels > maxPixels) maxPixels = cost.pixels;
+
+            bool changed = false;
+            forEachSubImage(frame, [&](const FrameCaptureSubImage& image) {
+                auto found = lastHash.find(image.swapchain);
+                if (image.contentHash == 0 || found == lastHash.end() || found->second != image.contentHash) changed = true;
+                lastHash[image.swapchain] = image.contentHash;
+            });
+            if (changed) ++contentChanges;
+
+            // The frame starts on a display slot; work that runs past it pushes the next
+            // frame's xrWaitFrame to a later slot
+            int64_t workNs = cpuNs + endNs;
+            int64_t slots = workNs <= periodNs ? 1 : (workNs + periodNs - 1) / periodNs;
+            if (slots > 1) {
+                ++lateFrames;
+                missedSlots += (uint64_t)(slots - 1);
+            }
+            if (csv) {
+                fprintf(csv, "%llu,%zu,%llu,%llu,%lld,%lld,%lld\n", (unsigned long long)frameNumber,
+                        frame.layers.size(), (unsigned long long)cost.pixels, (unsigned long long)cost.bytes,
+                        (long long)cpuNs, (long long)endNs, (long long)slots);
+            }
+        }
+    }
+
+    uint64_t frames = frameNumber;
+    printf("Stand-in, %d loop(s) at %.2f ms:\n", loops, periodNs / 1e6);
+    printHistogram("app CPU", cpuTime);
+    printHistogram("xrEndFrame", endFrameTime);
+    printHistogram("frame interval", interval);
+    printf("  composited: %.2f Mpx / %.2f MB per frame average, %.2f Mpx max\n", totalPixels / 1e6 / frames,
+           totalBytes / 1e6 / frames, maxPixels / 1e6);
+    printf("  content changed in %llu of %llu frames\n", (unsigned long long)contentChanges, (unsigned long long)frames);
+    printf("  late frames %llu, missed slots %llu, shouldRender=false %llu, failed xrEndFrame %llu\n",
+           (unsigned long long)lateFrames, (unsigned long long)missedSlots, (unsigned long long)skippedRenders,
+           (unsigned long long)failedFrames);
+    return 0;
+}
+
+// --- Runtime ---
+
+struct ReplayDispatch {
+    PFN_xrGetInstanceProcAddr GetInstanceProcAddr;
+    PFN_xrCreateInstance CreateInstance;
+    PFN_xrDestroyInstance DestroyInstance;
+    PFN_xrGetSystem GetSystem;
+    PFN_xrGetOpenGLESGraphicsRequirementsKHR GetOpenGLESGraphicsRequirementsKHR;
+    PFN_xrCreateSession CreateSession;
+    PFN_xrDestroySession DestroySession;
+    PFN_xrBeginSession BeginSession;
+    PFN_xrEndSession EndSession;
+    PFN_xrPollEvent PollEvent;
+    PFN_xrCreateReferenceSpace CreateReferenceSpace;
+    PFN_xrDestroySpace DestroySpace;
+    PFN_xrCreateSwapchain CreateSwapchain;
+    PFN_xrDestroySwapchain DestroySwapchain;
+    PFN_xrEnumerateSwapchainImages EnumerateSwapchainImages;
+    PFN_xrAcquireSwapchainImage AcquireSwapchainImage;
+    PFN_xrWaitSwapchainImage WaitSwapchainImage;
+    PFN_xrReleaseSwapchainImage ReleaseSwapchainImage;
+    PFN_xrWaitFrame WaitFrame;
+    PFN_xrBeginFrame BeginFrame;
+    PFN_xrEndFrame EndFrame;
+};
+
+template <typename Pfn>
+static bool resolve(const ReplayDispatch& d, XrInstance instance, const char* name, Pfn* out) {
+    *out = nullptr;
+    return XR_SUCCEEDED(d.GetInstanceProcAddr(instance, name, reinterpret_cast<PFN_xrVoidFunction*>(out))) && *out;
+}
+
+struct ReplaySwapchain {
+    XrSwapchain handle = XR_NULL_HANDLE;
+    std::vector<XrSwapchainImageOpenGLESKHR> images;
+    uint32_t arraySize = 1;
+    uint64_t hash = 0;
+    uint64_t renderedFrame = 0; // replay frame number + 1 of the last render; 0 if never
+};
+
+struct Replay {
+    ReplayDispatch xr = {};
+    XrInstance instance = XR_NULL_HANDLE;
+    XrSession session = XR_NULL_HANDLE;
+    XrSessionState state = XR_SESSION_STATE_UNKNOWN;
+    bool running = false;
+    bool exitRequested = false;
+    std::map<uint32_t, ReplaySwapchain> swapchains;
+    std::map<uint32_t, XrSpace> spaces;
+    XrSpace defaultSpace = XR_NULL_HANDLE;
+    HeadlessEgl egl;
+    GLuint framebuffer = 0;
+};
+
+static bool createInstance(Replay* replay, const Capture& capture) {
+    ReplayDispatch& d = replay->xr;
+    resolve(d, XR_NULL_HANDLE, "xrCreateInstance", &d.CreateInstance);
+    if (!d.CreateInstance) {
+        fprintf(stderr, "The library does not provide xrCreateInstance\n");
+        return false;
+    }
+
+    std::vector<const char*> extensions = {XR_KHR_OPENGL_ES_ENABLE_EXTENSION_NAME, XR_MNDX_EGL_ENABLE_EXTENSION_NAME};
+    for (const CapturedFrame& frame : capture.frames) {
+        bool cylinder = false;
+        for (const CapturedLayer& layer : frame.layers) cylinder |= layer.layer.type == XR_TYPE_COMPOSITION_LAYER_CYLINDER_KHR;
+        if (cylinder) {
+            extensions.push_back(XR_KHR_COMPOSITION_LAYER_CYLINDER_EXTENSION_NAME);
+            break;
+        }
+    }
+
+    XrInstanceCreateInfo createInfo{XR_TYPE_INSTANCE_CREATE_INFO};
+    strncpy(createInfo.applicationInfo.applicationName, "frame_replay", XR_MAX_APPLICATION_NAME_SIZE - 1);
+    createInfo.applicationInfo.apiVersion = XR_API_VERSION_1_0;
+    createInfo.enabledExtensionCount = (uint32_t)extensions.size();
+    createInfo.enabledExtensionNames = extensions.data();
+    XrResult result = d.CreateInstance(&createInfo, &replay->instance);
+    if (XR_FAILED(result)) {
+        fprintf(stderr, "xrCreateInstance failed: %d\n", result);
+        return false;
+    }
+
+    bool resolved = resolve(d, replay->instance, "xrDestroyInstance", &d.DestroyInstance) &&
+                    resolve(d, replay->instance, "xrGetSystem", &d.GetSystem) &&
+                    resolve(d, replay->instance, "xrCreateSession", &d.CreateSession) &&
+                    resolve(d, replay->instance, "xrDestroySession", &d.DestroySession) &&
+                    resolve(d, replay->instance, "xrBeginSession", &d.BeginSession) &&
+                    resolve(d, replay->instance, "xrEndSession", &d.EndSession) &&
+                    resolve(d, replay->instance, "xrPollEvent", &d.PollEvent) &&
+                    resolve(d, replay->instance, "xrCreateReferenceSpace", &d.CreateReferenceSpace) &&
+                    resolve(d, replay->instance, "xrDestroySpace", &d.DestroySpace) &&
+                    resolve(d, replay->instance, "xrCreateSwapchain", &d.CreateSwapchain) &&
+                    resolve(d, replay->instance, "xrDestroySwapchain", &d.DestroySwapchain) &&
+                    resolve(d, replay->instance, "xrEnumerateSwapchainImages", &d.EnumerateSwapchainImages) &&
+                    resolve(d, replay->instance, "xrAcquireSwapchainImage", &d.AcquireSwapchainImage) &&
+                    resolve(d, replay->instance, "xrWaitSwapchainImage", &d.WaitSwapchainImage) &&
+                    resolve(d, replay->instance, "xrReleaseSwapchainImage", &d.ReleaseSwapchainImage) &&
+                    resolve(d, replay->instance, "xrWaitFrame", &d.WaitFrame) &&
+                    resolve(d, replay->instance, "xrBeginFrame", &d.BeginFrame) &&
+                    resolve(d, replay->instance, "xrEndFrame", &d.EndFrame);
+    if (!resolved) {
+        fprintf(stderr, "The runtime is missing core functions\n");
+        return false;
+    }
+    resolve(d, replay->instance, "xrGetOpenGLESGraphicsRequirementsKHR", &d.GetOpenGLESGraphicsRequirementsKHR);
+    return true;
+}
+
+static bool createSession(Replay* replay) {
+    ReplayDispatch& d = replay->xr;
+    XrSystemGetInfo systemInfo{XR_TYPE_SYSTEM_GET_INFO};
+    systemInfo.formFactor = XR_FORM_FACTOR_HEAD_MOUNTED_DISPLAY;
+    XrSystemId systemId;
+    if (XR_FAILED(d.GetSystem(replay->instance, &systemInfo, &systemId))) {
+        fprintf(stderr, "No head-mounted system\n");
+        return false;
+    }
+    if (d.GetOpenGLESGraphicsRequirementsKHR) {
+        XrGraphicsRequirementsOpenGLESKHR requirements{XR_TYPE_GRAPHICS_REQUIREMENTS_OPENGL_ES_KHR};
+        d.GetOpenGLESGraphicsRequirementsKHR(replay->instance, systemId, &requirements);
+    }
+
+    XrGraphicsBindingEGLMNDX binding{XR_TYPE_GRAPHICS_BINDING_EGL_MNDX};
+    binding.getProcAddress = reinterpret_cast<PFN_xrEglGetProcAddressMNDX>(eglGetProcAddress);
+    binding.display = replay->egl.display;
+    binding.config = replay->egl.config;
+    binding.context = replay->egl.context;
+    XrSessionCreateInfo sessionInfo{XR_TYPE_SESSION_CREATE_INFO, &binding, 0, systemId};
+    XrResult result = d.CreateSession(replay->instance, &sessionInfo, &replay->session);
+    if (XR_FAILED(result)) {
+        fprintf(stderr, "xrCreateSession failed: %d\n", result);
+        return false;
+    }
+    return true;
+}
+
+static XrSpace createSpace(Replay* replay, XrReferenceSpaceType type, const XrPosef& pose) {
+    XrReferenceSpaceCreateInfo info{XR_TYPE_REFERENCE_SPACE_CREATE_INFO, nullptr, type, pose};
+    XrSpace space = XR_NULL_HANDLE;
+    if (XR_FAILED(replay->xr.CreateReferenceSpace(replay->session, &info, &space))) {
+        fprintf(stderr, "Cannot create reference space %d\n", type);
+    }
+    return space;
+}
+
+// Recreates the captured swapchains and spaces. Sizes the app never registered are taken
+// from the largest rect that refers to them.
+static bool createResources(Replay* replay, const Capture& capture) {
+    std::map<uint32_t, FrameCaptureSwapchain> wanted;
+    for (const FrameCaptureSwapchain& s : capture.swapchains) wanted[s.id] = s;
+    for (const CapturedFrame& frame : capture.frames) {
+        forEachSubImage(frame, [&](const FrameCaptureSubImage& image) {
+            FrameCaptureSwapchain& s = wanted[image.swapchain];
+            s.id = image.swapchain;
+            uint32_t right = (uint32_t)(image.rect.offset.x + image.rect.extent.width);
+            uint32_t bottom = (uint32_t)(image.rect.offset.y + image.rect.extent.height);
+            if (right > s.width) s.width = right;
+            if (bottom > s.height) s.height = bottom;
+            if (image.arrayIndex + 1 > s.arraySize) s.arraySize = image.arrayIndex + 1;
+        });
+    }
+
+    for (const auto& entry : wanted) {
+        const FrameCaptureSwapchain& s = entry.second;
+        XrSwapchainCreateInfo info{XR_TYPE_SWAPCHAIN_CREATE_INFO};
+        info.usageFlags = s.usageFlags ? s.usageFlags : XR_SWAPCHAIN_USAGE_SAMPLED_BIT | XR_SWAPCHAIN_USAGE_COLOR_ATTACHMENT_BIT;
+        info.usageFlags |= XR_SWAPCHAIN_USAGE_COLOR_ATTACHMENT_BIT; // replay clears through an FBO
+        info.format = s.format ? s.format : GL_RGBA8;
+        info.sampleCount = s.sampleCount ? s.sampleCount : 1;
+        info.width = s.width;
+        info.height = s.height;
+        info.faceCount = s.faceCount ? s.faceCount : 1;
+        info.arraySize = s.arraySize ? s.arraySize : 1;
+        info.mipCount = s.mipCount ? s.mipCount : 1;
+
+        ReplaySwapchain swapchain;
+        swapchain.arraySize = info.arraySize;
+        XrResult result = replay->xr.CreateSwapchain(replay->session, &info, &swapchain.handle);
+        if (XR_FAILED(result) && info.format != GL_RGBA8) {
+            fprintf(stderr, "Swapchain %u: format 0x%llx not accepted, using GL_RGBA8\n", s.id, (unsigned long long)info.format);
+            info.format = GL_RGBA8;
+            result = replay->xr.CreateSwapchain(replay->session, &info, &swapchain.handle);
+        }
+        if (XR_FAILED(result)) {
+            fprintf(stderr, "Cannot create swapchain %u (%ux%u x%u): %d\n", s.id, info.width, info.height, info.arraySize, result);
+            return false;
+        }
+        uint32_t imageCount = 0;
+        replay->xr.EnumerateSwapchainImages(swapchain.handle, 0, &imageCount, nullptr);
+        swapchain.images.assign(imageCount, {XR_TYPE_SWAPCHAIN_IMAGE_OPENGL_ES_KHR});
+        replay->xr.EnumerateSwapchainImages(swapchain.handle, imageCount, &imageCount,
+                                            reinterpret_cast<XrSwapchainImageBaseHeader*>(swapchain.images.data()));
+        replay->swapchains[s.id] = std::move(swapchain);
+    }
+
+    XrPosef identity = {{0, 0, 0, 1}, {0, 0, 0}};
+    for (const FrameCaptureSpace& s : capture.spaces) {
+        XrReferenceSpaceType type = s.referenceSpaceType ? (XrReferenceSpaceType)s.referenceSpaceType : XR_REFERENCE_SPACE_TYPE_LOCAL;
+        replay->spaces[s.id] = createSpace(replay, type, s.poseInReferenceSpace);
+    }
+    replay->defaultSpace = createSpace(replay, XR_REFERENCE_SPACE_TYPE_LOCAL, identity);
+    return replay->defaultSpace != XR_NULL_HANDLE;
+}
+
+static void pollEvents(Replay* replay) {
+    XrEventDataBuffer event{XR_TYPE_EVENT_DATA_BUFFER};
+    while (replay->xr.PollEvent(replay->instance, &event) == XR_SUCCESS) {
+        if (event.type == XR_TYPE_EVENT_DATA_SESSION_STATE_CHANGED) {
+            replay->state = reinterpret_cast<XrEventDataSessionStateChanged&>(event).state;
+            if (replay->state == XR_SESSION_STATE_READY) {
+                XrSessionBeginInfo beginInfo{XR_TYPE_SESSION_BEGIN_INFO};
+                beginInfo.primaryViewConfigurationType = XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO;
+                replay->running = XR_SUCCEEDED(replay->xr.BeginSession(replay->session, &beginInfo));
+            } else if (replay->state == XR_SESSION_STATE_STOPPING) {
+                replay->xr.EndSession(replay->session);
+                replay->running = false;
+            } else if (replay->state == XR_SESSION_STATE_EXITING || replay->state == XR_SESSION_STATE_LOSS_PENDING) {
+                replay->exitRequested = true;
+            }
+        } else if (event.type == XR_TYPE_EVENT_DATA_INSTANCE_LOSS_PENDING) {
+            replay->exitRequested = true;
+        }
+        event = {XR_TYPE_EVENT_DATA_BUFFER};
+    }
+}
+
+// Clears every array layer of the swapchain's next image to a colour picked by `hash`
+static void renderSwapchain(Replay* replay, ReplaySwapchain& swapchain, uint64_t hash) {
+    uint32_t index;
+    XrSwapchainImageAcquireInfo acquireInfo{XR_TYPE_SWAPCHAIN_IMAGE_ACQUIRE_INFO};
+    if (XR_FAILED(replay->xr.AcquireSwapchainImage(swapchain.handle, &acquireInfo, &index))) return;
+    XrSwapchainImageWaitInfo waitInfo{XR_TYPE_SWAPCHAIN_IMAGE_WAIT_INFO, nullptr, XR_INFINITE_DURATION};
+    replay->xr.WaitSwapchainImage(swapchain.handle, &waitInfo);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, replay->framebuffer);
+    GLuint image = swapchain.images[index].image;
+    glClearColor((hash & 0xff) / 255.0f, ((hash >> 8) & 0xff) / 255.0f, ((hash >> 16) & 0xff) / 255.0f, 1.0f);
+    for (uint32_t layer = 0; layer < swapchain.arraySize; ++layer) {
+        if (swapchain.arraySize > 1) {
+            glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, image, 0, (GLint)layer);
+        } else {
+            glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, image, 0);
+        }
+        glClear(GL_COLOR_BUFFER_BIT);
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    XrSwapchainImageReleaseInfo releaseInfo{XR_TYPE_SWAPCHAIN_IMAGE_RELEASE_INFO};
+    replay->xr.ReleaseSwapchainImage(swapchain.handle, &releaseInfo);
+    swapchain.hash = hash;
+}
+
+static XrSwapchainSubImage toSubImage(Replay* replay, const FrameCaptureSubImage& image) {
+    XrSwapchainSubImage subImage = {};
+    auto found = replay->swapchains.find(image.swapchain);
+    subImage.swapchain = found != replay->swapchains.end() ? found->second.handle : XR_NULL_HANDLE;
+    subImage.imageRect = image.rect;
+    subImage.imageArrayIndex = image.arrayIndex;
+    return subImage;
+}
+
+static XrSpace toSpace(Replay* replay, uint32_t id) {
+    auto found = replay->spaces.find(id);
+    return found != replay->spaces.end() && found->second ? found->second : replay->defaultSpace;
+}
+
+// Layer structs for one frame; all storage lives here so the header pointers stay valid
+struct ReplayLayers {
+    std::vector<XrCompositionLayerProjection> projections;
+    std::vector<XrCompositionLayerProjectionView> views;
+    std::vector<XrCompositionLayerQuad> quads;
+    std::vector<XrCompositionLayerCylinderKHR> cylinders;
+    std::vector<XrCompositionLayerBaseHeader*> headers;
+
+    void build(Replay* replay, const CapturedFrame& frame) {
+        size_t count = frame.layers.size();
+        projections.assign(count, {XR_TYPE_COMPOSITION_LAYER_PROJECTION});
+        views.assign(count * FrameCapture::MAX_VIEWS, {XR_TYPE_COMPOSITION_LAYER_PROJECTION_VIEW});
+        quads.assign(count, {XR_TYPE_COMPOSITION_LAYER_QUAD});
+        cylinders.assign(count, {XR_TYPE_COMPOSITION_LAYER_CYLINDER_KHR});
+        headers.clear();
+        for (size_t i = 0; i < count; ++i) {
+            const FrameCaptureLayer& captured = frame.layers[i].layer;
+            XrCompositionLayerBaseHeader* header = nullptr;
+            if (captured.type == XR_TYPE_COMPOSITION_LAYER_PROJECTION) {
+                XrCompositionLayerProjection& layer = projections[i];
+                XrCompositionLayerProjectionView* layerViews = &views[i * FrameCapture::MAX_VIEWS];
+                for (uint32_t v = 0; v < captured.viewCount; ++v) {
+                    layerViews[v].pose = frame.layers[i].views[v].pose;
+                    layerViews[v].fov = frame.layers[i].views[v].fov;
+                    layerViews[v].subImage = toSubImage(replay, frame.layers[i].views[v].subImage);
+                }
+                layer.viewCount = captured.viewCount;
+                layer.views = layerViews;
+                header = reinterpret_cast<XrCompositionLayerBaseHeader*>(&layer);
+            } else if (captured.type == XR_TYPE_COMPOSITION_LAYER_QUAD) {
+                XrCompositionLayerQuad& layer = quads[i];
+                layer.eyeVisibility = (XrEyeVisibility)captured.eyeVisibility;
+                layer.subImage = toSubImage(replay, captured.subImage);
+                layer.pose = captured.pose;
+                layer.size = {captured.params[0], captured.params[1]};
+                header = reinterpret_cast<XrCompositionLayerBaseHeader*>(&layer);
+            } else if (captured.type == XR_TYPE_COMPOSITION_LAYER_CYLINDER_KHR) {
+                XrCompositionLayerCylinderKHR& layer = cylinders[i];
+                layer.eyeVisibility = (XrEyeVisibility)captured.eyeVisibility;
+                layer.subImage = toSubImage(replay, captured.subImage);
+                layer.pose = captured.pose;
+                layer.radius = captured.params[0];
+                layer.centralAngle = captured.params[1];
+                layer.aspectRatio = captured.params[2];
+                header = reinterpret_cast<XrCompositionLayerBaseHeader*>(&layer);
+            } else {
+                continue; // only the type was captured; nothing to rebuild it from
+            }
+            header->layerFlags = captured.flags;
+            header->space = toSpace(replay, captured.space);
+            headers.push_back(header);
+        }
+    }
+};
+
+static void sleepUntil(int64_t targetNs) {
+    timespec ts = {(time_t)(targetNs / 1000000000), (long)(targetNs % 1000000000)};
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) != 0) {}
+}
+
+static void destroyReplay(Replay* replay) {
+    ReplayDispatch& d = replay->xr;
+    for (auto& entry : replay->swapchains) {
+        if (entry.second.handle) d.DestroySwapchain(entry.second.handle);
+    }
+    for (auto& entry : replay->spaces) {
+        if (entry.second) d.DestroySpace(entry.second);
+    }
+    if (replay->defaultSpace) d.DestroySpace(replay->defaultSpace);
+    if (replay->running) d.EndSession(replay->session);
+    if (replay->session) d.DestroySession(replay->session);
+    if (replay->instance) d.DestroyInstance(replay->instance);
+    if (replay->framebuffer) glDeleteFramebuffers(1, &replay->framebuffer);
+    headlessEglDestroy(&replay->egl);
+}
+
+static int replayRuntime(const Capture& capture, const char* library, int loops, bool appTime) {
+    void* handle = dlopen(library, RTLD_NOW | RTLD_LOCAL);
+    if (!handle) {
+        fprintf(stderr, "%s\n", dlerror());
+        return 1;
+    }
+    Replay replay;
+    replay.xr.GetInstanceProcAddr = reinterpret_cast<PFN_xrGetInstanceProcAddr>(dlsym(handle, "xrGetInstanceProcAddr"));
+    if (!replay.xr.GetInstanceProcAddr) {
+        fprintf(stderr, "%s does not export xrGetInstanceProcAddr\n", library);
+        return 1;
+    }
+
+    bool ready = headlessEglCreate(&replay.egl) && createInstance(&replay, capture) && createSession(&replay) &&
+                 createResources(&replay, capture);
+    if (replay.egl.context != EGL_NO_CONTEXT) glGenFramebuffers(1, &replay.framebuffer);
+    int64_t deadlineNs = monotonicNowNs() + 5000000000LL;
+    while (ready && !replay.running && !replay.exitRequested && monotonicNowNs() < deadlineNs) {
+        pollEvents(&replay);
+        if (!replay.running) usleep(1000);
+    }
+    if (!ready || !replay.running) {
+        if (ready) fprintf(stderr, "The session never became ready\n");
+        destroyReplay(&replay);
+        return 1;
+    }
+
+    LogHistogram waitTime, beginTime, endTime, displayInterval;
+    uint64_t frames = 0, missedSlots = 0, skippedRenders = 0, failedFrames = 0;
+    XrTime lastDisplayTime = 0;
+    ReplayLayers layers;
+    for (int loop = 0; loop < loops && !replay.exitRequested; ++loop) {
+        for (size_t i = 0; i < capture.frames.size() && !replay.exitRequested; ++i) {
+            pollEvents(&replay);
+            if (!replay.running) break;
+            const CapturedFrame& captured = capture.frames[i];
+
+            XrFrameWaitInfo waitInfo{XR_TYPE_FRAME_WAIT_INFO};
+            XrFrameState frameState{XR_TYPE_FRAME_STATE};
+            int64_t waitCallNs = monotonicNowNs();
+            if (XR_FAILED(replay.xr.WaitFrame(replay.session, &waitInfo, &frameState))) break;
+            int64_t waitReturnNs = monotonicNowNs();
+            XrFrameBeginInfo beginInfo{XR_TYPE_FRAME_BEGIN_INFO};
+            replay.xr.BeginFrame(replay.session, &beginInfo);
+            int64_t beginReturnNs = monotonicNowNs();
+            waitTime.record(waitReturnNs - waitCallNs);
+            beginTime.record(beginReturnNs - waitReturnNs);
+
+            if (lastDisplayTime != 0) {
+                int64_t interval = frameState.predictedDisplayTime - lastDisplayTime;
+                displayInterval.record(interval);
+                if (frameState.predictedDisplayPeriod > 0 && interval > frameState.predictedDisplayPeriod * 3 / 2) {
+                    missedSlots += (uint64_t)((interval + frameState.predictedDisplayPeriod / 2) / frameState.predictedDisplayPeriod - 1);
+                }
+            }
+            lastDisplayTime = frameState.predictedDisplayTime;
+
+            XrFrameEndInfo endInfo{XR_TYPE_FRAME_END_INFO};
+            endInfo.displayTime = frameState.predictedDisplayTime;
+            endInfo.environmentBlendMode = captured.frame.blendMode ? (XrEnvironmentBlendMode)captured.frame.blendMode : XR_ENVIRONMENT_BLEND_MODE_OPAQUE;
+            if (frameState.shouldRender) {
+                forEachSubImage(captured, [&](const FrameCaptureSubImage& image) {
+                    auto found = replay.swapchains.find(image.swapchain);
+                    if (found == replay.swapchains.end()) return;
+                    ReplaySwapchain& swapchain = found->second;
+                    // Each swapchain is acquired at most once per frame, and only when its
+                    // content changed; unhashed content is treated as changing every frame
+                    bool stale = swapchain.renderedFrame == 0 || image.contentHash == 0 || image.contentHash != swapchain.hash;
+                    if (stale && swapchain.renderedFrame != frames + 1) {
+                        renderSwapchain(&replay, swapchain, image.contentHash);
+                        swapchain.renderedFrame = frames + 1;
+                    }
+                });
+                layers.build(&replay, captured);
+                endInfo.layerCount = (uint32_t)layers.headers.size();
+                endInfo.layers = layers.headers.data();
+            } else {
+                ++skippedRenders;
+            }
+
+            if (appTime) sleepUntil(waitReturnNs + (captured.frame.endCallNs - captured.frame.waitReturnNs));
+            int64_t endCallNs = monotonicNowNs();
+            if (XR_FAILED(replay.xr.EndFrame(replay.session, &endInfo))) ++failedFrames;
+            endTime.record(monotonicNowNs() - endCallNs);
+            ++frames;
+        }
+    }
+
+    printf("Runtime %s, %d loop(s), %llu frames:\n", library, loops, (unsigned long long)frames);
+    printHistogram("xrWaitFrame", waitTime);
+    printHistogram("xrBeginFrame", beginTime);
+    printHistogram("xrEndFrame", endTime);
+    printHistogram("display interval", displayInterval);
+    printf("  missed slots %llu, shouldRender=false %llu, failed xrEndFrame %llu\n", (unsigned long long)missedSlots,
+           (unsigned long long)skippedRenders, (unsigned long long)failedFrames);
+    destroyReplay(&replay);
+    return 0;
+}
+
+// --- Main ---
+
+int main(int argc, char** argv) {
+    const char* path = nullptr;
+    const char* runtime = nullptr;
+    const char* csvPath = nullptr;
+    int loops = 1;
+    double periodMs = 0;
+    bool appTime = true;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--runtime") == 0 && i + 1 < argc) {
+            runtime = argv[++i];
+        } else if (strcmp(argv[i], "--loops") == 0 && i + 1 < argc) {
+            loops = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--period-ms") == 0 && i + 1 < argc) {
+            periodMs = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--csv") == 0 && i + 1 < argc) {
+            csvPath = argv[++i];
+        } else if (strcmp(argv[i], "--no-app-time") == 0) {
+            appTime = false;
+        } else if (!path && argv[i][0] != '-') {
+            path = argv[i];
+        } else {
+            path = nullptr;
+            break;
+        }
+    }
+    if (!path || loops < 1) {
+        fprintf(stderr, "usage: %s <capture.xfec> [--runtime <lib.so>] [--loops <n>] [--period-ms <ms>] "
+                        "[--no-app-time] [--csv <file>]\n", argv[0]);
+        return 2;
+    }
+
+    Capture capture;
+    if (!loadCapture(path, &capture)) return 1;
+    if (capture.frames.empty()) {
+        fprintf(stderr, "%s: no frames\n", path);
+        return 1;
+    }
+    printSummary(capture);
+
+    if (runtime) return replayRuntime(capture, runtime, loops, appTime);
+
+    int64_t periodNs = periodMs > 0 ? (int64_t)(periodMs * 1e6) : capture.frames.front().frame.displayPeriodNs;
+    if (periodNs <= 0) periodNs = 1000000000 / 72;
+    FILE* csv = nullptr;
+    if (csvPath && !(csv = fopen(csvPath, "w"))) {
+        perror(csvPath);
+        return 1;
+    }
+    int status = replayStandIn(capture, loops, periodNs, csv);
+    if (csv) fclose(csv);
+    return status;
+}
@@ -0,0 +1,518 @@
+// Replays a GL capture (gl_capture.h) on a local EGL context and times it.
+//
+//     gl_replay <capture.xglc> [--loops <n>] [--warmup <n>] [--per-draw] [--csv <file>]
+//
+// Objects are recreated from their snapshots first (buffers with their contents, vertex
+// arrays, programs compiled from the captured sources, renderbuffers, and blank storage for
+// textures and framebuffer 0), then the captured frames are executed --warmup times untimed
+// and --loops times timed. A frame is timed from its first command to the return of a
+// glFinish after its last, and the time to issue its commands is reported separately. With
+// --per-draw every draw is also bracketed by glFinish and timed on its own, which serialises
+// the GPU but shows which draws cost what; frame times then include that overhead.
+//
+// Runs anywhere with EGL and GLES 3.0, e.g. Mesa's llvmpipe on a desktop without a GPU.
+
+#define XR_GL_CAPTURE_NO_MACROS
+#include "gl_capture.h"
+#include "headless_egl.h"
+#include "log_histogram.h"
+#include "monotonic_clock.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <deque>
+#include <map>
+#include <utility>
+#include <vector>
+
+// Size used for textures and framebuffer 0 when the capture does not say
+static const uint32_t DEFAULT_SIZE = 1024;
+
+struct ReplayFrame {
+    uint32_t frame;
+    uint32_t commandCount;
+    std::vector<uint32_t> commands;
+};
+
+struct DrawStats {
+    uint32_t mode, count, program;
+    LogHistogram time;
+};
+
+struct GlReplay {
+    std::map<uint32_t, GLuint> buffers, vertexArrays, programs, renderbuffers, textures, framebuffers;
+    std::map<uint32_t, GLuint> textureTargets;
+    std::map<std::pair<GLuint, int32_t>, GLint> uniformLocations; // (replay program, captured location)
+    std::vector<ReplayFrame> frames;
+    GLuint defaultFramebuffer = 0;
+    GLuint currentProgram = 0;
+
+    GLuint map(const std::map<uint32_t, GLuint>& names, uint32_t name) const {
+        auto found = names.find(name);
+        return found != names.end() ? found->second : 0;
+    }
+};
+
+// --- Objects ---
+
+static void createSurface(GlReplay* replay, const GlCaptureSurface& surface) {
+    uint32_t width = surface.width ? surface.width : DEFAULT_SIZE;
+    uint32_t height = surface.height ? surface.height : DEFAULT_SIZE;
+    GLuint color, depth;
+    glGenRenderbuffers(1, &color);
+    glBindRenderbuffer(GL_RENDERBUFFER, color);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+    glGenRenderbuffers(1, &depth);
+    glBindRenderbuffer(GL_RENDERBUFFER, depth);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+    glGenFramebuffers(1, &replay->defaultFramebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, replay->defaultFramebuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, color);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depth);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    replay->framebuffers[0] = replay->defaultFramebuffer;
+    printf("framebuffer 0: %ux%u\n", width, height);
+}
+
+static void createBuffer(GlReplay* replay, const GlCaptureBuffer& record, const uint8_t* data) {
+    GLuint buffer;
+    glGenBuffers(1, &buffer);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+    glBufferData(GL_COPY_WRITE_BUFFER, record.size, data, record.usage);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    replay->buffers[record.name] = buffer;
+}
+
+static void createVertexArray(GlReplay* replay, const GlCaptureVertexArray& record, const GlCaptureAttrib* attribs) {
+    GLuint array;
+    glGenVertexArrays(1, &array);
+    glBindVertexArray(array);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, replay->map(replay->buffers, record.elementBuffer));
+    for (uint32_t i = 0; i < record.attribCount; ++i) {
+        const GlCaptureAttrib& a = attribs[i];
+        glBindBuffer(GL_ARRAY_BUFFER, replay->map(replay->buffers, a.buffer));
+        const void* offset = reinterpret_cast<const void*>((uintptr_t)a.offset);
+        if (a.integer) {
+            glVertexAttribIPointer(a.index, a.size, a.type, a.stride, offset);
+        } else {
+            glVertexAttribPointer(a.index, a.size, a.type, a.normalized ? GL_TRUE : GL_FALSE, a.stride, offset);
+        }
+        glEnableVertexAttribArray(a.index);
+    }
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    replay->vertexArrays[record.name] = array;
+}
+
+static bool createProgram(GlReplay* replay, const uint8_t* payload, uint32_t size) {
+    GlCaptureProgram record;
+    memcpy(&record, payload, sizeof(record));
+    size_t at = sizeof(record);
+    GLuint program = glCreateProgram();
+    for (uint32_t i = 0; i < record.shaderCount && at + sizeof(GlCaptureShader) <= size; ++i) {
+        GlCaptureShader shader;
+        memcpy(&shader, payload + at, sizeof(shader));
+        at += sizeof(shader);
+        if (at + shader.length > size) return false;
+        std::vector<char> source(payload + at, payload + at + shader.length);
+        source.push_back('\0');
+        at += shader.length;
+
+        GLuint object = glCreateShader(shader.type);
+        const char* text = source.data();
+        glShaderSource(object, 1, &text, nullptr);
+        glCompileShader(object);
+        GLint compiled = GL_FALSE;
+        glGetShaderiv(object, GL_COMPILE_STATUS, &compiled);
+        if (!compiled) {
+            char log[1024];
+            glGetShaderInfoLog(object, sizeof(log), nullptr, log);
+            fprintf(stderr, "program %u: shader does not compile here:\n%s\n", record.name, log);
+        }
+        glAttachShader(program, object);
+        glDeleteShader(object);
+    }
+    glLinkProgram(program);
+    GLint linked = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    if (!linked) {
+        char log[1024];
+        glGetProgramInfoLog(program, sizeof(log), nullptr, log);
+        fprintf(stderr, "program %u does not link here:\n%s\n", record.name, log);
+    }
+
+    glUseProgram(program);
+    for (uint32_t i = 0; i < record.uniformCount && at + sizeof(GlCaptureUniform) <= size; ++i) {
+        GlCaptureUniform uniform;
+        memcpy(&uniform, payload + at, sizeof(uniform));
+        at += sizeof(uniform);
+        uniform.name[sizeof(uniform.name) - 1] = '\0';
+        GLint location = glGetUniformLocation(program, uniform.name);
+        if (location < 0) continue;
+        switch (uniform.type) {
+            case GL_FLOAT: glUniform1fv(location, 1, uniform.value); break;
+            case GL_FLOAT_VEC2: glUniform2fv(location, 1, uniform.value); break;
+            case GL_FLOAT_VEC3: glUniform3fv(location, 1, uniform.value); break;
+            case GL_FLOAT_VEC4: glUniform4fv(location, 1, uniform.value); break;
+            case GL_FLOAT_MAT4: glUniformMatrix4fv(location, 1, GL_FALSE, uniform.value); break;
+        }
+    }
+    glUseProgram(0);
+    replay->programs[record.name] = program;
+    return true;
+}
+
+static void createRenderbuffer(GlReplay* replay, const GlCaptureRenderbuffer& record) {
+    GLuint renderbuffer;
+    glGenRenderbuffers(1, &renderbuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, renderbuffer);
+    if (record.samples > 0) {
+        glRenderbufferStorageMultisample(GL_RENDERBUFFER, record.samples, record.internalFormat, record.width, record.height);
+    } else {
+        glRenderbufferStorage(GL_RENDERBUFFER, record.internalFormat, record.width, record.height);
+    }
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+    replay->renderbuffers[record.name] = renderbuffer;
+}
+
+static void createTexture(GlReplay* replay, const GlCaptureTexture& record) {
+    uint32_t width = record.width ? record.width : DEFAULT_SIZE;
+    uint32_t height = record.height ? record.height : DEFAULT_SIZE;
+    uint32_t layers = record.layers ? record.layers : 1;
+    GLuint texture;
+    glGenTextures(1, &texture);
+    glBindTexture(record.target, texture);
+    if (record.target == GL_TEXTURE_2D_ARRAY) {
+        glTexStorage3D(GL_TEXTURE_2D_ARRAY, 1, record.internalFormat, width, height, layers);
+    } else {
+        glTexStorage2D(GL_TEXTURE_2D, 1, record.internalFormat, width, height);
+    }
+    glBindTexture(record.target, 0);
+    replay->textures[record.name] = texture;
+    replay->textureTargets[record.name] = record.target;
+}
+
+static void attach(GlReplay* replay, GLenum point, const GlCaptureAttachment& attachment) {
+    if (attachment.objectType == GL_RENDERBUFFER) {
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, point, GL_RENDERBUFFER, replay->map(replay->renderbuffers, attachment.object));
+    } else if (attachment.objectType == GL_TEXTURE) {
+        GLuint texture = replay->map(replay->textures, attachment.object);
+        if (replay->map(replay->textureTargets, attachment.object) == GL_TEXTURE_2D_ARRAY) {
+            glFramebufferTextureLayer(GL_FRAMEBUFFER, point, texture, attachment.level, attachment.layer);
+        } else {
+            glFramebufferTexture2D(GL_FRAMEBUFFER, point, GL_TEXTURE_2D, texture, attachment.level);
+        }
+    }
+}
+
+static void createFramebuffer(GlReplay* replay, const GlCaptureFramebuffer& record) {
+    GLuint framebuffer;
+    glGenFramebuffers(1, &framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    attach(replay, GL_COLOR_ATTACHMENT0, record.color);
+    attach(replay, GL_DEPTH_ATTACHMENT, record.depth);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    replay->framebuffers[record.name] = framebuffer;
+}
+
+// --- Capture file ---
+
+template <typename T>
+static bool readStruct(const uint8_t* payload, uint32_t size, T* out) {
+    if (size < sizeof(T)) return false;
+    memcpy(out, payload, sizeof(T));
+    return true;
+}
+
+static bool load(const char* path, GlReplay* replay) {
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        perror(path);
+        return false;
+    }
+    std::vector<uint8_t> data;
+    uint8_t chunk[1 << 16];
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), file)) > 0) data.insert(data.end(), chunk, chunk + n);
+    fclose(file);
+
+    GlCaptureFileHeader header;
+    if (data.size() < sizeof(header)) {
+        fprintf(stderr, "%s: too short for a GL capture\n", path);
+        return false;
+    }
+    memcpy(&header, data.data(), sizeof(header));
+    if (header.magic != GL_CAPTURE_MAGIC || header.version != GL_CAPTURE_VERSION) {
+        fprintf(stderr, "%s: not a version %u GL capture\n", path, GL_CAPTURE_VERSION);
+        return false;
+    }
+
+    size_t offset = header.headerSize;
+    while (offset + sizeof(GlCaptureRecordHeader) <= data.size()) {
+        GlCaptureRecordHeader record;
+        memcpy(&record, data.data() + offset, sizeof(record));
+        offset += sizeof(record);
+        if (offset + record.size > data.size()) {
+            fprintf(stderr, "%s: truncated after %zu frames\n", path, replay->frames.size());
+            break;
+        }
+        const uint8_t* payload = data.data() + offset;
+        offset += record.size;
+
+        switch ((GlCaptureTag)record.tag) {
+            case GlCaptureTag::Surface: {
+                GlCaptureSurface surface;
+                if (readStruct(payload, record.size, &surface)) createSurface(replay, surface);
+                break;
+            }
+            case GlCaptureTag::Buffer: {
+                GlCaptureBuffer buffer;
+                if (readStruct(payload, record.size, &buffer) && sizeof(buffer) + buffer.size <= record.size) {
+                    createBuffer(replay, buffer, payload + sizeof(buffer));
+                }
+                break;
+            }
+            case GlCaptureTag::VertexArray: {
+                GlCaptureVertexArray array;
+                if (readStruct(payload, record.size, &array) &&
+                    sizeof(array) + array.attribCount * sizeof(GlCaptureAttrib) <= record.size) {
+                    std::vector<GlCaptureAttrib> attribs(array.attribCount);
+                    memcpy(attribs.data(), payload + sizeof(array), attribs.size() * sizeof(GlCaptureAttrib));
+                    createVertexArray(replay, array, attribs.data());
+                }
+                break;
+            }
+            case GlCaptureTag::Program:
+                if (record.size >= sizeof(GlCaptureProgram)) createProgram(replay, payload, record.size);
+                break;
+            case GlCaptureTag::Renderbuffer: {
+                GlCaptureRenderbuffer renderbuffer;
+                if (readStruct(payload, record.size, &renderbuffer)) createRenderbuffer(replay, renderbuffer);
+                break;
+            }
+            case GlCaptureTag::Texture: {
+                GlCaptureTexture texture;
+                if (readStruct(payload, record.size, &texture)) createTexture(replay, texture);
+                break;
+            }
+            case GlCaptureTag::Framebuffer: {
+                GlCaptureFramebuffer framebuffer;
+                if (readStruct(payload, record.size, &framebuffer)) createFramebuffer(replay, framebuffer);
+                break;
+            }
+            case GlCaptureTag::Frame: {
+                GlCaptureFrame frame;
+                if (!readStruct(payload, record.size, &frame)) break;
+                ReplayFrame replayFrame = {frame.frame, frame.commandCount, {}};
+                replayFrame.commands.resize((record.size - sizeof(frame)) / sizeof(uint32_t));
+                memcpy(replayFrame.commands.data(), payload + sizeof(frame), replayFrame.commands.size() * sizeof(uint32_t));
+                replay->frames.push_back(std::move(replayFrame));
+                break;
+            }
+            default:
+                // Records from a newer writer; their size lets us step over them
+                break;
+        }
+    }
+    GLenum error = glGetError();
+    if (error != GL_NO_ERROR) fprintf(stderr, "GL error 0x%x while recreating the captured objects\n", error);
+    return true;
+}
+
+// --- Execution ---
+
+static float asFloat(uint32_t word) {
+    float value;
+    memcpy(&value, &word, sizeof(value));
+    return value;
+}
+
+// Runs one frame's commands. With `draws`, every draw is finished and timed on its own and
+// its stats go to draws[i] for the frame's i-th draw.
+static uint32_t executeFrame(GlReplay* replay, const ReplayFrame& frame, std::deque<DrawStats>* draws) {
+    const uint32_t* words = frame.commands.data();
+    size_t count = frame.commands.size();
+    size_t at = 0;
+    uint32_t drawIndex = 0;
+    for (uint32_t c = 0; c < frame.commandCount && at < count; ++c) {
+        GlCaptureCommand command;
+        memcpy(&command, &words[at], sizeof(command));
+        ++at;
+        const uint32_t* a = &words[at];
+        at += (command.size + 3) / 4;
+        if (at > count) break;
+
+        switch ((GlCaptureOp)command.op) {
+            case GlCaptureOp::Viewport: glViewport((GLint)a[0], (GLint)a[1], (GLsizei)a[2], (GLsizei)a[3]); break;
+            case GlCaptureOp::Scissor: glScissor((GLint)a[0], (GLint)a[1], (GLsizei)a[2], (GLsizei)a[3]); break;
+            case GlCaptureOp::ClearColor: glClearColor(asFloat(a[0]), asFloat(a[1]), asFloat(a[2]), asFloat(a[3])); break;
+            case GlCaptureOp::Clear: glClear(a[0]); break;
+            case GlCaptureOp::Enable: glEnable(a[0]); break;
+            case GlCaptureOp::Disable: glDisable(a[0]); break;
+            case GlCaptureOp::DepthFunc: glDepthFunc(a[0]); break;
+            case GlCaptureOp::DepthMask: glDepthMask((GLboolean)a[0]); break;
+            case GlCaptureOp::BlendFunc: glBlendFunc(a[0], a[1]); break;
+            case GlCaptureOp::BindFramebuffer: glBindFramebuffer(a[0], replay->map(replay->framebuffers, a[1])); break;
+            case GlCaptureOp::FramebufferTexture2D:
+                glFramebufferTexture2D(a[0], a[1], a[2], replay->map(replay->textures, a[3]), (GLint)a[4]);
+                break;
+            case GlCaptureOp::FramebufferTextureLayer:
+                glFramebufferTextureLayer(a[0], a[1], replay->map(replay->textures, a[2]), (GLint)a[3], (GLint)a[4]);
+                break;
+            case GlCaptureOp::FramebufferRenderbuffer:
+                glFramebufferRenderbuffer(a[0], a[1], a[2], replay->map(replay->renderbuffers, a[3]));
+                break;
+            case GlCaptureOp::BindVertexArray: glBindVertexArray(replay->map(replay->vertexArrays, a[0])); break;
+            case GlCaptureOp::UseProgram:
+                replay->currentProgram = replay->map(replay->programs, a[0]);
+                glUseProgram(replay->currentProgram);
+                break;
+            case GlCaptureOp::GetUniformLocation: {
+                GLuint program = replay->map(replay->programs, a[0]);
+                // The name runs to the end of the arguments, NUL-padded
+                const char* name = reinterpret_cast<const char*>(a + 2);
+                if (command.size > 8 && memchr(name, '\0', command.size - 8)) {
+                    replay->uniformLocations[{program, (int32_t)a[1]}] = glGetUniformLocation(program, name);
+                }
+                break;
+            }
+            case GlCaptureOp::UniformMatrix4fv:
+            case GlCaptureOp::Uniform3f:
+            case GlCaptureOp::Uniform1f: {
+                auto found = replay->uniformLocations.find({replay->currentProgram, (int32_t)a[0]});
+                GLint location = found != replay->uniformLocations.end() ? found->second : -1;
+                if ((GlCaptureOp)command.op == GlCaptureOp::UniformMatrix4fv) {
+                    glUniformMatrix4fv(location, (GLsizei)a[1], (GLboolean)a[2], reinterpret_cast<const GLfloat*>(a + 3));
+                } else if ((GlCaptureOp)command.op == GlCaptureOp::Uniform3f) {
+                    glUniform3f(location, asFloat(a[1]), asFloat(a[2]), asFloat(a[3]));
+                } else {
+                    glUniform1f(location, asFloat(a[1]));
+                }
+                break;
+            }
+            case GlCaptureOp::DrawElements: {
+                const void* offset = reinterpret_cast<const void*>((uintptr_t)a[3]);
+                if (!draws) {
+                    glDrawElements(a[0], (GLsizei)a[1], a[2], offset);
+                    break;
+                }
+                glFinish();
+                int64_t startNs = monotonicNowNs();
+                glDrawElements(a[0], (GLsizei)a[1], a[2], offset);
+                glFinish();
+                int64_t drawNs = monotonicNowNs() - startNs;
+                if (drawIndex >= draws->size()) {
+                    draws->emplace_back();
+                    draws->back().mode = a[0];
+                    draws->back().count = a[1];
+                    draws->back().program = replay->currentProgram;
+                }
+                (*draws)[drawIndex].time.record(drawNs);
+                break;
+            }
+            case GlCaptureOp::Flush: glFlush(); break;
+            case GlCaptureOp::Finish: glFinish(); break;
+            default: break;
+        }
+        if ((GlCaptureOp)command.op == GlCaptureOp::DrawElements) ++drawIndex;
+    }
+    return drawIndex;
+}
+
+static void printHistogram(const char* name, const LogHistogram& histogram) {
+    if (histogram.count() == 0) return;
+    printf("  %-10s p50 %8.3f  p90 %8.3f  p99 %8.3f  max %8.3f ms\n", name, histogram.percentile(0.5) / 1e6,
+           histogram.percentile(0.9) / 1e6, histogram.percentile(0.99) / 1e6, histogram.max() / 1e6);
+}
+
+int main(int argc, char** argv) {
+    const char* path = nullptr;
+    const char* csvPath = nullptr;
+    int loops = 10, warmup = 1;
+    bool perDraw = false;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--loops") == 0 && i + 1 < argc) {
+            loops = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--warmup") == 0 && i + 1 < argc) {
+            warmup = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--csv") == 0 && i + 1 < argc) {
+            csvPath = argv[++i];
+        } else if (strcmp(argv[i], "--per-draw") == 0) {
+            perDraw = true;
+        } else if (!path && argv[i][0] != '-') {
+            path = argv[i];
+        } else {
+            path = nullptr;
+            break;
+        }
+    }
+    if (!path || loops < 1 || warmup < 0) {
+        fprintf(stderr, "usage: %s <capture.xglc> [--loops <n>] [--warmup <n>] [--per-draw] [--csv <file>]\n", argv[0]);
+        return 2;
+    }
+
+    HeadlessEgl egl;
+    if (!headlessEglCreate(&egl)) return 1;
+    printf("GL_RENDERER: %s\n", (const char*)glGetString(GL_RENDERER));
+    GlReplay replay;
+    if (!load(path, &replay)) return 1;
+    if (replay.frames.empty()) {
+        fprintf(stderr, "%s: no frames\n", path);
+        return 1;
+    }
+    uint64_t commands = 0;
+    for (const ReplayFrame& frame : replay.frames) commands += frame.commandCount;
+    printf("%zu frames, %.1f commands per frame, %zu programs, %zu buffers, %zu textures\n", replay.frames.size(),
+           (double)commands / replay.frames.size(), replay.programs.size(), replay.buffers.size(), replay.textures.size());
+
+    FILE* csv = nullptr;
+    if (csvPath) {
+        csv = fopen(csvPath, "w");
+        if (!csv) {
+            perror(csvPath);
+            return 1;
+        }
+        fprintf(csv, "loop,frame,commands,draws,submit_ns,total_ns\n");
+    }
+
+    for (int loop = 0; loop < warmup; ++loop) {
+        for (const ReplayFrame& frame : replay.frames) executeFrame(&replay, frame, nullptr);
+    }
+    glFinish();
+
+    LogHistogram submitTime, frameTime;
+    std::deque<DrawStats> draws;
+    uint64_t drawCount = 0;
+    for (int loop = 0; loop < loops; ++loop) {
+        for (const ReplayFrame& frame : replay.frames) {
+            int64_t startNs = monotonicNowNs();
+            uint32_t frameDraws = executeFrame(&replay, frame, perDraw ? &draws : nullptr);
+            int64_t submitNs = monotonicNowNs() - startNs;
+            glFinish();
+            int64_t totalNs = monotonicNowNs() - startNs;
+            submitTime.record(submitNs);
+            frameTime.record(totalNs);
+            drawCount += frameDraws;
+            if (csv) {
+                fprintf(csv, "%d,%u,%u,%u,%lld,%lld\n", loop, frame.frame, frame.commandCount, frameDraws,
+                        (long long)submitNs, (long long)totalNs);
+            }
+        }
+    }
+    if (csv) fclose(csv);
+
+    printf("%d loop(s), %.1f draws per frame:\n", loops, (double)drawCount / (loops * replay.frames.size()));
+    printHistogram("submit", submitTime);
+    printHistogram("frame", frameTime);
+    if (perDraw) {
+        printf("per draw (index within the frame):\n");
+        for (size_t i = 0; i < draws.size(); ++i) {
+            printf("  #%-3zu mode 0x%x count %-6u program %-3u p50 %8.3f  max %8.3f ms\n", i, draws[i].mode,
+                   draws[i].count, draws[i].program, draws[i].time.percentile(0.5) / 1e6, draws[i].time.max() / 1e6);
+        }
+    }
+    GLenum error = glGetError();
+    if (error != GL_NO_ERROR) fprintf(stderr, "GL error 0x%x during the replay\n", error);
+    return 0;
+}
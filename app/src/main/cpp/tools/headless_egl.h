@@ -0,0 +1,62 @@
+#ifndef ANDROIDSAMSUNG_HEADLESS_EGL_H
+#define ANDROIDSAMSUNG_HEADLESS_EGL_H
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <stdio.h>
+
+// GLES 3 context for the host tools, current on a small pbuffer. Prefers Mesa's surfaceless
+// platform, which needs no X or Wayland server, and falls back to the default display.
+struct HeadlessEgl {
+    EGLDisplay display = EGL_NO_DISPLAY;
+    EGLConfig config = nullptr;
+    EGLContext context = EGL_NO_CONTEXT;
+    EGLSurface surface = EGL_NO_SURFACE;
+};
+
+inline EGLDisplay headlessEglDisplay() {
+    auto getPlatformDisplay = reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(eglGetProcAddress("eglGetPlatformDisplayEXT"));
+    if (getPlatformDisplay) {
+        EGLDisplay display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+        if (display != EGL_NO_DISPLAY && eglInitialize(display, nullptr, nullptr)) return display;
+    }
+    EGLDisplay display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    if (display != EGL_NO_DISPLAY && eglInitialize(display, nullptr, nullptr)) return display;
+    return EGL_NO_DISPLAY;
+}
+
+inline bool headlessEglCreate(HeadlessEgl* egl) {
+    egl->display = headlessEglDisplay();
+    if (egl->display == EGL_NO_DISPLAY) {
+        fprintf(stderr, "No EGL display: 0x%x\n", eglGetError());
+        return false;
+    }
+    const EGLint configAttribs[] = {EGL_RENDERABLE_TYPE, EGL_OPENGL_ES3_BIT, EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+                                    EGL_RED_SIZE, 8, EGL_GREEN_SIZE, 8, EGL_BLUE_SIZE, 8, EGL_ALPHA_SIZE, 8, EGL_NONE};
+    EGLint configCount = 0;
+    if (!eglChooseConfig(egl->display, configAttribs, &egl->config, 1, &configCount) || configCount == 0) {
+        fprintf(stderr, "No GLES3 pbuffer config\n");
+        return false;
+    }
+    const EGLint contextAttribs[] = {EGL_CONTEXT_CLIENT_VERSION, 3, EGL_NONE};
+    egl->context = eglCreateContext(egl->display, egl->config, EGL_NO_CONTEXT, contextAttribs);
+    const EGLint surfaceAttribs[] = {EGL_WIDTH, 16, EGL_HEIGHT, 16, EGL_NONE};
+    egl->surface = eglCreatePbufferSurface(egl->display, egl->config, surfaceAttribs);
+    if (egl->context == EGL_NO_CONTEXT || egl->surface == EGL_NO_SURFACE ||
+        !eglMakeCurrent(egl->display, egl->surface, egl->surface, egl->context)) {
+        fprintf(stderr, "Cannot make a GLES3 context current: 0x%x\n", eglGetError());
+        return false;
+    }
+    return true;
+}
+
+inline void headlessEglDestroy(HeadlessEgl* egl) {
+    if (egl->display == EGL_NO_DISPLAY) return;
+    eglMakeCurrent(egl->display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    if (egl->surface != EGL_NO_SURFACE) eglDestroySurface(egl->display, egl->surface);
+    if (egl->context != EGL_NO_CONTEXT) eglDestroyContext(egl->display, egl->context);
+    eglTerminate(egl->display);
+    *egl = HeadlessEgl();
+}
+
+#endif //ANDROIDSAMSUNG_HEADLESS_EGL_H
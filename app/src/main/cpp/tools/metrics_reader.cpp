@@ -0,0 +1,109 @@
+// Samples a SharedMetrics region from another process and prints it.
+//
+//     metrics_reader <region> [interval_ms] [samples]
+//
+// <region> is the file the app publishes to (e.g. /dev/shm/xr_metrics) or, for a memfd,
+// /proc/<pid>/fd/<fd> as logged by the app. Counters are shown with their rate since the
+// previous sample, gauges as is, histograms as percentiles of everything recorded so far.
+// With no sample count it runs until interrupted.
+
+#include "shared_metrics.h"
+#include "monotonic_clock.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <memory>
+
+static int64_t percentile(const SharedHistogram& histogram, double fraction) {
+    uint64_t n = histogram.count.load(std::memory_order_relaxed);
+    int64_t max = histogram.maxNs.load(std::memory_order_relaxed);
+    if (n == 0) return 0;
+    uint64_t rank = (uint64_t)(fraction * (double)n);
+    if (rank >= n) rank = n - 1;
+    uint64_t seen = 0;
+    for (int i = 0; i < LogHistogram::BUCKETS; ++i) {
+        seen += histogram.buckets[i].load(std::memory_order_relaxed);
+        if (seen > rank) {
+            int64_t midpoint = LogHistogram::bucketMidpoint(i);
+            return midpoint < max ? midpoint : max;
+        }
+    }
+    return max;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <region> [interval_ms] [samples]\n", argv[0]);
+        return 2;
+    }
+    int intervalMs = argc > 2 ? atoi(argv[2]) : 1000;
+    long samples = argc > 3 ? atol(argv[3]) : 0;
+
+    int fd = open(argv[1], O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        perror(argv[1]);
+        return 1;
+    }
+    void* memory = mmap(nullptr, sizeof(SharedMetricsRegion), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (memory == MAP_FAILED) {
+        perror("mmap");
+        return 1;
+    }
+    const SharedMetricsRegion* region = static_cast<const SharedMetricsRegion*>(memory);
+
+    std::unique_ptr<SharedMetricsRegion> current(new SharedMetricsRegion());
+    std::unique_ptr<SharedMetricsRegion> previous(new SharedMetricsRegion());
+    int64_t previousNs = 0;
+
+    for (long sample = 0; samples == 0 || sample < samples; ++sample) {
+        if (sample > 0) usleep((useconds_t)intervalMs * 1000);
+        if (!sharedMetricsSnapshot(region, current.get())) {
+            fprintf(stderr, "%s: not a version %u metrics region, or the writer stayed busy\n",
+                    argv[1], SHARED_METRICS_VERSION);
+            continue;
+        }
+        int64_t nowNs = monotonicNowNs();
+        double seconds = previousNs ? (nowNs - previousNs) / 1e9 : 0.0;
+
+        printf("--- pid %u, published %.1f ms ago, update %u\n", current->pid,
+               (nowNs - current->publishedNs.load(std::memory_order_relaxed)) / 1e6,
+               current->sequence.load(std::memory_order_relaxed) / 2);
+        for (uint32_t i = 0; i < current->metricCount; ++i) {
+            const SharedMetric& metric = current->metrics[i];
+            uint64_t value = metric.value.load(std::memory_order_relaxed);
+            switch (metric.kind) {
+                case MetricKind::Counter: {
+                    uint64_t before = i < previous->metricCount ? previous->metrics[i].value.load(std::memory_order_relaxed) : 0;
+                    if (seconds > 0) {
+                        printf("%-28s %12llu  %10.1f/s\n", metric.name, (unsigned long long)value, (value - before) / seconds);
+                    } else {
+                        printf("%-28s %12llu\n", metric.name, (unsigned long long)value);
+                    }
+                    break;
+                }
+                case MetricKind::Gauge:
+                    printf("%-28s %12.3f\n", metric.name, sharedMetricGauge(metric));
+                    break;
+                case MetricKind::Histogram: {
+                    if (value >= SharedMetricsRegion::MAX_HISTOGRAMS) break;
+                    const SharedHistogram& histogram = current->histograms[value];
+                    printf("%-28s %12llu  p50 %7.2f  p90 %7.2f  p99 %7.2f  max %7.2f ms\n", metric.name,
+                           (unsigned long long)histogram.count.load(std::memory_order_relaxed),
+                           percentile(histogram, 0.50) / 1e6, percentile(histogram, 0.90) / 1e6,
+                           percentile(histogram, 0.99) / 1e6,
+                           histogram.maxNs.load(std::memory_order_relaxed) / 1e6);
+                    break;
+                }
+            }
+        }
+        fflush(stdout);
+        std::swap(current, previous);
+        previousNs = nowNs;
+    }
+    munmap(memory, sizeof(SharedMetricsRegion));
+    return 0;
+}
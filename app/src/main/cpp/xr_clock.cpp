@@ -0,0 +1,97 @@
+#include "xr_clock.h"
+#include "monotonic_clock.h"
+
+#include <atomic>
+#include <cstdlib>
+
+#define LOG_TAG "XrClock"
+#include "log.h"
+
+// An offset change larger than this between refreshes is worth a log line
+static const int64_t DRIFT_LOG_THRESHOLD_NS = 50000;
+
+// XrTime = monotonic + offset
+static std::atomic<int64_t> offsetNs{0};
+static std::atomic<bool> calibrated{false};
+
+// Only touched by init, shutdown and refresh, which all run on the frame thread
+static const XrDispatchTable* dispatch = nullptr;
+static XrInstance clockInstance = XR_NULL_HANDLE;
+static int64_t lastMeasureNs = 0;
+
+static timespec toTimespec(int64_t ns) {
+    timespec ts;
+    ts.tv_sec = (time_t)(ns / 1000000000);
+    ts.tv_nsec = (long)(ns % 1000000000);
+    return ts;
+}
+
+// Converts one timestamp each way and averages the two offsets. Both conversions are of
+// explicit values, so how long the calls take does not affect the result.
+static bool measureOffset(int64_t nowNs, int64_t* result) {
+    timespec now = toTimespec(nowNs);
+    XrTime forward = 0;
+    if (XR_FAILED(dispatch->ConvertTimespecTimeToTimeKHR(clockInstance, &now, &forward))) return false;
+
+    timespec back{};
+    if (XR_FAILED(dispatch->ConvertTimeToTimespecTimeKHR(clockInstance, forward, &back))) return false;
+    int64_t roundTripNs = (int64_t)back.tv_sec * 1000000000 + back.tv_nsec;
+
+    // forward - nowNs is the offset; nowNs - roundTripNs is the runtime's rounding error
+    *result = (forward - nowNs) + (nowNs - roundTripNs) / 2;
+    return true;
+}
+
+bool xrClockInit(const XrDispatchTable* xr, XrInstance instance) {
+    dispatch = xr;
+    clockInstance = instance;
+    lastMeasureNs = monotonicNowNs();
+
+    if (!xr->ConvertTimespecTimeToTimeKHR || !xr->ConvertTimeToTimespecTimeKHR) {
+        LOGW("XR_KHR_convert_timespec_time unavailable; assuming XrTime is CLOCK_MONOTONIC");
+        offsetNs = 0;
+        calibrated = false;
+        return false;
+    }
+
+    int64_t offset = 0;
+    if (!measureOffset(lastMeasureNs, &offset)) {
+        LOGE("Failed to convert timespec to XrTime");
+        calibrated = false;
+        return false;
+    }
+    offsetNs = offset;
+    calibrated = true;
+    LOGI("XrTime offset from CLOCK_MONOTONIC: %lld ns", (long long)offset);
+    return true;
+}
+
+void xrClockShutdown() {
+    dispatch = nullptr;
+    clockInstance = XR_NULL_HANDLE;
+}
+
+void xrClockRefresh(int64_t nowNs) {
+    if (!dispatch || !calibrated.load(std::memory_order_relaxed)) return;
+    if (nowNs - lastMeasureNs < XR_CLOCK_REFRESH_INTERVAL_NS) return;
+    lastMeasureNs = nowNs;
+
+    int64_t offset = 0;
+    if (!measureOffset(nowNs, &offset)) return;
+    int64_t previous = offsetNs.exchange(offset, std::memory_order_relaxed);
+    if (llabs(offset - previous) > DRIFT_LOG_THRESHOLD_NS) {
+        LOGW("XrTime offset moved by %lld ns", (long long)(offset - previous));
+    }
+}
+
+bool xrClockCalibrated() {
+    return calibrated.load(std::memory_order_relaxed);
+}
+
+int64_t xrTimeToMonotonicNs(XrTime time) {
+    return time - offsetNs.load(std::memory_order_relaxed);
+}
+
+XrTime monotonicNsToXrTime(int64_t monotonicNs) {
+    return monotonicNs + offsetNs.load(std::memory_order_relaxed);
+}
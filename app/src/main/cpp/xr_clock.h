@@ -0,0 +1,35 @@
+#ifndef ANDROIDSAMSUNG_XR_CLOCK_H
+#define ANDROIDSAMSUNG_XR_CLOCK_H
+
+#include <stdint.h>
+
+#include "xr_dispatch.h"
+
+// Conversion between XrTime and the app's timebase (monotonicNowNs(), CLOCK_MONOTONIC).
+//
+// The offset between the two clocks is measured through XR_KHR_convert_timespec_time at
+// xrClockInit() and re-measured by xrClockRefresh() every XR_CLOCK_REFRESH_INTERVAL_NS, so
+// the conversions themselves are plain arithmetic and safe on the frame path and from any
+// thread. Profilers and traces convert runtime timestamps (predictedDisplayTime and the
+// like) through here so everything lines up on one clock.
+//
+// Without the extension the offset is assumed to be zero, which holds for runtimes that
+// report XrTime in CLOCK_MONOTONIC nanoseconds; xrClockCalibrated() then returns false.
+
+const int64_t XR_CLOCK_REFRESH_INTERVAL_NS = 10000000000LL;
+
+// Measures the offset for `instance`. `xr` must stay valid until xrClockShutdown().
+bool xrClockInit(const XrDispatchTable* xr, XrInstance instance);
+
+// Stops using the instance; call before destroying it. The last offset stays in effect.
+void xrClockShutdown();
+
+// Re-measures the offset if the refresh interval has passed. Call once per frame.
+void xrClockRefresh(int64_t nowNs);
+
+bool xrClockCalibrated();
+
+int64_t xrTimeToMonotonicNs(XrTime time);
+XrTime monotonicNsToXrTime(int64_t monotonicNs);
+
+#endif //ANDROIDSAMSUNG_XR_CLOCK_H
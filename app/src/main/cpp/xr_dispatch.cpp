@@ -0,0 +1,45 @@
+#include "xr_dispatch.h"
+
+#include <cstring>
+#include <vector>
+
+#define LOG_TAG "XrDispatch"
+#include "log.h"
+
+bool xrDispatchLoad(XrInstance instance, XrDispatchTable* table) {
+    return xrDispatchLoad(instance, xrGetInstanceProcAddr, table);
+}
+
+bool xrDispatchLoad(XrInstance instance, PFN_xrGetInstanceProcAddr getProcAddr, XrDispatchTable* table) {
+    *table = {};
+    bool complete = true;
+
+#define XR_DISPATCH_LOAD_CORE(name, feature) \
+    if (XR_FAILED(getProcAddr(instance, "xr" #name, reinterpret_cast<PFN_xrVoidFunction*>(&table->name))) || !table->name) { \
+        LOGE("Runtime does not provide xr" #name); \
+        complete = false; \
+    }
+#define XR_DISPATCH_LOAD_OPTIONAL(name, feature) \
+    if (XR_FAILED(getProcAddr(instance, "xr" #name, reinterpret_cast<PFN_xrVoidFunction*>(&table->name)))) { \
+        table->name = nullptr; \
+    }
+
+    XR_LIST_FUNCTIONS_XR_VERSION_1_0(XR_DISPATCH_LOAD_CORE)
+    XR_DISPATCH_LIST_OPTIONAL(XR_DISPATCH_LOAD_OPTIONAL)
+
+#undef XR_DISPATCH_LOAD_CORE
+#undef XR_DISPATCH_LOAD_OPTIONAL
+
+    return complete;
+}
+
+bool runtimeSupportsExtension(const char* name) {
+    uint32_t count = 0;
+    if (XR_FAILED(xrEnumerateInstanceExtensionProperties(nullptr, 0, &count, nullptr))) return false;
+    std::vector<XrExtensionProperties> properties(count, {XR_TYPE_EXTENSION_PROPERTIES});
+    if (XR_FAILED(xrEnumerateInstanceExtensionProperties(nullptr, count, &count, properties.data()))) return false;
+    for (const XrExtensionProperties& property : properties) {
+        if (strcmp(property.extensionName, name) == 0) return true;
+    }
+    return false;
+}
@@ -0,0 +1,55 @@
+#ifndef ANDROIDSAMSUNG_XR_DISPATCH_H
+#define ANDROIDSAMSUNG_XR_DISPATCH_H
+
+#include "xr_platform.h"
+#include <openxr/openxr_reflection.h>
+
+// Extension functions the app may use. Entries stay null when the extension is not enabled.
+#if defined(XR_USE_GRAPHICS_API_OPENGL_ES)
+#define XR_DISPATCH_LIST_OPENGL_ES(_) XR_LIST_FUNCTIONS_XR_KHR_opengl_es_enable(_)
+#else
+#define XR_DISPATCH_LIST_OPENGL_ES(_)
+#endif
+
+#if defined(XR_USE_TIMESPEC)
+#define XR_DISPATCH_LIST_TIMESPEC(_) XR_LIST_FUNCTIONS_XR_KHR_convert_timespec_time(_)
+#else
+#define XR_DISPATCH_LIST_TIMESPEC(_)
+#endif
+
+// openxr_reflection.h lists KHR_locate_spaces as a promoted alias without its functions
+#define XR_DISPATCH_LIST_KHR_LOCATE_SPACES(_) _(LocateSpacesKHR, KHR_locate_spaces)
+
+#define XR_DISPATCH_LIST_OPTIONAL(_) \
+    XR_LIST_FUNCTIONS_XR_VERSION_1_1(_) \
+    XR_DISPATCH_LIST_KHR_LOCATE_SPACES(_) \
+    XR_DISPATCH_LIST_OPENGL_ES(_) \
+    XR_DISPATCH_LIST_TIMESPEC(_) \
+    XR_LIST_FUNCTIONS_XR_FB_display_refresh_rate(_)
+
+// Runtime entry points for one instance, generated from the X-macro lists in
+// openxr_reflection.h and resolved once through xrGetInstanceProcAddr.
+//
+// Calling through the table skips the loader's exported trampolines (a PLT call plus the
+// loader's own instance lookup before it forwards to the same pointer). Use it for everything
+// on the frame path: xr.WaitFrame(session, ...) instead of xrWaitFrame(session, ...).
+struct XrDispatchTable {
+#define XR_DISPATCH_MEMBER(name, feature) PFN_xr##name name = nullptr;
+    XR_LIST_FUNCTIONS_XR_VERSION_1_0(XR_DISPATCH_MEMBER)
+    XR_DISPATCH_LIST_OPTIONAL(XR_DISPATCH_MEMBER)
+#undef XR_DISPATCH_MEMBER
+};
+
+// Fills the table for `instance`. Returns false if any core 1.0 function is missing.
+// Must be called again after the instance is recreated.
+bool xrDispatchLoad(XrInstance instance, XrDispatchTable* table);
+
+// Same, resolving through an explicit xrGetInstanceProcAddr (a runtime linked directly
+// rather than through the loader).
+bool xrDispatchLoad(XrInstance instance, PFN_xrGetInstanceProcAddr getProcAddr, XrDispatchTable* table);
+
+// Whether the runtime (through the loader) offers an instance extension. Enumerates on every
+// call, so use it while building the extension list, not per frame.
+bool runtimeSupportsExtension(const char* name);
+
+#endif //ANDROIDSAMSUNG_XR_DISPATCH_H
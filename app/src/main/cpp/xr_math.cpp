@@ -0,0 +1,83 @@
+#include "xr_math.h"
+
+#include <cmath>
+
+void matrix_identity(float* m) {
+    m[0] = 1; m[4] = 0; m[8] = 0;  m[12] = 0;
+    m[1] = 0; m[5] = 1; m[9] = 0;  m[13] = 0;
+    m[2] = 0; m[6] = 0; m[10] = 1; m[14] = 0;
+    m[3] = 0; m[7] = 0; m[11] = 0; m[15] = 1;
+}
+
+void matrix_multiply(const float* a, const float* b, float* r) {
+    for (int i = 0; i < 4; ++i) {
+        for (int j = 0; j < 4; ++j) {
+            r[i * 4 + j] = 0;
+            for (int k = 0; k < 4; ++k) {
+                r[i * 4 + j] += a[k * 4 + j] * b[i * 4 + k];
+            }
+        }
+    }
+}
+
+void matrix_translate(float x, float y, float z, float* m) {
+    matrix_identity(m);
+    m[12] = x;
+    m[13] = y;
+    m[14] = z;
+}
+
+void matrix_scale(float sx, float sy, float sz, float* m) {
+    matrix_identity(m);
+    m[0] = sx;
+    m[5] = sy;
+    m[10] = sz;
+}
+
+void matrix_create_projection_from_fov(const XrFovf& fov, float nearZ, float farZ, float* m) {
+    const float tan_left = tanf(fov.angleLeft);
+    const float tan_right = tanf(fov.angleRight);
+    const float tan_down = tanf(fov.angleDown);
+    const float tan_up = tanf(fov.angleUp);
+    const float tan_width = tan_right - tan_left;
+    const float tan_height = tan_up - tan_down;
+    m[0] = 2.0f / tan_width;
+    m[1] = 0.0f;
+    m[2] = 0.0f;
+    m[3] = 0.0f;
+    m[4] = 0.0f;
+    m[5] = 2.0f / tan_height;
+    m[6] = 0.0f;
+    m[7] = 0.0f;
+    m[8] = (tan_right + tan_left) / tan_width;
+    m[9] = (tan_up + tan_down) / tan_height;
+    m[10] = -(farZ + nearZ) / (farZ - nearZ);
+    m[11] = -1.0f;
+    m[12] = 0.0f;
+    m[13] = 0.0f;
+    m[14] = -2.0f * farZ * nearZ / (farZ - nearZ);
+    m[15] = 0.0f;
+}
+
+void matrix_create_view_from_pose(const XrPosef& pose, float* m) {
+    const XrQuaternionf& q = pose.orientation;
+    const XrVector3f& p = pose.position;
+    float x2 = q.x + q.x, y2 = q.y + q.y, z2 = q.z + q.z;
+    float xx = q.x * x2, xy = q.x * y2, xz = q.x * z2;
+    float yy = q.y * y2, yz = q.y * z2, zz = q.z * z2;
+    float wx = q.w * x2, wy = q.w * y2, wz = q.w * z2;
+    m[0] = 1 - (yy + zz); m[4] = xy - wz;     m[8] = xz + wy;      m[12] = -(m[0] * p.x + m[4] * p.y + m[8] * p.z);
+    m[1] = xy + wz;      m[5] = 1 - (xx + zz); m[9] = yz - wx;      m[13] = -(m[1] * p.x + m[5] * p.y + m[9] * p.z);
+    m[2] = xz - wy;      m[6] = yz + wx;      m[10] = 1 - (xx + yy); m[14] = -(m[2] * p.x + m[6] * p.y + m[10] * p.z);
+    m[3] = 0;            m[7] = 0;            m[11] = 0;             m[15] = 1;
+}
+
+bool pose_faces_point(const XrPosef& pose, const XrVector3f& point) {
+    // Forward is -Z rotated by the orientation
+    const XrQuaternionf& q = pose.orientation;
+    XrVector3f forward = {-2.0f * (q.x * q.z + q.w * q.y),
+                          -2.0f * (q.y * q.z - q.w * q.x),
+                          -1.0f + 2.0f * (q.x * q.x + q.y * q.y)};
+    XrVector3f toPoint = {point.x - pose.position.x, point.y - pose.position.y, point.z - pose.position.z};
+    return forward.x * toPoint.x + forward.y * toPoint.y + forward.z * toPoint.z > 0.0f;
+}
@@ -0,0 +1,23 @@
+#ifndef ANDROIDSAMSUNG_XR_MATH_H
+#define ANDROIDSAMSUNG_XR_MATH_H
+
+#include <openxr/openxr.h>
+
+// 4x4 matrices for the renderer: 16 floats, column-major as glUniformMatrix4fv takes them
+// with transpose off. Outputs are written in full and must not alias the inputs.
+
+void matrix_identity(float* m);
+// r = a * b
+void matrix_multiply(const float* a, const float* b, float* r);
+void matrix_translate(float x, float y, float z, float* m);
+void matrix_scale(float sx, float sy, float sz, float* m);
+
+// OpenGL clip space (z in [-1, 1]) for an asymmetric OpenXR field of view
+void matrix_create_projection_from_fov(const XrFovf& fov, float nearZ, float farZ, float* m);
+// World-to-eye transform: the inverse of the rigid transform `pose` (unit quaternion)
+void matrix_create_view_from_pose(const XrPosef& pose, float* m);
+
+// Whether `point` lies in the half-space in front of `pose` (along its -Z axis)
+bool pose_faces_point(const XrPosef& pose, const XrVector3f& point);
+
+#endif //ANDROIDSAMSUNG_XR_MATH_H
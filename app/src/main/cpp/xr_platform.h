@@ -0,0 +1,43 @@
+#ifndef ANDROIDSAMSUNG_XR_PLATFORM_H
+#define ANDROIDSAMSUNG_XR_PLATFORM_H
+
+// Single place that decides which OpenXR platform and graphics bindings are compiled in.
+// Everything that touches OpenXR includes this instead of the OpenXR headers directly, so
+// every translation unit sees the same structs and function lists.
+
+#if defined(__ANDROID__)
+#ifndef XR_USE_PLATFORM_ANDROID
+#define XR_USE_PLATFORM_ANDROID
+#endif
+#ifndef XR_USE_GRAPHICS_API_OPENGL_ES
+#define XR_USE_GRAPHICS_API_OPENGL_ES
+#endif
+#else
+// Host tools drive GLES through a bare EGL context, which runtimes accept via XR_MNDX_egl_enable.
+// Desktop runtimes without XR_KHR_opengl_es_enable take the same binding under
+// XR_KHR_opengl_enable, whose swapchain images have the same layout.
+#ifndef XR_USE_PLATFORM_EGL
+#define XR_USE_PLATFORM_EGL
+#endif
+#ifndef XR_USE_GRAPHICS_API_OPENGL_ES
+#define XR_USE_GRAPHICS_API_OPENGL_ES
+#endif
+#ifndef XR_USE_GRAPHICS_API_OPENGL
+#define XR_USE_GRAPHICS_API_OPENGL
+#endif
+#endif
+
+#ifndef XR_USE_TIMESPEC
+#define XR_USE_TIMESPEC
+#endif
+
+#include <time.h>
+#if defined(__ANDROID__)
+#include <jni.h>
+#endif
+#include <EGL/egl.h>
+#include <GLES3/gl3.h>
+#include <openxr/openxr.h>
+#include <openxr/openxr_platform.h>
+
+#endif //ANDROIDSAMSUNG_XR_PLATFORM_H